@@ -2,6 +2,8 @@
 #include <stdlib.h>   // atoi, malloc, free, posix_memalign, _Exit, EXIT_SUCCESS/FAILURE
 #include <stdint.h>
 #include "simd.h"
+#include "sysconf.h"
+#include "affinity.h" // set_affinity
 #include "environ.h"  // detectCPU, detectSIMD, printSysconf
 #include "timers.h"
 
@@ -46,18 +48,6 @@ using std::endl;
 #endif
 
 
-/*!
- *  \todo Move this definition of omp_enabled to .cpp definition file, placed here temporarily to prevent multiple definition error
- */
-bool SYSCONF::omp_enabled; // = false;
-int32_t SYSCONF::omp_threads; // = 1;
-size_t SYSCONF::L1l_elems_i32;
-size_t SYSCONF::L1c_elems_i32;
-size_t SYSCONF::L2l_elems_i32;
-size_t SYSCONF::L2c_elems_i32;
-size_t SYSCONF::page_sz;
-
-
 int main(int argc, char *argv[])
 {
     long int timer[2];
@@ -76,8 +66,12 @@ int main(int argc, char *argv[])
 
     detectCPU();
     detectSIMD();
-    SYSCONF::initSysconf();
-    SYSCONF::printSysconf();
+    gvl::SYSCONF::initSysconf();
+    gvl::SYSCONF::printSysconf();
+
+    // Reproducible placement, one thread per physical core
+    gvl::set_affinity(gvl::AFFINITY_CORES, NUM_THREADS);
+    gvl::print_affinity();
 
     cout << "Alignment: " << alignment << endl;
     cout << "Num. elems: " << n << endl;
@@ -135,8 +129,8 @@ int main(int argc, char *argv[])
 
 
 #if OO_VERSION == 1
-    SYSCONF::set_omp(NUM_THREADS);
-    SYSCONF::omp_settings();
+    gvl::SYSCONF::set_omp(NUM_THREADS);
+    gvl::SYSCONF::omp_settings();
 
     tic(timer);
 
@@ -154,7 +148,7 @@ int main(int argc, char *argv[])
     for (size_t i = elem_offs; i < n; ++i) {
         if (C1[i] != C2[i])
             result += 1;
-        if (n <= (2 * (SYSCONF::getL2LineSz() / sizeof(*A))))
+        if (n <= (2 * (gvl::SYSCONF::getL2LineSz() / sizeof(*A))))
             cout << C1[i] << " == " << C2[i] << endl;
     }
 
@@ -9,6 +9,18 @@
 int test_simd_add_classic(int, int);
 int test_simd_add_func(int, int);
 int test_simd_add_oo(int, int);
+int test_simd_add_kernel(int, int);
+int test_simd_add_dispatch(int, int);
+int test_simd_irregular_steal(int, int);
+int test_simd_vec_oo(int, int);
+int test_simd_expr(int, int);
+int test_simd_soa(int, int);
+int test_simd_batched_gemv(int, int);
+int test_simd_gemm(int, int);
+int test_simd_mat(int, int);
+int test_simd_spmv(int, int);
+int test_simd_stencil(int, int);
+int test_simd_scan(int, int);
 int test_simd_loop_dependence_classic(int, int);
 int test_simd_loop_dependence(int, int);
 int test_simd_loop_dependence2(int, int);
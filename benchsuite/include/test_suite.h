@@ -31,6 +31,18 @@ struct TEST_T TESTS[] =
     { test_simd_add_classic, "(Classic) Add signed 32-bit integers" },
     { test_simd_add_func, "(SIMD function) Add signed 32-bit integers" },
     { test_simd_add_oo, "(SIMD OO) Add signed 32-bit integers" },
+    { test_simd_add_kernel, "(SIMD kernel) Add signed 32-bit integers" },
+    { test_simd_add_dispatch, "(SIMD dispatch) Add signed 32-bit integers" },
+    { test_simd_irregular_steal, "(SIMD work stealing) Early-exit searches of irregular cost, OpenMP static versus work stealing" },
+    { test_simd_vec_oo, "(SIMD vec) Vector objects versus SIMD functions for single-precision floating-point and 32-bit integer numbers" },
+    { test_simd_expr, "(SIMD expression) Fused array expression of single-precision floating-point numbers" },
+    { test_simd_soa, "(SIMD SoA) Particle updates with array-of-structs, structure-of-arrays and AoSoA layouts" },
+    { test_simd_batched_gemv, "(SIMD batched) Matrix-vector products of many 6x6 single-precision matrices, row-padded versus compact layout" },
+    { test_simd_gemm, "(SIMD gemm) Single-precision matrix-matrix product, loop nest versus packed register-blocked kernel" },
+    { test_simd_mat, "(SIMD mat) Products of many 4x4 single-precision matrices, loop nest versus fixed-size matrices" },
+    { test_simd_spmv, "(SIMD spmv) Sparse matrix-vector product of a graph-like single-precision matrix, scalar CSR versus CSR gather and SELL-C-sigma" },
+    { test_simd_stencil, "(SIMD stencil) Time steps of a 5-point single-precision stencil, unaligned loads versus register rotation and temporal blocking" },
+    { test_simd_scan, "(SIMD scan) Exclusive sums of 32-bit integers and inclusive sums of single-precision values, scalar loops versus in-register scans" },
     //{ test_simd_loop_dependence_classic, "(Classic) Loop dependence" },
     //{ test_simd_loop_dependence, "(SIMD) Loop dependence" },
     //{ test_simd_loop_dependence2, "(SIMD) Loop dependence 2" },
@@ -10,6 +10,21 @@
 #include "test_utils.h"
 #include "test_simd.h"
 #include "timers.h"
+#include "sysconf.h"
+#include "dispatch.h"
+#include "arena.h"
+#include "vec.h"
+#include "expr.h"
+#include "kernels.h"
+#include "soa.h"
+#include "transpose.h"
+#include "batched.h"
+#include "gemm.h"
+#include "mat.h"
+#include "spmv.h"
+#include "stencil.h"
+#include "scan.h"
+#include <vector>
 
 
 #if defined(_OPENMP)
@@ -18,7 +33,7 @@
 
 
 // Deallocate dynamic memory and nullify pointer
-#define FREE(p) do { if(p) { free(p); p = NULL; } } while(0)
+#define FREE(p) do { if(p) { gvl::pool_free(p); p = NULL; } } while(0)
 
 
 int test_simd_add_classic(int num_elems, int offset_elems)
@@ -265,7 +280,7 @@ int test_simd_add_oo(int num_elems, int offset_elems)
         elapsed = 0.0;
         tic(timer);
 
-        C1 = add(pA, pB, num_elems);
+        C1 = gvl::add(pA, pB, num_elems, true, gvl::pool_allocator());
 
         elapsed = toc(timer);
         printf("(SIMD OO) Elapsed time is %f seconds for %d elements, offset by %d elements\n", elapsed, num_elems, offset_elems);
@@ -284,6 +299,1046 @@ int test_simd_add_oo(int num_elems, int offset_elems)
 }
 
 
+int test_simd_add_kernel(int num_elems, int offset_elems)
+{
+    long int timer[2];
+    double elapsed = 0.0;
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+
+    {
+        const TEST_TYPES test_type = TEST_I32;
+        int32_t *A = NULL, *B = NULL, *C1 = NULL, *C2 = NULL;
+        int32_t *pA = NULL, *pB = NULL;
+
+        create_test_array(test_type, (void **)&A, num_elems + offset_elems, alignment);
+        create_test_array(test_type, (void **)&B, num_elems + offset_elems, alignment);
+        create_empty_array(test_type, (void **)&C1, num_elems, alignment);
+        create_empty_array(test_type, (void **)&C2, num_elems, alignment);
+
+        pA = A + offset_elems;
+        pB = B + offset_elems;
+
+        elapsed = 0.0;
+        tic(timer);
+
+        gvl::add(C1, pA, pB, num_elems);
+
+        elapsed = toc(timer);
+        printf("(SIMD kernel) Elapsed time is %f seconds for %d elements, offset by %d elements\n", elapsed, num_elems, offset_elems);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = pA[i] + pB[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        FREE(A); pA = NULL;
+        FREE(B); pB = NULL;
+        FREE(C1);
+        FREE(C2);
+    }
+
+    return test_result;
+}
+
+
+// Range functor adding arrays with the add kernel
+struct test_add_range
+{
+    typedef int32_t stype;
+    int32_t *sc;
+    const int32_t *sa, *sb;
+
+    void operator()(const size_t lo, const size_t hi) const
+    { gvl::add(sc + lo, sa + lo, sb + lo, hi - lo); }
+};
+
+int test_simd_add_dispatch(int num_elems, int offset_elems)
+{
+    long int timer[2];
+    double elapsed = 0.0;
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+
+    {
+        const TEST_TYPES test_type = TEST_I32;
+        int32_t *A = NULL, *B = NULL, *C1 = NULL, *C2 = NULL;
+        int32_t *pA = NULL, *pB = NULL;
+
+        create_test_array(test_type, (void **)&A, num_elems + offset_elems, alignment);
+        create_test_array(test_type, (void **)&B, num_elems + offset_elems, alignment);
+        create_empty_array(test_type, (void **)&C1, num_elems, alignment);
+        create_empty_array(test_type, (void **)&C2, num_elems, alignment);
+
+        pA = A + offset_elems;
+        pB = B + offset_elems;
+
+        test_add_range k;
+        k.sc = C1;
+        k.sa = pA;
+        k.sb = pB;
+
+        elapsed = 0.0;
+        tic(timer);
+
+        gvl::parallel_for(num_elems, k);
+
+        elapsed = toc(timer);
+        printf("(SIMD dispatch) Elapsed time is %f seconds for %d elements, offset by %d elements, %d threads\n", elapsed, num_elems, offset_elems, gvl::get_dispatch_threads());
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = pA[i] + pB[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        FREE(A); pA = NULL;
+        FREE(B); pB = NULL;
+        FREE(C1);
+        FREE(C2);
+    }
+
+    return test_result;
+}
+
+// Early-exit search per element, cost grows along the range
+struct test_search_range
+{
+    typedef int32_t stype;
+    int32_t *sc;
+    const int32_t *sa;
+    int32_t n;
+
+    void operator()(const size_t lo, const size_t hi) const
+    {
+        for (size_t i = lo; i < hi; ++i) {
+            const int32_t limit = (int32_t)(((int64_t)i * 1024) / n);
+            int32_t j = 0;
+            while (j < limit && sa[j] != -1)
+                ++j;
+            sc[i] = j;
+        }
+    }
+};
+
+int test_simd_irregular_steal(int num_elems, int offset_elems)
+{
+    long int timer[2];
+    double elapsed = 0.0;
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+
+    {
+        const TEST_TYPES test_type = TEST_I32;
+        int32_t *A = NULL, *C1 = NULL, *C2 = NULL;
+        int32_t *pA = NULL;
+
+        create_test_array(test_type, (void **)&A, 1024 + offset_elems, alignment);
+        create_empty_array(test_type, (void **)&C1, num_elems, alignment);
+        create_empty_array(test_type, (void **)&C2, num_elems, alignment);
+
+        pA = A + offset_elems;
+        for (int i = 0; i < 1024; ++i)
+            pA[i] = (pA[i] == -1) ? (0) : (pA[i]);
+
+        test_search_range k;
+        k.sc = C1;
+        k.sa = pA;
+        k.n = num_elems;
+
+        elapsed = 0.0;
+        tic(timer);
+
+        gvl::parallel_for(num_elems, k);
+
+        elapsed = toc(timer);
+        printf("(SIMD dispatch) Elapsed time is %f seconds for %d elements, offset by %d elements, %d threads\n", elapsed, num_elems, offset_elems, gvl::get_dispatch_threads());
+
+        k.sc = C2;
+        elapsed = 0.0;
+        tic(timer);
+
+        gvl::steal_for(num_elems, k);
+
+        elapsed = toc(timer);
+        printf("(SIMD work stealing) Elapsed time is %f seconds for %d elements, offset by %d elements, %d threads\n", elapsed, num_elems, offset_elems, gvl::get_dispatch_threads());
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        FREE(A); pA = NULL;
+        FREE(C1);
+        FREE(C2);
+    }
+
+    return test_result;
+}
+
+
+
+int test_simd_vec_oo(int num_elems, int offset_elems)
+{
+    long int timer[2];
+    double elapsed = 0.0;
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+
+    // Vector objects should not add storage to the SIMD datatype
+    if (sizeof(gvl::flt32_v) != sizeof(SIMD_FLT)) {
+        printf("(SIMD vec) Size of vector object is %d bytes, expected %d bytes\n", (int)sizeof(gvl::flt32_v), (int)sizeof(SIMD_FLT));
+        ++test_result;
+    }
+    if (sizeof(gvl::int32_v) != sizeof(SIMD_INT)) {
+        printf("(SIMD vec) Size of vector object is %d bytes, expected %d bytes\n", (int)sizeof(gvl::int32_v), (int)sizeof(SIMD_INT));
+        ++test_result;
+    }
+
+    // Both versions are validated against the scalar loop, the element-wise
+    // operations are exact so results have to be identical
+    {
+        const TEST_TYPES test_type = TEST_FLT;
+        const int streams = SIMD_STREAMS_32;
+        float *A = NULL, *B = NULL, *C0 = NULL, *C1 = NULL, *C2 = NULL;
+        float *pA = NULL, *pB = NULL;
+
+        create_test_array(test_type, (void **)&A, num_elems + offset_elems, alignment);
+        create_test_array(test_type, (void **)&B, num_elems + offset_elems, alignment);
+        create_empty_array(test_type, (void **)&C0, num_elems, alignment);
+        create_empty_array(test_type, (void **)&C1, num_elems, alignment);
+        create_empty_array(test_type, (void **)&C2, num_elems, alignment);
+
+        pA = A + offset_elems;
+        pB = B + offset_elems;
+
+        const int rem = num_elems & (streams - 1);
+        int i;
+
+        for (i = 0; i < num_elems; ++i) {
+            const float c = pA[i] * pB[i] + (pA[i] - pB[i]);
+            C0[i] = (pA[i] < pB[i]) ? pA[i] : c;
+        }
+
+        // Raw SIMD functions
+        elapsed = 0.0;
+        tic(timer);
+        for (i = 0; i < (num_elems - rem); i+=streams) {
+            SIMD_FLT va = simd_loadu(&pA[i]);
+            SIMD_FLT vb = simd_loadu(&pB[i]);
+            SIMD_FLT vc = simd_add(simd_mul(va, vb), simd_sub(va, vb));
+            vc = simd_blend(vc, va, simd_cmplt(va, vb));
+            simd_store(&C1[i], vc);
+        }
+        for (; i < num_elems; ++i) {
+            const float c = pA[i] * pB[i] + (pA[i] - pB[i]);
+            C1[i] = (pA[i] < pB[i]) ? pA[i] : c;
+        }
+        elapsed = toc(timer);
+        printf("(SIMD function) Elapsed time is %f seconds for %d elements, offset by %d elements\n", elapsed, num_elems, offset_elems);
+
+        // Vector objects
+        elapsed = 0.0;
+        tic(timer);
+        for (i = 0; i < (num_elems - rem); i+=streams) {
+            gvl::flt32_v va(&pA[i]);
+            gvl::flt32_v vb(&pB[i]);
+            gvl::flt32_v vc = va * vb + (va - vb);
+            vc = select(va < vb, va, vc);
+            vc.store(&C2[i]);
+        }
+        // Remainder with partial loads/stores
+        if (rem > 0) {
+            gvl::flt32_v va(&pA[i], rem);
+            gvl::flt32_v vb(&pB[i], rem);
+            gvl::flt32_v vc = va * vb + (va - vb);
+            vc = select(va < vb, va, vc);
+            vc.storeu(&C2[i], rem);
+        }
+        elapsed = toc(timer);
+        printf("(SIMD vec) Elapsed time is %f seconds for %d elements, offset by %d elements\n", elapsed, num_elems, offset_elems);
+
+        test_result += validate_test_arrays(test_type, (void *)C0, (void *)C1, num_elems);
+        test_result += validate_test_arrays(test_type, (void *)C0, (void *)C2, num_elems);
+
+        FREE(A); pA = NULL;
+        FREE(B); pB = NULL;
+        FREE(C0);
+        FREE(C1);
+        FREE(C2);
+    }
+
+    {
+        const TEST_TYPES test_type = TEST_I32;
+        const int streams = SIMD_STREAMS_32;
+        int32_t *A = NULL, *B = NULL, *C0 = NULL, *C1 = NULL, *C2 = NULL;
+        int32_t *pA = NULL, *pB = NULL;
+
+        create_test_array(test_type, (void **)&A, num_elems + offset_elems, alignment);
+        create_test_array(test_type, (void **)&B, num_elems + offset_elems, alignment);
+        create_empty_array(test_type, (void **)&C0, num_elems, alignment);
+        create_empty_array(test_type, (void **)&C1, num_elems, alignment);
+        create_empty_array(test_type, (void **)&C2, num_elems, alignment);
+
+        pA = A + offset_elems;
+        pB = B + offset_elems;
+
+        const int rem = num_elems & (streams - 1);
+        int i;
+
+        // Products wrap around, computed unsigned to avoid overflow
+        for (i = 0; i < num_elems; ++i) {
+            const int32_t c = (int32_t)((uint32_t)pA[i] * (uint32_t)pB[i] + (uint32_t)pA[i] - (uint32_t)pB[i]);
+            C0[i] = (pA[i] < pB[i]) ? pA[i] : (c ^ pB[i]);
+        }
+
+        // Raw SIMD functions
+        elapsed = 0.0;
+        tic(timer);
+        for (i = 0; i < (num_elems - rem); i+=streams) {
+            SIMD_INT va = simd_loadu(&pA[i]);
+            SIMD_INT vb = simd_loadu(&pB[i]);
+            SIMD_INT vc = simd_sub_32(simd_add_32(simd_mul_32(va, vb), va), vb);
+            vc = simd_blend(simd_xor(vc, vb), va, simd_cmplt_i32(va, vb));
+            simd_store(&C1[i], vc);
+        }
+        for (; i < num_elems; ++i) {
+            const int32_t c = (int32_t)((uint32_t)pA[i] * (uint32_t)pB[i] + (uint32_t)pA[i] - (uint32_t)pB[i]);
+            C1[i] = (pA[i] < pB[i]) ? pA[i] : (c ^ pB[i]);
+        }
+        elapsed = toc(timer);
+        printf("(SIMD function) Elapsed time is %f seconds for %d elements, offset by %d elements\n", elapsed, num_elems, offset_elems);
+
+        // Vector objects
+        elapsed = 0.0;
+        tic(timer);
+        for (i = 0; i < (num_elems - rem); i+=streams) {
+            gvl::int32_v va(&pA[i]);
+            gvl::int32_v vb(&pB[i]);
+            gvl::int32_v vc = va * vb + va - vb;
+            vc = select(va < vb, va, vc ^ vb);
+            vc.store(&C2[i]);
+        }
+        if (rem > 0) {
+            gvl::int32_v va(&pA[i], rem);
+            gvl::int32_v vb(&pB[i], rem);
+            gvl::int32_v vc = va * vb + va - vb;
+            vc = select(va < vb, va, vc ^ vb);
+            vc.storeu(&C2[i], rem);
+        }
+        elapsed = toc(timer);
+        printf("(SIMD vec) Elapsed time is %f seconds for %d elements, offset by %d elements\n", elapsed, num_elems, offset_elems);
+
+        test_result += validate_test_arrays(test_type, (void *)C0, (void *)C1, num_elems);
+        test_result += validate_test_arrays(test_type, (void *)C0, (void *)C2, num_elems);
+
+        FREE(A); pA = NULL;
+        FREE(B); pB = NULL;
+        FREE(C0);
+        FREE(C1);
+        FREE(C2);
+    }
+
+    return test_result;
+}
+
+
+int test_simd_expr(int num_elems, int offset_elems)
+{
+    long int timer[2];
+    double elapsed = 0.0;
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+
+    {
+        const TEST_TYPES test_type = TEST_FLT;
+        float *A = NULL, *B = NULL, *C = NULL, *E = NULL, *D1 = NULL, *D2 = NULL;
+        float *pA = NULL, *pB = NULL, *pC = NULL, *pE = NULL;
+
+        create_test_array(test_type, (void **)&A, num_elems + offset_elems, alignment);
+        create_test_array(test_type, (void **)&B, num_elems + offset_elems, alignment);
+        create_test_array(test_type, (void **)&C, num_elems + offset_elems, alignment);
+        create_test_array(test_type, (void **)&E, num_elems + offset_elems, alignment);
+        create_empty_array(test_type, (void **)&D1, num_elems, alignment);
+        create_empty_array(test_type, (void **)&D2, num_elems, alignment);
+
+        pA = A + offset_elems;
+        pB = B + offset_elems;
+        pC = C + offset_elems;
+        pE = E + offset_elems;
+
+        // Small integer values keep results exact with or without FMA
+        for (int i = 0; i < num_elems; ++i) {
+            pA[i] = (float)(i % 5);
+            pB[i] = (float)(i % 3);
+            pC[i] = (float)(i % 11);
+            pE[i] = (float)(i % 4);
+        }
+
+        elapsed = 0.0;
+        tic(timer);
+        for (int i = 0; i < num_elems; ++i)
+            D2[i] = pA[i] + pB[i] * pC[i] - pE[i];
+        elapsed = toc(timer);
+        printf("(Classic) Elapsed time is %f seconds for %d elements, offset by %d elements\n", elapsed, num_elems, offset_elems);
+
+        gvl::varray<float> a(pA, num_elems), b(pB, num_elems), c(pC, num_elems), e(pE, num_elems);
+        gvl::varray<float> d(D1, num_elems);
+
+        // One array and memory pass per operation
+        elapsed = 0.0;
+        tic(timer);
+        {
+            gvl::varray<float> t1(b * c);
+            gvl::varray<float> t2(a + t1);
+            d = t2 - e;
+        }
+        elapsed = toc(timer);
+        printf("(SIMD temporaries) Elapsed time is %f seconds for %d elements, offset by %d elements\n", elapsed, num_elems, offset_elems);
+
+        test_result += validate_test_arrays(test_type, (void *)D1, (void *)D2, num_elems);
+
+        // Temporaries recycled by the pool, no system allocation after warm-up
+        {
+            gvl::varray<float, gvl::pool_allocator> t1(b * c);
+        }
+        elapsed = 0.0;
+        tic(timer);
+        {
+            gvl::varray<float, gvl::pool_allocator> t1(b * c);
+            gvl::varray<float, gvl::pool_allocator> t2(a + t1);
+            d = t2 - e;
+        }
+        elapsed = toc(timer);
+        printf("(SIMD pool temporaries) Elapsed time is %f seconds for %d elements, offset by %d elements\n", elapsed, num_elems, offset_elems);
+
+        test_result += validate_test_arrays(test_type, (void *)D1, (void *)D2, num_elems);
+
+        elapsed = 0.0;
+        tic(timer);
+        d = a + b * c - e;
+        elapsed = toc(timer);
+        printf("(SIMD expression) Elapsed time is %f seconds for %d elements, offset by %d elements\n", elapsed, num_elems, offset_elems);
+
+        test_result += validate_test_arrays(test_type, (void *)D1, (void *)D2, num_elems);
+
+        FREE(A); pA = NULL;
+        FREE(B); pB = NULL;
+        FREE(C); pC = NULL;
+        FREE(E); pE = NULL;
+        FREE(D1);
+        FREE(D2);
+    }
+
+    return test_result;
+}
+
+
+// Particle record for array-of-structs layout
+struct aos_particle {
+    float x, y, z;
+    float vx, vy, vz;
+};
+
+int test_simd_soa(int num_elems, int offset_elems)
+{
+    long int timer[2];
+    double elapsed = 0.0;
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+    const float dt = 0.5f;
+
+    {
+        const TEST_TYPES test_type = TEST_FLT;
+        float *A = NULL, *C1 = NULL, *C2 = NULL;
+        float *pA = NULL;
+
+        create_test_array(test_type, (void **)&A, 6 * num_elems + offset_elems, alignment);
+        create_empty_array(test_type, (void **)&C1, num_elems, alignment);
+        create_empty_array(test_type, (void **)&C2, num_elems, alignment);
+
+        pA = A + offset_elems;
+
+        aos_particle *aos = (aos_particle *)pA;
+        gvl::soa<float, float, float, float, float, float> parts;
+        gvl::aosoa<float, float, float, float, float, float> blocks;
+        parts.reserve(num_elems);
+        blocks.reserve(num_elems);
+        for (int i = 0; i < num_elems; ++i) {
+            parts.push_back(aos[i].x, aos[i].y, aos[i].z, aos[i].vx, aos[i].vy, aos[i].vz);
+            blocks.push_back(aos[i].x, aos[i].y, aos[i].z, aos[i].vx, aos[i].vy, aos[i].vz);
+        }
+
+        // Strided field accesses
+        elapsed = 0.0;
+        tic(timer);
+        for (int i = 0; i < num_elems; ++i) {
+            aos[i].x += dt * aos[i].vx;
+            aos[i].y += dt * aos[i].vy;
+            aos[i].z += dt * aos[i].vz;
+        }
+        elapsed = toc(timer);
+        printf("(Classic AoS) Elapsed time is %f seconds for %d elements, offset by %d elements\n", elapsed, num_elems, offset_elems);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = aos[i].x + aos[i].y + aos[i].z;
+
+        // Unit-stride vectors per field, padding needs no remainder loop
+        const gvl::vec<float> vdt(dt);
+        elapsed = 0.0;
+        tic(timer);
+        for (size_t i = 0; i < parts.padded_size(); i+=SIMD_STREAMS_32) {
+            parts.store<0>(i, parts.load<0>(i) + vdt * parts.load<3>(i));
+            parts.store<1>(i, parts.load<1>(i) + vdt * parts.load<4>(i));
+            parts.store<2>(i, parts.load<2>(i) + vdt * parts.load<5>(i));
+        }
+        elapsed = toc(timer);
+        printf("(SIMD SoA) Elapsed time is %f seconds for %d elements, offset by %d elements\n", elapsed, num_elems, offset_elems);
+
+        for (int i = 0; i < num_elems; ++i)
+            C1[i] = parts.get<0>(i) + parts.get<1>(i) + parts.get<2>(i);
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        elapsed = 0.0;
+        tic(timer);
+        for (size_t b = 0; b < blocks.nblocks(); ++b) {
+            blocks.store<0>(b, blocks.load<0>(b) + vdt * blocks.load<3>(b));
+            blocks.store<1>(b, blocks.load<1>(b) + vdt * blocks.load<4>(b));
+            blocks.store<2>(b, blocks.load<2>(b) + vdt * blocks.load<5>(b));
+        }
+        elapsed = toc(timer);
+        printf("(SIMD AoSoA) Elapsed time is %f seconds for %d elements, offset by %d elements\n", elapsed, num_elems, offset_elems);
+
+        for (int i = 0; i < num_elems; ++i)
+            C1[i] = blocks.get<0>(i) + blocks.get<1>(i) + blocks.get<2>(i);
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        FREE(A); pA = NULL;
+        FREE(C1);
+        FREE(C2);
+    }
+
+    return test_result;
+}
+
+
+int test_simd_batched_gemv(int num_elems, int offset_elems)
+{
+    long int timer[2];
+    double elapsed = 0.0;
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+    const int streams = SIMD_STREAMS_32;
+    const size_t N = 6;
+    const size_t nmat = (num_elems / (int)(N * N) > 0) ? (num_elems / (N * N)) : (1);
+
+    {
+        const TEST_TYPES test_type = TEST_FLT;
+        float *A = NULL, *X = NULL, *C1 = NULL, *C2 = NULL;
+        float *AP = NULL, *AC = NULL, *XC = NULL, *YC = NULL;
+
+        // Row-major matrices, rows padded to the SIMD width
+        const size_t lda = ((N + streams - 1) / streams) * streams;
+        create_empty_array(test_type, (void **)&A, nmat * N * N + offset_elems, alignment);
+        create_empty_array(test_type, (void **)&AP, nmat * N * lda, alignment);
+        create_empty_array(test_type, (void **)&X, lda * nmat, alignment);
+        create_empty_array(test_type, (void **)&C1, nmat * N, alignment);
+        create_empty_array(test_type, (void **)&C2, nmat * N, alignment);
+        create_empty_array(test_type, (void **)&AC, gvl::batch_elems<float>(nmat, N, N), alignment);
+        create_empty_array(test_type, (void **)&XC, gvl::batch_elems<float>(nmat, N, 1), alignment);
+        create_empty_array(test_type, (void **)&YC, gvl::batch_elems<float>(nmat, N, 1), alignment);
+
+        // Small integers keep sums exact in any order
+        float * const pA = A + offset_elems;
+        for (size_t i = 0; i < nmat * N * N; ++i)
+            pA[i] = (float)(rand() % 8);
+        for (size_t i = 0; i < nmat * N * lda; ++i)
+            AP[i] = ((i % lda) < N) ? (pA[(i / lda) * N + i % lda]) : (0.0f);
+        for (size_t i = 0; i < lda * nmat; ++i)
+            X[i] = ((i % lda) < N) ? ((float)(rand() % 8)) : (0.0f);
+
+        // One matrix at a time, a horizontal sum per row
+        elapsed = 0.0;
+        tic(timer);
+        for (size_t k = 0; k < nmat; ++k) {
+            const float * const pa = AP + k * N * lda;
+            const float * const px = X + k * lda;
+            for (size_t i = 0; i < N; ++i) {
+                SIMD_FLT vdp;
+                simd_set_zero(&vdp);
+                for (size_t j = 0; j < lda; j+=streams)
+                    vdp = simd_fmadd(simd_load(pa + i * lda + j), simd_load(px + j), vdp);
+                float tdp[SIMD_STREAMS_32] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+                simd_store(tdp, vdp);
+                float dp = 0.0f;
+                for (int l = 0; l < streams; ++l)
+                    dp += tdp[l];
+                C2[k * N + i] = dp;
+            }
+        }
+        elapsed = toc(timer);
+        printf("(SIMD row-padded) Elapsed time is %f seconds for %d matrices of %dx%d\n", elapsed, (int)nmat, (int)N, (int)N);
+
+        // One matrix per lane, packing is usually amortized over many products
+        elapsed = 0.0;
+        tic(timer);
+        gvl::batch_pack(AC, pA, nmat, N, N, N);
+        gvl::batch_pack(XC, X, nmat, 1, N, lda);
+        elapsed = toc(timer);
+        printf("(SIMD compact pack) Elapsed time is %f seconds for %d matrices of %dx%d\n", elapsed, (int)nmat, (int)N, (int)N);
+
+        elapsed = 0.0;
+        tic(timer);
+        gvl::batch_gemv(YC, AC, XC, nmat, N, N);
+        elapsed = toc(timer);
+        printf("(SIMD compact) Elapsed time is %f seconds for %d matrices of %dx%d\n", elapsed, (int)nmat, (int)N, (int)N);
+
+        gvl::batch_unpack(C1, 1, YC, nmat, N, 1);
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, nmat * N);
+
+        elapsed = 0.0;
+        tic(timer);
+        gvl::batch_gemv(YC, AC, XC, nmat, N, N, true);
+        elapsed = toc(timer);
+        printf("(SIMD compact parallel) Elapsed time is %f seconds for %d matrices of %dx%d\n", elapsed, (int)nmat, (int)N, (int)N);
+
+        gvl::batch_unpack(C1, 1, YC, nmat, N, 1);
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, nmat * N);
+
+        FREE(A);
+        FREE(AP);
+        FREE(X);
+        FREE(C1);
+        FREE(C2);
+        FREE(AC);
+        FREE(XC);
+        FREE(YC);
+    }
+
+    return test_result;
+}
+
+
+int test_simd_gemm(int num_elems, int offset_elems)
+{
+    long int timer[2];
+    double elapsed = 0.0;
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+
+    // Square matrices of about num_elems elements
+    size_t N = 1;
+    while ((N + 1) * (N + 1) <= (size_t)num_elems && N < 1024)
+        ++N;
+
+    {
+        const TEST_TYPES test_type = TEST_FLT;
+        float *A = NULL, *B = NULL, *C1 = NULL, *C2 = NULL;
+
+        create_empty_array(test_type, (void **)&A, N * N + offset_elems, alignment);
+        create_empty_array(test_type, (void **)&B, N * N, alignment);
+        create_empty_array(test_type, (void **)&C1, N * N, alignment);
+        create_empty_array(test_type, (void **)&C2, N * N, alignment);
+
+        // Small integers keep sums exact in any order
+        float * const pA = A + offset_elems;
+        for (size_t i = 0; i < N * N; ++i) {
+            pA[i] = (float)(rand() % 8);
+            B[i] = (float)(rand() % 8);
+        }
+
+        // Row of C updated with rows of B, vectorized by the compiler
+        elapsed = 0.0;
+        tic(timer);
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = 0; j < N; ++j)
+                C2[i * N + j] = 0.0f;
+            for (size_t p = 0; p < N; ++p)
+                for (size_t j = 0; j < N; ++j)
+                    C2[i * N + j] += pA[i * N + p] * B[p * N + j];
+        }
+        elapsed = toc(timer);
+        printf("(Classic) Elapsed time is %f seconds (%f GFLOPS) for %dx%d matrices, offset by %d elements\n", elapsed, 2e-9 * N * N * N / elapsed, (int)N, (int)N, offset_elems);
+
+        elapsed = 0.0;
+        tic(timer);
+        test_result += gvl::gemm(C1, N, pA, N, B, N, N, N, N);
+        elapsed = toc(timer);
+        printf("(SIMD gemm) Elapsed time is %f seconds (%f GFLOPS) for %dx%d matrices, offset by %d elements\n", elapsed, 2e-9 * N * N * N / elapsed, (int)N, (int)N, offset_elems);
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, N * N);
+
+        elapsed = 0.0;
+        tic(timer);
+        test_result += gvl::gemm(C1, N, pA, N, B, N, N, N, N, 1.0f, 0.0f, true);
+        elapsed = toc(timer);
+        printf("(SIMD gemm parallel) Elapsed time is %f seconds (%f GFLOPS) for %dx%d matrices, offset by %d elements\n", elapsed, 2e-9 * N * N * N / elapsed, (int)N, (int)N, offset_elems);
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, N * N);
+
+        FREE(A);
+        FREE(B);
+        FREE(C1);
+        FREE(C2);
+    }
+
+    return test_result;
+}
+
+
+int test_simd_mat(int num_elems, int offset_elems)
+{
+    long int timer[2];
+    double elapsed = 0.0;
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+    const size_t N = 4;
+    const size_t nmat = (num_elems / (int)(N * N) > 0) ? (num_elems / (N * N)) : (1);
+
+    {
+        const TEST_TYPES test_type = TEST_FLT;
+        float *A = NULL, *C1 = NULL, *C2 = NULL;
+
+        create_empty_array(test_type, (void **)&A, nmat * N * N + offset_elems, alignment);
+        create_empty_array(test_type, (void **)&C1, nmat * N * N, alignment);
+        create_empty_array(test_type, (void **)&C2, nmat * N * N, alignment);
+
+        // Small integers keep sums exact in any order
+        float * const pA = A + offset_elems;
+        for (size_t i = 0; i < nmat * N * N; ++i)
+            pA[i] = (float)(rand() % 8);
+        float sb[N * N];
+        for (size_t i = 0; i < N * N; ++i)
+            sb[i] = (float)(rand() % 8);
+
+        // Chain of products with a transform, as in geometry pipelines
+        elapsed = 0.0;
+        tic(timer);
+        for (size_t m = 0; m < nmat; ++m) {
+            const float * const a = pA + m * N * N;
+            float * const c = C2 + m * N * N;
+            for (size_t i = 0; i < N; ++i)
+                for (size_t j = 0; j < N; ++j) {
+                    float dp = 0.0f;
+                    for (size_t k = 0; k < N; ++k)
+                        dp += a[i * N + k] * sb[k * N + j];
+                    c[i * N + j] = dp;
+                }
+        }
+        elapsed = toc(timer);
+        printf("(Classic) Elapsed time is %f seconds for %d products of %dx%d matrices, offset by %d elements\n", elapsed, (int)nmat, (int)N, (int)N, offset_elems);
+
+        // Matrices kept in mat objects, conversions are not timed
+        const gvl::mat<float, N, N> mb(sb);
+        std::vector<gvl::mat<float, N, N> > ma(nmat), mc(nmat);
+        for (size_t m = 0; m < nmat; ++m)
+            ma[m].load(pA + m * N * N);
+
+        elapsed = 0.0;
+        tic(timer);
+        for (size_t m = 0; m < nmat; ++m)
+            mc[m] = ma[m] * mb;
+        elapsed = toc(timer);
+        printf("(SIMD mat) Elapsed time is %f seconds for %d products of %dx%d matrices, offset by %d elements\n", elapsed, (int)nmat, (int)N, (int)N, offset_elems);
+
+        for (size_t m = 0; m < nmat; ++m)
+            mc[m].store(C1 + m * N * N);
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, nmat * N * N);
+
+        FREE(A);
+        FREE(C1);
+        FREE(C2);
+    }
+
+    return test_result;
+}
+
+
+int test_simd_spmv(int num_elems, int offset_elems)
+{
+    long int timer[2];
+    double elapsed = 0.0;
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+    const size_t nrows = (num_elems / 8 > 0) ? (num_elems / 8) : (1);
+
+    {
+        const TEST_TYPES test_type = TEST_FLT;
+        float *X = NULL, *Y1 = NULL, *Y2 = NULL;
+
+        // Graph-like rows, mostly short with a few hubs
+        std::vector<size_t> row_ptr(nrows + 1, 0);
+        std::vector<int32_t> col_idx;
+        std::vector<float> val;
+        for (size_t i = 0; i < nrows; ++i) {
+            const size_t len = (rand() % 1000 == 0) ? (512) : (1 + rand() % 16);
+            for (size_t k = 0; k < len; ++k) {
+                col_idx.push_back(rand() % (int32_t)nrows);
+                val.push_back((float)(rand() % 4));
+            }
+            row_ptr[i + 1] = col_idx.size();
+        }
+        const gvl::csr_matrix<float> a(nrows, nrows, &row_ptr[0], &col_idx[0], &val[0]);
+
+        create_empty_array(test_type, (void **)&X, nrows + offset_elems, alignment);
+        create_empty_array(test_type, (void **)&Y1, nrows, alignment);
+        create_empty_array(test_type, (void **)&Y2, nrows, alignment);
+
+        // Small integers keep sums exact in any order
+        float * const pX = X + offset_elems;
+        for (size_t j = 0; j < nrows; ++j)
+            pX[j] = (float)(rand() % 8);
+
+        elapsed = 0.0;
+        tic(timer);
+        for (size_t i = 0; i < nrows; ++i) {
+            float dp = 0.0f;
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+                dp += val[k] * pX[col_idx[k]];
+            Y2[i] = dp;
+        }
+        elapsed = toc(timer);
+        printf("(Scalar CSR) Elapsed time is %f seconds for %d rows and %d nonzeros\n", elapsed, (int)nrows, (int)a.nnz());
+
+        elapsed = 0.0;
+        tic(timer);
+        gvl::spmv(Y1, a, pX);
+        elapsed = toc(timer);
+        printf("(SIMD CSR gather) Elapsed time is %f seconds for %d rows and %d nonzeros\n", elapsed, (int)nrows, (int)a.nnz());
+        test_result += validate_test_arrays(test_type, (void *)Y1, (void *)Y2, nrows);
+
+        // Conversion is amortized over the iterations of a solver or ranking job
+        const size_t sigmas[] = { 1, 256 };
+        for (size_t t = 0; t < sizeof(sigmas) / sizeof(sigmas[0]); ++t) {
+            elapsed = 0.0;
+            tic(timer);
+            const gvl::sell_matrix<float> b(a, sigmas[t]);
+            elapsed = toc(timer);
+            printf("(SELL-%d-%d convert) Elapsed time is %f seconds for %d stored elements\n", (int)b.C, (int)b.sigma(), elapsed, (int)b.elems());
+
+            elapsed = 0.0;
+            tic(timer);
+            gvl::spmv(Y1, b, pX);
+            elapsed = toc(timer);
+            printf("(SIMD SELL-%d-%d) Elapsed time is %f seconds for %d rows and %d nonzeros\n", (int)b.C, (int)b.sigma(), elapsed, (int)nrows, (int)a.nnz());
+            test_result += validate_test_arrays(test_type, (void *)Y1, (void *)Y2, nrows);
+
+            elapsed = 0.0;
+            tic(timer);
+            gvl::spmv(Y1, b, pX, true);
+            elapsed = toc(timer);
+            printf("(SIMD SELL-%d-%d parallel) Elapsed time is %f seconds for %d rows and %d nonzeros\n", (int)b.C, (int)b.sigma(), elapsed, (int)nrows, (int)a.nnz());
+            test_result += validate_test_arrays(test_type, (void *)Y1, (void *)Y2, nrows);
+        }
+
+        FREE(X);
+        FREE(Y1);
+        FREE(Y2);
+    }
+
+    return test_result;
+}
+
+
+int test_simd_stencil(int num_elems, int offset_elems)
+{
+    long int timer[2];
+    double elapsed = 0.0;
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+    const int streams = SIMD_STREAMS_32;
+    const size_t steps = 8;
+
+    // Grids must be aligned, offset_elems does not apply
+    (void)offset_elems;
+
+    {
+        const TEST_TYPES test_type = TEST_FLT;
+        float *A1 = NULL, *B1 = NULL, *A2 = NULL, *B2 = NULL;
+
+        // Square grid, 5-point diffusion
+        size_t n = 3;
+        while ((n + 1) * (n + 1) <= (size_t)num_elems)
+            ++n;
+        const gvl::stencil_grid<float> g(n, n);
+        const float w[3] = { 0.125f, 0.0f, 0.125f };
+        const gvl::stencil_coeffs<float, 2, 1> f(0.5f, w, w);
+
+        create_empty_array(test_type, (void **)&A1, g.elems(), alignment);
+        create_empty_array(test_type, (void **)&B1, g.elems(), alignment);
+        create_empty_array(test_type, (void **)&A2, g.elems(), alignment);
+        create_empty_array(test_type, (void **)&B2, g.elems(), alignment);
+        for (size_t i = 0; i < g.elems(); ++i)
+            A1[i] = B1[i] = A2[i] = B2[i] = (float)((i * 7) % 8);
+
+        // Neighbours in x are unaligned loads, same operations as the functor
+        elapsed = 0.0;
+        tic(timer);
+        const SIMD_FLT vc = simd_set(0.5f), vw = simd_set(0.125f);
+        float *pa = A2, *pb = B2;
+        for (size_t s = 0; s < steps; ++s) {
+            for (size_t y = 1; y + 1 < n; ++y) {
+                const float * const ra = pa + g.index(0, y);
+                float * const rb = pb + g.index(0, y);
+                size_t x = 1;
+                for (; x + streams + 1 <= n; x+=streams) {
+                    SIMD_FLT acc = simd_mul(vc, simd_loadu(&ra[x]));
+                    acc = simd_fmadd(vw, simd_loadu(&ra[x-1]), acc);
+                    acc = simd_fmadd(vw, simd_loadu(&ra[x-g.ldx]), acc);
+                    acc = simd_fmadd(vw, simd_loadu(&ra[x+1]), acc);
+                    acc = simd_fmadd(vw, simd_loadu(&ra[x+g.ldx]), acc);
+                    simd_storeu(&rb[x], acc);
+                }
+                for (; x + 1 < n; ++x) {
+                    float acc = 0.5f * ra[x];
+                    acc += 0.125f * ra[x-1];
+                    acc += 0.125f * ra[x-g.ldx];
+                    acc += 0.125f * ra[x+1];
+                    acc += 0.125f * ra[x+g.ldx];
+                    rb[x] = acc;
+                }
+            }
+            float * const pt = pa; pa = pb; pb = pt;
+        }
+        elapsed = toc(timer);
+        printf("(SIMD unaligned) Elapsed time is %f seconds for %d steps on %dx%d points\n", elapsed, (int)steps, (int)n, (int)n);
+
+        elapsed = 0.0;
+        tic(timer);
+        const float *pc = gvl::stencil_run(A1, B1, g, f, steps);
+        elapsed = toc(timer);
+        printf("(SIMD stencil) Elapsed time is %f seconds for %d steps on %dx%d points\n", elapsed, (int)steps, (int)n, (int)n);
+        test_result += validate_test_arrays(test_type, (void *)pc, (void *)pa, g.elems());
+
+        for (size_t i = 0; i < g.elems(); ++i)
+            A1[i] = B1[i] = (float)((i * 7) % 8);
+        elapsed = 0.0;
+        tic(timer);
+        pc = gvl::stencil_run(A1, B1, g, f, steps, steps);
+        elapsed = toc(timer);
+        printf("(SIMD stencil temporal) Elapsed time is %f seconds for %d steps on %dx%d points\n", elapsed, (int)steps, (int)n, (int)n);
+        test_result += validate_test_arrays(test_type, (void *)pc, (void *)pa, g.elems());
+
+        for (size_t i = 0; i < g.elems(); ++i)
+            A1[i] = B1[i] = (float)((i * 7) % 8);
+        elapsed = 0.0;
+        tic(timer);
+        pc = gvl::stencil_run(A1, B1, g, f, steps, steps, true);
+        elapsed = toc(timer);
+        printf("(SIMD stencil temporal parallel) Elapsed time is %f seconds for %d steps on %dx%d points\n", elapsed, (int)steps, (int)n, (int)n);
+        test_result += validate_test_arrays(test_type, (void *)pc, (void *)pa, g.elems());
+
+        FREE(A1);
+        FREE(B1);
+        FREE(A2);
+        FREE(B2);
+    }
+
+    return test_result;
+}
+
+
+int test_simd_scan(int num_elems, int offset_elems)
+{
+    long int timer[2];
+    double elapsed = 0.0;
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+
+    // Row lengths to row offsets, exclusive sums of 32-bit integers
+    {
+        const TEST_TYPES test_type = TEST_I32;
+        int32_t *A = NULL, *B1 = NULL, *B2 = NULL;
+
+        create_empty_array(test_type, (void **)&A, num_elems + offset_elems, alignment);
+        create_empty_array(test_type, (void **)&B1, num_elems, alignment);
+        create_empty_array(test_type, (void **)&B2, num_elems, alignment);
+        int32_t * const pA = A + offset_elems;
+        for (int i = 0; i < num_elems; ++i)
+            pA[i] = rand() % 16;
+
+        elapsed = 0.0;
+        tic(timer);
+        int32_t s = 0;
+        for (int i = 0; i < num_elems; ++i) {
+            B2[i] = s;
+            s += pA[i];
+        }
+        elapsed = toc(timer);
+        printf("(Scalar exclusive i32) Elapsed time is %f seconds for %d elements\n", elapsed, num_elems);
+
+        elapsed = 0.0;
+        tic(timer);
+        gvl::exclusive_scan(B1, pA, num_elems);
+        elapsed = toc(timer);
+        printf("(SIMD exclusive i32) Elapsed time is %f seconds for %d elements\n", elapsed, num_elems);
+        test_result += validate_test_arrays(test_type, (void *)B1, (void *)B2, num_elems);
+
+        elapsed = 0.0;
+        tic(timer);
+        gvl::exclusive_scan(B1, pA, num_elems, 0, true);
+        elapsed = toc(timer);
+        printf("(SIMD exclusive i32 parallel) Elapsed time is %f seconds for %d elements\n", elapsed, num_elems);
+        test_result += validate_test_arrays(test_type, (void *)B1, (void *)B2, num_elems);
+
+        FREE(A);
+        FREE(B1);
+        FREE(B2);
+    }
+
+    // Inclusive sums of single-precision values
+    {
+        const TEST_TYPES test_type = TEST_FLT;
+        float *A = NULL, *B1 = NULL, *B2 = NULL;
+
+        create_empty_array(test_type, (void **)&A, num_elems + offset_elems, alignment);
+        create_empty_array(test_type, (void **)&B1, num_elems, alignment);
+        create_empty_array(test_type, (void **)&B2, num_elems, alignment);
+
+        // Small integers keep sums exact in any order
+        float * const pA = A + offset_elems;
+        for (int i = 0; i < num_elems; ++i)
+            pA[i] = (float)(rand() % 3 - 1);
+
+        elapsed = 0.0;
+        tic(timer);
+        float s = 0.0f;
+        for (int i = 0; i < num_elems; ++i) {
+            s += pA[i];
+            B2[i] = s;
+        }
+        elapsed = toc(timer);
+        printf("(Scalar inclusive f32) Elapsed time is %f seconds for %d elements\n", elapsed, num_elems);
+
+        elapsed = 0.0;
+        tic(timer);
+        gvl::inclusive_scan(B1, pA, num_elems);
+        elapsed = toc(timer);
+        printf("(SIMD inclusive f32) Elapsed time is %f seconds for %d elements\n", elapsed, num_elems);
+        test_result += validate_test_arrays(test_type, (void *)B1, (void *)B2, num_elems);
+
+        elapsed = 0.0;
+        tic(timer);
+        gvl::inclusive_scan(B1, pA, num_elems, 0.0f, true);
+        elapsed = toc(timer);
+        printf("(SIMD inclusive f32 parallel) Elapsed time is %f seconds for %d elements\n", elapsed, num_elems);
+        test_result += validate_test_arrays(test_type, (void *)B1, (void *)B2, num_elems);
+
+        FREE(A);
+        FREE(B1);
+        FREE(B2);
+    }
+
+    return test_result;
+}
+
+
 int test_simd_loop_dependence_classic(int num_elems, int offset_elems)
 {
     long int timer[2];
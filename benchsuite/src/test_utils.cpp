@@ -1,43 +1,52 @@
-#include <stdlib.h>  // posix_memalign, rand
+#include <stdlib.h>  // rand
 #include <stdint.h>
 #include <limits.h>  // limits of fundamental integral types
 #include <float.h>   // floating-point epsilons
 #include <math.h>    // fabs
+#include "arena.h"   // pool_malloc
 #include "test_utils.h"
 
 
+// Test arrays come from the pool so repeated tests recycle buffers
+static int pool_memalign(void ** const arr, const int alignment, const size_t bytes)
+{
+    *arr = ((size_t)alignment <= gvl::POOL_ALIGN) ? (gvl::pool_malloc(bytes)) : (NULL);
+    return (*arr) ? (0) : (-1);
+}
+
+
 void create_empty_array(const TEST_TYPES test_type, void ** const arr, const int num_elems, const int alignment)
 {
     switch (test_type) {
         case TEST_I8:
-            posix_memalign((void **)arr, alignment, num_elems * sizeof(int8_t));
+            pool_memalign(arr, alignment, num_elems * sizeof(int8_t));
             break;
         case TEST_I16:
-            posix_memalign((void **)arr, alignment, num_elems * sizeof(int16_t));
+            pool_memalign(arr, alignment, num_elems * sizeof(int16_t));
             break;
         case TEST_I32:
-            posix_memalign((void **)arr, alignment, num_elems * sizeof(int32_t));
+            pool_memalign(arr, alignment, num_elems * sizeof(int32_t));
             break;
         case TEST_I64:
-            posix_memalign((void **)arr, alignment, num_elems * sizeof(int64_t));
+            pool_memalign(arr, alignment, num_elems * sizeof(int64_t));
             break;
         case TEST_U8:
-            posix_memalign((void **)arr, alignment, num_elems * sizeof(uint8_t));
+            pool_memalign(arr, alignment, num_elems * sizeof(uint8_t));
             break;
         case TEST_U16:
-            posix_memalign((void **)arr, alignment, num_elems * sizeof(uint16_t));
+            pool_memalign(arr, alignment, num_elems * sizeof(uint16_t));
             break;
         case TEST_U32:
-            posix_memalign((void **)arr, alignment, num_elems * sizeof(uint32_t));
+            pool_memalign(arr, alignment, num_elems * sizeof(uint32_t));
             break;
         case TEST_U64:
-            posix_memalign((void **)arr, alignment, num_elems * sizeof(uint64_t));
+            pool_memalign(arr, alignment, num_elems * sizeof(uint64_t));
             break;
         case TEST_FLT:
-            posix_memalign((void **)arr, alignment, num_elems * sizeof(float));
+            pool_memalign(arr, alignment, num_elems * sizeof(float));
             break;
         case TEST_DBL:
-            posix_memalign((void **)arr, alignment, num_elems * sizeof(double));
+            pool_memalign(arr, alignment, num_elems * sizeof(double));
             break;
     }
 }
@@ -47,52 +56,52 @@ void create_test_array(const TEST_TYPES test_type, void ** const arr, const int
 {
     switch (test_type) {
         case TEST_I8:
-            if (!posix_memalign((void **)arr, alignment, num_elems * sizeof(int8_t)))
+            if (!pool_memalign(arr, alignment, num_elems * sizeof(int8_t)))
                 for (int32_t i = 0; i < num_elems; ++i)
                     ((int8_t *)*arr)[i] = (int8_t)(rand() % SCHAR_MAX);
             break;
         case TEST_I16:
-            if (!posix_memalign((void **)arr, alignment, num_elems * sizeof(int16_t)))
+            if (!pool_memalign(arr, alignment, num_elems * sizeof(int16_t)))
                 for (int32_t i = 0; i < num_elems; ++i)
                     ((int16_t *)*arr)[i] = (int16_t)(rand() % SHRT_MAX);
             break;
         case TEST_I32:
-            if (!posix_memalign((void **)arr, alignment, num_elems * sizeof(int32_t)))
+            if (!pool_memalign(arr, alignment, num_elems * sizeof(int32_t)))
                 for (int32_t i = 0; i < num_elems; ++i)
                     ((int32_t *)*arr)[i] = (int32_t)(rand() % INT_MAX);
             break;
         case TEST_I64:
-            if (!posix_memalign((void **)arr, alignment, num_elems * sizeof(int64_t)))
+            if (!pool_memalign(arr, alignment, num_elems * sizeof(int64_t)))
                 for (int32_t i = 0; i < num_elems; ++i)
                     ((int64_t *)*arr)[i] = (int64_t)(rand() % LONG_MAX);
             break;
         case TEST_U8:
-            if (!posix_memalign((void **)arr, alignment, num_elems * sizeof(uint8_t)))
+            if (!pool_memalign(arr, alignment, num_elems * sizeof(uint8_t)))
                 for (int32_t i = 0; i < num_elems; ++i)
                     ((uint8_t *)*arr)[i] = (uint8_t)(rand() % UCHAR_MAX);
             break;
         case TEST_U16:
-            if (!posix_memalign((void **)arr, alignment, num_elems * sizeof(uint16_t)))
+            if (!pool_memalign(arr, alignment, num_elems * sizeof(uint16_t)))
                 for (int32_t i = 0; i < num_elems; ++i)
                     ((uint16_t *)*arr)[i] = (uint16_t)(rand() % USHRT_MAX);
             break;
         case TEST_U32:
-            if (!posix_memalign((void **)arr, alignment, num_elems * sizeof(uint32_t)))
+            if (!pool_memalign(arr, alignment, num_elems * sizeof(uint32_t)))
                 for (int32_t i = 0; i < num_elems; ++i)
                     ((uint32_t *)*arr)[i] = (uint32_t)(rand() % UINT_MAX);
             break;
         case TEST_U64:
-            if (!posix_memalign((void **)arr, alignment, num_elems * sizeof(uint64_t)))
+            if (!pool_memalign(arr, alignment, num_elems * sizeof(uint64_t)))
                 for (int32_t i = 0; i < num_elems; ++i)
                     ((uint64_t *)*arr)[i] = (uint64_t)(rand() % ULONG_MAX);
             break;
         case TEST_FLT:
-            if (!posix_memalign((void **)arr, alignment, num_elems * sizeof(float)))
+            if (!pool_memalign(arr, alignment, num_elems * sizeof(float)))
                 for (int32_t i = 0; i < num_elems; ++i)
                     ((float *)*arr)[i] = (float)(rand() % RAND_MAX) / RAND_MAX;
             break;
         case TEST_DBL:
-            if (!posix_memalign((void **)arr, alignment, num_elems * sizeof(double)))
+            if (!pool_memalign(arr, alignment, num_elems * sizeof(double)))
                 for (int32_t i = 0; i < num_elems; ++i)
                     ((double *)*arr)[i] = (double)(rand() % RAND_MAX) / RAND_MAX;
             break;
@@ -23,19 +23,30 @@
  *   sysconf
  */
 
+#include <stddef.h>  // NULL
+#include <stdint.h>
 #include <string>
 
 
+/*
+ *  CPUID is only available on x86, other architectures get zeros and
+ *  callers fall back to sysconf()
+ */
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#  define CPUID_AVAILABLE 1
+#endif
+
 #if defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 150030729
 // VC10+ and VC9 SP1 have:
 //   void __cpuid(int regs[4], int function)  // (subfunction) ECX = 0
 //   void __cpuidex(int regs[4], int function, int subfunction)
 #  include <intrin.h>
-#  define __cpuid__(r, f)       __cpuid((r), (f))
-#  define __cpuidex__(r, f, sf) __cpuidex((r), (f), (sf))
+#  define __cpuid__(r, f)       __cpuid((int *)(r), (f))
+#  define __cpuidex__(r, f, sf) __cpuidex((int *)(r), (f), (sf))
 #elif defined(__GNUC__)
-#  include <cpuid.h>
-#  define __cpuid__(r, f) ((void)__get_cpuid((f), &(r)[0], &(r)[1], &(r)[2], &(r)[3]))
+// NOTE: GCC <cpuid.h> is not included, this header shadows it if its
+// directory is in the include path
+#  define __cpuid__(r, f) __cpuidex__(r, f, 0)
 #  define __cpuidex__(r, f, sf) \
      asm volatile ("cpuid"      \
          : "=a" ((r)[0]),       \
@@ -51,14 +62,11 @@
 
 
 // Return flags/values from CPUID instruction.
-union cpuid_info {
-    uint32_t regs[4];
-    struct {
-        uint32_t eax;
-        uint32_t ebx;
-        uint32_t ecx;
-        uint32_t edx;
-    };
+struct cpuid_info {
+    uint32_t eax;
+    uint32_t ebx;
+    uint32_t ecx;
+    uint32_t edx;
 };
 
 
@@ -100,7 +108,8 @@ enum {
     // EAX=0x80000000, ECX
     _SSE4A = 6,
     _3DNOWPREFETCH = 8,
-    _FMA4 = 16
+    _FMA4 = 16,
+    _TOPOEXT = 22
 };
 
 
@@ -108,47 +117,92 @@ enum {
 struct features {
     std::string manufacturer_id;
     std::string processor_id;
-    int clsize = 0;  // cache line size
-    bool clflush = 0;
-    bool clflushopt = 0;
-    bool htt = 0;
-    bool fma3 = 0;
-    bool mmx = 0;
-    bool sse = 0;
-    bool sse2 = 0;
-    bool sse3 = 0;
-    bool ssse3 = 0;
-    bool sse4_1 = 0;
-    bool sse4_2 = 0;
-    bool avx = 0;
-    bool avx2 = 0;
-    bool avx512f = 0;
-    bool avx512dq = 0;
-    bool avx512pf = 0;
-    bool avx512er = 0;
-    bool avx512cd = 0;
-    bool avx512bw = 0;
-    bool avx512vl = 0;
-    bool avx512ifma = 0;
-    bool avx512fmaps = 0;
+    int clsize;  // cache line size
+    bool clflush;
+    bool clflushopt;
+    bool htt;
+    bool fma3;
+    bool mmx;
+    bool sse;
+    bool sse2;
+    bool sse3;
+    bool ssse3;
+    bool sse4_1;
+    bool sse4_2;
+    bool avx;
+    bool avx2;
+    bool avx512f;
+    bool avx512dq;
+    bool avx512pf;
+    bool avx512er;
+    bool avx512cd;
+    bool avx512bw;
+    bool avx512vl;
+    bool avx512ifma;
+    bool avx512fmaps;
     // Extended features begin with an underscore
-    bool _fma4 = 0;
-    bool _mmx = 0;
-    bool _mmxext = 0;
-    bool _sse4a = 0;
-    bool _3dnow = 0;
-    bool _3dnowext = 0;
-    bool _3dnowprefetch = 0;
+    bool _fma4;
+    bool _mmx;
+    bool _mmxext;
+    bool _sse4a;
+    bool _3dnow;
+    bool _3dnowext;
+    bool _3dnowprefetch;
+    bool _topoext;
+};
+
+
+// Cache types in CPUID leaf 4 and 0x8000001D.
+enum cache_type {
+    CACHE_NULL = 0,
+    CACHE_DATA = 1,
+    CACHE_INSTRUCTION = 2,
+    CACHE_UNIFIED = 3
+};
+
+
+// Cache level from CPUID leaf 4 (Intel), 0x8000001D (AMD) or 0x8000000[56] (legacy AMD).
+struct cache_info {
+    uint32_t level;      // 1, 2, 3, ...
+    uint32_t type;       // cache_type
+    uint32_t size;       // bytes
+    uint32_t line_size;  // bytes
+    uint32_t ways;       // associativity
+    uint32_t sets;
+    uint32_t sharing;    // maximum logical processors sharing this cache, 0 if unknown
+    bool inclusive;
+};
+
+
+// Processor topology from CPUID leaf 0x1F or 0xB (legacy leaves 1 and 4 otherwise).
+struct topology {
+    uint32_t smt_per_core;  // logical processors per core
+    uint32_t cores_per_package;
+    uint32_t logical_per_package;
+};
+
+
+#define MAX_CACHES 8
+
+// Processor descriptor, detected once on first use and read-only afterwards.
+struct cpu_desc {
+    struct features features;
+    struct topology topology;
+    struct cache_info caches[MAX_CACHES];
+    int ncaches;
 };
 
 
-union cpuid_info cpuid(uint32_t function);
-union cpuid_info cpuidex(uint32_t function, uint32_t subfunction);
+struct cpuid_info cpuid(uint32_t function);
+struct cpuid_info cpuidex(uint32_t function, uint32_t subfunction);
 uint32_t highest_function(void);
 uint32_t highest_extended_function(void);
 std::string manufacturer_id(void);
 std::string processor_id(void);
-struct features get_features(void);
+const struct cpu_desc & get_cpu_desc(void);
+const struct features & get_features(void);
+const struct topology & get_topology(void);
+const struct cache_info * get_cache(const uint32_t level, const bool data = true);
 
 
 #endif  // _CPUID_H
@@ -2,15 +2,25 @@
 #include "cpuid.h"
 
 
-union cpuid_info cpuidex(uint32_t function, uint32_t subfunction)
+struct cpuid_info cpuidex(uint32_t function, uint32_t subfunction)
 {
-    union cpuid_info info;
-    __cpuidex__(info.regs, function, subfunction);
+    uint32_t regs[4] = { 0, 0, 0, 0 };
+#if defined(CPUID_AVAILABLE)
+    __cpuidex__(regs, function, subfunction);
+#else
+    (void)function;
+    (void)subfunction;
+#endif
+    struct cpuid_info info;
+    info.eax = regs[0];
+    info.ebx = regs[1];
+    info.ecx = regs[2];
+    info.edx = regs[3];
     return info;
 }
 
 
-union cpuid_info cpuid(uint32_t function)
+struct cpuid_info cpuid(uint32_t function)
 {
     // EAX=0: Highest function parameter and manufacturer ID
     // EAX=1: Processor info and feature bits
@@ -26,7 +36,7 @@ union cpuid_info cpuid(uint32_t function)
     // EAX=80000007: Advanced power management info
     // EAX=80000008: Virtual and physical address sizes
 //    const uint32_t subfunction = 0;  // ECX
-//    union cpuid_info info;
+//    struct cpuid_info info;
 //    asm volatile (
 //        "cpuid" : "=a" (info.eax),
 //                  "=b" (info.ebx),
@@ -42,14 +52,14 @@ union cpuid_info cpuid(uint32_t function)
 
 uint32_t highest_function()
 {
-    union cpuid_info info = cpuid(0);
+    struct cpuid_info info = cpuid(0);
     return info.eax;
 }
 
 
 uint32_t highest_extended_function()
 {
-    union cpuid_info info = cpuid(0x80000000);
+    struct cpuid_info info = cpuid(0x80000000);
     return info.eax & 0x7FFFFFFF;  // mask 0x80000000
 }
 
@@ -57,7 +67,7 @@ uint32_t highest_extended_function()
 std::string manufacturer_id()
 {
     std::string id;
-    union cpuid_info info = cpuid(0);
+    struct cpuid_info info = cpuid(0);
     id += std::string((const char *)&info.ebx, sizeof(info.ebx));
     id += std::string((const char *)&info.edx, sizeof(info.edx));
     id += std::string((const char *)&info.ecx, sizeof(info.ecx));
@@ -68,10 +78,10 @@ std::string manufacturer_id()
 std::string processor_id()
 {
     std::string id;
-    uint32_t hxf = highest_function();
+    uint32_t hxf = highest_extended_function();
     if (hxf >= 4) {
-        union cpuid_info info;
-        for (int f = 0x80000002; f <= 0x80000004; f++) {
+        struct cpuid_info info;
+        for (uint32_t f = 0x80000002; f <= 0x80000004; f++) {
             info = cpuid(f);
             id += std::string((const char *)&info.eax, sizeof(info.eax));
             id += std::string((const char *)&info.ebx, sizeof(info.ebx));
@@ -83,10 +93,10 @@ std::string processor_id()
 }
 
 
-struct features get_features()
+static struct features detect_features()
 {
-    struct features vf;
-    union cpuid_info info;
+    struct features vf = features();
+    struct cpuid_info info;
 
     vf.manufacturer_id = manufacturer_id();
     vf.processor_id = processor_id(); 
@@ -133,7 +143,8 @@ struct features get_features()
         vf._3dnow = CHECK_BIT(info.edx, _3DNOW);
         vf._3dnowext = CHECK_BIT(info.edx, _3DNOWEXT);
         vf._3dnowprefetch = CHECK_BIT(info.ecx, _3DNOWPREFETCH);
-    } 
+        vf._topoext = CHECK_BIT(info.ecx, _TOPOEXT);
+    }
 
     // Extended L2 cache features
     if (hxf >= 6) {
@@ -144,3 +155,186 @@ struct features get_features()
 
     return vf;
 }
+
+
+// Decode a deterministic cache parameters leaf, same layout for Intel leaf 4 and AMD 0x8000001D
+static bool decode_cache(const struct cpuid_info &info, struct cache_info &ci)
+{
+    ci.type = info.eax & 0x1F;
+    if (ci.type == CACHE_NULL)
+        return false;
+    ci.level = (info.eax >> 5) & 0x7;
+    ci.sharing = ((info.eax >> 14) & 0xFFF) + 1;
+    ci.line_size = (info.ebx & 0xFFF) + 1;
+    const uint32_t partitions = ((info.ebx >> 12) & 0x3FF) + 1;
+    ci.ways = ((info.ebx >> 22) & 0x3FF) + 1;
+    ci.sets = info.ecx + 1;
+    ci.size = ci.ways * partitions * ci.line_size * ci.sets;
+    ci.inclusive = CHECK_BIT(info.edx, 1) != 0;
+    return true;
+}
+
+
+// AMD legacy L1/L2/L3 descriptors (EAX=80000005, 80000006), no sharing information
+static int detect_legacy_caches(struct cache_info *caches, const uint32_t hxf)
+{
+    // Associativity encoding of 0x80000006 ECX[15:12] and EDX[15:12]
+    static const uint32_t l2ways[16] = { 0, 1, 2, 0, 4, 0, 8, 0, 16, 0, 32, 48, 64, 96, 128, 0 };
+    int n = 0;
+
+    if (hxf >= 5) {
+        const struct cpuid_info info = cpuid(0x80000005);
+        if (info.ecx) {
+            struct cache_info &ci = caches[n++];
+            ci.level = 1;
+            ci.type = CACHE_DATA;
+            ci.size = (info.ecx >> 24) << 10;
+            ci.line_size = info.ecx & 0xFF;
+            ci.ways = (info.ecx >> 16) & 0xFF;
+            ci.sharing = 1;
+        }
+    }
+
+    if (hxf >= 6) {
+        const struct cpuid_info info = cpuid(0x80000006);
+        if (info.ecx >> 16) {
+            struct cache_info &ci = caches[n++];
+            ci.level = 2;
+            ci.type = CACHE_UNIFIED;
+            ci.size = (info.ecx >> 16) << 10;
+            ci.line_size = info.ecx & 0xFF;
+            ci.ways = l2ways[(info.ecx >> 12) & 0xF];
+            ci.sharing = 1;
+        }
+        if (info.edx >> 18) {
+            struct cache_info &ci = caches[n++];
+            ci.level = 3;
+            ci.type = CACHE_UNIFIED;
+            ci.size = (info.edx >> 18) << 19;  // 512 KB units
+            ci.line_size = info.edx & 0xFF;
+            ci.ways = l2ways[(info.edx >> 12) & 0xF];
+            ci.sharing = 0;  // unknown
+        }
+    }
+
+    for (int i = 0; i < n; ++i)
+        if (caches[i].line_size && caches[i].ways)
+            caches[i].sets = caches[i].size / (caches[i].line_size * caches[i].ways);
+    return n;
+}
+
+
+static int detect_caches(struct cache_info *caches, const struct features &vf)
+{
+    const uint32_t hf = highest_function();
+    const uint32_t hxf = highest_extended_function();
+    int n = 0;
+
+    // AMD reports leaf 4 as reserved, use its extended leaf when supported
+    uint32_t leaf = 0;
+    if (hxf >= 0x1D && vf._topoext)
+        leaf = 0x8000001D;
+    else if (hf >= 4 && vf.manufacturer_id != "AuthenticAMD")
+        leaf = 4;
+
+    if (leaf) {
+        for (uint32_t sf = 0; n < MAX_CACHES; ++sf) {
+            if (!decode_cache(cpuidex(leaf, sf), caches[n]))
+                break;
+            ++n;
+        }
+    }
+
+    if (n == 0)
+        n = detect_legacy_caches(caches, hxf);
+    return n;
+}
+
+
+static struct topology detect_topology(const struct features &vf)
+{
+    struct topology tp = topology();
+    const uint32_t hf = highest_function();
+
+    // Extended topology enumeration, V2 (0x1F) is a superset of 0xB
+    uint32_t leaf = 0;
+    if (hf >= 0x1F && cpuidex(0x1F, 0).ebx)
+        leaf = 0x1F;
+    else if (hf >= 0xB && cpuidex(0xB, 0).ebx)
+        leaf = 0xB;
+
+    if (leaf) {
+        // ECX[15:8] level type: 1 SMT, 2 core, >2 module/tile/die; EBX[15:0] logical processors at level
+        for (uint32_t sf = 0; sf < 8; ++sf) {
+            const struct cpuid_info info = cpuidex(leaf, sf);
+            const uint32_t type = (info.ecx >> 8) & 0xFF;
+            if (type == 0)
+                break;
+            if (type == 1)
+                tp.smt_per_core = info.ebx & 0xFFFF;
+            tp.logical_per_package = info.ebx & 0xFFFF;
+        }
+    } else if (hf >= 1) {
+        // Legacy: maximum logical processors per package (if HTT) and cores per package (Intel leaf 4)
+        tp.logical_per_package = (vf.htt) ? ((cpuid(1).ebx >> 16) & 0xFF) : (1);
+        if (hf >= 4 && vf.manufacturer_id != "AuthenticAMD") {
+            const uint32_t cores = (cpuidex(4, 0).eax >> 26) + 1;
+            if (cores <= tp.logical_per_package)
+                tp.smt_per_core = tp.logical_per_package / cores;
+        }
+    }
+
+    if (tp.smt_per_core == 0)
+        tp.smt_per_core = 1;
+    if (tp.logical_per_package == 0)
+        tp.logical_per_package = tp.smt_per_core;
+    tp.cores_per_package = tp.logical_per_package / tp.smt_per_core;
+    return tp;
+}
+
+
+static struct cpu_desc detect_cpu_desc()
+{
+    struct cpu_desc desc = cpu_desc();
+    desc.features = detect_features();
+    desc.topology = detect_topology(desc.features);
+    desc.ncaches = detect_caches(desc.caches, desc.features);
+    return desc;
+}
+
+
+/*
+ *  Descriptor is detected on first call (function-local static, guarded by
+ *  compiler) and is read-only afterwards, so callers need no locking
+ */
+const struct cpu_desc & get_cpu_desc()
+{
+    static const struct cpu_desc desc = detect_cpu_desc();
+    return desc;
+}
+
+
+const struct features & get_features()
+{
+    return get_cpu_desc().features;
+}
+
+
+const struct topology & get_topology()
+{
+    return get_cpu_desc().topology;
+}
+
+
+// Data (or unified) cache if data, else instruction (or unified) cache, NULL if level not found
+const struct cache_info * get_cache(const uint32_t level, const bool data)
+{
+    const struct cpu_desc &desc = get_cpu_desc();
+    const uint32_t type = (data) ? (CACHE_DATA) : (CACHE_INSTRUCTION);
+    for (int i = 0; i < desc.ncaches; ++i) {
+        const struct cache_info &ci = desc.caches[i];
+        if (ci.level == level && (ci.type == type || ci.type == CACHE_UNIFIED))
+            return &ci;
+    }
+    return NULL;
+}
@@ -41,4 +41,22 @@ int main()
     std::cout << "3DNow!: " << fs._3dnow << std::endl;
     std::cout << "Extended 3DNow!: " << fs._3dnowext << std::endl;
     std::cout << "3DNow! Prefetch: " << fs._3dnowprefetch << std::endl;
+    std::cout << "TOPOEXT: " << fs._topoext << std::endl;
+
+    std::cout << "Topology" << std::endl;
+    const struct topology &tp = get_topology();
+    std::cout << "SMT per core: " << tp.smt_per_core << std::endl;
+    std::cout << "Cores per package: " << tp.cores_per_package << std::endl;
+    std::cout << "Logical per package: " << tp.logical_per_package << std::endl;
+
+    std::cout << "Caches" << std::endl;
+    const struct cpu_desc &desc = get_cpu_desc();
+    static const char *types[] = { "null", "data", "instruction", "unified" };
+    for (int i = 0; i < desc.ncaches; ++i) {
+        const struct cache_info &ci = desc.caches[i];
+        std::cout << "L" << ci.level << " " << types[ci.type & 3]
+                  << ": " << ci.size << " B, line " << ci.line_size << " B, "
+                  << ci.ways << "-way, " << ci.sets << " sets, shared by "
+                  << ci.sharing << ", inclusive " << ci.inclusive << std::endl;
+    }
 }
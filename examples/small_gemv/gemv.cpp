@@ -11,13 +11,14 @@
 #include <ctime>
 #include <iostream>
 #include <vector>
-#include <boost/align/aligned_allocator.hpp>
 #include <cmath>
 // #include "papi.h"
 #include "simd.h"
 #include "environ.h"
 #include "utils.h"
 #include "vutils.h"
+#include "aligned_vector.h"
+#include "batched.h"
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -45,22 +46,22 @@ typedef SIMD_DBL vreal;
 
 // Number of floating-point values that fit into a SIMD register
 const int SIMD_STREAMS = SIMD_WIDTH_BYTES / sizeof(real);
-const int LOG2STREAMS = std::log2(SIMD_STREAMS);
+// log2 of a power of two, std::log2() is C++11
+static int ilog2(const int n)
+{ return (n > 1) ? (1 + ilog2(n / 2)) : (0); }
+
+const int LOG2STREAMS = ilog2(SIMD_STREAMS);
 
 
 ///////////////////////////////////////////////////////////////////////////////
 // PROGRAM
 ///////////////////////////////////////////////////////////////////////////////
-template <typename T>
-using aligned_vector = std::vector<T, boost::alignment::aligned_allocator<T, SIMD_WIDTH_BYTES>>;
-
-
 void gemv(
     const size_t n,
     const size_t lda,
-    const aligned_vector<real> v1,
-    const aligned_vector<real> v2,
-    aligned_vector<real> &dp)
+    const gvl::aligned_vector<real> v1,
+    const gvl::aligned_vector<real> v2,
+    gvl::aligned_vector<real> &dp)
 {
     for (size_t row = 0; row < n; row++) {
         for (size_t col = 0; col < n; col++) {
@@ -92,7 +93,7 @@ void gemv_simd_tree_sum(
         }
 
         // Binary tree sum reduction
-        for (size_t i = 0; i < LOG2STREAMS - 1; i++) {
+        for (int i = 0; i < LOG2STREAMS - 1; i++) {
             vdp = simd_hadd(vdp, vdp);
         }
 
@@ -140,18 +141,15 @@ int main(int argc, char *argv[])
     std::cout << "Log2 SIMD: " << LOG2STREAMS << std::endl;
 
     // Number of elements in padded matrix column to conform with SIMD alignment
-    const size_t lda = (((N * sizeof(real)) / SIMD_WIDTH_BYTES) * SIMD_WIDTH_BYTES + SIMD_WIDTH_BYTES) / sizeof(real);
+    const size_t lda = gvl::aligned_vector<real>::padded(N);
     // For unaligned rows, set LDA to N
     // const size_t lda = N;
 
     // Create a vector of given size
-    aligned_vector<real> v1(N * lda);      // matrix
-    aligned_vector<real> v2(1 * lda, 1.);  // column vector, set to 1 --> add rows of matrix
-    aligned_vector<real> dp(N, 0.);  // resulting column vector (dot products)
-
-    // Zero out extra rows used for padding, to prevent floating-point exception during vector multiplication.
-    // This memory elements are never modified, so set once.
-    std::memset(v2.data() + N, 0, (lda - N) * sizeof(real));
+    // Padding up to a whole SIMD register is zeroed, to prevent floating-point exception during vector multiplication.
+    gvl::aligned_vector<real> v1(N * lda);  // matrix
+    gvl::aligned_vector<real> v2(N, 1.);    // column vector, set to 1 --> add rows of matrix
+    gvl::aligned_vector<real> dp(N, 0.);    // resulting column vector (dot products)
 
     // real *v1 = NULL;
     // real *v2 = NULL;
@@ -194,6 +192,35 @@ int main(int argc, char *argv[])
 
     std::cout << "Matrix size: " << N << " x " << lda << std::endl;
 
+    // Batched engine, matrices are interleaved so each SIMD lane owns one
+    // matrix (compact layout), no padding nor horizontal sums
+    std::vector<real> mats(num_matrices * N * N);
+    std::vector<real> vecs(num_matrices * N, 1.);
+    std::vector<real> res(num_matrices * N);
+    for (size_t k = 0; k < num_matrices; k++) {
+        for (size_t row = 0; row < N; row++) {
+            for (size_t col = 0; col < N; col++) {
+                mats[(k * N + row) * N + col] = k + 1. * (row + col);
+            }
+        }
+    }
+
+    gvl::aligned_vector<real> ac(gvl::batch_elems<real>(num_matrices, N, N));
+    gvl::aligned_vector<real> xc(gvl::batch_elems<real>(num_matrices, N, 1));
+    gvl::aligned_vector<real> yc(gvl::batch_elems<real>(num_matrices, N, 1));
+    gvl::batch_pack(ac.data(), mats.data(), num_matrices, N, N, N);
+    gvl::batch_pack(xc.data(), vecs.data(), num_matrices, N, 1, 1);
+    gvl::batch_gemv(yc.data(), ac.data(), xc.data(), num_matrices, N, N, true);
+    gvl::batch_unpack(res.data(), 1, yc.data(), num_matrices, N, 1);
+
+#if defined(DEBUG)
+    // Print resulting column vector of last matrix
+    std::cout << "Batched result:" << std::endl;
+    print_matrix(N, 1, 1, res.data() + (num_matrices - 1) * N);
+    std::cout << std::endl;
+#endif
+    std::cout << "Matrices per batch: " << gvl::batch_traits<real>::nlanes << std::endl;
+
     // Only needed if this array was allocated using 'scalar_malloc'.
     // scalar_free(&v1);
     // scalar_free(&v2);
@@ -10,13 +10,13 @@
 #include <ctime>
 #include <iostream>
 #include <vector>
-#include <boost/align/aligned_allocator.hpp>
 #include <cmath>
 // #include "papi.h"
 #include "simd.h"
 #include "environ.h"
 #include "utils.h"
 #include "vutils.h"
+#include "aligned_vector.h"
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -44,22 +44,22 @@ typedef SIMD_DBL vreal;
 
 // Number of floating-point values that fit into a SIMD register
 const int SIMD_STREAMS = SIMD_WIDTH_BYTES / sizeof(real);
-const int LOG2STREAMS = std::log2(SIMD_STREAMS);
+// log2 of a power of two, std::log2() is C++11
+static int ilog2(const int n)
+{ return (n > 1) ? (1 + ilog2(n / 2)) : (0); }
+
+const int LOG2STREAMS = ilog2(SIMD_STREAMS);
 
 
 ///////////////////////////////////////////////////////////////////////////////
 // PROGRAM
 ///////////////////////////////////////////////////////////////////////////////
-template <typename T>
-using aligned_vector = std::vector<T, boost::alignment::aligned_allocator<T, SIMD_WIDTH_BYTES>>;
-
-
 void gemv(
     const size_t n,
     const size_t lda,
-    const aligned_vector<real> v1,
-    const aligned_vector<real> v2,
-    aligned_vector<real> &dp)
+    const gvl::aligned_vector<real> v1,
+    const gvl::aligned_vector<real> v2,
+    gvl::aligned_vector<real> &dp)
 {
     for (size_t row = 0; row < n; row++) {
         for (size_t col = 0; col < n; col++) {
@@ -87,7 +87,8 @@ void gemv_simd_tree_sum(
 #endif
 
     for (size_t row = 0; row < n; row++) {
-        vreal vdp = simd_zero();
+        vreal vdp;
+        simd_set_zero(&vdp);
         for (size_t col = 0; col < lda; col+=SIMD_STREAMS) {
             vreal vv1 = simd_load(&_v1[row * lda + col]);
             vreal vv2 = simd_load(&_v2[col]);
@@ -100,19 +101,19 @@ void gemv_simd_tree_sum(
         }
 
         // Binary tree sum reduction
-        for (size_t i = 0; i < LOG2STREAMS - 1; i++) {
+        for (int i = 0; i < LOG2STREAMS - 1; i++) {
             vdp = simd_hadd(vdp, vdp);
         }
 
         real tdp[SIMD_STREAMS] __attribute__((aligned(SIMD_WIDTH_BYTES)));
         simd_store(tdp, vdp);
         // NOTE: 'dp' does need to be aligned because it is used to store a scalar value.
-#if SIMD_WIDTH_BITS == 128
         // HADD from SSE3 does not interleave horizontal sums.
-        dp[row] = tdp[0] + tdp[1];
-#else
-        dp[row] = tdp[0] + tdp[SIMD_STREAMS / 2];
-#endif
+        // NOTE: SIMD_WIDTH_BITS is a constant, not a macro, so branch in code.
+        if (SIMD_WIDTH_BITS == 128)
+            dp[row] = tdp[0] + tdp[1];
+        else
+            dp[row] = tdp[0] + tdp[SIMD_STREAMS / 2];
     }
 }
 
@@ -121,7 +122,7 @@ void print_matrix(
     const size_t n,
     const size_t m,
     const size_t lda,
-    const vector<real> v)
+    const std::vector<real> v)
 {
     for (size_t row = 0; row < n; row++) {
         for (size_t col = 0; col < m; col++) {
@@ -149,18 +150,15 @@ int main(int argc, char *argv[])
     std::cout << "Num. elems: " << SIMD_STREAMS << std::endl;
 
     // Number of elements in padded matrix column to conform with SIMD alignment
-    const size_t lda = (((N * sizeof(real)) / SIMD_WIDTH_BYTES) * SIMD_WIDTH_BYTES + SIMD_WIDTH_BYTES) / sizeof(real);
+    const size_t lda = gvl::aligned_vector<real>::padded(N);
     // For unaligned rows, set LDA to N
     // const size_t lda = N;
 
     // Create a vector of given size
-    aligned_vector<real> v1(N * lda);      // matrix
-    aligned_vector<real> v2(1 * lda, 1.);  // column vector, set to 1 --> add rows of matrix
-    aligned_vector<real> dp(N, 0);  // resulting column vector (dot products)
-
-    // Zero out extra rows used for padding, to prevent floating-point exception during vector multiplication.
-    // This memory elements are never modified, so set once.
-    memset(v2.data() + N, 0, (lda - N) * sizeof(real));
+    // Padding up to a whole SIMD register is zeroed, to prevent floating-point exception during vector multiplication.
+    gvl::aligned_vector<real> v1(N * lda);  // matrix
+    gvl::aligned_vector<real> v2(N, 1.);    // column vector, set to 1 --> add rows of matrix
+    gvl::aligned_vector<real> dp(N, 0);     // resulting column vector (dot products)
 
     real *arr_A = NULL, *arr_B = NULL, *arr_C = NULL;
     // scalar_malloc(&arr_A, SIMD_WIDTH_BYTES, SIMD_STREAMS);
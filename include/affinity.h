@@ -0,0 +1,72 @@
+/*!
+ *  \brief Thread placement
+ *  Pins OpenMP threads to logical CPUs following a topology-aware policy.
+ *  Topology (package, core, SMT sibling) comes from Linux sysfs, or from the
+ *  CPUID descriptor if sysfs is not available, and only CPUs in the process
+ *  affinity mask are used (taskset, cgroups).
+ *  Threads are pinned with pthread_setaffinity_np() from inside an OpenMP
+ *  parallel region, because the runtime reads OMP_PLACES/OMP_PROC_BIND only
+ *  at startup. Those variables are also exported with the same placement for
+ *  child processes and runtimes initialized later.
+ *  \note Placement holds while the OpenMP runtime reuses its pool threads,
+ *        i.e., for parallel regions with the same number of threads
+ */
+#ifndef _AFFINITY_H
+#define _AFFINITY_H
+
+
+#include <stdint.h>
+#include <stddef.h>   // NULL
+
+
+namespace gvl {
+
+
+//! Placement policies
+enum affinity_policy {
+    AFFINITY_COMPACT,  //!< Fill SMT siblings of a core, then next core, then next package
+    AFFINITY_SCATTER,  //!< Spread over packages, then cores, SMT siblings last
+    AFFINITY_CORES,    //!< One thread per physical core, SMT siblings are not used
+    AFFINITY_LIST      //!< Explicit list of logical CPUs, thread i on cpus[i % ncpus]
+};
+
+//! Maximum number of threads with a recorded placement
+const int32_t AFFINITY_MAX_THREADS = 1024;
+
+/*!
+ *  Pin \c nthreads OpenMP threads following \c policy.
+ *  If \c nthreads < 1, one thread per CPU of the policy is used (e.g., number
+ *  of physical cores for AFFINITY_CORES). Threads beyond the CPUs available
+ *  wrap around. For AFFINITY_LIST, \c cpus and \c ncpus give the CPU list.
+ *  Also sets the default number of OpenMP threads to the threads pinned.
+ *  \return Number of threads pinned, 0 if placement is not supported or
+ *          no valid CPU was found
+ */
+int32_t set_affinity(const affinity_policy policy, const int32_t nthreads = 0, const int32_t * const cpus = NULL, const int32_t ncpus = 0);
+
+/*!
+ *  Logical CPU assigned to thread \c tid by the last set_affinity()
+ *  \return CPU number, or -1 if thread is not pinned
+ */
+int32_t get_affinity_cpu(const int32_t tid);
+
+//! Number of threads pinned by the last set_affinity()
+int32_t get_affinity_threads();
+
+/*!
+ *  Pin calling thread to logical CPU \c cpu
+ *  \return 0 on success, -1 otherwise
+ */
+int32_t pin_thread(const int32_t cpu);
+
+/*!
+ *  Print assigned and current CPU of each OpenMP thread, with the package
+ *  and core of the CPU
+ */
+void print_affinity();
+
+
+}  // namespace gvl
+
+
+#endif  // _AFFINITY_H
@@ -0,0 +1,180 @@
+/*!
+ *  \brief Scratch memory without malloc in hot loops
+ *  - arena, bump allocator over reusable chunks, reset to a mark releases
+ *    everything allocated after it (arena_scope does it on scope exit).
+ *    Each thread has its own arena, see thread_arena().
+ *  - pool, power-of-two size classes with per-thread free lists, freed
+ *    buffers are recycled by later requests of the same class.
+ *  Allocator policies (heap_allocator, pool_allocator, arena_allocator)
+ *  plug these into array types (varray) and allocating kernels (add).
+ *  \note Memory is aligned to POOL_ALIGN bytes, a multiple of the SIMD width
+ *        of every interface and of the cache line size
+ */
+#ifndef _ARENA_H
+#define _ARENA_H
+
+
+#include <stdint.h>
+#include <stddef.h>   // size_t
+#include <stdlib.h>   // posix_memalign, free
+
+
+namespace gvl {
+
+
+//! Alignment of pool and arena memory
+const size_t POOL_ALIGN = 128;
+
+
+/**********
+ *  Pool  *
+ **********/
+/*!
+ *  Buffer of at least \c bytes bytes aligned to POOL_ALIGN, recycled from
+ *  the calling thread's free list of its size class if available
+ *  \return NULL if allocation fails
+ */
+void *pool_malloc(const size_t bytes);
+
+/*!
+ *  Return buffer of pool_malloc() to the calling thread's free list, or to
+ *  the system if the list of its size class is full
+ */
+void pool_free(void * const sa);
+
+//! Release buffers cached by the calling thread
+void pool_trim();
+
+
+/***********
+ *  Arena  *
+ ***********/
+/*!
+ *  \class arena
+ *  \brief Bump allocator over a list of chunks
+ *  Chunks are kept on reset and reused, requests larger than the chunk size
+ *  get a chunk of their own.
+ */
+class arena
+{
+    public:
+        //! Position in the arena, see mark() and reset()
+        struct arena_mark {
+            void *chunk;
+            size_t used;
+        };
+
+    private:
+        struct chunk_header {
+            chunk_header *next;
+            size_t capacity;  // usable bytes after header
+        };
+
+        chunk_header *head;
+        chunk_header *current;
+        size_t used;
+        size_t chunk_bytes;
+
+        // Not copyable
+        arena(const arena &);
+        arena & operator=(const arena &);
+
+    public:
+        /*!
+         *  Chunks of \c chunk_sz bytes are allocated on demand, an arena of
+         *  chunk size 0 has no memory and all its allocations fail
+         */
+        explicit arena(const size_t chunk_sz = 1 << 20);
+        ~arena();
+
+        //! \c bytes bytes aligned to POOL_ALIGN, NULL if allocation fails
+        void *allocate(const size_t bytes);
+
+        //! Array of \c n T elements (not constructed)
+        template <typename T>
+        T *allocate(const size_t n)
+        { return (T *)allocate(n * sizeof(T)); }
+
+        //! Current position
+        arena_mark mark() const;
+
+        //! Release allocations after mark \c m, chunks are kept
+        void reset(const arena_mark &m);
+
+        //! Release all allocations, chunks are kept
+        void reset();
+
+        //! Bytes reserved in chunks
+        size_t capacity() const;
+};
+
+/*!
+ *  Arena of the calling thread, created on first use and destroyed at
+ *  thread exit. If it cannot be created, an arena without memory is
+ *  returned and arena_allocator returns NULL.
+ */
+arena & thread_arena();
+
+/*!
+ *  \class arena_scope
+ *  \brief Resets an arena to its position at construction on scope exit
+ */
+class arena_scope
+{
+    private:
+        arena &a;
+        const arena::arena_mark m;
+
+        arena_scope(const arena_scope &);
+        arena_scope & operator=(const arena_scope &);
+
+    public:
+        explicit arena_scope(arena &aa = thread_arena()): a(aa), m(aa.mark())
+        { }
+
+        ~arena_scope()
+        { a.reset(m); }
+};
+
+
+/***********************
+ *  Allocator policies  *
+ ***********************/
+//! System allocator, aligned to POOL_ALIGN
+struct heap_allocator
+{
+    static void *allocate(const size_t bytes)
+    {
+        void *p = NULL;
+        return (posix_memalign(&p, POOL_ALIGN, bytes)) ? (NULL) : (p);
+    }
+
+    static void deallocate(void * const p)
+    { free(p); }
+};
+
+//! Size-class pool with per-thread recycling
+struct pool_allocator
+{
+    static void *allocate(const size_t bytes)
+    { return pool_malloc(bytes); }
+
+    static void deallocate(void * const p)
+    { pool_free(p); }
+};
+
+//! Arena of calling thread, memory is released by resetting the arena
+struct arena_allocator
+{
+    static void *allocate(const size_t bytes)
+    { return thread_arena().allocate(bytes); }
+
+    static void deallocate(void * const)
+    { }
+};
+
+
+}  // namespace gvl
+
+
+#endif  // _ARENA_H
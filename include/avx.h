@@ -6,6 +6,7 @@
  *  Support '_t' C datatypes
  */
 #include <stdint.h>
+#include <stddef.h>   // size_t
 
 
 /*
@@ -32,6 +33,10 @@
 #endif
 
 
+namespace gvl {
+namespace avx {
+
+
 /*
  *  AVX 256-bit wide vector units
  *  Define constants required for SIMD module to function properly.
@@ -58,6 +63,15 @@ typedef __m256d SIMD_DBL;
  */
 
 
+/*
+ *  AVX has no 256-bit integer arithmetic and compare instructions,
+ *  these operate on 128-bit halves which are then joined.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_join(const __m128i vl, const __m128i vh)
+{ return _mm256_insertf128_si256(_mm256_castsi128_si256(vl), vh, 0x01); }
+
+
 /**************************
  *  Arithmetic intrinsics
  **************************/
@@ -89,6 +103,13 @@ static SIMD_FUNC_INLINE
 SIMD_INT simd_add_i64(const SIMD_INT va, const SIMD_INT vb)
 { return _mm256_add_epi64(va, vb); }
 
+static SIMD_FUNC_INLINE
+SIMD_INT simd_add_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    return simd_join(_mm_add_epi32(_mm256_castsi256_si128(va), _mm256_castsi256_si128(vb)),
+                     _mm_add_epi32(_mm256_extractf128_si256(va, 0x01), _mm256_extractf128_si256(vb, 0x01)));
+}
+
 /*!
  *  Add for unsigned 16-bit integers
  *  Uses saturation arithmetic (no wrap around)
@@ -205,6 +226,13 @@ static SIMD_FUNC_INLINE
 SIMD_INT simd_sub_i64(const SIMD_INT va, const SIMD_INT vb)
 { return _mm256_sub_epi64(va, vb); }
 
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sub_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    return simd_join(_mm_sub_epi32(_mm256_castsi256_si128(va), _mm256_castsi256_si128(vb)),
+                     _mm_sub_epi32(_mm256_extractf128_si256(va, 0x01), _mm256_extractf128_si256(vb, 0x01)));
+}
+
 //static SIMD_FUNC_INLINE
 //SIMD_INT simd_sub_u16(const SIMD_INT va, const SIMD_INT vb)
 //{ return _mm256_sub_epu16(va, vb); }
@@ -403,6 +431,14 @@ static SIMD_FUNC_INLINE
 SIMD_INT simd_mullo_i32(const SIMD_INT va, const SIMD_INT vb)
 { return _mm256_mullo_epi32(va, vb); }
 
+//! Low 32-bit results of 32-bit integer multiplies, from 128-bit halves
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    return simd_join(_mm_mullo_epi32(_mm256_castsi256_si128(va), _mm256_castsi256_si128(vb)),
+                     _mm_mullo_epi32(_mm256_extractf128_si256(va, 0x01), _mm256_extractf128_si256(vb, 0x01)));
+}
+
 static SIMD_FUNC_INLINE
 SIMD_FLT simd_mul(const SIMD_FLT va, const SIMD_FLT vb)
 { return _mm256_mul_ps(va, vb); }
@@ -411,38 +447,159 @@ static SIMD_FUNC_INLINE
 SIMD_DBL simd_mul(const SIMD_DBL va, const SIMD_DBL vb)
 { return _mm256_mul_pd(va, vb); }
 
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_div(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm256_div_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_div(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm256_div_pd(va, vb); }
+
 
 /********************************
  *  Integral logical intrinsics
  ********************************/
+/*!
+ *  AVX has no 256-bit integer logical instructions,
+ *  the bitwise floating-point ones are used instead.
+ */
 static SIMD_FUNC_INLINE
 SIMD_INT simd_or(const SIMD_INT va, const SIMD_INT vb)
-{ return _mm256_or_si256(va, vb); }
+{ return _mm256_castps_si256(_mm256_or_ps(_mm256_castsi256_ps(va), _mm256_castsi256_ps(vb))); }
 
 static SIMD_FUNC_INLINE
 SIMD_INT simd_xor(const SIMD_INT va, const SIMD_INT vb)
-{ return _mm256_xor_si256(va, vb); }
+{ return _mm256_castps_si256(_mm256_xor_ps(_mm256_castsi256_ps(va), _mm256_castsi256_ps(vb))); }
 
 static SIMD_FUNC_INLINE
 SIMD_INT simd_and(const SIMD_INT va, const SIMD_INT vb)
-{ return _mm256_and_si256(va, vb); }
+{ return _mm256_castps_si256(_mm256_and_ps(_mm256_castsi256_ps(va), _mm256_castsi256_ps(vb))); }
 
 static SIMD_FUNC_INLINE
 SIMD_FLT simd_and(const SIMD_FLT va, const SIMD_INT vb)
+{ return _mm256_and_ps(va, _mm256_castsi256_ps(vb)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_and(const SIMD_DBL va, const SIMD_INT vb)
+{ return _mm256_and_pd(va, _mm256_castsi256_pd(vb)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_and(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm256_and_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_and(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm256_and_pd(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_or(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm256_or_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_or(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm256_or_pd(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_xor(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm256_xor_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_xor(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm256_xor_pd(va, vb); }
+
+
+/***********************
+ *  Compare intrinsics
+ ***********************/
+/*!
+ *  Comparisons set all bits of elements where the condition holds
+ *  and clear them otherwise, results are used as masks.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmpeq_32(const SIMD_INT va, const SIMD_INT vb)
 {
-    SIMD_INT va_int = _mm256_castps_si256(va);
-    va_int = _mm256_and_si256(va_int, vb);
-    return _mm256_castsi256_ps(va_int);
+    return simd_join(_mm_cmpeq_epi32(_mm256_castsi256_si128(va), _mm256_castsi256_si128(vb)),
+                     _mm_cmpeq_epi32(_mm256_extractf128_si256(va, 0x01), _mm256_extractf128_si256(vb, 0x01)));
 }
 
 static SIMD_FUNC_INLINE
-SIMD_DBL simd_and(const SIMD_DBL va, const SIMD_INT vb)
+SIMD_INT simd_cmpgt_i32(const SIMD_INT va, const SIMD_INT vb)
 {
-    SIMD_INT va_int = _mm256_castpd_si256(va);
-    va_int = _mm256_and_si256(va_int, vb);
-    return _mm256_castsi256_pd(va_int);
+    return simd_join(_mm_cmpgt_epi32(_mm256_castsi256_si128(va), _mm256_castsi256_si128(vb)),
+                     _mm_cmpgt_epi32(_mm256_extractf128_si256(va, 0x01), _mm256_extractf128_si256(vb, 0x01)));
 }
 
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmplt_i32(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_cmpgt_i32(vb, va); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpeq(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm256_cmp_ps(va, vb, _CMP_EQ_OQ); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpeq(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm256_cmp_pd(va, vb, _CMP_EQ_OQ); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpneq(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm256_cmp_ps(va, vb, _CMP_NEQ_UQ); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpneq(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm256_cmp_pd(va, vb, _CMP_NEQ_UQ); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmplt(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm256_cmp_ps(va, vb, _CMP_LT_OQ); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmplt(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm256_cmp_pd(va, vb, _CMP_LT_OQ); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmple(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm256_cmp_ps(va, vb, _CMP_LE_OQ); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmple(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm256_cmp_pd(va, vb, _CMP_LE_OQ); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpgt(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm256_cmp_ps(va, vb, _CMP_GT_OQ); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpgt(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm256_cmp_pd(va, vb, _CMP_GT_OQ); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpge(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm256_cmp_ps(va, vb, _CMP_GE_OQ); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpge(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm256_cmp_pd(va, vb, _CMP_GE_OQ); }
+
+/*!
+ *  Select elements from second operand where mask is set,
+ *  otherwise select elements from first operand.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_blend(const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vmsk)
+{
+    return simd_join(_mm_blendv_epi8(_mm256_castsi256_si128(va), _mm256_castsi256_si128(vb), _mm256_castsi256_si128(vmsk)),
+                     _mm_blendv_epi8(_mm256_extractf128_si256(va, 0x01), _mm256_extractf128_si256(vb, 0x01), _mm256_extractf128_si256(vmsk, 0x01)));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_blend(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vmsk)
+{ return _mm256_blendv_ps(va, vb, vmsk); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_blend(const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vmsk)
+{ return _mm256_blendv_pd(va, vb, vmsk); }
+
 
 /*****************************
  *  Shift/Shuffle intrinsics
@@ -736,14 +893,52 @@ SIMD_INT simd_loadu(const short int * const sa)
 //{ return _mm256_loadu_si256((SIMD_INT *)sa); }
 { return _mm256_lddqu_si256((SIMD_INT *)sa); }
 
+/*
+ *  Lane masks for the first n 32/64-bit elements, used with masked
+ *  loads/stores, from floating-point compares as AVX has no 256-bit
+ *  integer compares.
+ */
 static SIMD_FUNC_INLINE
-SIMD_INT simd_load(const int * const sa)
-{ return _mm256_load_si256((SIMD_INT *)sa); }
+SIMD_INT simd_mask_32(const int32_t n)
+{ return _mm256_castps_si256(_mm256_cmp_ps(_mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f), _mm256_set1_ps((float)n), _CMP_LT_OQ)); }
 
 static SIMD_FUNC_INLINE
-SIMD_INT simd_loadu(const int * const sa)
-//{ return _mm256_loadu_si256((SIMD_INT *)sa); }
-{ return _mm256_lddqu_si256((SIMD_INT *)sa); }
+SIMD_INT simd_mask_64(const int32_t n)
+{ return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_setr_pd(0.0, 1.0, 2.0, 3.0), _mm256_set1_pd((double)n), _CMP_LT_OQ)); }
+
+/*!
+ *  Load first n elements, remaining elements are set to zero.
+ *  Negative n loads into the upper |n| elements.
+ *  Partial loads use masked loads, masked lanes do not access memory.
+ *  NOTE: AVX has no 256-bit streaming loads, the hint is ignored
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const int32_t * const sa, const int32_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    (void)strmHint;
+    if (n == SIMD_STREAMS_32 || n == -SIMD_STREAMS_32)
+        return _mm256_load_si256((SIMD_INT *)sa);
+    else if (n > 0 && n < SIMD_STREAMS_32)
+        return _mm256_castps_si256(_mm256_maskload_ps((const float *)sa, simd_mask_32(n)));
+    else if (n < 0 && n > -SIMD_STREAMS_32) {
+        int32_t tmp[SIMD_STREAMS_32] SIMD_ALIGNED(SIMD_WIDTH_BYTES) = {0};
+        for (int32_t i = SIMD_STREAMS_32 + n, j = 0; i < SIMD_STREAMS_32; ++i, ++j)
+            tmp[i] = sa[j];
+        return _mm256_load_si256((SIMD_INT *)tmp);
+    }
+    return _mm256_setzero_si256();
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const int32_t * const sa, const size_t n = SIMD_STREAMS_32)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        //return _mm256_loadu_si256((SIMD_INT *)sa);
+        return _mm256_lddqu_si256((SIMD_INT *)sa);
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_32)
+        return _mm256_castps_si256(_mm256_maskload_ps((const float *)sa, simd_mask_32(n)));
+    return _mm256_setzero_si256();
+}
 
 static SIMD_FUNC_INLINE
 SIMD_INT simd_load(const unsigned short int * const sa)
@@ -782,20 +977,42 @@ SIMD_INT simd_loadu(const unsigned long int * const sa)
 { return _mm256_lddqu_si256((SIMD_INT *)sa); }
 
 static SIMD_FUNC_INLINE
-SIMD_FLT simd_load(const float * const sa)
-{ return _mm256_load_ps(sa); }
+SIMD_FLT simd_loadu(const float * const sa, const size_t n = SIMD_STREAMS_32)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        return _mm256_loadu_ps(sa);
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_32)
+        return _mm256_maskload_ps(sa, simd_mask_32(n));
+    return _mm256_setzero_ps();
+}
 
 static SIMD_FUNC_INLINE
-SIMD_FLT simd_loadu(const float * const sa)
-{ return _mm256_loadu_ps(sa); }
+SIMD_FLT simd_load(const float * const sa, const size_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    (void)strmHint;
+    if (n == (size_t)SIMD_STREAMS_32)
+        return _mm256_load_ps(sa);
+    return simd_loadu(sa, n);
+}
 
 static SIMD_FUNC_INLINE
-SIMD_DBL simd_load(const double * const sa)
-{ return _mm256_load_pd(sa); }
+SIMD_DBL simd_loadu(const double * const sa, const size_t n = SIMD_STREAMS_64)
+{
+    if (n == (size_t)SIMD_STREAMS_64)
+        return _mm256_loadu_pd(sa);
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_64)
+        return _mm256_maskload_pd(sa, simd_mask_64(n));
+    return _mm256_setzero_pd();
+}
 
 static SIMD_FUNC_INLINE
-SIMD_DBL simd_loadu(const double * const sa)
-{ return _mm256_loadu_pd(sa); }
+SIMD_DBL simd_load(const double * const sa, const size_t n = SIMD_STREAMS_64, const bool strmHint = false)
+{
+    (void)strmHint;
+    if (n == (size_t)SIMD_STREAMS_64)
+        return _mm256_load_pd(sa);
+    return simd_loadu(sa, n);
+}
 
 
 /*******************************
@@ -813,13 +1030,34 @@ static SIMD_FUNC_INLINE
 void simd_storeu(short int * const sa, const SIMD_INT va)
 { _mm256_storeu_si256((SIMD_INT *)sa, va); }
 
+/*!
+ *  Store first n elements.
+ *  Negative n stores the upper |n| elements.
+ *  Partial stores use masked stores, masked lanes do not access memory.
+ */
 static SIMD_FUNC_INLINE
-void simd_store(int * const sa, const SIMD_INT va)
-{ _mm256_store_si256((SIMD_INT *)sa, va); }
+void simd_store(int32_t * const sa, const SIMD_INT va, const int32_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    if (n == SIMD_STREAMS_32 || n == -SIMD_STREAMS_32)
+        (strmHint) ? (_mm256_stream_si256((SIMD_INT *)sa, va)) : (_mm256_store_si256((SIMD_INT *)sa, va));
+    else if (n > 0 && n < SIMD_STREAMS_32)
+        _mm256_maskstore_ps((float *)sa, simd_mask_32(n), _mm256_castsi256_ps(va));
+    else if (n < 0 && n > -SIMD_STREAMS_32) {
+        int32_t tmp[SIMD_STREAMS_32] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+        _mm256_store_si256((SIMD_INT *)tmp, va);
+        for (int32_t i = SIMD_STREAMS_32 + n, j = 0; i < SIMD_STREAMS_32; ++i, ++j)
+            sa[j] = tmp[i];
+    }
+}
 
 static SIMD_FUNC_INLINE
-void simd_storeu(int * const sa, const SIMD_INT va)
-{ _mm256_storeu_si256((SIMD_INT *)sa, va); }
+void simd_storeu(int32_t * const sa, const SIMD_INT va, const size_t n = SIMD_STREAMS_32)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        _mm256_storeu_si256((SIMD_INT *)sa, va);
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_32)
+        _mm256_maskstore_ps((float *)sa, simd_mask_32(n), _mm256_castsi256_ps(va));
+}
 
 static SIMD_FUNC_INLINE
 void simd_store(unsigned short int * const sa, const SIMD_INT va)
@@ -854,20 +1092,724 @@ void simd_storeu(unsigned long int * const sa, const SIMD_INT va)
 { _mm256_storeu_si256((SIMD_INT *)sa, va); }
 
 static SIMD_FUNC_INLINE
-void simd_store(float * const sa, const SIMD_FLT va)
-{ _mm256_store_ps(sa, va); }
+void simd_storeu(float * const sa, const SIMD_FLT va, const size_t n = SIMD_STREAMS_32)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        _mm256_storeu_ps(sa, va);
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_32)
+        _mm256_maskstore_ps(sa, simd_mask_32(n), va);
+}
 
 static SIMD_FUNC_INLINE
-void simd_storeu(float * const sa, const SIMD_FLT va)
-{ _mm256_storeu_ps(sa, va); }
+void simd_store(float * const sa, const SIMD_FLT va, const size_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        (strmHint) ? (_mm256_stream_ps(sa, va)) : (_mm256_store_ps(sa, va));
+    else
+        simd_storeu(sa, va, n);
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(double * const sa, const SIMD_DBL va, const size_t n = SIMD_STREAMS_64)
+{
+    if (n == (size_t)SIMD_STREAMS_64)
+        _mm256_storeu_pd(sa, va);
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_64)
+        _mm256_maskstore_pd(sa, simd_mask_64(n), va);
+}
 
 static SIMD_FUNC_INLINE
-void simd_store(double * const sa, const SIMD_DBL va)
-{ _mm256_store_pd(sa, va); }
+void simd_store(double * const sa, const SIMD_DBL va, const size_t n = SIMD_STREAMS_64, const bool strmHint = false)
+{
+    if (n == (size_t)SIMD_STREAMS_64)
+        (strmHint) ? (_mm256_stream_pd(sa, va)) : (_mm256_store_pd(sa, va));
+    else
+        simd_storeu(sa, va, n);
+}
+
+
+/***************************
+ *  Interleave intrinsics
+ ***************************/
+/*!
+ *  Load records of 2/3/4 components (array of structures) and split them
+ *  into one vector per component (structure of arrays), e.g., xyz points
+ *  or RGB/RGBA pixels. simd_store_interleave* is the inverse.
+ *  Each call reads/writes 2/3/4 vectors of consecutive elements, pointers
+ *  need not be aligned.
+ *  Shuffles work within 128-bit lanes, so records are first regrouped so
+ *  that the low lane holds the first half of them and the high lane the
+ *  second half.
+ */
+//! Lane I of va, lane J of vb, lane K of vc and lane L of vd, in each 128-bit lane
+template <int I, int J, int K, int L>
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_gather_lanes(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc, const SIMD_FLT vd)
+{
+    return _mm256_shuffle_ps(_mm256_shuffle_ps(va, vb, _MM_SHUFFLE(J, J, I, I)),
+                             _mm256_shuffle_ps(vc, vd, _MM_SHUFFLE(L, L, K, K)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+//! 4x4 transpose in each 128-bit lane
+static SIMD_FUNC_INLINE
+void simd_transpose_lanes(SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc, SIMD_FLT * const vd)
+{
+    const SIMD_FLT t0 = _mm256_unpacklo_ps(*va, *vb);
+    const SIMD_FLT t1 = _mm256_unpacklo_ps(*vc, *vd);
+    const SIMD_FLT t2 = _mm256_unpackhi_ps(*va, *vb);
+    const SIMD_FLT t3 = _mm256_unpackhi_ps(*vc, *vd);
+    *va = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+    *vb = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+    *vc = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    *vd = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb)
+{
+    const SIMD_FLT v0 = _mm256_loadu_ps(sa);
+    const SIMD_FLT v1 = _mm256_loadu_ps(sa + 8);
+    const SIMD_FLT vlo = _mm256_permute2f128_ps(v0, v1, 0x20);
+    const SIMD_FLT vhi = _mm256_permute2f128_ps(v0, v1, 0x31);
+    *va = _mm256_shuffle_ps(vlo, vhi, _MM_SHUFFLE(2, 0, 2, 0));
+    *vb = _mm256_shuffle_ps(vlo, vhi, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc)
+{
+    const SIMD_FLT v0 = _mm256_loadu_ps(sa);
+    const SIMD_FLT v1 = _mm256_loadu_ps(sa + 8);
+    const SIMD_FLT v2 = _mm256_loadu_ps(sa + 16);
+    const SIMD_FLT p0 = _mm256_permute2f128_ps(v0, v1, 0x30);
+    const SIMD_FLT p1 = _mm256_permute2f128_ps(v0, v2, 0x21);
+    const SIMD_FLT p2 = _mm256_permute2f128_ps(v1, v2, 0x30);
+    *va = simd_gather_lanes<0, 3, 2, 1>(p0, p0, p1, p2);
+    *vb = simd_gather_lanes<1, 0, 3, 2>(p0, p1, p1, p2);
+    *vc = simd_gather_lanes<2, 1, 0, 3>(p0, p1, p2, p2);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc, SIMD_FLT * const vd)
+{
+    const SIMD_FLT v0 = _mm256_loadu_ps(sa);
+    const SIMD_FLT v1 = _mm256_loadu_ps(sa + 8);
+    const SIMD_FLT v2 = _mm256_loadu_ps(sa + 16);
+    const SIMD_FLT v3 = _mm256_loadu_ps(sa + 24);
+    *va = _mm256_permute2f128_ps(v0, v2, 0x20);
+    *vb = _mm256_permute2f128_ps(v0, v2, 0x31);
+    *vc = _mm256_permute2f128_ps(v1, v3, 0x20);
+    *vd = _mm256_permute2f128_ps(v1, v3, 0x31);
+    simd_transpose_lanes(va, vb, vc, vd);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(float * const sa, const SIMD_FLT va, const SIMD_FLT vb)
+{
+    const SIMD_FLT vlo = _mm256_unpacklo_ps(va, vb);
+    const SIMD_FLT vhi = _mm256_unpackhi_ps(va, vb);
+    _mm256_storeu_ps(sa, _mm256_permute2f128_ps(vlo, vhi, 0x20));
+    _mm256_storeu_ps(sa + 8, _mm256_permute2f128_ps(vlo, vhi, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc)
+{
+    const SIMD_FLT p0 = simd_gather_lanes<0, 0, 0, 1>(va, vb, vc, va);
+    const SIMD_FLT p1 = simd_gather_lanes<1, 1, 2, 2>(vb, vc, va, vb);
+    const SIMD_FLT p2 = simd_gather_lanes<2, 3, 3, 3>(vc, va, vb, vc);
+    _mm256_storeu_ps(sa, _mm256_permute2f128_ps(p0, p1, 0x20));
+    _mm256_storeu_ps(sa + 8, _mm256_permute2f128_ps(p2, p0, 0x30));
+    _mm256_storeu_ps(sa + 16, _mm256_permute2f128_ps(p1, p2, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc, const SIMD_FLT vd)
+{
+    SIMD_FLT v0 = va, v1 = vb, v2 = vc, v3 = vd;
+    simd_transpose_lanes(&v0, &v1, &v2, &v3);
+    _mm256_storeu_ps(sa, _mm256_permute2f128_ps(v0, v1, 0x20));
+    _mm256_storeu_ps(sa + 8, _mm256_permute2f128_ps(v2, v3, 0x20));
+    _mm256_storeu_ps(sa + 16, _mm256_permute2f128_ps(v0, v1, 0x31));
+    _mm256_storeu_ps(sa + 24, _mm256_permute2f128_ps(v2, v3, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb)
+{
+    const SIMD_DBL v0 = _mm256_loadu_pd(sa);
+    const SIMD_DBL v1 = _mm256_loadu_pd(sa + 4);
+    const SIMD_DBL vlo = _mm256_permute2f128_pd(v0, v1, 0x20);
+    const SIMD_DBL vhi = _mm256_permute2f128_pd(v0, v1, 0x31);
+    *va = _mm256_unpacklo_pd(vlo, vhi);
+    *vb = _mm256_unpackhi_pd(vlo, vhi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc)
+{
+    const SIMD_DBL v0 = _mm256_loadu_pd(sa);
+    const SIMD_DBL v1 = _mm256_loadu_pd(sa + 4);
+    const SIMD_DBL v2 = _mm256_loadu_pd(sa + 8);
+    const SIMD_DBL p0 = _mm256_permute2f128_pd(v0, v1, 0x30);
+    const SIMD_DBL p1 = _mm256_permute2f128_pd(v0, v2, 0x21);
+    const SIMD_DBL p2 = _mm256_permute2f128_pd(v1, v2, 0x30);
+    *va = _mm256_shuffle_pd(p0, p1, 0xA);
+    *vb = _mm256_shuffle_pd(p0, p2, 0x5);
+    *vc = _mm256_shuffle_pd(p1, p2, 0xA);
+}
 
 static SIMD_FUNC_INLINE
-void simd_storeu(double * const sa, const SIMD_DBL va)
-{ _mm256_storeu_pd(sa, va); }
+void simd_load_deinterleave4(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc, SIMD_DBL * const vd)
+{
+    const SIMD_DBL v0 = _mm256_loadu_pd(sa);
+    const SIMD_DBL v1 = _mm256_loadu_pd(sa + 4);
+    const SIMD_DBL v2 = _mm256_loadu_pd(sa + 8);
+    const SIMD_DBL v3 = _mm256_loadu_pd(sa + 12);
+    const SIMD_DBL p0 = _mm256_permute2f128_pd(v0, v2, 0x20);
+    const SIMD_DBL p1 = _mm256_permute2f128_pd(v0, v2, 0x31);
+    const SIMD_DBL p2 = _mm256_permute2f128_pd(v1, v3, 0x20);
+    const SIMD_DBL p3 = _mm256_permute2f128_pd(v1, v3, 0x31);
+    *va = _mm256_unpacklo_pd(p0, p2);
+    *vb = _mm256_unpackhi_pd(p0, p2);
+    *vc = _mm256_unpacklo_pd(p1, p3);
+    *vd = _mm256_unpackhi_pd(p1, p3);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(double * const sa, const SIMD_DBL va, const SIMD_DBL vb)
+{
+    const SIMD_DBL vlo = _mm256_unpacklo_pd(va, vb);
+    const SIMD_DBL vhi = _mm256_unpackhi_pd(va, vb);
+    _mm256_storeu_pd(sa, _mm256_permute2f128_pd(vlo, vhi, 0x20));
+    _mm256_storeu_pd(sa + 4, _mm256_permute2f128_pd(vlo, vhi, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc)
+{
+    const SIMD_DBL p0 = _mm256_shuffle_pd(va, vb, 0x0);
+    const SIMD_DBL p1 = _mm256_shuffle_pd(vc, va, 0xA);
+    const SIMD_DBL p2 = _mm256_shuffle_pd(vb, vc, 0xF);
+    _mm256_storeu_pd(sa, _mm256_permute2f128_pd(p0, p1, 0x20));
+    _mm256_storeu_pd(sa + 4, _mm256_permute2f128_pd(p2, p0, 0x30));
+    _mm256_storeu_pd(sa + 8, _mm256_permute2f128_pd(p1, p2, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc, const SIMD_DBL vd)
+{
+    const SIMD_DBL t0 = _mm256_unpacklo_pd(va, vb);
+    const SIMD_DBL t1 = _mm256_unpacklo_pd(vc, vd);
+    const SIMD_DBL t2 = _mm256_unpackhi_pd(va, vb);
+    const SIMD_DBL t3 = _mm256_unpackhi_pd(vc, vd);
+    _mm256_storeu_pd(sa, _mm256_permute2f128_pd(t0, t1, 0x20));
+    _mm256_storeu_pd(sa + 4, _mm256_permute2f128_pd(t2, t3, 0x20));
+    _mm256_storeu_pd(sa + 8, _mm256_permute2f128_pd(t0, t1, 0x31));
+    _mm256_storeu_pd(sa + 12, _mm256_permute2f128_pd(t2, t3, 0x31));
+}
+
+//! 32-bit integers use the single-precision shuffles
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    SIMD_FLT fa, fb;
+    simd_load_deinterleave2((const float *)sa, &fa, &fb);
+    *va = _mm256_castps_si256(fa);
+    *vb = _mm256_castps_si256(fb);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    SIMD_FLT fa, fb, fc;
+    simd_load_deinterleave3((const float *)sa, &fa, &fb, &fc);
+    *va = _mm256_castps_si256(fa);
+    *vb = _mm256_castps_si256(fb);
+    *vc = _mm256_castps_si256(fc);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    SIMD_FLT fa, fb, fc, fd;
+    simd_load_deinterleave4((const float *)sa, &fa, &fb, &fc, &fd);
+    *va = _mm256_castps_si256(fa);
+    *vb = _mm256_castps_si256(fb);
+    *vc = _mm256_castps_si256(fc);
+    *vd = _mm256_castps_si256(fd);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{ simd_store_interleave2((float *)sa, _mm256_castsi256_ps(va), _mm256_castsi256_ps(vb)); }
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{ simd_store_interleave3((float *)sa, _mm256_castsi256_ps(va), _mm256_castsi256_ps(vb), _mm256_castsi256_ps(vc)); }
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{ simd_store_interleave4((float *)sa, _mm256_castsi256_ps(va), _mm256_castsi256_ps(vb), _mm256_castsi256_ps(vc), _mm256_castsi256_ps(vd)); }
+
+#if defined(__AVX2__)
+//! Byte shuffle \c va in each 128-bit lane by the 16-byte mask \c vmsk
+static SIMD_FUNC_INLINE
+SIMD_INT simd_shuffle_lanes_8(const SIMD_INT va, const __m128i vmsk)
+{ return _mm256_shuffle_epi8(va, _mm256_broadcastsi128_si256(vmsk)); }
+
+//! 8-bit records (e.g., pixels) use byte shuffles
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    // Components in 64-bit halves of each lane, then regroup halves
+    const __m128i vmsk = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    const SIMD_INT v0 = _mm256_permute4x64_epi64(simd_shuffle_lanes_8(_mm256_loadu_si256((SIMD_INT *)sa), vmsk), _MM_SHUFFLE(3, 1, 2, 0));
+    const SIMD_INT v1 = _mm256_permute4x64_epi64(simd_shuffle_lanes_8(_mm256_loadu_si256((SIMD_INT *)(sa + 32)), vmsk), _MM_SHUFFLE(3, 1, 2, 0));
+    *va = _mm256_permute2x128_si256(v0, v1, 0x20);
+    *vb = _mm256_permute2x128_si256(v0, v1, 0x31);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    const SIMD_INT v0 = _mm256_loadu_si256((SIMD_INT *)sa);
+    const SIMD_INT v1 = _mm256_loadu_si256((SIMD_INT *)(sa + 32));
+    const SIMD_INT v2 = _mm256_loadu_si256((SIMD_INT *)(sa + 64));
+    const SIMD_INT p0 = _mm256_permute2x128_si256(v0, v1, 0x30);
+    const SIMD_INT p1 = _mm256_permute2x128_si256(v0, v2, 0x21);
+    const SIMD_INT p2 = _mm256_permute2x128_si256(v1, v2, 0x30);
+    *va = _mm256_or_si256(_mm256_or_si256(
+              simd_shuffle_lanes_8(p0, _mm_setr_epi8(0, 3, 6, 9, 12, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+              simd_shuffle_lanes_8(p1, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, 2, 5, 8, 11, 14, -128, -128, -128, -128, -128))),
+              simd_shuffle_lanes_8(p2, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 1, 4, 7, 10, 13)));
+    *vb = _mm256_or_si256(_mm256_or_si256(
+              simd_shuffle_lanes_8(p0, _mm_setr_epi8(1, 4, 7, 10, 13, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+              simd_shuffle_lanes_8(p1, _mm_setr_epi8(-128, -128, -128, -128, -128, 0, 3, 6, 9, 12, 15, -128, -128, -128, -128, -128))),
+              simd_shuffle_lanes_8(p2, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 2, 5, 8, 11, 14)));
+    *vc = _mm256_or_si256(_mm256_or_si256(
+              simd_shuffle_lanes_8(p0, _mm_setr_epi8(2, 5, 8, 11, 14, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+              simd_shuffle_lanes_8(p1, _mm_setr_epi8(-128, -128, -128, -128, -128, 1, 4, 7, 10, 13, -128, -128, -128, -128, -128, -128))),
+              simd_shuffle_lanes_8(p2, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 0, 3, 6, 9, 12, 15)));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    // Components in 32-bit groups, then regroup to 64-bit groups of 8 records
+    const __m128i vmsk = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const SIMD_INT vidx = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    const SIMD_INT v0 = _mm256_permutevar8x32_epi32(simd_shuffle_lanes_8(_mm256_loadu_si256((SIMD_INT *)sa), vmsk), vidx);
+    const SIMD_INT v1 = _mm256_permutevar8x32_epi32(simd_shuffle_lanes_8(_mm256_loadu_si256((SIMD_INT *)(sa + 32)), vmsk), vidx);
+    const SIMD_INT v2 = _mm256_permutevar8x32_epi32(simd_shuffle_lanes_8(_mm256_loadu_si256((SIMD_INT *)(sa + 64)), vmsk), vidx);
+    const SIMD_INT v3 = _mm256_permutevar8x32_epi32(simd_shuffle_lanes_8(_mm256_loadu_si256((SIMD_INT *)(sa + 96)), vmsk), vidx);
+    const SIMD_INT t0 = _mm256_unpacklo_epi64(v0, v1);
+    const SIMD_INT t1 = _mm256_unpacklo_epi64(v2, v3);
+    const SIMD_INT t2 = _mm256_unpackhi_epi64(v0, v1);
+    const SIMD_INT t3 = _mm256_unpackhi_epi64(v2, v3);
+    *va = _mm256_permute2x128_si256(t0, t1, 0x20);
+    *vb = _mm256_permute2x128_si256(t2, t3, 0x20);
+    *vc = _mm256_permute2x128_si256(t0, t1, 0x31);
+    *vd = _mm256_permute2x128_si256(t2, t3, 0x31);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{
+    const SIMD_INT vlo = _mm256_unpacklo_epi8(va, vb);
+    const SIMD_INT vhi = _mm256_unpackhi_epi8(va, vb);
+    _mm256_storeu_si256((SIMD_INT *)sa, _mm256_permute2x128_si256(vlo, vhi, 0x20));
+    _mm256_storeu_si256((SIMD_INT *)(sa + 32), _mm256_permute2x128_si256(vlo, vhi, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{
+    const SIMD_INT p0 = _mm256_or_si256(_mm256_or_si256(
+        simd_shuffle_lanes_8(va, _mm_setr_epi8(0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128, -128, 5)),
+        simd_shuffle_lanes_8(vb, _mm_setr_epi8(-128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128, -128))),
+        simd_shuffle_lanes_8(vc, _mm_setr_epi8(-128, -128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128)));
+    const SIMD_INT p1 = _mm256_or_si256(_mm256_or_si256(
+        simd_shuffle_lanes_8(va, _mm_setr_epi8(-128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128, 10, -128)),
+        simd_shuffle_lanes_8(vb, _mm_setr_epi8(5, -128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128, 10))),
+        simd_shuffle_lanes_8(vc, _mm_setr_epi8(-128, 5, -128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128)));
+    const SIMD_INT p2 = _mm256_or_si256(_mm256_or_si256(
+        simd_shuffle_lanes_8(va, _mm_setr_epi8(-128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15, -128, -128)),
+        simd_shuffle_lanes_8(vb, _mm_setr_epi8(-128, -128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15, -128))),
+        simd_shuffle_lanes_8(vc, _mm_setr_epi8(10, -128, -128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15)));
+    _mm256_storeu_si256((SIMD_INT *)sa, _mm256_permute2x128_si256(p0, p1, 0x20));
+    _mm256_storeu_si256((SIMD_INT *)(sa + 32), _mm256_permute2x128_si256(p2, p0, 0x30));
+    _mm256_storeu_si256((SIMD_INT *)(sa + 64), _mm256_permute2x128_si256(p1, p2, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{
+    const SIMD_INT vab_lo = _mm256_unpacklo_epi8(va, vb);
+    const SIMD_INT vab_hi = _mm256_unpackhi_epi8(va, vb);
+    const SIMD_INT vcd_lo = _mm256_unpacklo_epi8(vc, vd);
+    const SIMD_INT vcd_hi = _mm256_unpackhi_epi8(vc, vd);
+    const SIMD_INT t0 = _mm256_unpacklo_epi16(vab_lo, vcd_lo);
+    const SIMD_INT t1 = _mm256_unpackhi_epi16(vab_lo, vcd_lo);
+    const SIMD_INT t2 = _mm256_unpacklo_epi16(vab_hi, vcd_hi);
+    const SIMD_INT t3 = _mm256_unpackhi_epi16(vab_hi, vcd_hi);
+    _mm256_storeu_si256((SIMD_INT *)sa, _mm256_permute2x128_si256(t0, t1, 0x20));
+    _mm256_storeu_si256((SIMD_INT *)(sa + 32), _mm256_permute2x128_si256(t2, t3, 0x20));
+    _mm256_storeu_si256((SIMD_INT *)(sa + 64), _mm256_permute2x128_si256(t0, t1, 0x31));
+    _mm256_storeu_si256((SIMD_INT *)(sa + 96), _mm256_permute2x128_si256(t2, t3, 0x31));
+}
+#else
+//! 8-bit records (e.g., pixels), AVX has no 256-bit byte shuffles, components go through memory
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    uint8_t tmp[2][32] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    for (int32_t i = 0; i < 32; ++i) {
+        tmp[0][i] = sa[2 * i];
+        tmp[1][i] = sa[2 * i + 1];
+    }
+    *va = _mm256_load_si256((SIMD_INT *)tmp[0]);
+    *vb = _mm256_load_si256((SIMD_INT *)tmp[1]);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    uint8_t tmp[3][32] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    for (int32_t i = 0; i < 32; ++i) {
+        tmp[0][i] = sa[3 * i];
+        tmp[1][i] = sa[3 * i + 1];
+        tmp[2][i] = sa[3 * i + 2];
+    }
+    *va = _mm256_load_si256((SIMD_INT *)tmp[0]);
+    *vb = _mm256_load_si256((SIMD_INT *)tmp[1]);
+    *vc = _mm256_load_si256((SIMD_INT *)tmp[2]);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    uint8_t tmp[4][32] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    for (int32_t i = 0; i < 32; ++i) {
+        tmp[0][i] = sa[4 * i];
+        tmp[1][i] = sa[4 * i + 1];
+        tmp[2][i] = sa[4 * i + 2];
+        tmp[3][i] = sa[4 * i + 3];
+    }
+    *va = _mm256_load_si256((SIMD_INT *)tmp[0]);
+    *vb = _mm256_load_si256((SIMD_INT *)tmp[1]);
+    *vc = _mm256_load_si256((SIMD_INT *)tmp[2]);
+    *vd = _mm256_load_si256((SIMD_INT *)tmp[3]);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{
+    uint8_t tmp[2][32] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    _mm256_store_si256((SIMD_INT *)tmp[0], va);
+    _mm256_store_si256((SIMD_INT *)tmp[1], vb);
+    for (int32_t i = 0; i < 32; ++i) {
+        sa[2 * i] = tmp[0][i];
+        sa[2 * i + 1] = tmp[1][i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{
+    uint8_t tmp[3][32] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    _mm256_store_si256((SIMD_INT *)tmp[0], va);
+    _mm256_store_si256((SIMD_INT *)tmp[1], vb);
+    _mm256_store_si256((SIMD_INT *)tmp[2], vc);
+    for (int32_t i = 0; i < 32; ++i) {
+        sa[3 * i] = tmp[0][i];
+        sa[3 * i + 1] = tmp[1][i];
+        sa[3 * i + 2] = tmp[2][i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{
+    uint8_t tmp[4][32] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    _mm256_store_si256((SIMD_INT *)tmp[0], va);
+    _mm256_store_si256((SIMD_INT *)tmp[1], vb);
+    _mm256_store_si256((SIMD_INT *)tmp[2], vc);
+    _mm256_store_si256((SIMD_INT *)tmp[3], vd);
+    for (int32_t i = 0; i < 32; ++i) {
+        sa[4 * i] = tmp[0][i];
+        sa[4 * i + 1] = tmp[1][i];
+        sa[4 * i + 2] = tmp[2][i];
+        sa[4 * i + 3] = tmp[3][i];
+    }
+}
+#endif
+
+
+/**************************
+ *  Transpose intrinsics
+ **************************/
+/*!
+ *  Transpose a square tile, sb[j * ldb + i] = sa[i * lda + j].
+ *  Rows of \c sa are loaded into registers, transposed with shuffles and
+ *  stored as rows of \c sb. Leading dimensions are in elements, rows need
+ *  not be aligned and tiles must not overlap.
+ */
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    __m128 r0 = _mm_loadu_ps(sa);
+    __m128 r1 = _mm_loadu_ps(sa + lda);
+    __m128 r2 = _mm_loadu_ps(sa + 2 * lda);
+    __m128 r3 = _mm_loadu_ps(sa + 3 * lda);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(sb, r0);
+    _mm_storeu_ps(sb + ldb, r1);
+    _mm_storeu_ps(sb + 2 * ldb, r2);
+    _mm_storeu_ps(sb + 3 * ldb, r3);
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    const __m256 r0 = _mm256_loadu_ps(sa);
+    const __m256 r1 = _mm256_loadu_ps(sa + lda);
+    const __m256 r2 = _mm256_loadu_ps(sa + 2 * lda);
+    const __m256 r3 = _mm256_loadu_ps(sa + 3 * lda);
+    const __m256 r4 = _mm256_loadu_ps(sa + 4 * lda);
+    const __m256 r5 = _mm256_loadu_ps(sa + 5 * lda);
+    const __m256 r6 = _mm256_loadu_ps(sa + 6 * lda);
+    const __m256 r7 = _mm256_loadu_ps(sa + 7 * lda);
+
+    // Pairs of rows, then 4x4 blocks in each 128-bit lane
+    const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+    const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+    const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    const __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+    const __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+    const __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+    const __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+    const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+    // Swap 128-bit lanes between upper and lower rows
+    _mm256_storeu_ps(sb, _mm256_permute2f128_ps(s0, s4, 0x20));
+    _mm256_storeu_ps(sb + ldb, _mm256_permute2f128_ps(s1, s5, 0x20));
+    _mm256_storeu_ps(sb + 2 * ldb, _mm256_permute2f128_ps(s2, s6, 0x20));
+    _mm256_storeu_ps(sb + 3 * ldb, _mm256_permute2f128_ps(s3, s7, 0x20));
+    _mm256_storeu_ps(sb + 4 * ldb, _mm256_permute2f128_ps(s0, s4, 0x31));
+    _mm256_storeu_ps(sb + 5 * ldb, _mm256_permute2f128_ps(s1, s5, 0x31));
+    _mm256_storeu_ps(sb + 6 * ldb, _mm256_permute2f128_ps(s2, s6, 0x31));
+    _mm256_storeu_ps(sb + 7 * ldb, _mm256_permute2f128_ps(s3, s7, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    const __m256d r0 = _mm256_loadu_pd(sa);
+    const __m256d r1 = _mm256_loadu_pd(sa + lda);
+    const __m256d r2 = _mm256_loadu_pd(sa + 2 * lda);
+    const __m256d r3 = _mm256_loadu_pd(sa + 3 * lda);
+    const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+    _mm256_storeu_pd(sb, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(sb + ldb, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(sb + 2 * ldb, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(sb + 3 * ldb, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    simd_transpose4x4_f64(sb, ldb, sa, lda);
+    simd_transpose4x4_f64(sb + 4, ldb, sa + 4 * lda, lda);
+    simd_transpose4x4_f64(sb + 4 * ldb, ldb, sa + 4, lda);
+    simd_transpose4x4_f64(sb + 4 * ldb + 4, ldb, sa + 4 * lda + 4, lda);
+}
+
+
+/*************************
+ *  Gather instructions  *
+ *************************/
+/*!
+ *  Gather, lane i is loaded from sa[idx[i]], one 32-bit index per lane.
+ *  Indices need not be sorted or distinct and are not range-checked.
+ */
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_gather(const float * const sa, const int32_t * const idx)
+{
+    return _mm256_set_ps(sa[idx[7]], sa[idx[6]], sa[idx[5]], sa[idx[4]],
+                         sa[idx[3]], sa[idx[2]], sa[idx[1]], sa[idx[0]]);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_gather(const double * const sa, const int32_t * const idx)
+{ return _mm256_set_pd(sa[idx[3]], sa[idx[2]], sa[idx[1]], sa[idx[0]]); }
+
+
+/************************
+ *  Align instructions  *
+ ************************/
+/*!
+ *  Lanes N .. N + nlanes - 1 of the concatenation of vb (low lanes) and va
+ *  (high lanes), 0 <= N <= nlanes. Vectors at consecutive aligned addresses
+ *  give the vector at an unaligned offset of N elements.
+ */
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_alignr(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    if (N <= 0)
+        return vb;
+    if (N >= 8)
+        return va;
+    const __m256 vm = _mm256_permute2f128_ps(vb, va, 0x21);
+    if (N == 4)
+        return vm;
+
+    // No shifts across 128-bit lanes, combine lane pairs (lo, hi) in-lane
+    const __m256 lo = (N < 4) ? (vb) : (vm);
+    const __m256 hi = (N < 4) ? (vm) : (va);
+    if ((N & 3) == 2)
+        return _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(1, 0, 3, 2));
+    const __m256 vt = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(0, 0, 3, 3));
+    return ((N & 3) == 1) ? (_mm256_shuffle_ps(lo, vt, _MM_SHUFFLE(2, 0, 2, 1)))
+                          : (_mm256_shuffle_ps(vt, hi, _MM_SHUFFLE(2, 1, 2, 0)));
+}
+
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_alignr(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    if (N <= 0)
+        return vb;
+    if (N >= 4)
+        return va;
+    const __m256d vm = _mm256_permute2f128_pd(vb, va, 0x21);
+    if (N == 2)
+        return vm;
+    return (N == 1) ? (_mm256_shuffle_pd(vb, vm, 0x5)) : (_mm256_shuffle_pd(vm, va, 0x5));
+}
+
+
+/***********************
+ *  Scan instructions  *
+ ***********************/
+/*!
+ *  Inclusive prefix sums of the lanes of va plus the carry *vc (all lanes
+ *  equal), by log2(nlanes) steps of lane shifts and adds. The sum of va is
+ *  broadcast and added to *vc, the carry of the next vector, so that one
+ *  add per vector is on the loop-carried path.
+ */
+//! No 256-bit integer adds, 128-bit halves where hi gets the last lane of lo
+static SIMD_FUNC_INLINE
+__m128i simd_scan_128_32(const __m128i va)
+{
+    const __m128i vs = _mm_add_epi32(va, _mm_slli_si128(va, 4));
+    return _mm_add_epi32(vs, _mm_slli_si128(vs, 8));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_32(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const __m128i vp = _mm256_castsi256_si128(*vc);
+    const __m128i vl = simd_scan_128_32(_mm256_castsi256_si128(va));
+    const __m128i vh = _mm_add_epi32(simd_scan_128_32(_mm256_extractf128_si256(va, 0x01)), _mm_shuffle_epi32(vl, 0xFF));
+    const __m128i vt = _mm_add_epi32(vp, _mm_shuffle_epi32(vh, 0xFF));
+    *vc = _mm256_insertf128_si256(_mm256_castsi128_si256(vt), vt, 0x01);
+    return _mm256_insertf128_si256(_mm256_castsi128_si256(_mm_add_epi32(vl, vp)), _mm_add_epi32(vh, vp), 0x01);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_64(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const __m128i va_lo = _mm256_castsi256_si128(va);
+    const __m128i va_hi = _mm256_extractf128_si256(va, 0x01);
+    const __m128i vp = _mm256_castsi256_si128(*vc);
+    const __m128i vl = _mm_add_epi64(va_lo, _mm_slli_si128(va_lo, 8));
+    const __m128i vh = _mm_add_epi64(_mm_add_epi64(va_hi, _mm_slli_si128(va_hi, 8)), _mm_shuffle_epi32(vl, 0xEE));
+    const __m128i vt = _mm_add_epi64(vp, _mm_shuffle_epi32(vh, 0xEE));
+    *vc = _mm256_insertf128_si256(_mm256_castsi128_si256(vt), vt, 0x01);
+    return _mm256_insertf128_si256(_mm256_castsi128_si256(_mm_add_epi64(vl, vp)), _mm_add_epi64(vh, vp), 0x01);
+}
+
+//! In-lane shifts are permutes with zeros blended in, then low half to high half
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    const __m256 vz = _mm256_setzero_ps();
+    SIMD_FLT vs = _mm256_add_ps(va, _mm256_blend_ps(_mm256_permute_ps(va, _MM_SHUFFLE(2, 1, 0, 0)), vz, 0x11));
+    vs = _mm256_add_ps(vs, _mm256_blend_ps(_mm256_permute_ps(vs, _MM_SHUFFLE(1, 0, 0, 0)), vz, 0x33));
+    const __m256 vt = _mm256_permute_ps(vs, 0xFF);
+    vs = _mm256_add_ps(vs, _mm256_permute2f128_ps(vt, vt, 0x08));
+    const __m256 vl = _mm256_permute_ps(vs, 0xFF);
+    const SIMD_FLT vp = *vc;
+    *vc = _mm256_add_ps(vp, _mm256_permute2f128_ps(vl, vl, 0x11));
+    return _mm256_add_ps(vs, vp);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    SIMD_DBL vs = _mm256_add_pd(va, _mm256_blend_pd(_mm256_permute_pd(va, 0x0), _mm256_setzero_pd(), 0x5));
+    const __m256d vt = _mm256_permute_pd(vs, 0xF);
+    vs = _mm256_add_pd(vs, _mm256_permute2f128_pd(vt, vt, 0x08));
+    const __m256d vl = _mm256_permute_pd(vs, 0xF);
+    const SIMD_DBL vp = *vc;
+    *vc = _mm256_add_pd(vp, _mm256_permute2f128_pd(vl, vl, 0x11));
+    return _mm256_add_pd(vs, vp);
+}
+
+/*!
+ *  Exclusive prefix sums, lane i is the carry plus lanes 0 .. i-1 of va,
+ *  *vc is updated as by the inclusive sums
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_32(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const __m128i vp = _mm256_castsi256_si128(*vc);
+    const SIMD_INT vs = simd_scan_32(va, vc);
+    const __m128i vl = _mm256_castsi256_si128(vs);
+    const __m128i vh = _mm256_extractf128_si256(vs, 0x01);
+    return _mm256_insertf128_si256(_mm256_castsi128_si256(_mm_alignr_epi8(vl, vp, 12)), _mm_alignr_epi8(vh, vl, 12), 0x01);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_64(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const __m128i vp = _mm256_castsi256_si128(*vc);
+    const SIMD_INT vs = simd_scan_64(va, vc);
+    const __m128i vl = _mm256_castsi256_si128(vs);
+    const __m128i vh = _mm256_extractf128_si256(vs, 0x01);
+    return _mm256_insertf128_si256(_mm256_castsi128_si256(_mm_alignr_epi8(vl, vp, 8)), _mm_alignr_epi8(vh, vl, 8), 0x01);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan_excl(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    const SIMD_FLT vp = *vc;
+    return simd_alignr<7>(simd_scan(va, vc), vp);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan_excl(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    const SIMD_DBL vp = *vc;
+    return simd_alignr<3>(simd_scan(va, vc), vp);
+}
+
+
+}  // namespace avx
+}  // namespace gvl
 
 
 #endif  // _AVX_H
@@ -0,0 +1,2143 @@
+/*!
+ *  \defgroup AVX2X2 AVX2x2
+ *  \brief SIMD interface for 512-bit logical vectors built from pairs of AVX2 registers
+ *
+ *  Each vector type holds two 256-bit registers: \c lo (lower half) and
+ *  \c hi (upper half). Code tuned for 512-bit widths (e.g. SIMD_STREAMS_32 == 16)
+ *  runs unchanged on AVX2 hosts, and the two halves form independent
+ *  dependency chains that the out-of-order core can overlap.
+ *
+ *  Operations follow the SSE4.2 interface extended to the full 512-bit
+ *  register: "halves" refer to \c lo and \c hi, except 128-bit shifts
+ *  which operate on each 128-bit block (as in AVX2).
+ *
+ *  Interface Legend:\n
+ *  simd_*_iXX = signed XX-bit integers\n
+ *  simd_*_uXX = unsigned XX-bit integers\n
+ *  simd_*_fXX = floating-point XX-bit elements\n
+ *  simd_*_XX  = unsigned/signed XX-bit integers\n
+ *  simd_*_XX  = (set functions) specifies width to consider for integer types\n
+ *  simd_*     = datatype obtained from function overloading and parameters
+ */
+#ifndef _AVX2X2_H
+#define _AVX2X2_H
+
+
+#include "compiler_attributes.h"
+#include "compiler_builtins.h"
+#include <immintrin.h>
+#include <stdint.h>
+#include <stddef.h>   // size_t
+
+
+#if !defined(__AVX2__)
+#   error "AVX2x2 SIMD interface requires AVX2 support (-mavx2)."
+#endif
+
+
+#ifndef _SHUFFLE_CTRL_
+#define _SHUFFLE_CTRL_
+/*!
+ *  Control values for shuffle operations
+ *  \todo Move this enum to a global area, all SIMD modes will use it
+ */
+enum SHUFFLE_CTRL { XCHG = 0, // Exchange lower/upper halfs of register
+                    XCHG8,    // Exchange pairs of 8-bit elements
+                    XCHG16,   // Exchange pairs of 16-bit elements
+                    XCHG32,   // Exchange pairs of 32-bit elements
+                    XCHG64,   // Exchange pairs of 64-bit elements
+                    DUPL,     // Duplicate lower half into upper half of register
+                    DUPH };   // Duplicate upper half into lower half of register
+#endif
+
+
+namespace gvl {
+namespace avx2x2 {
+
+
+const int32_t SIMD_WIDTH_BITS = 512;
+const int32_t SIMD_WIDTH_BYTES = SIMD_WIDTH_BITS / 8;
+const int32_t SIMD_STREAMS_8 = SIMD_WIDTH_BYTES;
+const int32_t SIMD_STREAMS_16 = SIMD_WIDTH_BYTES / sizeof(int16_t);
+const int32_t SIMD_STREAMS_32 = SIMD_WIDTH_BYTES / sizeof(int32_t);
+const int32_t SIMD_STREAMS_64 = SIMD_WIDTH_BYTES / sizeof(int64_t);
+typedef struct { __m256i lo, hi; } SIMD_INT;
+typedef struct { __m256  lo, hi; } SIMD_FLT;
+typedef struct { __m256d lo, hi; } SIMD_DBL;
+
+
+/*
+ *  Build a vector from its lower and upper 256-bit halves.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_join(const __m256i va_lo, const __m256i va_hi)
+{
+    SIMD_INT va;
+    va.lo = va_lo;
+    va.hi = va_hi;
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_join(const __m256 va_lo, const __m256 va_hi)
+{
+    SIMD_FLT va;
+    va.lo = va_lo;
+    va.hi = va_hi;
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_join(const __m256d va_lo, const __m256d va_hi)
+{
+    SIMD_DBL va;
+    va.lo = va_lo;
+    va.hi = va_hi;
+    return va;
+}
+
+/*
+ *  Lane masks for the first n 32/64-bit elements of a 256-bit register,
+ *  used with masked loads/stores.
+ */
+static SIMD_FUNC_INLINE
+__m256i simd_mask_32(const int32_t n)
+{ return _mm256_cmpgt_epi32(_mm256_set1_epi32(n), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)); }
+
+static SIMD_FUNC_INLINE
+__m256i simd_mask_64(const int32_t n)
+{ return _mm256_cmpgt_epi64(_mm256_set1_epi64x(n), _mm256_setr_epi64x(0, 1, 2, 3)); }
+
+
+/***********************
+ *  Misc instructions  *
+ ***********************/
+static SIMD_FUNC_INLINE
+void simd_prefetch(const void *sa, const int32_t hint = 0)
+{
+    switch (hint) {
+        case 1: __prefetchw((char *)sa); break;
+        default: __prefetchr((char *)sa); break;
+    }
+}
+
+
+/*****************************
+ *  Arithmetic instructions  *
+ *****************************/
+static SIMD_FUNC_INLINE
+SIMD_INT simd_add_8(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_add_epi8(va.lo, vb.lo), _mm256_add_epi8(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_add_16(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_add_epi16(va.lo, vb.lo), _mm256_add_epi16(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_add_32(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_add_epi32(va.lo, vb.lo), _mm256_add_epi32(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_add_64(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_add_epi64(va.lo, vb.lo), _mm256_add_epi64(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_add(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(_mm256_add_ps(va.lo, vb.lo), _mm256_add_ps(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_add(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(_mm256_add_pd(va.lo, vb.lo), _mm256_add_pd(va.hi, vb.hi)); }
+
+/*!
+ *  Horizontal operations store pairwise results from first operand in lower
+ *  half and from second operand in upper half.
+ *  \note AVX2 horizontal instructions interleave 128-bit blocks of both
+ *        operands, a 64-bit permute restores element order.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_hadd_16(const SIMD_INT va, const SIMD_INT vb)
+{
+    return simd_join(_mm256_permute4x64_epi64(_mm256_hadd_epi16(va.lo, va.hi), 0xD8),
+                     _mm256_permute4x64_epi64(_mm256_hadd_epi16(vb.lo, vb.hi), 0xD8));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_hadd_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    return simd_join(_mm256_permute4x64_epi64(_mm256_hadd_epi32(va.lo, va.hi), 0xD8),
+                     _mm256_permute4x64_epi64(_mm256_hadd_epi32(vb.lo, vb.hi), 0xD8));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_hadd(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    const __m256d vc_lo = _mm256_castps_pd(_mm256_hadd_ps(va.lo, va.hi));
+    const __m256d vc_hi = _mm256_castps_pd(_mm256_hadd_ps(vb.lo, vb.hi));
+    return simd_join(_mm256_castpd_ps(_mm256_permute4x64_pd(vc_lo, 0xD8)),
+                     _mm256_castpd_ps(_mm256_permute4x64_pd(vc_hi, 0xD8)));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_hadd(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    return simd_join(_mm256_permute4x64_pd(_mm256_hadd_pd(va.lo, va.hi), 0xD8),
+                     _mm256_permute4x64_pd(_mm256_hadd_pd(vb.lo, vb.hi), 0xD8));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sub_8(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_sub_epi8(va.lo, vb.lo), _mm256_sub_epi8(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sub_16(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_sub_epi16(va.lo, vb.lo), _mm256_sub_epi16(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sub_32(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_sub_epi32(va.lo, vb.lo), _mm256_sub_epi32(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sub_64(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_sub_epi64(va.lo, vb.lo), _mm256_sub_epi64(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_sub(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(_mm256_sub_ps(va.lo, vb.lo), _mm256_sub_ps(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_sub(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(_mm256_sub_pd(va.lo, vb.lo), _mm256_sub_pd(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_hsub_16(const SIMD_INT va, const SIMD_INT vb)
+{
+    return simd_join(_mm256_permute4x64_epi64(_mm256_hsub_epi16(va.lo, va.hi), 0xD8),
+                     _mm256_permute4x64_epi64(_mm256_hsub_epi16(vb.lo, vb.hi), 0xD8));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_hsub_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    return simd_join(_mm256_permute4x64_epi64(_mm256_hsub_epi32(va.lo, va.hi), 0xD8),
+                     _mm256_permute4x64_epi64(_mm256_hsub_epi32(vb.lo, vb.hi), 0xD8));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_hsub(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    const __m256d vc_lo = _mm256_castps_pd(_mm256_hsub_ps(va.lo, va.hi));
+    const __m256d vc_hi = _mm256_castps_pd(_mm256_hsub_ps(vb.lo, vb.hi));
+    return simd_join(_mm256_castpd_ps(_mm256_permute4x64_pd(vc_lo, 0xD8)),
+                     _mm256_castpd_ps(_mm256_permute4x64_pd(vc_hi, 0xD8)));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_hsub(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    return simd_join(_mm256_permute4x64_pd(_mm256_hsub_pd(va.lo, va.hi), 0xD8),
+                     _mm256_permute4x64_pd(_mm256_hsub_pd(vb.lo, vb.hi), 0xD8));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_fmadd(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc)
+{
+#if defined(__FMA__)
+    return simd_join(_mm256_fmadd_ps(va.lo, vb.lo, vc.lo), _mm256_fmadd_ps(va.hi, vb.hi, vc.hi));
+#else
+    return simd_join(_mm256_add_ps(_mm256_mul_ps(va.lo, vb.lo), vc.lo),
+                     _mm256_add_ps(_mm256_mul_ps(va.hi, vb.hi), vc.hi));
+#endif
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_fmadd(const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc)
+{
+#if defined(__FMA__)
+    return simd_join(_mm256_fmadd_pd(va.lo, vb.lo, vc.lo), _mm256_fmadd_pd(va.hi, vb.hi, vc.hi));
+#else
+    return simd_join(_mm256_add_pd(_mm256_mul_pd(va.lo, vb.lo), vc.lo),
+                     _mm256_add_pd(_mm256_mul_pd(va.hi, vb.hi), vc.hi));
+#endif
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_fmsub(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc)
+{
+#if defined(__FMA__)
+    return simd_join(_mm256_fmsub_ps(va.lo, vb.lo, vc.lo), _mm256_fmsub_ps(va.hi, vb.hi, vc.hi));
+#else
+    return simd_join(_mm256_sub_ps(_mm256_mul_ps(va.lo, vb.lo), vc.lo),
+                     _mm256_sub_ps(_mm256_mul_ps(va.hi, vb.hi), vc.hi));
+#endif
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_fmsub(const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc)
+{
+#if defined(__FMA__)
+    return simd_join(_mm256_fmsub_pd(va.lo, vb.lo, vc.lo), _mm256_fmsub_pd(va.hi, vb.hi, vc.hi));
+#else
+    return simd_join(_mm256_sub_pd(_mm256_mul_pd(va.lo, vb.lo), vc.lo),
+                     _mm256_sub_pd(_mm256_mul_pd(va.hi, vb.hi), vc.hi));
+#endif
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_16(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_mullo_epi16(va.lo, vb.lo), _mm256_mullo_epi16(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_32(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_mullo_epi32(va.lo, vb.lo), _mm256_mullo_epi32(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+__m256i simd_mul_64(const __m256i va, const __m256i vb)
+{
+    //! \note x64 * y64 = (xl * yl) + (xl * yh + xh * yl) * 2^32
+    const __m256i vmsk = _mm256_set1_epi64x(0xFFFFFFFF00000000);
+    __m256i vlo, vhi;
+    vlo = _mm256_shuffle_epi32(vb, 0xB1);  // shuffle multiplier
+    vhi = _mm256_mullo_epi32(va, vlo);     // xl * yh, xh * yl
+    vlo = _mm256_slli_epi64(vhi, 0x20);    // shift << 32
+    vhi = _mm256_add_epi64(vhi, vlo);      // h = h1 + h2
+    vhi = _mm256_and_si256(vhi, vmsk);     // h & 0xFFFFFFFF00000000
+    vlo = _mm256_mul_epu32(va, vb);        // l = xl * yl
+    return _mm256_add_epi64(vlo, vhi);     // l + h
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_64(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(simd_mul_64(va.lo, vb.lo), simd_mul_64(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_mul(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(_mm256_mul_ps(va.lo, vb.lo), _mm256_mul_ps(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_mul(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(_mm256_mul_pd(va.lo, vb.lo), _mm256_mul_pd(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+__m256i simd_mul_i16_32(const __m256i va, const __m256i vb)
+{
+    const __m256i vlo = _mm256_mullo_epi16(va, vb);  // low 16-bits
+    __m256i vhi = _mm256_mulhi_epi16(va, vb);        // high 16-bits
+    vhi = _mm256_slli_si256(vhi, 0x02);              // shift 16-bits
+    return _mm256_blend_epi16(vlo, vhi, 0xAA);       // merge low and high parts
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_i16_32(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(simd_mul_i16_32(va.lo, vb.lo), simd_mul_i16_32(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_i32_64(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_mul_epi32(va.lo, vb.lo), _mm256_mul_epi32(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+__m256i simd_mul_u16_32(const __m256i va, const __m256i vb)
+{
+    const __m256i vlo = _mm256_mullo_epi16(va, vb);  // low 16-bits
+    __m256i vhi = _mm256_mulhi_epu16(va, vb);        // high 16-bits
+    vhi = _mm256_slli_si256(vhi, 0x02);              // shift 16-bits
+    return _mm256_blend_epi16(vlo, vhi, 0xAA);       // merge low and high parts
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_u16_32(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(simd_mul_u16_32(va.lo, vb.lo), simd_mul_u16_32(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_u32_64(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_mul_epu32(va.lo, vb.lo), _mm256_mul_epu32(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_div(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(_mm256_div_ps(va.lo, vb.lo), _mm256_div_ps(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_div(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(_mm256_div_pd(va.lo, vb.lo), _mm256_div_pd(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_sqrt(const SIMD_FLT va)
+{ return simd_join(_mm256_sqrt_ps(va.lo), _mm256_sqrt_ps(va.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_sqrt(const SIMD_DBL va)
+{ return simd_join(_mm256_sqrt_pd(va.lo), _mm256_sqrt_pd(va.hi)); }
+
+
+/**************************
+ *  Logical instructions  *
+ **************************/
+static SIMD_FUNC_INLINE
+SIMD_INT simd_and(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_and_si256(va.lo, vb.lo), _mm256_and_si256(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_and(const SIMD_FLT va, const SIMD_INT vb)
+{
+    //! \note Used to mask vector elements
+    return simd_join(_mm256_and_ps(va.lo, _mm256_castsi256_ps(vb.lo)),
+                     _mm256_and_ps(va.hi, _mm256_castsi256_ps(vb.hi)));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_and(const SIMD_DBL va, const SIMD_INT vb)
+{
+    //! \note Used to mask vector elements
+    return simd_join(_mm256_and_pd(va.lo, _mm256_castsi256_pd(vb.lo)),
+                     _mm256_and_pd(va.hi, _mm256_castsi256_pd(vb.hi)));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_or(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_or_si256(va.lo, vb.lo), _mm256_or_si256(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_xor(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_xor_si256(va.lo, vb.lo), _mm256_xor_si256(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_and(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(_mm256_and_ps(va.lo, vb.lo), _mm256_and_ps(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_and(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(_mm256_and_pd(va.lo, vb.lo), _mm256_and_pd(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_or(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(_mm256_or_ps(va.lo, vb.lo), _mm256_or_ps(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_or(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(_mm256_or_pd(va.lo, vb.lo), _mm256_or_pd(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_xor(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(_mm256_xor_ps(va.lo, vb.lo), _mm256_xor_ps(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_xor(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(_mm256_xor_pd(va.lo, vb.lo), _mm256_xor_pd(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sll_16(const SIMD_INT va, const int8_t shft)
+{ return simd_join(_mm256_slli_epi16(va.lo, shft), _mm256_slli_epi16(va.hi, shft)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sll_32(const SIMD_INT va, const int8_t shft)
+{ return simd_join(_mm256_slli_epi32(va.lo, shft), _mm256_slli_epi32(va.hi, shft)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sll_64(const SIMD_INT va, const int8_t shft)
+{ return simd_join(_mm256_slli_epi64(va.lo, shft), _mm256_slli_epi64(va.hi, shft)); }
+
+/*!
+ *  Shift bytes within each 128-bit block.
+ *  \note Byte shuffles are used because \c shft is not an immediate literal,
+ *        indices with the sign bit set produce zero.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sll_128(const SIMD_INT va, const int8_t shft)
+{
+    if ((uint8_t)shft > 15)
+        return simd_join(_mm256_setzero_si256(), _mm256_setzero_si256());
+    const __m256i viota = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                           0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m256i vidx = _mm256_sub_epi8(viota, _mm256_set1_epi8(shft));
+    return simd_join(_mm256_shuffle_epi8(va.lo, vidx), _mm256_shuffle_epi8(va.hi, vidx));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_srl_16(const SIMD_INT va, const int8_t shft)
+{ return simd_join(_mm256_srli_epi16(va.lo, shft), _mm256_srli_epi16(va.hi, shft)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_srl_32(const SIMD_INT va, const int8_t shft)
+{ return simd_join(_mm256_srli_epi32(va.lo, shft), _mm256_srli_epi32(va.hi, shft)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_srl_64(const SIMD_INT va, const int8_t shft)
+{ return simd_join(_mm256_srli_epi64(va.lo, shft), _mm256_srli_epi64(va.hi, shft)); }
+
+//! \note Shift bytes within each 128-bit block
+static SIMD_FUNC_INLINE
+SIMD_INT simd_srl_128(const SIMD_INT va, const int8_t shft)
+{
+    if ((uint8_t)shft > 15)
+        return simd_join(_mm256_setzero_si256(), _mm256_setzero_si256());
+    const __m256i viota = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                           0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m256i vidx = _mm256_add_epi8(viota, _mm256_set1_epi8(shft));
+    vidx = _mm256_or_si256(vidx, _mm256_cmpgt_epi8(vidx, _mm256_set1_epi8(15)));
+    return simd_join(_mm256_shuffle_epi8(va.lo, vidx), _mm256_shuffle_epi8(va.hi, vidx));
+}
+
+
+/**************************
+ *  Compare instructions  *
+ **************************/
+/*!
+ *  Comparisons set all bits of elements where the condition holds
+ *  and clear them otherwise, results are used as masks.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmpeq_32(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_cmpeq_epi32(va.lo, vb.lo), _mm256_cmpeq_epi32(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmpgt_i32(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_cmpgt_epi32(va.lo, vb.lo), _mm256_cmpgt_epi32(va.hi, vb.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmplt_i32(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(_mm256_cmpgt_epi32(vb.lo, va.lo), _mm256_cmpgt_epi32(vb.hi, va.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpeq(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(_mm256_cmp_ps(va.lo, vb.lo, _CMP_EQ_OQ), _mm256_cmp_ps(va.hi, vb.hi, _CMP_EQ_OQ)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpeq(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(_mm256_cmp_pd(va.lo, vb.lo, _CMP_EQ_OQ), _mm256_cmp_pd(va.hi, vb.hi, _CMP_EQ_OQ)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpneq(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(_mm256_cmp_ps(va.lo, vb.lo, _CMP_NEQ_UQ), _mm256_cmp_ps(va.hi, vb.hi, _CMP_NEQ_UQ)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpneq(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(_mm256_cmp_pd(va.lo, vb.lo, _CMP_NEQ_UQ), _mm256_cmp_pd(va.hi, vb.hi, _CMP_NEQ_UQ)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmplt(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(_mm256_cmp_ps(va.lo, vb.lo, _CMP_LT_OQ), _mm256_cmp_ps(va.hi, vb.hi, _CMP_LT_OQ)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmplt(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(_mm256_cmp_pd(va.lo, vb.lo, _CMP_LT_OQ), _mm256_cmp_pd(va.hi, vb.hi, _CMP_LT_OQ)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmple(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(_mm256_cmp_ps(va.lo, vb.lo, _CMP_LE_OQ), _mm256_cmp_ps(va.hi, vb.hi, _CMP_LE_OQ)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmple(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(_mm256_cmp_pd(va.lo, vb.lo, _CMP_LE_OQ), _mm256_cmp_pd(va.hi, vb.hi, _CMP_LE_OQ)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpgt(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(_mm256_cmp_ps(va.lo, vb.lo, _CMP_GT_OQ), _mm256_cmp_ps(va.hi, vb.hi, _CMP_GT_OQ)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpgt(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(_mm256_cmp_pd(va.lo, vb.lo, _CMP_GT_OQ), _mm256_cmp_pd(va.hi, vb.hi, _CMP_GT_OQ)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpge(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(_mm256_cmp_ps(va.lo, vb.lo, _CMP_GE_OQ), _mm256_cmp_ps(va.hi, vb.hi, _CMP_GE_OQ)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpge(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(_mm256_cmp_pd(va.lo, vb.lo, _CMP_GE_OQ), _mm256_cmp_pd(va.hi, vb.hi, _CMP_GE_OQ)); }
+
+/*!
+ *  Select elements from second operand where mask is set,
+ *  otherwise select elements from first operand.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_blend(const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vmsk)
+{ return simd_join(_mm256_blendv_epi8(va.lo, vb.lo, vmsk.lo), _mm256_blendv_epi8(va.hi, vb.hi, vmsk.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_blend(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vmsk)
+{ return simd_join(_mm256_blendv_ps(va.lo, vb.lo, vmsk.lo), _mm256_blendv_ps(va.hi, vb.hi, vmsk.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_blend(const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vmsk)
+{ return simd_join(_mm256_blendv_pd(va.lo, vb.lo, vmsk.lo), _mm256_blendv_pd(va.hi, vb.hi, vmsk.hi)); }
+
+
+/*********************************
+ *  Merge and pack instructions  *
+ *********************************/
+//! \note Halves are separate registers, merges only select registers
+static SIMD_FUNC_INLINE
+SIMD_INT simd_merge_lo(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(va.lo, vb.lo); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_merge_lo(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(va.lo, vb.lo); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_merge_lo(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(va.lo, vb.lo); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_merge_hi(const SIMD_INT va, const SIMD_INT vb)
+{ return simd_join(va.hi, vb.hi); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_merge_hi(const SIMD_FLT va, const SIMD_FLT vb)
+{ return simd_join(va.hi, vb.hi); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_merge_hi(const SIMD_DBL va, const SIMD_DBL vb)
+{ return simd_join(va.hi, vb.hi); }
+
+
+/**************************
+ *  Shuffle instructions  *
+ **************************/
+/*!
+ *  Pack even elements into lower half and odd elements into upper half.
+ *  \note Each register is packed into [even | odd] halves and then
+ *        the halves of both registers are recombined.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_pack_halves(const __m256i va_lo, const __m256i va_hi)
+{
+    return simd_join(_mm256_permute2x128_si256(va_lo, va_hi, 0x20),
+                     _mm256_permute2x128_si256(va_lo, va_hi, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_pack_8(const SIMD_INT va)
+{
+    const __m256i vmsk = _mm256_set_epi64x(0x0F0D0B0907050301, 0x0E0C0A0806040200,
+                                           0x0F0D0B0907050301, 0x0E0C0A0806040200);
+    return simd_pack_halves(_mm256_permute4x64_epi64(_mm256_shuffle_epi8(va.lo, vmsk), 0xD8),
+                            _mm256_permute4x64_epi64(_mm256_shuffle_epi8(va.hi, vmsk), 0xD8));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_pack_16(const SIMD_INT va)
+{
+    const __m256i vmsk = _mm256_set_epi64x(0x0F0E0B0A07060302, 0x0D0C090805040100,
+                                           0x0F0E0B0A07060302, 0x0D0C090805040100);
+    return simd_pack_halves(_mm256_permute4x64_epi64(_mm256_shuffle_epi8(va.lo, vmsk), 0xD8),
+                            _mm256_permute4x64_epi64(_mm256_shuffle_epi8(va.hi, vmsk), 0xD8));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_pack_32(const SIMD_INT va)
+{
+    const __m256i vidx = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    return simd_pack_halves(_mm256_permutevar8x32_epi32(va.lo, vidx),
+                            _mm256_permutevar8x32_epi32(va.hi, vidx));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_pack(const SIMD_FLT va)
+{
+    const __m256i vidx = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    const SIMD_INT vc = simd_pack_halves(_mm256_castps_si256(_mm256_permutevar8x32_ps(va.lo, vidx)),
+                                         _mm256_castps_si256(_mm256_permutevar8x32_ps(va.hi, vidx)));
+    return simd_join(_mm256_castsi256_ps(vc.lo), _mm256_castsi256_ps(vc.hi));
+}
+
+//! \note Shuffle assumes that vector register width is a multiple of 32
+static SIMD_FUNC_INLINE
+SIMD_INT simd_shuffle(const SIMD_INT va, const SHUFFLE_CTRL ctrl)
+{
+    switch (ctrl) {
+        case XCHG: return simd_join(va.hi, va.lo); break;
+        case XCHG8:
+        {
+            const __m256i vmsk = _mm256_set_epi64x(0x0E0F0C0D0A0B0809, 0x0607040502030001,
+                                                   0x0E0F0C0D0A0B0809, 0x0607040502030001);
+            return simd_join(_mm256_shuffle_epi8(va.lo, vmsk), _mm256_shuffle_epi8(va.hi, vmsk));
+        }
+        break;
+        case XCHG16:
+        {
+            const __m256i vmsk = _mm256_set_epi64x(0x0D0C0F0E09080B0A, 0x0504070601000302,
+                                                   0x0D0C0F0E09080B0A, 0x0504070601000302);
+            return simd_join(_mm256_shuffle_epi8(va.lo, vmsk), _mm256_shuffle_epi8(va.hi, vmsk));
+        }
+        break;
+        case XCHG32: return simd_join(_mm256_shuffle_epi32(va.lo, 0xB1), _mm256_shuffle_epi32(va.hi, 0xB1)); break;
+        case XCHG64: return simd_join(_mm256_shuffle_epi32(va.lo, 0x4E), _mm256_shuffle_epi32(va.hi, 0x4E)); break;
+        case DUPL: return simd_join(va.lo, va.lo); break;
+        case DUPH: return simd_join(va.hi, va.hi); break;
+        default: return va; break;
+    }
+}
+
+//! \note Shuffle assumes that vector register width is a multiple of 32
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_shuffle(const SIMD_FLT va, const SHUFFLE_CTRL ctrl)
+{
+    switch (ctrl) {
+        case XCHG: return simd_join(va.hi, va.lo); break;
+        case XCHG32: return simd_join(_mm256_permute_ps(va.lo, 0xB1), _mm256_permute_ps(va.hi, 0xB1)); break;
+        case XCHG64: return simd_join(_mm256_permute_ps(va.lo, 0x4E), _mm256_permute_ps(va.hi, 0x4E)); break;
+        case DUPL: return simd_join(va.lo, va.lo); break;
+        case DUPH: return simd_join(va.hi, va.hi); break;
+        default: return va; break;
+    }
+}
+
+//! \note Shuffle assumes that vector register width is a multiple of 32
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_shuffle(const SIMD_DBL va, const SHUFFLE_CTRL ctrl)
+{
+    switch (ctrl) {
+        case XCHG: return simd_join(va.hi, va.lo); break;
+        case XCHG64: return simd_join(_mm256_permute_pd(va.lo, 0x5), _mm256_permute_pd(va.hi, 0x5)); break;
+        case DUPL: return simd_join(va.lo, va.lo); break;
+        case DUPH: return simd_join(va.hi, va.hi); break;
+        default: return va; break;
+    }
+}
+
+
+/**************************
+ *  Convert instructions  *
+ **************************/
+/*!
+ *  Widening conversions use the lower half of the operand,
+ *  narrowing conversions set the upper half to zero.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_i16_i32(const SIMD_INT va)
+{
+    return simd_join(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(va.lo)),
+                     _mm256_cvtepi16_epi32(_mm256_extracti128_si256(va.lo, 1)));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_i32_i64(const SIMD_INT va)
+{
+    return simd_join(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(va.lo)),
+                     _mm256_cvtepi32_epi64(_mm256_extracti128_si256(va.lo, 1)));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_i32_f32(const SIMD_INT va)
+{ return simd_join(_mm256_cvtepi32_ps(va.lo), _mm256_cvtepi32_ps(va.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_i32_f64(const SIMD_INT va)
+{
+    return simd_join(_mm256_cvtepi32_pd(_mm256_castsi256_si128(va.lo)),
+                     _mm256_cvtepi32_pd(_mm256_extracti128_si256(va.lo, 1)));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_i64_f32(const SIMD_INT va)
+{
+    /*!
+     *  \note Type conversion performed with scalar unit since
+     *        vector extensions do not support direct conversion
+     */
+    int64_t sa[SIMD_STREAMS_64] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    float sa_flt[SIMD_STREAMS_32] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    _mm256_store_si256((__m256i *)sa, va.lo);
+    _mm256_store_si256((__m256i *)(sa + SIMD_STREAMS_64 / 2), va.hi);
+    #pragma unroll
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        sa_flt[i] = (float)sa[i];
+        sa_flt[i + SIMD_STREAMS_64] = 0.0f;
+    }
+    return simd_join(_mm256_load_ps(sa_flt), _mm256_setzero_ps());
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_i64_f64(const SIMD_INT va)
+{
+    /*!
+     *  \note Type conversion performed with scalar unit since
+     *        vector extensions do not support direct conversion
+     */
+    int64_t sa[SIMD_STREAMS_64] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    double sa_dbl[SIMD_STREAMS_64] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    _mm256_store_si256((__m256i *)sa, va.lo);
+    _mm256_store_si256((__m256i *)(sa + SIMD_STREAMS_64 / 2), va.hi);
+    #pragma unroll
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        sa_dbl[i] = (double)sa[i];
+    return simd_join(_mm256_load_pd(sa_dbl), _mm256_load_pd(sa_dbl + SIMD_STREAMS_64 / 2));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_u16_i32(const SIMD_INT va)
+{
+    return simd_join(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(va.lo)),
+                     _mm256_cvtepu16_epi32(_mm256_extracti128_si256(va.lo, 1)));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_u32_i64(const SIMD_INT va)
+{
+    return simd_join(_mm256_cvtepu32_epi64(_mm256_castsi256_si128(va.lo)),
+                     _mm256_cvtepu32_epi64(_mm256_extracti128_si256(va.lo, 1)));
+}
+
+static SIMD_FUNC_INLINE
+__m256 simd_cvt_u32_f32(const __m256i va)
+{
+    //! \note Convert upper/lower 16 bits separately, both are exact in single-precision
+    const __m256 vhi = _mm256_cvtepi32_ps(_mm256_srli_epi32(va, 16));
+    const __m256 vlo = _mm256_cvtepi32_ps(_mm256_and_si256(va, _mm256_set1_epi32(0xFFFF)));
+    return _mm256_add_ps(_mm256_mul_ps(vhi, _mm256_set1_ps(65536.0f)), vlo);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_u32_f32(const SIMD_INT va)
+{ return simd_join(simd_cvt_u32_f32(va.lo), simd_cvt_u32_f32(va.hi)); }
+
+static SIMD_FUNC_INLINE
+__m256d simd_cvt_u32_f64(const __m128i va)
+{
+    //! \note Signed conversion, negative results are offset by 2^32
+    const __m256d vc = _mm256_cvtepi32_pd(va);
+    const __m256d vmsk = _mm256_cmp_pd(vc, _mm256_setzero_pd(), _CMP_LT_OQ);
+    return _mm256_add_pd(vc, _mm256_and_pd(vmsk, _mm256_set1_pd(4294967296.0)));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_u32_f64(const SIMD_INT va)
+{
+    return simd_join(simd_cvt_u32_f64(_mm256_castsi256_si128(va.lo)),
+                     simd_cvt_u32_f64(_mm256_extracti128_si256(va.lo, 1)));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_u64_f32(const SIMD_INT va)
+{
+    /*!
+     *  \note Type conversion performed with scalar unit since
+     *        vector extensions do not support direct conversion
+     */
+    uint64_t sa[SIMD_STREAMS_64] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    float sa_flt[SIMD_STREAMS_32] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    _mm256_store_si256((__m256i *)sa, va.lo);
+    _mm256_store_si256((__m256i *)(sa + SIMD_STREAMS_64 / 2), va.hi);
+    #pragma unroll
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        sa_flt[i] = (float)sa[i];
+        sa_flt[i + SIMD_STREAMS_64] = 0.0f;
+    }
+    return simd_join(_mm256_load_ps(sa_flt), _mm256_setzero_ps());
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_u64_f64(const SIMD_INT va)
+{
+    /*!
+     *  \note Type conversion performed with scalar unit since
+     *        vector extensions do not support direct conversion
+     */
+    uint64_t sa[SIMD_STREAMS_64] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    double sa_dbl[SIMD_STREAMS_64] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    _mm256_store_si256((__m256i *)sa, va.lo);
+    _mm256_store_si256((__m256i *)(sa + SIMD_STREAMS_64 / 2), va.hi);
+    #pragma unroll
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        sa_dbl[i] = (double)sa[i];
+    return simd_join(_mm256_load_pd(sa_dbl), _mm256_load_pd(sa_dbl + SIMD_STREAMS_64 / 2));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_f32_i32(const SIMD_FLT va)
+{ return simd_join(_mm256_cvtps_epi32(va.lo), _mm256_cvtps_epi32(va.hi)); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_f32_f64(const SIMD_FLT va)
+{
+    return simd_join(_mm256_cvtps_pd(_mm256_castps256_ps128(va.lo)),
+                     _mm256_cvtps_pd(_mm256_extractf128_ps(va.lo, 1)));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_f64_i32(const SIMD_DBL va)
+{
+    const __m256i vc = _mm256_castsi128_si256(_mm256_cvtpd_epi32(va.lo));
+    return simd_join(_mm256_inserti128_si256(vc, _mm256_cvtpd_epi32(va.hi), 1), _mm256_setzero_si256());
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_f64_f32(const SIMD_DBL va)
+{
+    const __m256 vc = _mm256_castps128_ps256(_mm256_cvtpd_ps(va.lo));
+    return simd_join(_mm256_insertf128_ps(vc, _mm256_cvtpd_ps(va.hi), 1), _mm256_setzero_ps());
+}
+
+
+/**********************
+ *  Set instructions  *
+ **********************/
+/*!
+ *  Set vector to zero. Use pointer for function overloading.
+ */
+static SIMD_FUNC_INLINE
+void simd_set_zero(SIMD_INT * const va)
+{ *va = simd_join(_mm256_setzero_si256(), _mm256_setzero_si256()); }
+
+static SIMD_FUNC_INLINE
+void simd_set_zero(SIMD_FLT * const va)
+{ *va = simd_join(_mm256_setzero_ps(), _mm256_setzero_ps()); }
+
+static SIMD_FUNC_INLINE
+void simd_set_zero(SIMD_DBL * const va)
+{ *va = simd_join(_mm256_setzero_pd(), _mm256_setzero_pd()); }
+
+/*!
+ *  Set vector with 32/64 elements.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const int32_t sa)
+{
+    const __m256i va = _mm256_set1_epi32(sa);
+    return simd_join(va, va);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set_64(const int32_t sa)
+{
+    const __m256i va = _mm256_set1_epi64x((int64_t)sa);
+    return simd_join(va, va);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const uint32_t sa)
+{
+    const __m256i va = _mm256_set1_epi32((int32_t)sa);
+    return simd_join(va, va);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set_64(const uint32_t sa)
+{
+    const __m256i va = _mm256_set1_epi64x((int64_t)sa);
+    return simd_join(va, va);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const int64_t sa)
+{
+    const __m256i va = _mm256_set1_epi64x(sa);
+    return simd_join(va, va);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const uint64_t sa)
+{
+    const __m256i va = _mm256_set1_epi64x((int64_t)sa);
+    return simd_join(va, va);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_set(const float sa)
+{
+    const __m256 va = _mm256_set1_ps(sa);
+    return simd_join(va, va);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_set(const double sa)
+{
+    const __m256d va = _mm256_set1_pd(sa);
+    return simd_join(va, va);
+}
+
+/*!
+ *  Set vector given an array.
+ *  Only required for non-contiguous 32-bit elements due to in-between padding,
+ *  64-bit elements can use load instructions.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const int32_t * const sa, const size_t n)
+{
+    if (n == SIMD_STREAMS_64)
+        return simd_join(_mm256_cvtepi32_epi64(_mm_loadu_si128((__m128i *)sa)),
+                         _mm256_cvtepi32_epi64(_mm_loadu_si128((__m128i *)(sa + 4))));
+    else if (n == SIMD_STREAMS_32)
+        return simd_join(_mm256_loadu_si256((__m256i *)sa), _mm256_loadu_si256((__m256i *)(sa + 8)));
+    else
+        return simd_join(_mm256_setzero_si256(), _mm256_setzero_si256());
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const uint32_t * const sa, const size_t n)
+{
+    if (n == SIMD_STREAMS_64)
+        return simd_join(_mm256_cvtepu32_epi64(_mm_loadu_si128((__m128i *)sa)),
+                         _mm256_cvtepu32_epi64(_mm_loadu_si128((__m128i *)(sa + 4))));
+    else if (n == SIMD_STREAMS_32)
+        return simd_join(_mm256_loadu_si256((__m256i *)sa), _mm256_loadu_si256((__m256i *)(sa + 8)));
+    else
+        return simd_join(_mm256_setzero_si256(), _mm256_setzero_si256());
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const int64_t * const sa, const size_t n)
+{
+    if (n == SIMD_STREAMS_64)
+        return simd_join(_mm256_loadu_si256((__m256i *)sa), _mm256_loadu_si256((__m256i *)(sa + 4)));
+    else
+        return simd_join(_mm256_setzero_si256(), _mm256_setzero_si256());
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const uint64_t * const sa, const size_t n)
+{
+    if (n == SIMD_STREAMS_64)
+        return simd_join(_mm256_loadu_si256((__m256i *)sa), _mm256_loadu_si256((__m256i *)(sa + 4)));
+    else
+        return simd_join(_mm256_setzero_si256(), _mm256_setzero_si256());
+}
+
+
+/***********************
+ *  Load instructions  *
+ ***********************/
+/*!
+ *  Aligned loads/stores require 32-byte alignment (alignment of each half).
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const void * const sa)
+{ return simd_join(_mm256_load_si256((__m256i *)sa), _mm256_load_si256((__m256i *)sa + 1)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const void * const sa)
+{ return simd_join(_mm256_loadu_si256((__m256i *)sa), _mm256_loadu_si256((__m256i *)sa + 1)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const int8_t * const sa)
+{ return simd_load((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const int8_t * const sa)
+{ return simd_loadu((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const int16_t * const sa)
+{ return simd_load((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const int16_t * const sa)
+{ return simd_loadu((const void *)sa); }
+
+/*!
+ *  Load first n elements, remaining elements are set to zero.
+ *  Negative n loads into the upper |n| elements.
+ *  \note Partial loads use masked loads, masked lanes do not access memory.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const int32_t * const sa, const int32_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    if (n == SIMD_STREAMS_32 || n == -SIMD_STREAMS_32) {
+        if (strmHint)
+            return simd_join(_mm256_stream_load_si256((__m256i *)sa), _mm256_stream_load_si256((__m256i *)sa + 1));
+        return simd_load((const void *)sa);
+    }
+    else if (n > 0 && n < SIMD_STREAMS_32) {
+        const __m256i va_lo = _mm256_maskload_epi32((const int *)sa, simd_mask_32(n));
+        if (n <= SIMD_STREAMS_32 / 2)
+            return simd_join(va_lo, _mm256_setzero_si256());
+        return simd_join(va_lo, _mm256_maskload_epi32((const int *)(sa + 8), simd_mask_32(n - 8)));
+    }
+    else if (n < 0 && n > -SIMD_STREAMS_32) {
+        int32_t tmp[SIMD_STREAMS_32] SIMD_ALIGNED(SIMD_WIDTH_BYTES) = {0};
+        for (int32_t i = SIMD_STREAMS_32 + n, j = 0; i < SIMD_STREAMS_32; ++i, ++j)
+            tmp[i] = sa[j];
+        return simd_load((const void *)tmp);
+    }
+    return simd_join(_mm256_setzero_si256(), _mm256_setzero_si256());
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const int32_t * const sa, const size_t n = SIMD_STREAMS_32)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        return simd_loadu((const void *)sa);
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_32) {
+        const __m256i va_lo = _mm256_maskload_epi32((const int *)sa, simd_mask_32(n));
+        if (n <= (size_t)SIMD_STREAMS_32 / 2)
+            return simd_join(va_lo, _mm256_setzero_si256());
+        return simd_join(va_lo, _mm256_maskload_epi32((const int *)(sa + 8), simd_mask_32(n - 8)));
+    }
+    return simd_join(_mm256_setzero_si256(), _mm256_setzero_si256());
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const uint8_t * const sa)
+{ return simd_load((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const uint8_t * const sa)
+{ return simd_loadu((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const uint16_t * const sa)
+{ return simd_load((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const uint16_t * const sa)
+{ return simd_loadu((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const uint32_t * const sa)
+{ return simd_load((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const uint32_t * const sa)
+{ return simd_loadu((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const int64_t * const sa)
+{ return simd_load((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const int64_t * const sa)
+{ return simd_loadu((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const uint64_t * const sa)
+{ return simd_load((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const uint64_t * const sa)
+{ return simd_loadu((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_loadu(const float * const sa, const size_t n = SIMD_STREAMS_32)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        return simd_join(_mm256_loadu_ps(sa), _mm256_loadu_ps(sa + 8));
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_32) {
+        const __m256 va_lo = _mm256_maskload_ps(sa, simd_mask_32(n));
+        if (n <= (size_t)SIMD_STREAMS_32 / 2)
+            return simd_join(va_lo, _mm256_setzero_ps());
+        return simd_join(va_lo, _mm256_maskload_ps(sa + 8, simd_mask_32(n - 8)));
+    }
+    return simd_join(_mm256_setzero_ps(), _mm256_setzero_ps());
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_load(const float * const sa, const size_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    if (n == (size_t)SIMD_STREAMS_32) {
+        if (strmHint)
+            return simd_join(_mm256_castsi256_ps(_mm256_stream_load_si256((__m256i *)sa)),
+                             _mm256_castsi256_ps(_mm256_stream_load_si256((__m256i *)sa + 1)));
+        return simd_join(_mm256_load_ps(sa), _mm256_load_ps(sa + 8));
+    }
+    return simd_loadu(sa, n);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_loadu(const double * const sa, const size_t n = SIMD_STREAMS_64)
+{
+    if (n == (size_t)SIMD_STREAMS_64)
+        return simd_join(_mm256_loadu_pd(sa), _mm256_loadu_pd(sa + 4));
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_64) {
+        const __m256d va_lo = _mm256_maskload_pd(sa, simd_mask_64(n));
+        if (n <= (size_t)SIMD_STREAMS_64 / 2)
+            return simd_join(va_lo, _mm256_setzero_pd());
+        return simd_join(va_lo, _mm256_maskload_pd(sa + 4, simd_mask_64(n - 4)));
+    }
+    return simd_join(_mm256_setzero_pd(), _mm256_setzero_pd());
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_load(const double * const sa, const size_t n = SIMD_STREAMS_64, const bool strmHint = false)
+{
+    if (n == (size_t)SIMD_STREAMS_64) {
+        if (strmHint)
+            return simd_join(_mm256_castsi256_pd(_mm256_stream_load_si256((__m256i *)sa)),
+                             _mm256_castsi256_pd(_mm256_stream_load_si256((__m256i *)sa + 1)));
+        return simd_join(_mm256_load_pd(sa), _mm256_load_pd(sa + 4));
+    }
+    return simd_loadu(sa, n);
+}
+
+
+/************************
+ *  Store instructions  *
+ ************************/
+static SIMD_FUNC_INLINE
+void simd_store(void * const sa, const SIMD_INT va)
+{
+    _mm256_store_si256((__m256i *)sa, va.lo);
+    _mm256_store_si256((__m256i *)sa + 1, va.hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(void * const sa, const SIMD_INT va)
+{
+    _mm256_storeu_si256((__m256i *)sa, va.lo);
+    _mm256_storeu_si256((__m256i *)sa + 1, va.hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store(int8_t * const sa, const SIMD_INT va)
+{ simd_store((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(int8_t * const sa, const SIMD_INT va)
+{ simd_storeu((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(int16_t * const sa, const SIMD_INT va)
+{ simd_store((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(int16_t * const sa, const SIMD_INT va)
+{ simd_storeu((void *)sa, va); }
+
+/*!
+ *  Store first n elements.
+ *  Negative n stores the upper |n| elements.
+ *  \note Partial stores use masked stores, masked lanes do not access memory.
+ */
+static SIMD_FUNC_INLINE
+void simd_store(int32_t * const sa, const SIMD_INT va, const int32_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    if (n == SIMD_STREAMS_32 || n == -SIMD_STREAMS_32) {
+        if (strmHint) {
+            _mm256_stream_si256((__m256i *)sa, va.lo);
+            _mm256_stream_si256((__m256i *)sa + 1, va.hi);
+        }
+        else
+            simd_store((void *)sa, va);
+    }
+    else if (n > 0 && n < SIMD_STREAMS_32) {
+        _mm256_maskstore_epi32((int *)sa, simd_mask_32(n), va.lo);
+        if (n > SIMD_STREAMS_32 / 2)
+            _mm256_maskstore_epi32((int *)(sa + 8), simd_mask_32(n - 8), va.hi);
+    }
+    else if (n < 0 && n > -SIMD_STREAMS_32) {
+        int32_t tmp[SIMD_STREAMS_32] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+        simd_store((void *)tmp, va);
+        for (int32_t i = SIMD_STREAMS_32 + n, j = 0; i < SIMD_STREAMS_32; ++i, ++j)
+            sa[j] = tmp[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(int32_t * const sa, const SIMD_INT va, const size_t n = SIMD_STREAMS_32)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        simd_storeu((void *)sa, va);
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_32) {
+        _mm256_maskstore_epi32((int *)sa, simd_mask_32(n), va.lo);
+        if (n > (size_t)SIMD_STREAMS_32 / 2)
+            _mm256_maskstore_epi32((int *)(sa + 8), simd_mask_32(n - 8), va.hi);
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store(uint8_t * const sa, const SIMD_INT va)
+{ simd_store((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(uint8_t * const sa, const SIMD_INT va)
+{ simd_storeu((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(uint16_t * const sa, const SIMD_INT va)
+{ simd_store((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(uint16_t * const sa, const SIMD_INT va)
+{ simd_storeu((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(uint32_t * const sa, const SIMD_INT va)
+{ simd_store((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(uint32_t * const sa, const SIMD_INT va)
+{ simd_storeu((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(int64_t * const sa, const SIMD_INT va)
+{ simd_store((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(int64_t * const sa, const SIMD_INT va)
+{ simd_storeu((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(uint64_t * const sa, const SIMD_INT va)
+{ simd_store((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(uint64_t * const sa, const SIMD_INT va)
+{ simd_storeu((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(float * const sa, const SIMD_FLT va, const size_t n = SIMD_STREAMS_32)
+{
+    if (n == (size_t)SIMD_STREAMS_32) {
+        _mm256_storeu_ps(sa, va.lo);
+        _mm256_storeu_ps(sa + 8, va.hi);
+    }
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_32) {
+        _mm256_maskstore_ps(sa, simd_mask_32(n), va.lo);
+        if (n > (size_t)SIMD_STREAMS_32 / 2)
+            _mm256_maskstore_ps(sa + 8, simd_mask_32(n - 8), va.hi);
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store(float * const sa, const SIMD_FLT va, const size_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    if (n == (size_t)SIMD_STREAMS_32) {
+        if (strmHint) {
+            _mm256_stream_ps(sa, va.lo);
+            _mm256_stream_ps(sa + 8, va.hi);
+        }
+        else {
+            _mm256_store_ps(sa, va.lo);
+            _mm256_store_ps(sa + 8, va.hi);
+        }
+    }
+    else
+        simd_storeu(sa, va, n);
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(double * const sa, const SIMD_DBL va, const size_t n = SIMD_STREAMS_64)
+{
+    if (n == (size_t)SIMD_STREAMS_64) {
+        _mm256_storeu_pd(sa, va.lo);
+        _mm256_storeu_pd(sa + 4, va.hi);
+    }
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_64) {
+        _mm256_maskstore_pd(sa, simd_mask_64(n), va.lo);
+        if (n > (size_t)SIMD_STREAMS_64 / 2)
+            _mm256_maskstore_pd(sa + 4, simd_mask_64(n - 4), va.hi);
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store(double * const sa, const SIMD_DBL va, const size_t n = SIMD_STREAMS_64, const bool strmHint = false)
+{
+    if (n == (size_t)SIMD_STREAMS_64) {
+        if (strmHint) {
+            _mm256_stream_pd(sa, va.lo);
+            _mm256_stream_pd(sa + 4, va.hi);
+        }
+        else {
+            _mm256_store_pd(sa, va.lo);
+            _mm256_store_pd(sa + 4, va.hi);
+        }
+    }
+    else
+        simd_storeu(sa, va, n);
+}
+
+
+/*****************************
+ *  Interleave instructions  *
+ *****************************/
+/*!
+ *  Load records of 2/3/4 components (array of structures) and split them
+ *  into one vector per component (structure of arrays), e.g., xyz points
+ *  or RGB/RGBA pixels. simd_store_interleave* is the inverse.
+ *  Each call reads/writes 2/3/4 vectors of consecutive elements, pointers
+ *  need not be aligned.
+ *  The first half of the records goes to \c lo and the second half to
+ *  \c hi, each half uses the AVX2 kernels on 256-bit registers below.
+ */
+//! Lane I of va, lane J of vb, lane K of vc and lane L of vd, in each 128-bit lane
+template <int I, int J, int K, int L>
+static SIMD_FUNC_INLINE
+__m256 simd_gather_lanes(const __m256 va, const __m256 vb, const __m256 vc, const __m256 vd)
+{
+    return _mm256_shuffle_ps(_mm256_shuffle_ps(va, vb, _MM_SHUFFLE(J, J, I, I)),
+                             _mm256_shuffle_ps(vc, vd, _MM_SHUFFLE(L, L, K, K)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+//! 4x4 transpose in each 128-bit lane
+static SIMD_FUNC_INLINE
+void simd_transpose_lanes(__m256 * const va, __m256 * const vb, __m256 * const vc, __m256 * const vd)
+{
+    const __m256 t0 = _mm256_unpacklo_ps(*va, *vb);
+    const __m256 t1 = _mm256_unpacklo_ps(*vc, *vd);
+    const __m256 t2 = _mm256_unpackhi_ps(*va, *vb);
+    const __m256 t3 = _mm256_unpackhi_ps(*vc, *vd);
+    *va = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+    *vb = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+    *vc = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    *vd = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const float * const sa, __m256 * const va, __m256 * const vb)
+{
+    const __m256 v0 = _mm256_loadu_ps(sa);
+    const __m256 v1 = _mm256_loadu_ps(sa + 8);
+    const __m256 vlo = _mm256_permute2f128_ps(v0, v1, 0x20);
+    const __m256 vhi = _mm256_permute2f128_ps(v0, v1, 0x31);
+    *va = _mm256_shuffle_ps(vlo, vhi, _MM_SHUFFLE(2, 0, 2, 0));
+    *vb = _mm256_shuffle_ps(vlo, vhi, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const float * const sa, __m256 * const va, __m256 * const vb, __m256 * const vc)
+{
+    const __m256 v0 = _mm256_loadu_ps(sa);
+    const __m256 v1 = _mm256_loadu_ps(sa + 8);
+    const __m256 v2 = _mm256_loadu_ps(sa + 16);
+    const __m256 p0 = _mm256_permute2f128_ps(v0, v1, 0x30);
+    const __m256 p1 = _mm256_permute2f128_ps(v0, v2, 0x21);
+    const __m256 p2 = _mm256_permute2f128_ps(v1, v2, 0x30);
+    *va = simd_gather_lanes<0, 3, 2, 1>(p0, p0, p1, p2);
+    *vb = simd_gather_lanes<1, 0, 3, 2>(p0, p1, p1, p2);
+    *vc = simd_gather_lanes<2, 1, 0, 3>(p0, p1, p2, p2);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const float * const sa, __m256 * const va, __m256 * const vb, __m256 * const vc, __m256 * const vd)
+{
+    const __m256 v0 = _mm256_loadu_ps(sa);
+    const __m256 v1 = _mm256_loadu_ps(sa + 8);
+    const __m256 v2 = _mm256_loadu_ps(sa + 16);
+    const __m256 v3 = _mm256_loadu_ps(sa + 24);
+    *va = _mm256_permute2f128_ps(v0, v2, 0x20);
+    *vb = _mm256_permute2f128_ps(v0, v2, 0x31);
+    *vc = _mm256_permute2f128_ps(v1, v3, 0x20);
+    *vd = _mm256_permute2f128_ps(v1, v3, 0x31);
+    simd_transpose_lanes(va, vb, vc, vd);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(float * const sa, const __m256 va, const __m256 vb)
+{
+    const __m256 vlo = _mm256_unpacklo_ps(va, vb);
+    const __m256 vhi = _mm256_unpackhi_ps(va, vb);
+    _mm256_storeu_ps(sa, _mm256_permute2f128_ps(vlo, vhi, 0x20));
+    _mm256_storeu_ps(sa + 8, _mm256_permute2f128_ps(vlo, vhi, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(float * const sa, const __m256 va, const __m256 vb, const __m256 vc)
+{
+    const __m256 p0 = simd_gather_lanes<0, 0, 0, 1>(va, vb, vc, va);
+    const __m256 p1 = simd_gather_lanes<1, 1, 2, 2>(vb, vc, va, vb);
+    const __m256 p2 = simd_gather_lanes<2, 3, 3, 3>(vc, va, vb, vc);
+    _mm256_storeu_ps(sa, _mm256_permute2f128_ps(p0, p1, 0x20));
+    _mm256_storeu_ps(sa + 8, _mm256_permute2f128_ps(p2, p0, 0x30));
+    _mm256_storeu_ps(sa + 16, _mm256_permute2f128_ps(p1, p2, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(float * const sa, const __m256 va, const __m256 vb, const __m256 vc, const __m256 vd)
+{
+    __m256 v0 = va, v1 = vb, v2 = vc, v3 = vd;
+    simd_transpose_lanes(&v0, &v1, &v2, &v3);
+    _mm256_storeu_ps(sa, _mm256_permute2f128_ps(v0, v1, 0x20));
+    _mm256_storeu_ps(sa + 8, _mm256_permute2f128_ps(v2, v3, 0x20));
+    _mm256_storeu_ps(sa + 16, _mm256_permute2f128_ps(v0, v1, 0x31));
+    _mm256_storeu_ps(sa + 24, _mm256_permute2f128_ps(v2, v3, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const double * const sa, __m256d * const va, __m256d * const vb)
+{
+    const __m256d v0 = _mm256_loadu_pd(sa);
+    const __m256d v1 = _mm256_loadu_pd(sa + 4);
+    const __m256d vlo = _mm256_permute2f128_pd(v0, v1, 0x20);
+    const __m256d vhi = _mm256_permute2f128_pd(v0, v1, 0x31);
+    *va = _mm256_unpacklo_pd(vlo, vhi);
+    *vb = _mm256_unpackhi_pd(vlo, vhi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const double * const sa, __m256d * const va, __m256d * const vb, __m256d * const vc)
+{
+    const __m256d v0 = _mm256_loadu_pd(sa);
+    const __m256d v1 = _mm256_loadu_pd(sa + 4);
+    const __m256d v2 = _mm256_loadu_pd(sa + 8);
+    const __m256d p0 = _mm256_permute2f128_pd(v0, v1, 0x30);
+    const __m256d p1 = _mm256_permute2f128_pd(v0, v2, 0x21);
+    const __m256d p2 = _mm256_permute2f128_pd(v1, v2, 0x30);
+    *va = _mm256_shuffle_pd(p0, p1, 0xA);
+    *vb = _mm256_shuffle_pd(p0, p2, 0x5);
+    *vc = _mm256_shuffle_pd(p1, p2, 0xA);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const double * const sa, __m256d * const va, __m256d * const vb, __m256d * const vc, __m256d * const vd)
+{
+    const __m256d v0 = _mm256_loadu_pd(sa);
+    const __m256d v1 = _mm256_loadu_pd(sa + 4);
+    const __m256d v2 = _mm256_loadu_pd(sa + 8);
+    const __m256d v3 = _mm256_loadu_pd(sa + 12);
+    const __m256d p0 = _mm256_permute2f128_pd(v0, v2, 0x20);
+    const __m256d p1 = _mm256_permute2f128_pd(v0, v2, 0x31);
+    const __m256d p2 = _mm256_permute2f128_pd(v1, v3, 0x20);
+    const __m256d p3 = _mm256_permute2f128_pd(v1, v3, 0x31);
+    *va = _mm256_unpacklo_pd(p0, p2);
+    *vb = _mm256_unpackhi_pd(p0, p2);
+    *vc = _mm256_unpacklo_pd(p1, p3);
+    *vd = _mm256_unpackhi_pd(p1, p3);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(double * const sa, const __m256d va, const __m256d vb)
+{
+    const __m256d vlo = _mm256_unpacklo_pd(va, vb);
+    const __m256d vhi = _mm256_unpackhi_pd(va, vb);
+    _mm256_storeu_pd(sa, _mm256_permute2f128_pd(vlo, vhi, 0x20));
+    _mm256_storeu_pd(sa + 4, _mm256_permute2f128_pd(vlo, vhi, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(double * const sa, const __m256d va, const __m256d vb, const __m256d vc)
+{
+    const __m256d p0 = _mm256_shuffle_pd(va, vb, 0x0);
+    const __m256d p1 = _mm256_shuffle_pd(vc, va, 0xA);
+    const __m256d p2 = _mm256_shuffle_pd(vb, vc, 0xF);
+    _mm256_storeu_pd(sa, _mm256_permute2f128_pd(p0, p1, 0x20));
+    _mm256_storeu_pd(sa + 4, _mm256_permute2f128_pd(p2, p0, 0x30));
+    _mm256_storeu_pd(sa + 8, _mm256_permute2f128_pd(p1, p2, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(double * const sa, const __m256d va, const __m256d vb, const __m256d vc, const __m256d vd)
+{
+    const __m256d t0 = _mm256_unpacklo_pd(va, vb);
+    const __m256d t1 = _mm256_unpacklo_pd(vc, vd);
+    const __m256d t2 = _mm256_unpackhi_pd(va, vb);
+    const __m256d t3 = _mm256_unpackhi_pd(vc, vd);
+    _mm256_storeu_pd(sa, _mm256_permute2f128_pd(t0, t1, 0x20));
+    _mm256_storeu_pd(sa + 4, _mm256_permute2f128_pd(t2, t3, 0x20));
+    _mm256_storeu_pd(sa + 8, _mm256_permute2f128_pd(t0, t1, 0x31));
+    _mm256_storeu_pd(sa + 12, _mm256_permute2f128_pd(t2, t3, 0x31));
+}
+
+//! 32-bit integers use the single-precision shuffles
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const int32_t * const sa, __m256i * const va, __m256i * const vb)
+{
+    __m256 fa, fb;
+    simd_load_deinterleave2((const float *)sa, &fa, &fb);
+    *va = _mm256_castps_si256(fa);
+    *vb = _mm256_castps_si256(fb);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const int32_t * const sa, __m256i * const va, __m256i * const vb, __m256i * const vc)
+{
+    __m256 fa, fb, fc;
+    simd_load_deinterleave3((const float *)sa, &fa, &fb, &fc);
+    *va = _mm256_castps_si256(fa);
+    *vb = _mm256_castps_si256(fb);
+    *vc = _mm256_castps_si256(fc);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const int32_t * const sa, __m256i * const va, __m256i * const vb, __m256i * const vc, __m256i * const vd)
+{
+    __m256 fa, fb, fc, fd;
+    simd_load_deinterleave4((const float *)sa, &fa, &fb, &fc, &fd);
+    *va = _mm256_castps_si256(fa);
+    *vb = _mm256_castps_si256(fb);
+    *vc = _mm256_castps_si256(fc);
+    *vd = _mm256_castps_si256(fd);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(int32_t * const sa, const __m256i va, const __m256i vb)
+{ simd_store_interleave2((float *)sa, _mm256_castsi256_ps(va), _mm256_castsi256_ps(vb)); }
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(int32_t * const sa, const __m256i va, const __m256i vb, const __m256i vc)
+{ simd_store_interleave3((float *)sa, _mm256_castsi256_ps(va), _mm256_castsi256_ps(vb), _mm256_castsi256_ps(vc)); }
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(int32_t * const sa, const __m256i va, const __m256i vb, const __m256i vc, const __m256i vd)
+{ simd_store_interleave4((float *)sa, _mm256_castsi256_ps(va), _mm256_castsi256_ps(vb), _mm256_castsi256_ps(vc), _mm256_castsi256_ps(vd)); }
+
+//! Byte shuffle \c va in each 128-bit lane by the 16-byte mask \c vmsk
+static SIMD_FUNC_INLINE
+__m256i simd_shuffle_lanes_8(const __m256i va, const __m128i vmsk)
+{ return _mm256_shuffle_epi8(va, _mm256_broadcastsi128_si256(vmsk)); }
+
+//! 8-bit records (e.g., pixels) use byte shuffles
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const uint8_t * const sa, __m256i * const va, __m256i * const vb)
+{
+    // Components in 64-bit halves of each lane, then regroup halves
+    const __m128i vmsk = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    const __m256i v0 = _mm256_permute4x64_epi64(simd_shuffle_lanes_8(_mm256_loadu_si256((__m256i *)sa), vmsk), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m256i v1 = _mm256_permute4x64_epi64(simd_shuffle_lanes_8(_mm256_loadu_si256((__m256i *)(sa + 32)), vmsk), _MM_SHUFFLE(3, 1, 2, 0));
+    *va = _mm256_permute2x128_si256(v0, v1, 0x20);
+    *vb = _mm256_permute2x128_si256(v0, v1, 0x31);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const uint8_t * const sa, __m256i * const va, __m256i * const vb, __m256i * const vc)
+{
+    const __m256i v0 = _mm256_loadu_si256((__m256i *)sa);
+    const __m256i v1 = _mm256_loadu_si256((__m256i *)(sa + 32));
+    const __m256i v2 = _mm256_loadu_si256((__m256i *)(sa + 64));
+    const __m256i p0 = _mm256_permute2x128_si256(v0, v1, 0x30);
+    const __m256i p1 = _mm256_permute2x128_si256(v0, v2, 0x21);
+    const __m256i p2 = _mm256_permute2x128_si256(v1, v2, 0x30);
+    *va = _mm256_or_si256(_mm256_or_si256(
+              simd_shuffle_lanes_8(p0, _mm_setr_epi8(0, 3, 6, 9, 12, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+              simd_shuffle_lanes_8(p1, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, 2, 5, 8, 11, 14, -128, -128, -128, -128, -128))),
+              simd_shuffle_lanes_8(p2, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 1, 4, 7, 10, 13)));
+    *vb = _mm256_or_si256(_mm256_or_si256(
+              simd_shuffle_lanes_8(p0, _mm_setr_epi8(1, 4, 7, 10, 13, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+              simd_shuffle_lanes_8(p1, _mm_setr_epi8(-128, -128, -128, -128, -128, 0, 3, 6, 9, 12, 15, -128, -128, -128, -128, -128))),
+              simd_shuffle_lanes_8(p2, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 2, 5, 8, 11, 14)));
+    *vc = _mm256_or_si256(_mm256_or_si256(
+              simd_shuffle_lanes_8(p0, _mm_setr_epi8(2, 5, 8, 11, 14, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+              simd_shuffle_lanes_8(p1, _mm_setr_epi8(-128, -128, -128, -128, -128, 1, 4, 7, 10, 13, -128, -128, -128, -128, -128, -128))),
+              simd_shuffle_lanes_8(p2, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 0, 3, 6, 9, 12, 15)));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const uint8_t * const sa, __m256i * const va, __m256i * const vb, __m256i * const vc, __m256i * const vd)
+{
+    // Components in 32-bit groups, then regroup to 64-bit groups of 8 records
+    const __m128i vmsk = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const __m256i vidx = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    const __m256i v0 = _mm256_permutevar8x32_epi32(simd_shuffle_lanes_8(_mm256_loadu_si256((__m256i *)sa), vmsk), vidx);
+    const __m256i v1 = _mm256_permutevar8x32_epi32(simd_shuffle_lanes_8(_mm256_loadu_si256((__m256i *)(sa + 32)), vmsk), vidx);
+    const __m256i v2 = _mm256_permutevar8x32_epi32(simd_shuffle_lanes_8(_mm256_loadu_si256((__m256i *)(sa + 64)), vmsk), vidx);
+    const __m256i v3 = _mm256_permutevar8x32_epi32(simd_shuffle_lanes_8(_mm256_loadu_si256((__m256i *)(sa + 96)), vmsk), vidx);
+    const __m256i t0 = _mm256_unpacklo_epi64(v0, v1);
+    const __m256i t1 = _mm256_unpacklo_epi64(v2, v3);
+    const __m256i t2 = _mm256_unpackhi_epi64(v0, v1);
+    const __m256i t3 = _mm256_unpackhi_epi64(v2, v3);
+    *va = _mm256_permute2x128_si256(t0, t1, 0x20);
+    *vb = _mm256_permute2x128_si256(t2, t3, 0x20);
+    *vc = _mm256_permute2x128_si256(t0, t1, 0x31);
+    *vd = _mm256_permute2x128_si256(t2, t3, 0x31);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(uint8_t * const sa, const __m256i va, const __m256i vb)
+{
+    const __m256i vlo = _mm256_unpacklo_epi8(va, vb);
+    const __m256i vhi = _mm256_unpackhi_epi8(va, vb);
+    _mm256_storeu_si256((__m256i *)sa, _mm256_permute2x128_si256(vlo, vhi, 0x20));
+    _mm256_storeu_si256((__m256i *)(sa + 32), _mm256_permute2x128_si256(vlo, vhi, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(uint8_t * const sa, const __m256i va, const __m256i vb, const __m256i vc)
+{
+    const __m256i p0 = _mm256_or_si256(_mm256_or_si256(
+        simd_shuffle_lanes_8(va, _mm_setr_epi8(0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128, -128, 5)),
+        simd_shuffle_lanes_8(vb, _mm_setr_epi8(-128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128, -128))),
+        simd_shuffle_lanes_8(vc, _mm_setr_epi8(-128, -128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128)));
+    const __m256i p1 = _mm256_or_si256(_mm256_or_si256(
+        simd_shuffle_lanes_8(va, _mm_setr_epi8(-128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128, 10, -128)),
+        simd_shuffle_lanes_8(vb, _mm_setr_epi8(5, -128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128, 10))),
+        simd_shuffle_lanes_8(vc, _mm_setr_epi8(-128, 5, -128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128)));
+    const __m256i p2 = _mm256_or_si256(_mm256_or_si256(
+        simd_shuffle_lanes_8(va, _mm_setr_epi8(-128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15, -128, -128)),
+        simd_shuffle_lanes_8(vb, _mm_setr_epi8(-128, -128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15, -128))),
+        simd_shuffle_lanes_8(vc, _mm_setr_epi8(10, -128, -128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15)));
+    _mm256_storeu_si256((__m256i *)sa, _mm256_permute2x128_si256(p0, p1, 0x20));
+    _mm256_storeu_si256((__m256i *)(sa + 32), _mm256_permute2x128_si256(p2, p0, 0x30));
+    _mm256_storeu_si256((__m256i *)(sa + 64), _mm256_permute2x128_si256(p1, p2, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(uint8_t * const sa, const __m256i va, const __m256i vb, const __m256i vc, const __m256i vd)
+{
+    const __m256i vab_lo = _mm256_unpacklo_epi8(va, vb);
+    const __m256i vab_hi = _mm256_unpackhi_epi8(va, vb);
+    const __m256i vcd_lo = _mm256_unpacklo_epi8(vc, vd);
+    const __m256i vcd_hi = _mm256_unpackhi_epi8(vc, vd);
+    const __m256i t0 = _mm256_unpacklo_epi16(vab_lo, vcd_lo);
+    const __m256i t1 = _mm256_unpackhi_epi16(vab_lo, vcd_lo);
+    const __m256i t2 = _mm256_unpacklo_epi16(vab_hi, vcd_hi);
+    const __m256i t3 = _mm256_unpackhi_epi16(vab_hi, vcd_hi);
+    _mm256_storeu_si256((__m256i *)sa, _mm256_permute2x128_si256(t0, t1, 0x20));
+    _mm256_storeu_si256((__m256i *)(sa + 32), _mm256_permute2x128_si256(t2, t3, 0x20));
+    _mm256_storeu_si256((__m256i *)(sa + 64), _mm256_permute2x128_si256(t0, t1, 0x31));
+    _mm256_storeu_si256((__m256i *)(sa + 96), _mm256_permute2x128_si256(t2, t3, 0x31));
+}
+
+//! 512-bit vectors, half of the records in each 256-bit register
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb)
+{
+    simd_load_deinterleave2(sa, &va->lo, &vb->lo);
+    simd_load_deinterleave2(sa + 16, &va->hi, &vb->hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc)
+{
+    simd_load_deinterleave3(sa, &va->lo, &vb->lo, &vc->lo);
+    simd_load_deinterleave3(sa + 24, &va->hi, &vb->hi, &vc->hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc, SIMD_FLT * const vd)
+{
+    simd_load_deinterleave4(sa, &va->lo, &vb->lo, &vc->lo, &vd->lo);
+    simd_load_deinterleave4(sa + 32, &va->hi, &vb->hi, &vc->hi, &vd->hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(float * const sa, const SIMD_FLT va, const SIMD_FLT vb)
+{
+    simd_store_interleave2(sa, va.lo, vb.lo);
+    simd_store_interleave2(sa + 16, va.hi, vb.hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc)
+{
+    simd_store_interleave3(sa, va.lo, vb.lo, vc.lo);
+    simd_store_interleave3(sa + 24, va.hi, vb.hi, vc.hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc, const SIMD_FLT vd)
+{
+    simd_store_interleave4(sa, va.lo, vb.lo, vc.lo, vd.lo);
+    simd_store_interleave4(sa + 32, va.hi, vb.hi, vc.hi, vd.hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb)
+{
+    simd_load_deinterleave2(sa, &va->lo, &vb->lo);
+    simd_load_deinterleave2(sa + 8, &va->hi, &vb->hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc)
+{
+    simd_load_deinterleave3(sa, &va->lo, &vb->lo, &vc->lo);
+    simd_load_deinterleave3(sa + 12, &va->hi, &vb->hi, &vc->hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc, SIMD_DBL * const vd)
+{
+    simd_load_deinterleave4(sa, &va->lo, &vb->lo, &vc->lo, &vd->lo);
+    simd_load_deinterleave4(sa + 16, &va->hi, &vb->hi, &vc->hi, &vd->hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(double * const sa, const SIMD_DBL va, const SIMD_DBL vb)
+{
+    simd_store_interleave2(sa, va.lo, vb.lo);
+    simd_store_interleave2(sa + 8, va.hi, vb.hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc)
+{
+    simd_store_interleave3(sa, va.lo, vb.lo, vc.lo);
+    simd_store_interleave3(sa + 12, va.hi, vb.hi, vc.hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc, const SIMD_DBL vd)
+{
+    simd_store_interleave4(sa, va.lo, vb.lo, vc.lo, vd.lo);
+    simd_store_interleave4(sa + 16, va.hi, vb.hi, vc.hi, vd.hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    simd_load_deinterleave2(sa, &va->lo, &vb->lo);
+    simd_load_deinterleave2(sa + 16, &va->hi, &vb->hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    simd_load_deinterleave3(sa, &va->lo, &vb->lo, &vc->lo);
+    simd_load_deinterleave3(sa + 24, &va->hi, &vb->hi, &vc->hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    simd_load_deinterleave4(sa, &va->lo, &vb->lo, &vc->lo, &vd->lo);
+    simd_load_deinterleave4(sa + 32, &va->hi, &vb->hi, &vc->hi, &vd->hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{
+    simd_store_interleave2(sa, va.lo, vb.lo);
+    simd_store_interleave2(sa + 16, va.hi, vb.hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{
+    simd_store_interleave3(sa, va.lo, vb.lo, vc.lo);
+    simd_store_interleave3(sa + 24, va.hi, vb.hi, vc.hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{
+    simd_store_interleave4(sa, va.lo, vb.lo, vc.lo, vd.lo);
+    simd_store_interleave4(sa + 32, va.hi, vb.hi, vc.hi, vd.hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    simd_load_deinterleave2(sa, &va->lo, &vb->lo);
+    simd_load_deinterleave2(sa + 64, &va->hi, &vb->hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    simd_load_deinterleave3(sa, &va->lo, &vb->lo, &vc->lo);
+    simd_load_deinterleave3(sa + 96, &va->hi, &vb->hi, &vc->hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    simd_load_deinterleave4(sa, &va->lo, &vb->lo, &vc->lo, &vd->lo);
+    simd_load_deinterleave4(sa + 128, &va->hi, &vb->hi, &vc->hi, &vd->hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{
+    simd_store_interleave2(sa, va.lo, vb.lo);
+    simd_store_interleave2(sa + 64, va.hi, vb.hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{
+    simd_store_interleave3(sa, va.lo, vb.lo, vc.lo);
+    simd_store_interleave3(sa + 96, va.hi, vb.hi, vc.hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{
+    simd_store_interleave4(sa, va.lo, vb.lo, vc.lo, vd.lo);
+    simd_store_interleave4(sa + 128, va.hi, vb.hi, vc.hi, vd.hi);
+}
+
+
+/****************************
+ *  Transpose instructions  *
+ ****************************/
+/*!
+ *  Transpose a square tile, sb[j * ldb + i] = sa[i * lda + j].
+ *  Rows of \c sa are loaded into registers, transposed with shuffles and
+ *  stored as rows of \c sb. Leading dimensions are in elements, rows need
+ *  not be aligned and tiles must not overlap.
+ */
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    __m128 r0 = _mm_loadu_ps(sa);
+    __m128 r1 = _mm_loadu_ps(sa + lda);
+    __m128 r2 = _mm_loadu_ps(sa + 2 * lda);
+    __m128 r3 = _mm_loadu_ps(sa + 3 * lda);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(sb, r0);
+    _mm_storeu_ps(sb + ldb, r1);
+    _mm_storeu_ps(sb + 2 * ldb, r2);
+    _mm_storeu_ps(sb + 3 * ldb, r3);
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    const __m256 r0 = _mm256_loadu_ps(sa);
+    const __m256 r1 = _mm256_loadu_ps(sa + lda);
+    const __m256 r2 = _mm256_loadu_ps(sa + 2 * lda);
+    const __m256 r3 = _mm256_loadu_ps(sa + 3 * lda);
+    const __m256 r4 = _mm256_loadu_ps(sa + 4 * lda);
+    const __m256 r5 = _mm256_loadu_ps(sa + 5 * lda);
+    const __m256 r6 = _mm256_loadu_ps(sa + 6 * lda);
+    const __m256 r7 = _mm256_loadu_ps(sa + 7 * lda);
+
+    // Pairs of rows, then 4x4 blocks in each 128-bit lane
+    const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+    const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+    const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    const __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+    const __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+    const __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+    const __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+    const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+    // Swap 128-bit lanes between upper and lower rows
+    _mm256_storeu_ps(sb, _mm256_permute2f128_ps(s0, s4, 0x20));
+    _mm256_storeu_ps(sb + ldb, _mm256_permute2f128_ps(s1, s5, 0x20));
+    _mm256_storeu_ps(sb + 2 * ldb, _mm256_permute2f128_ps(s2, s6, 0x20));
+    _mm256_storeu_ps(sb + 3 * ldb, _mm256_permute2f128_ps(s3, s7, 0x20));
+    _mm256_storeu_ps(sb + 4 * ldb, _mm256_permute2f128_ps(s0, s4, 0x31));
+    _mm256_storeu_ps(sb + 5 * ldb, _mm256_permute2f128_ps(s1, s5, 0x31));
+    _mm256_storeu_ps(sb + 6 * ldb, _mm256_permute2f128_ps(s2, s6, 0x31));
+    _mm256_storeu_ps(sb + 7 * ldb, _mm256_permute2f128_ps(s3, s7, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    const __m256d r0 = _mm256_loadu_pd(sa);
+    const __m256d r1 = _mm256_loadu_pd(sa + lda);
+    const __m256d r2 = _mm256_loadu_pd(sa + 2 * lda);
+    const __m256d r3 = _mm256_loadu_pd(sa + 3 * lda);
+    const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+    _mm256_storeu_pd(sb, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(sb + ldb, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(sb + 2 * ldb, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(sb + 3 * ldb, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    simd_transpose4x4_f64(sb, ldb, sa, lda);
+    simd_transpose4x4_f64(sb + 4, ldb, sa + 4 * lda, lda);
+    simd_transpose4x4_f64(sb + 4 * ldb, ldb, sa + 4, lda);
+    simd_transpose4x4_f64(sb + 4 * ldb + 4, ldb, sa + 4 * lda + 4, lda);
+}
+
+
+/*************************
+ *  Gather instructions  *
+ *************************/
+/*!
+ *  Gather, lane i is loaded from sa[idx[i]], one 32-bit index per lane.
+ *  Indices need not be sorted or distinct and are not range-checked.
+ */
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_gather(const float * const sa, const int32_t * const idx)
+{
+    const __m256 vm = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    return simd_join(_mm256_mask_i32gather_ps(_mm256_setzero_ps(), sa, _mm256_loadu_si256((const __m256i *)idx), vm, 4),
+                     _mm256_mask_i32gather_ps(_mm256_setzero_ps(), sa, _mm256_loadu_si256((const __m256i *)(idx + 8)), vm, 4));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_gather(const double * const sa, const int32_t * const idx)
+{
+    const __m256d vm = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    return simd_join(_mm256_mask_i32gather_pd(_mm256_setzero_pd(), sa, _mm_loadu_si128((const __m128i *)idx), vm, 8),
+                     _mm256_mask_i32gather_pd(_mm256_setzero_pd(), sa, _mm_loadu_si128((const __m128i *)(idx + 4)), vm, 8));
+}
+
+
+/************************
+ *  Align instructions  *
+ ************************/
+/*!
+ *  Lanes N .. N + nlanes - 1 of the concatenation of vb (low lanes) and va
+ *  (high lanes), 0 <= N <= nlanes. Vectors at consecutive aligned addresses
+ *  give the vector at an unaligned offset of N elements.
+ */
+//! 256-bit halves, see the AVX2 interface
+template <int N>
+static SIMD_FUNC_INLINE
+__m256 simd_alignr_256(const __m256 va, const __m256 vb)
+{
+    if (N <= 0)
+        return vb;
+    if (N >= 8)
+        return va;
+    const __m256i vm = _mm256_permute2x128_si256(_mm256_castps_si256(vb), _mm256_castps_si256(va), 0x21);
+    if (N == 4)
+        return _mm256_castsi256_ps(vm);
+    return (N < 4) ? (_mm256_castsi256_ps(_mm256_alignr_epi8(vm, _mm256_castps_si256(vb), (4 * N) & 15)))
+                   : (_mm256_castsi256_ps(_mm256_alignr_epi8(_mm256_castps_si256(va), vm, (4 * N) & 15)));
+}
+
+template <int N>
+static SIMD_FUNC_INLINE
+__m256d simd_alignr_256(const __m256d va, const __m256d vb)
+{
+    if (N <= 0)
+        return vb;
+    if (N >= 4)
+        return va;
+    const __m256i vm = _mm256_permute2x128_si256(_mm256_castpd_si256(vb), _mm256_castpd_si256(va), 0x21);
+    if (N == 2)
+        return _mm256_castsi256_pd(vm);
+    return (N < 2) ? (_mm256_castsi256_pd(_mm256_alignr_epi8(vm, _mm256_castpd_si256(vb), 8)))
+                   : (_mm256_castsi256_pd(_mm256_alignr_epi8(_mm256_castpd_si256(va), vm, 8)));
+}
+
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_alignr(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    if (N <= 0)
+        return vb;
+    if (N >= 16)
+        return va;
+    if (N < 8)
+        return simd_join(simd_alignr_256<N & 7>(vb.hi, vb.lo), simd_alignr_256<N & 7>(va.lo, vb.hi));
+    return simd_join(simd_alignr_256<N & 7>(va.lo, vb.hi), simd_alignr_256<N & 7>(va.hi, va.lo));
+}
+
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_alignr(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    if (N <= 0)
+        return vb;
+    if (N >= 8)
+        return va;
+    if (N < 4)
+        return simd_join(simd_alignr_256<N & 3>(vb.hi, vb.lo), simd_alignr_256<N & 3>(va.lo, vb.hi));
+    return simd_join(simd_alignr_256<N & 3>(va.lo, vb.hi), simd_alignr_256<N & 3>(va.hi, va.lo));
+}
+
+
+/***********************
+ *  Scan instructions  *
+ ***********************/
+/*!
+ *  Inclusive prefix sums of the lanes of va plus the carry *vc (all lanes
+ *  equal), by log2(nlanes) steps of lane shifts and adds. The sum of va is
+ *  broadcast and added to *vc, the carry of the next vector, so that one
+ *  add per vector is on the loop-carried path.
+ */
+//! 256-bit halves without carry, see the AVX2 interface
+static SIMD_FUNC_INLINE
+__m256i simd_scan_256_32(const __m256i va)
+{
+    __m256i vs = _mm256_add_epi32(va, _mm256_slli_si256(va, 4));
+    vs = _mm256_add_epi32(vs, _mm256_slli_si256(vs, 8));
+    return _mm256_add_epi32(vs, _mm256_blend_epi32(_mm256_permutevar8x32_epi32(vs, _mm256_set1_epi32(3)), _mm256_setzero_si256(), 0x0F));
+}
+
+static SIMD_FUNC_INLINE
+__m256i simd_scan_256_64(const __m256i va)
+{
+    const __m256i vs = _mm256_add_epi64(va, _mm256_slli_si256(va, 8));
+    return _mm256_add_epi64(vs, _mm256_blend_epi32(_mm256_permute4x64_epi64(vs, 0x55), _mm256_setzero_si256(), 0x0F));
+}
+
+static SIMD_FUNC_INLINE
+__m256 simd_scan_256(const __m256 va)
+{
+    __m256 vs = _mm256_add_ps(va, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(va), 4)));
+    vs = _mm256_add_ps(vs, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(vs), 8)));
+    return _mm256_add_ps(vs, _mm256_blend_ps(_mm256_permutevar8x32_ps(vs, _mm256_set1_epi32(3)), _mm256_setzero_ps(), 0x0F));
+}
+
+static SIMD_FUNC_INLINE
+__m256d simd_scan_256(const __m256d va)
+{
+    const __m256d vs = _mm256_add_pd(va, _mm256_castsi256_pd(_mm256_slli_si256(_mm256_castpd_si256(va), 8)));
+    return _mm256_add_pd(vs, _mm256_blend_pd(_mm256_permute4x64_pd(vs, 0x55), _mm256_setzero_pd(), 0x3));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_32(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const __m256i vp = vc->lo;
+    const __m256i vl = simd_scan_256_32(va.lo);
+    const __m256i vh = _mm256_add_epi32(simd_scan_256_32(va.hi), _mm256_permutevar8x32_epi32(vl, _mm256_set1_epi32(7)));
+    const __m256i vt = _mm256_add_epi32(vp, _mm256_permutevar8x32_epi32(vh, _mm256_set1_epi32(7)));
+    *vc = simd_join(vt, vt);
+    return simd_join(_mm256_add_epi32(vl, vp), _mm256_add_epi32(vh, vp));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_64(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const __m256i vp = vc->lo;
+    const __m256i vl = simd_scan_256_64(va.lo);
+    const __m256i vh = _mm256_add_epi64(simd_scan_256_64(va.hi), _mm256_permute4x64_epi64(vl, 0xFF));
+    const __m256i vt = _mm256_add_epi64(vp, _mm256_permute4x64_epi64(vh, 0xFF));
+    *vc = simd_join(vt, vt);
+    return simd_join(_mm256_add_epi64(vl, vp), _mm256_add_epi64(vh, vp));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    const __m256 vp = vc->lo;
+    const __m256 vl = simd_scan_256(va.lo);
+    const __m256 vh = _mm256_add_ps(simd_scan_256(va.hi), _mm256_permutevar8x32_ps(vl, _mm256_set1_epi32(7)));
+    const __m256 vt = _mm256_add_ps(vp, _mm256_permutevar8x32_ps(vh, _mm256_set1_epi32(7)));
+    *vc = simd_join(vt, vt);
+    return simd_join(_mm256_add_ps(vl, vp), _mm256_add_ps(vh, vp));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    const __m256d vp = vc->lo;
+    const __m256d vl = simd_scan_256(va.lo);
+    const __m256d vh = _mm256_add_pd(simd_scan_256(va.hi), _mm256_permute4x64_pd(vl, 0xFF));
+    const __m256d vt = _mm256_add_pd(vp, _mm256_permute4x64_pd(vh, 0xFF));
+    *vc = simd_join(vt, vt);
+    return simd_join(_mm256_add_pd(vl, vp), _mm256_add_pd(vh, vp));
+}
+
+/*!
+ *  Exclusive prefix sums, lane i is the carry plus lanes 0 .. i-1 of va,
+ *  *vc is updated as by the inclusive sums
+ */
+//! Integer sums are exact, the exclusive sums are the inclusive sums less va
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_32(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const SIMD_INT vs = simd_scan_32(va, vc);
+    return simd_join(_mm256_sub_epi32(vs.lo, va.lo), _mm256_sub_epi32(vs.hi, va.hi));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_64(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const SIMD_INT vs = simd_scan_64(va, vc);
+    return simd_join(_mm256_sub_epi64(vs.lo, va.lo), _mm256_sub_epi64(vs.hi, va.hi));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan_excl(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    const SIMD_FLT vp = *vc;
+    return simd_alignr<15>(simd_scan(va, vc), vp);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan_excl(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    const SIMD_DBL vp = *vc;
+    return simd_alignr<7>(simd_scan(va, vc), vp);
+}
+
+
+}  // namespace avx2x2
+}  // namespace gvl
+
+
+#endif  // _AVX2X2_H
+
@@ -6,6 +6,7 @@
  *  Support '_t' C datatypes
  */
 #include <stdint.h>
+#include <stddef.h>   // size_t
 
 
 /*
@@ -32,6 +33,10 @@
 #endif
 
 
+namespace gvl {
+namespace avx512 {
+
+
 /*
  *  AVX512 512-bit wide vector units
  *  Define constants required for SIMD module to function properly.
@@ -77,6 +82,10 @@ static SIMD_FUNC_INLINE
 SIMD_INT simd_add_i64(const SIMD_INT va, const SIMD_INT vb)
 { return _mm512_add_epi64(va, vb); }
 
+static SIMD_FUNC_INLINE
+SIMD_INT simd_add_32(const SIMD_INT va, const SIMD_INT vb)
+{ return _mm512_add_epi32(va, vb); }
+
 /*!
  *  Add for unsigned 16-bit integers
  *  Uses saturation arithmetic (no wrap around)
@@ -135,6 +144,10 @@ static SIMD_FUNC_INLINE
 SIMD_INT simd_sub_i64(const SIMD_INT va, const SIMD_INT vb)
 { return _mm512_sub_epi64(va, vb); }
 
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sub_32(const SIMD_INT va, const SIMD_INT vb)
+{ return _mm512_sub_epi32(va, vb); }
+
 /*!
  *  Sub for unsigned 16-bit integers
  *  Uses saturation arithmetic (no wrap around)
@@ -247,6 +260,10 @@ static SIMD_FUNC_INLINE
 SIMD_INT simd_mullo_i32(const SIMD_INT va, const SIMD_INT vb)
 { return _mm512_mullo_epi32(va, vb); }
 
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_32(const SIMD_INT va, const SIMD_INT vb)
+{ return _mm512_mullo_epi32(va, vb); }
+
 /*!
  *  Multiply packed 64-bit integers, produce intermediate 128-bit integers,
  *  and store the low 64-bit results
@@ -282,6 +299,14 @@ static SIMD_FUNC_INLINE
 SIMD_DBL simd_mul(const SIMD_DBL va, const SIMD_DBL vb)
 { return _mm512_mul_pd(va, vb); }
 
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_div(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm512_div_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_div(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm512_div_pd(va, vb); }
+
 
 /********************************
  *  Integral logical intrinsics
@@ -306,6 +331,115 @@ static SIMD_FUNC_INLINE
 SIMD_DBL simd_and(const SIMD_DBL va, const SIMD_DBL vb)
 { return _mm512_and_pd(va, vb); }
 
+/*!
+ *  NOTE: requires at least AVX512DQ for floating-point or/xor
+ */
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_or(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm512_or_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_or(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm512_or_pd(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_xor(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm512_xor_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_xor(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm512_xor_pd(va, vb); }
+
+
+/***********************
+ *  Compare intrinsics
+ ***********************/
+/*!
+ *  Comparisons set all bits of elements where the condition holds
+ *  and clear them otherwise, results are used as masks.
+ *  AVX-512 compares write mask registers, these are expanded to vectors
+ *  so masks can be combined with the logical intrinsics.
+ *  NOTE: requires at least AVX512DQ for _mm512_movm_epi32/64()
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmpeq_32(const SIMD_INT va, const SIMD_INT vb)
+{ return _mm512_movm_epi32(_mm512_cmpeq_epi32_mask(va, vb)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmpgt_i32(const SIMD_INT va, const SIMD_INT vb)
+{ return _mm512_movm_epi32(_mm512_cmpgt_epi32_mask(va, vb)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmplt_i32(const SIMD_INT va, const SIMD_INT vb)
+{ return _mm512_movm_epi32(_mm512_cmplt_epi32_mask(va, vb)); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpeq(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm512_castsi512_ps(_mm512_movm_epi32(_mm512_cmp_ps_mask(va, vb, _CMP_EQ_OQ))); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpeq(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm512_castsi512_pd(_mm512_movm_epi64(_mm512_cmp_pd_mask(va, vb, _CMP_EQ_OQ))); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpneq(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm512_castsi512_ps(_mm512_movm_epi32(_mm512_cmp_ps_mask(va, vb, _CMP_NEQ_UQ))); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpneq(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm512_castsi512_pd(_mm512_movm_epi64(_mm512_cmp_pd_mask(va, vb, _CMP_NEQ_UQ))); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmplt(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm512_castsi512_ps(_mm512_movm_epi32(_mm512_cmp_ps_mask(va, vb, _CMP_LT_OQ))); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmplt(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm512_castsi512_pd(_mm512_movm_epi64(_mm512_cmp_pd_mask(va, vb, _CMP_LT_OQ))); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmple(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm512_castsi512_ps(_mm512_movm_epi32(_mm512_cmp_ps_mask(va, vb, _CMP_LE_OQ))); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmple(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm512_castsi512_pd(_mm512_movm_epi64(_mm512_cmp_pd_mask(va, vb, _CMP_LE_OQ))); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpgt(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm512_castsi512_ps(_mm512_movm_epi32(_mm512_cmp_ps_mask(va, vb, _CMP_GT_OQ))); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpgt(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm512_castsi512_pd(_mm512_movm_epi64(_mm512_cmp_pd_mask(va, vb, _CMP_GT_OQ))); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpge(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm512_castsi512_ps(_mm512_movm_epi32(_mm512_cmp_ps_mask(va, vb, _CMP_GE_OQ))); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpge(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm512_castsi512_pd(_mm512_movm_epi64(_mm512_cmp_pd_mask(va, vb, _CMP_GE_OQ))); }
+
+/*!
+ *  Select elements from second operand where mask is set,
+ *  otherwise select elements from first operand.
+ *  Integer masks are taken per byte (most significant bits) as in the
+ *  128/256-bit interfaces.
+ *  NOTE: requires at least AVX512BW for _mm512_movepi8_mask()
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_blend(const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vmsk)
+{ return _mm512_mask_blend_epi8(_mm512_movepi8_mask(vmsk), va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_blend(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vmsk)
+{ return _mm512_mask_blend_ps(_mm512_movepi32_mask(_mm512_castps_si512(vmsk)), va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_blend(const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vmsk)
+{ return _mm512_mask_blend_pd(_mm512_movepi64_mask(_mm512_castpd_si512(vmsk)), va, vb); }
+
 
 /*****************************
  *  Shift/Shuffle intrinsics
@@ -568,13 +702,43 @@ SIMD_DBL simd_cvt_u64_f64(const SIMD_INT va)
 /********************
  *  Load intrinsics
  ********************/
+/*
+ *  Masks of the first n 32/64-bit elements, used with masked loads/stores
+ */
 static SIMD_FUNC_INLINE
-SIMD_INT simd_load(const int * const sa)
-{ return _mm512_load_si512((SIMD_INT *)sa); }
+__mmask16 simd_mask_32(const int32_t n)
+{ return (__mmask16)((1U << n) - 1U); }
 
 static SIMD_FUNC_INLINE
-SIMD_INT simd_loadu(const int * const sa)
-{ return _mm512_loadu_si512((SIMD_INT *)sa); }
+__mmask8 simd_mask_64(const int32_t n)
+{ return (__mmask8)((1U << n) - 1U); }
+
+/*!
+ *  Load first n elements, remaining elements are set to zero.
+ *  Negative n loads into the upper |n| elements (expand load).
+ *  Masked lanes do not access memory.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const int32_t * const sa, const int32_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    if (n == SIMD_STREAMS_32 || n == -SIMD_STREAMS_32)
+        return (strmHint) ? (_mm512_stream_load_si512((void *)sa)) : (_mm512_load_si512((SIMD_INT *)sa));
+    else if (n > 0 && n < SIMD_STREAMS_32)
+        return _mm512_maskz_loadu_epi32(simd_mask_32(n), sa);
+    else if (n < 0 && n > -SIMD_STREAMS_32)
+        return _mm512_maskz_expandloadu_epi32((__mmask16)~simd_mask_32(SIMD_STREAMS_32 + n), sa);
+    return _mm512_setzero_si512();
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const int32_t * const sa, const size_t n = SIMD_STREAMS_32)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        return _mm512_loadu_si512((SIMD_INT *)sa);
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_32)
+        return _mm512_maskz_loadu_epi32(simd_mask_32(n), sa);
+    return _mm512_setzero_si512();
+}
 
 static SIMD_FUNC_INLINE
 SIMD_INT simd_load(const unsigned int * const sa)
@@ -601,32 +765,69 @@ SIMD_INT simd_loadu(const unsigned long int * const sa)
 { return _mm512_loadu_si512((SIMD_INT *)sa); }
 
 static SIMD_FUNC_INLINE
-SIMD_FLT simd_load(const float * const sa)
-{ return _mm512_load_ps(sa); }
+SIMD_FLT simd_loadu(const float * const sa, const size_t n = SIMD_STREAMS_32)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        return _mm512_loadu_ps(sa);
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_32)
+        return _mm512_maskz_loadu_ps(simd_mask_32(n), sa);
+    return _mm512_setzero_ps();
+}
 
 static SIMD_FUNC_INLINE
-SIMD_FLT simd_loadu(const float * const sa)
-{ return _mm512_loadu_ps(sa); }
+SIMD_FLT simd_load(const float * const sa, const size_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        return (strmHint) ? (_mm512_castsi512_ps(_mm512_stream_load_si512((void *)sa))) : (_mm512_load_ps(sa));
+    return simd_loadu(sa, n);
+}
 
 static SIMD_FUNC_INLINE
-SIMD_DBL simd_load(const double * const sa)
-{ return _mm512_load_pd(sa); }
+SIMD_DBL simd_loadu(const double * const sa, const size_t n = SIMD_STREAMS_64)
+{
+    if (n == (size_t)SIMD_STREAMS_64)
+        return _mm512_loadu_pd(sa);
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_64)
+        return _mm512_maskz_loadu_pd(simd_mask_64(n), sa);
+    return _mm512_setzero_pd();
+}
 
 static SIMD_FUNC_INLINE
-SIMD_DBL simd_loadu(const double * const sa)
-{ return _mm512_loadu_pd(sa); }
+SIMD_DBL simd_load(const double * const sa, const size_t n = SIMD_STREAMS_64, const bool strmHint = false)
+{
+    if (n == (size_t)SIMD_STREAMS_64)
+        return (strmHint) ? (_mm512_castsi512_pd(_mm512_stream_load_si512((void *)sa))) : (_mm512_load_pd(sa));
+    return simd_loadu(sa, n);
+}
 
 
 /*******************************
  *  Store intrinsics
  *******************************/
+/*!
+ *  Store first n elements.
+ *  Negative n stores the upper |n| elements (compress store).
+ *  Masked lanes do not access memory.
+ */
 static SIMD_FUNC_INLINE
-void simd_store(int * const sa, const SIMD_INT va)
-{ _mm512_store_si512((SIMD_INT *)sa, va); }
+void simd_store(int32_t * const sa, const SIMD_INT va, const int32_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    if (n == SIMD_STREAMS_32 || n == -SIMD_STREAMS_32)
+        (strmHint) ? (_mm512_stream_si512((SIMD_INT *)sa, va)) : (_mm512_store_si512((SIMD_INT *)sa, va));
+    else if (n > 0 && n < SIMD_STREAMS_32)
+        _mm512_mask_storeu_epi32(sa, simd_mask_32(n), va);
+    else if (n < 0 && n > -SIMD_STREAMS_32)
+        _mm512_mask_compressstoreu_epi32(sa, (__mmask16)~simd_mask_32(SIMD_STREAMS_32 + n), va);
+}
 
 static SIMD_FUNC_INLINE
-void simd_storeu(int * const sa, const SIMD_INT va)
-{ _mm512_storeu_si512((SIMD_INT *)sa, va); }
+void simd_storeu(int32_t * const sa, const SIMD_INT va, const size_t n = SIMD_STREAMS_32)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        _mm512_storeu_si512((SIMD_INT *)sa, va);
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_32)
+        _mm512_mask_storeu_epi32(sa, simd_mask_32(n), va);
+}
 
 static SIMD_FUNC_INLINE
 void simd_store(unsigned int * const sa, const SIMD_INT va)
@@ -653,20 +854,686 @@ void simd_storeu(unsigned long int * const sa, const SIMD_INT va)
 { _mm512_storeu_si512((SIMD_INT *)sa, va); }
 
 static SIMD_FUNC_INLINE
-void simd_store(float * const sa, const SIMD_FLT va)
-{ _mm512_store_ps(sa, va); }
+void simd_storeu(float * const sa, const SIMD_FLT va, const size_t n = SIMD_STREAMS_32)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        _mm512_storeu_ps(sa, va);
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_32)
+        _mm512_mask_storeu_ps(sa, simd_mask_32(n), va);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store(float * const sa, const SIMD_FLT va, const size_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        (strmHint) ? (_mm512_stream_ps(sa, va)) : (_mm512_store_ps(sa, va));
+    else
+        simd_storeu(sa, va, n);
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(double * const sa, const SIMD_DBL va, const size_t n = SIMD_STREAMS_64)
+{
+    if (n == (size_t)SIMD_STREAMS_64)
+        _mm512_storeu_pd(sa, va);
+    else if (n > 0 && n < (size_t)SIMD_STREAMS_64)
+        _mm512_mask_storeu_pd(sa, simd_mask_64(n), va);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store(double * const sa, const SIMD_DBL va, const size_t n = SIMD_STREAMS_64, const bool strmHint = false)
+{
+    if (n == (size_t)SIMD_STREAMS_64)
+        (strmHint) ? (_mm512_stream_pd(sa, va)) : (_mm512_store_pd(sa, va));
+    else
+        simd_storeu(sa, va, n);
+}
+
+
+/***************************
+ *  Interleave intrinsics
+ ***************************/
+/*!
+ *  Load records of 2/3/4 components (array of structures) and split them
+ *  into one vector per component (structure of arrays), e.g., xyz points
+ *  or RGB/RGBA pixels. simd_store_interleave* is the inverse.
+ *  Each call reads/writes 2/3/4 vectors of consecutive elements, pointers
+ *  need not be aligned.
+ *  Elements move with two-source permutes (permutex2var), 3 sources take
+ *  two permutes.
+ */
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb)
+{
+    const SIMD_FLT v0 = _mm512_loadu_ps(sa);
+    const SIMD_FLT v1 = _mm512_loadu_ps(sa + 16);
+    *va = _mm512_permutex2var_ps(v0, _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30), v1);
+    *vb = _mm512_permutex2var_ps(v0, _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31), v1);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc)
+{
+    const SIMD_FLT v0 = _mm512_loadu_ps(sa);
+    const SIMD_FLT v1 = _mm512_loadu_ps(sa + 16);
+    const SIMD_FLT v2 = _mm512_loadu_ps(sa + 32);
+    *va = _mm512_permutex2var_ps(_mm512_permutex2var_ps(v0, _mm512_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 0, 0, 0, 0, 0), v1),
+                                 _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 17, 20, 23, 26, 29), v2);
+    *vb = _mm512_permutex2var_ps(_mm512_permutex2var_ps(v0, _mm512_setr_epi32(1, 4, 7, 10, 13, 16, 19, 22, 25, 28, 31, 0, 0, 0, 0, 0), v1),
+                                 _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 18, 21, 24, 27, 30), v2);
+    *vc = _mm512_permutex2var_ps(_mm512_permutex2var_ps(v0, _mm512_setr_epi32(2, 5, 8, 11, 14, 17, 20, 23, 26, 29, 0, 0, 0, 0, 0, 0), v1),
+                                 _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 19, 22, 25, 28, 31), v2);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc, SIMD_FLT * const vd)
+{
+    // Components (0, 1) and (2, 3) of each half of the records, then join halves
+    const SIMD_FLT v0 = _mm512_loadu_ps(sa);
+    const SIMD_FLT v1 = _mm512_loadu_ps(sa + 16);
+    const SIMD_FLT v2 = _mm512_loadu_ps(sa + 32);
+    const SIMD_FLT v3 = _mm512_loadu_ps(sa + 48);
+    const SIMD_FLT vab_lo = _mm512_permutex2var_ps(v0, _mm512_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28, 1, 5, 9, 13, 17, 21, 25, 29), v1);
+    const SIMD_FLT vab_hi = _mm512_permutex2var_ps(v2, _mm512_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28, 1, 5, 9, 13, 17, 21, 25, 29), v3);
+    const SIMD_FLT vcd_lo = _mm512_permutex2var_ps(v0, _mm512_setr_epi32(2, 6, 10, 14, 18, 22, 26, 30, 3, 7, 11, 15, 19, 23, 27, 31), v1);
+    const SIMD_FLT vcd_hi = _mm512_permutex2var_ps(v2, _mm512_setr_epi32(2, 6, 10, 14, 18, 22, 26, 30, 3, 7, 11, 15, 19, 23, 27, 31), v3);
+    *va = _mm512_permutex2var_ps(vab_lo, _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 16, 17, 18, 19, 20, 21, 22, 23), vab_hi);
+    *vb = _mm512_permutex2var_ps(vab_lo, _mm512_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15, 24, 25, 26, 27, 28, 29, 30, 31), vab_hi);
+    *vc = _mm512_permutex2var_ps(vcd_lo, _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 16, 17, 18, 19, 20, 21, 22, 23), vcd_hi);
+    *vd = _mm512_permutex2var_ps(vcd_lo, _mm512_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15, 24, 25, 26, 27, 28, 29, 30, 31), vcd_hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(float * const sa, const SIMD_FLT va, const SIMD_FLT vb)
+{
+    _mm512_storeu_ps(sa, _mm512_permutex2var_ps(va, _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23), vb));
+    _mm512_storeu_ps(sa + 16, _mm512_permutex2var_ps(va, _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31), vb));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc)
+{
+    _mm512_storeu_ps(sa, _mm512_permutex2var_ps(_mm512_permutex2var_ps(va, _mm512_setr_epi32(0, 16, 0, 1, 17, 0, 2, 18, 0, 3, 19, 0, 4, 20, 0, 5), vb),
+                                                _mm512_setr_epi32(0, 1, 16, 3, 4, 17, 6, 7, 18, 9, 10, 19, 12, 13, 20, 15), vc));
+    _mm512_storeu_ps(sa + 16, _mm512_permutex2var_ps(_mm512_permutex2var_ps(va, _mm512_setr_epi32(21, 0, 6, 22, 0, 7, 23, 0, 8, 24, 0, 9, 25, 0, 10, 26), vb),
+                                                     _mm512_setr_epi32(0, 21, 2, 3, 22, 5, 6, 23, 8, 9, 24, 11, 12, 25, 14, 15), vc));
+    _mm512_storeu_ps(sa + 32, _mm512_permutex2var_ps(_mm512_permutex2var_ps(va, _mm512_setr_epi32(0, 11, 27, 0, 12, 28, 0, 13, 29, 0, 14, 30, 0, 15, 31, 0), vb),
+                                                     _mm512_setr_epi32(26, 1, 2, 27, 4, 5, 28, 7, 8, 29, 10, 11, 30, 13, 14, 31), vc));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc, const SIMD_FLT vd)
+{
+    const SIMD_FLT vab_lo = _mm512_permutex2var_ps(va, _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 16, 17, 18, 19, 20, 21, 22, 23), vb);
+    const SIMD_FLT vab_hi = _mm512_permutex2var_ps(va, _mm512_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15, 24, 25, 26, 27, 28, 29, 30, 31), vb);
+    const SIMD_FLT vcd_lo = _mm512_permutex2var_ps(vc, _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 16, 17, 18, 19, 20, 21, 22, 23), vd);
+    const SIMD_FLT vcd_hi = _mm512_permutex2var_ps(vc, _mm512_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15, 24, 25, 26, 27, 28, 29, 30, 31), vd);
+    _mm512_storeu_ps(sa, _mm512_permutex2var_ps(vab_lo, _mm512_setr_epi32(0, 8, 16, 24, 1, 9, 17, 25, 2, 10, 18, 26, 3, 11, 19, 27), vcd_lo));
+    _mm512_storeu_ps(sa + 16, _mm512_permutex2var_ps(vab_lo, _mm512_setr_epi32(4, 12, 20, 28, 5, 13, 21, 29, 6, 14, 22, 30, 7, 15, 23, 31), vcd_lo));
+    _mm512_storeu_ps(sa + 32, _mm512_permutex2var_ps(vab_hi, _mm512_setr_epi32(0, 8, 16, 24, 1, 9, 17, 25, 2, 10, 18, 26, 3, 11, 19, 27), vcd_hi));
+    _mm512_storeu_ps(sa + 48, _mm512_permutex2var_ps(vab_hi, _mm512_setr_epi32(4, 12, 20, 28, 5, 13, 21, 29, 6, 14, 22, 30, 7, 15, 23, 31), vcd_hi));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb)
+{
+    const SIMD_DBL v0 = _mm512_loadu_pd(sa);
+    const SIMD_DBL v1 = _mm512_loadu_pd(sa + 8);
+    *va = _mm512_permutex2var_pd(v0, _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14), v1);
+    *vb = _mm512_permutex2var_pd(v0, _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15), v1);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc)
+{
+    const SIMD_DBL v0 = _mm512_loadu_pd(sa);
+    const SIMD_DBL v1 = _mm512_loadu_pd(sa + 8);
+    const SIMD_DBL v2 = _mm512_loadu_pd(sa + 16);
+    *va = _mm512_permutex2var_pd(_mm512_permutex2var_pd(v0, _mm512_setr_epi64(0, 3, 6, 9, 12, 15, 0, 0), v1),
+                                 _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 10, 13), v2);
+    *vb = _mm512_permutex2var_pd(_mm512_permutex2var_pd(v0, _mm512_setr_epi64(1, 4, 7, 10, 13, 0, 0, 0), v1),
+                                 _mm512_setr_epi64(0, 1, 2, 3, 4, 8, 11, 14), v2);
+    *vc = _mm512_permutex2var_pd(_mm512_permutex2var_pd(v0, _mm512_setr_epi64(2, 5, 8, 11, 14, 0, 0, 0), v1),
+                                 _mm512_setr_epi64(0, 1, 2, 3, 4, 9, 12, 15), v2);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc, SIMD_DBL * const vd)
+{
+    // Components (0, 1) and (2, 3) of each half of the records, then join halves
+    const SIMD_DBL v0 = _mm512_loadu_pd(sa);
+    const SIMD_DBL v1 = _mm512_loadu_pd(sa + 8);
+    const SIMD_DBL v2 = _mm512_loadu_pd(sa + 16);
+    const SIMD_DBL v3 = _mm512_loadu_pd(sa + 24);
+    const SIMD_DBL vab_lo = _mm512_permutex2var_pd(v0, _mm512_setr_epi64(0, 4, 8, 12, 1, 5, 9, 13), v1);
+    const SIMD_DBL vab_hi = _mm512_permutex2var_pd(v2, _mm512_setr_epi64(0, 4, 8, 12, 1, 5, 9, 13), v3);
+    const SIMD_DBL vcd_lo = _mm512_permutex2var_pd(v0, _mm512_setr_epi64(2, 6, 10, 14, 3, 7, 11, 15), v1);
+    const SIMD_DBL vcd_hi = _mm512_permutex2var_pd(v2, _mm512_setr_epi64(2, 6, 10, 14, 3, 7, 11, 15), v3);
+    *va = _mm512_permutex2var_pd(vab_lo, _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11), vab_hi);
+    *vb = _mm512_permutex2var_pd(vab_lo, _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15), vab_hi);
+    *vc = _mm512_permutex2var_pd(vcd_lo, _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11), vcd_hi);
+    *vd = _mm512_permutex2var_pd(vcd_lo, _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15), vcd_hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(double * const sa, const SIMD_DBL va, const SIMD_DBL vb)
+{
+    _mm512_storeu_pd(sa, _mm512_permutex2var_pd(va, _mm512_setr_epi64(0, 8, 1, 9, 2, 10, 3, 11), vb));
+    _mm512_storeu_pd(sa + 8, _mm512_permutex2var_pd(va, _mm512_setr_epi64(4, 12, 5, 13, 6, 14, 7, 15), vb));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc)
+{
+    _mm512_storeu_pd(sa, _mm512_permutex2var_pd(_mm512_permutex2var_pd(va, _mm512_setr_epi64(0, 8, 0, 1, 9, 0, 2, 10), vb),
+                                                _mm512_setr_epi64(0, 1, 8, 3, 4, 9, 6, 7), vc));
+    _mm512_storeu_pd(sa + 8, _mm512_permutex2var_pd(_mm512_permutex2var_pd(va, _mm512_setr_epi64(0, 3, 11, 0, 4, 12, 0, 5), vb),
+                                                    _mm512_setr_epi64(10, 1, 2, 11, 4, 5, 12, 7), vc));
+    _mm512_storeu_pd(sa + 16, _mm512_permutex2var_pd(_mm512_permutex2var_pd(va, _mm512_setr_epi64(13, 0, 6, 14, 0, 7, 15, 0), vb),
+                                                     _mm512_setr_epi64(0, 13, 2, 3, 14, 5, 6, 15), vc));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc, const SIMD_DBL vd)
+{
+    const SIMD_DBL vab_lo = _mm512_permutex2var_pd(va, _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11), vb);
+    const SIMD_DBL vab_hi = _mm512_permutex2var_pd(va, _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15), vb);
+    const SIMD_DBL vcd_lo = _mm512_permutex2var_pd(vc, _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11), vd);
+    const SIMD_DBL vcd_hi = _mm512_permutex2var_pd(vc, _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15), vd);
+    _mm512_storeu_pd(sa, _mm512_permutex2var_pd(vab_lo, _mm512_setr_epi64(0, 4, 8, 12, 1, 5, 9, 13), vcd_lo));
+    _mm512_storeu_pd(sa + 8, _mm512_permutex2var_pd(vab_lo, _mm512_setr_epi64(2, 6, 10, 14, 3, 7, 11, 15), vcd_lo));
+    _mm512_storeu_pd(sa + 16, _mm512_permutex2var_pd(vab_hi, _mm512_setr_epi64(0, 4, 8, 12, 1, 5, 9, 13), vcd_hi));
+    _mm512_storeu_pd(sa + 24, _mm512_permutex2var_pd(vab_hi, _mm512_setr_epi64(2, 6, 10, 14, 3, 7, 11, 15), vcd_hi));
+}
+
+//! 32-bit integers use the same permutes
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    const SIMD_INT v0 = _mm512_loadu_si512(sa);
+    const SIMD_INT v1 = _mm512_loadu_si512(sa + 16);
+    *va = _mm512_permutex2var_epi32(v0, _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30), v1);
+    *vb = _mm512_permutex2var_epi32(v0, _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31), v1);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    const SIMD_INT v0 = _mm512_loadu_si512(sa);
+    const SIMD_INT v1 = _mm512_loadu_si512(sa + 16);
+    const SIMD_INT v2 = _mm512_loadu_si512(sa + 32);
+    *va = _mm512_permutex2var_epi32(_mm512_permutex2var_epi32(v0, _mm512_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 0, 0, 0, 0, 0), v1),
+                                    _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 17, 20, 23, 26, 29), v2);
+    *vb = _mm512_permutex2var_epi32(_mm512_permutex2var_epi32(v0, _mm512_setr_epi32(1, 4, 7, 10, 13, 16, 19, 22, 25, 28, 31, 0, 0, 0, 0, 0), v1),
+                                    _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 18, 21, 24, 27, 30), v2);
+    *vc = _mm512_permutex2var_epi32(_mm512_permutex2var_epi32(v0, _mm512_setr_epi32(2, 5, 8, 11, 14, 17, 20, 23, 26, 29, 0, 0, 0, 0, 0, 0), v1),
+                                    _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 19, 22, 25, 28, 31), v2);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    // Components (0, 1) and (2, 3) of each half of the records, then join halves
+    const SIMD_INT v0 = _mm512_loadu_si512(sa);
+    const SIMD_INT v1 = _mm512_loadu_si512(sa + 16);
+    const SIMD_INT v2 = _mm512_loadu_si512(sa + 32);
+    const SIMD_INT v3 = _mm512_loadu_si512(sa + 48);
+    const SIMD_INT vab_lo = _mm512_permutex2var_epi32(v0, _mm512_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28, 1, 5, 9, 13, 17, 21, 25, 29), v1);
+    const SIMD_INT vab_hi = _mm512_permutex2var_epi32(v2, _mm512_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28, 1, 5, 9, 13, 17, 21, 25, 29), v3);
+    const SIMD_INT vcd_lo = _mm512_permutex2var_epi32(v0, _mm512_setr_epi32(2, 6, 10, 14, 18, 22, 26, 30, 3, 7, 11, 15, 19, 23, 27, 31), v1);
+    const SIMD_INT vcd_hi = _mm512_permutex2var_epi32(v2, _mm512_setr_epi32(2, 6, 10, 14, 18, 22, 26, 30, 3, 7, 11, 15, 19, 23, 27, 31), v3);
+    *va = _mm512_permutex2var_epi32(vab_lo, _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 16, 17, 18, 19, 20, 21, 22, 23), vab_hi);
+    *vb = _mm512_permutex2var_epi32(vab_lo, _mm512_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15, 24, 25, 26, 27, 28, 29, 30, 31), vab_hi);
+    *vc = _mm512_permutex2var_epi32(vcd_lo, _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 16, 17, 18, 19, 20, 21, 22, 23), vcd_hi);
+    *vd = _mm512_permutex2var_epi32(vcd_lo, _mm512_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15, 24, 25, 26, 27, 28, 29, 30, 31), vcd_hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{
+    _mm512_storeu_si512(sa, _mm512_permutex2var_epi32(va, _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23), vb));
+    _mm512_storeu_si512(sa + 16, _mm512_permutex2var_epi32(va, _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31), vb));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{
+    _mm512_storeu_si512(sa, _mm512_permutex2var_epi32(_mm512_permutex2var_epi32(va, _mm512_setr_epi32(0, 16, 0, 1, 17, 0, 2, 18, 0, 3, 19, 0, 4, 20, 0, 5), vb),
+                                                      _mm512_setr_epi32(0, 1, 16, 3, 4, 17, 6, 7, 18, 9, 10, 19, 12, 13, 20, 15), vc));
+    _mm512_storeu_si512(sa + 16, _mm512_permutex2var_epi32(_mm512_permutex2var_epi32(va, _mm512_setr_epi32(21, 0, 6, 22, 0, 7, 23, 0, 8, 24, 0, 9, 25, 0, 10, 26), vb),
+                                                           _mm512_setr_epi32(0, 21, 2, 3, 22, 5, 6, 23, 8, 9, 24, 11, 12, 25, 14, 15), vc));
+    _mm512_storeu_si512(sa + 32, _mm512_permutex2var_epi32(_mm512_permutex2var_epi32(va, _mm512_setr_epi32(0, 11, 27, 0, 12, 28, 0, 13, 29, 0, 14, 30, 0, 15, 31, 0), vb),
+                                                           _mm512_setr_epi32(26, 1, 2, 27, 4, 5, 28, 7, 8, 29, 10, 11, 30, 13, 14, 31), vc));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{
+    const SIMD_INT vab_lo = _mm512_permutex2var_epi32(va, _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 16, 17, 18, 19, 20, 21, 22, 23), vb);
+    const SIMD_INT vab_hi = _mm512_permutex2var_epi32(va, _mm512_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15, 24, 25, 26, 27, 28, 29, 30, 31), vb);
+    const SIMD_INT vcd_lo = _mm512_permutex2var_epi32(vc, _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 16, 17, 18, 19, 20, 21, 22, 23), vd);
+    const SIMD_INT vcd_hi = _mm512_permutex2var_epi32(vc, _mm512_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15, 24, 25, 26, 27, 28, 29, 30, 31), vd);
+    _mm512_storeu_si512(sa, _mm512_permutex2var_epi32(vab_lo, _mm512_setr_epi32(0, 8, 16, 24, 1, 9, 17, 25, 2, 10, 18, 26, 3, 11, 19, 27), vcd_lo));
+    _mm512_storeu_si512(sa + 16, _mm512_permutex2var_epi32(vab_lo, _mm512_setr_epi32(4, 12, 20, 28, 5, 13, 21, 29, 6, 14, 22, 30, 7, 15, 23, 31), vcd_lo));
+    _mm512_storeu_si512(sa + 32, _mm512_permutex2var_epi32(vab_hi, _mm512_setr_epi32(0, 8, 16, 24, 1, 9, 17, 25, 2, 10, 18, 26, 3, 11, 19, 27), vcd_hi));
+    _mm512_storeu_si512(sa + 48, _mm512_permutex2var_epi32(vab_hi, _mm512_setr_epi32(4, 12, 20, 28, 5, 13, 21, 29, 6, 14, 22, 30, 7, 15, 23, 31), vcd_hi));
+}
+
+/*!
+ *  Byte shuffle \c va in each 128-bit lane by the 16-byte mask \c vmsk
+ *  \note Zero-masked broadcast, the unmasked one warns of an uninitialized
+ *        value in GCC headers
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_shuffle_lanes_8(const SIMD_INT va, const __m128i vmsk)
+{ return _mm512_shuffle_epi8(va, _mm512_maskz_broadcast_i32x4(0xFFFF, vmsk)); }
+
+//! 8-bit records (e.g., pixels) use byte shuffles in 128-bit lanes, then lane permutes
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    // Components in 64-bit halves of each lane, then gather halves
+    const __m128i vmsk = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    const SIMD_INT v0 = simd_shuffle_lanes_8(_mm512_loadu_si512(sa), vmsk);
+    const SIMD_INT v1 = simd_shuffle_lanes_8(_mm512_loadu_si512(sa + 64), vmsk);
+    *va = _mm512_permutex2var_epi64(v0, _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14), v1);
+    *vb = _mm512_permutex2var_epi64(v0, _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15), v1);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    // Lane k of p0/p1/p2 holds bytes 48k to 48k + 47, then shuffle in lanes
+    const SIMD_INT v0 = _mm512_loadu_si512(sa);
+    const SIMD_INT v1 = _mm512_loadu_si512(sa + 64);
+    const SIMD_INT v2 = _mm512_loadu_si512(sa + 128);
+    const SIMD_INT p0 = _mm512_permutex2var_epi64(_mm512_permutex2var_epi64(v0, _mm512_setr_epi64(0, 1, 6, 7, 12, 13, 0, 0), v1),
+                                                  _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 10, 11), v2);
+    const SIMD_INT p1 = _mm512_permutex2var_epi64(_mm512_permutex2var_epi64(v0, _mm512_setr_epi64(2, 3, 8, 9, 14, 15, 0, 0), v1),
+                                                  _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 12, 13), v2);
+    const SIMD_INT p2 = _mm512_permutex2var_epi64(_mm512_permutex2var_epi64(v0, _mm512_setr_epi64(4, 5, 10, 11, 0, 0, 0, 0), v1),
+                                                  _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 14, 15), v2);
+    *va = _mm512_or_si512(_mm512_or_si512(
+              simd_shuffle_lanes_8(p0, _mm_setr_epi8(0, 3, 6, 9, 12, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+              simd_shuffle_lanes_8(p1, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, 2, 5, 8, 11, 14, -128, -128, -128, -128, -128))),
+              simd_shuffle_lanes_8(p2, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 1, 4, 7, 10, 13)));
+    *vb = _mm512_or_si512(_mm512_or_si512(
+              simd_shuffle_lanes_8(p0, _mm_setr_epi8(1, 4, 7, 10, 13, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+              simd_shuffle_lanes_8(p1, _mm_setr_epi8(-128, -128, -128, -128, -128, 0, 3, 6, 9, 12, 15, -128, -128, -128, -128, -128))),
+              simd_shuffle_lanes_8(p2, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 2, 5, 8, 11, 14)));
+    *vc = _mm512_or_si512(_mm512_or_si512(
+              simd_shuffle_lanes_8(p0, _mm_setr_epi8(2, 5, 8, 11, 14, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+              simd_shuffle_lanes_8(p1, _mm_setr_epi8(-128, -128, -128, -128, -128, 1, 4, 7, 10, 13, -128, -128, -128, -128, -128, -128))),
+              simd_shuffle_lanes_8(p2, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 0, 3, 6, 9, 12, 15)));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    // Components in 32-bit groups, then deinterleave groups as 32-bit records
+    const __m128i vmsk = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const SIMD_INT v0 = simd_shuffle_lanes_8(_mm512_loadu_si512(sa), vmsk);
+    const SIMD_INT v1 = simd_shuffle_lanes_8(_mm512_loadu_si512(sa + 64), vmsk);
+    const SIMD_INT v2 = simd_shuffle_lanes_8(_mm512_loadu_si512(sa + 128), vmsk);
+    const SIMD_INT v3 = simd_shuffle_lanes_8(_mm512_loadu_si512(sa + 192), vmsk);
+    const SIMD_INT vab_lo = _mm512_permutex2var_epi32(v0, _mm512_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28, 1, 5, 9, 13, 17, 21, 25, 29), v1);
+    const SIMD_INT vab_hi = _mm512_permutex2var_epi32(v2, _mm512_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28, 1, 5, 9, 13, 17, 21, 25, 29), v3);
+    const SIMD_INT vcd_lo = _mm512_permutex2var_epi32(v0, _mm512_setr_epi32(2, 6, 10, 14, 18, 22, 26, 30, 3, 7, 11, 15, 19, 23, 27, 31), v1);
+    const SIMD_INT vcd_hi = _mm512_permutex2var_epi32(v2, _mm512_setr_epi32(2, 6, 10, 14, 18, 22, 26, 30, 3, 7, 11, 15, 19, 23, 27, 31), v3);
+    *va = _mm512_permutex2var_epi64(vab_lo, _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11), vab_hi);
+    *vb = _mm512_permutex2var_epi64(vab_lo, _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15), vab_hi);
+    *vc = _mm512_permutex2var_epi64(vcd_lo, _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11), vcd_hi);
+    *vd = _mm512_permutex2var_epi64(vcd_lo, _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15), vcd_hi);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{
+    const SIMD_INT vlo = _mm512_unpacklo_epi8(va, vb);
+    const SIMD_INT vhi = _mm512_unpackhi_epi8(va, vb);
+    _mm512_storeu_si512(sa, _mm512_permutex2var_epi64(vlo, _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11), vhi));
+    _mm512_storeu_si512(sa + 64, _mm512_permutex2var_epi64(vlo, _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15), vhi));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{
+    // Lane k of p0/p1/p2 holds bytes 48k to 48k + 47, then gather lanes
+    const SIMD_INT p0 = _mm512_or_si512(_mm512_or_si512(
+        simd_shuffle_lanes_8(va, _mm_setr_epi8(0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128, -128, 5)),
+        simd_shuffle_lanes_8(vb, _mm_setr_epi8(-128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128, -128))),
+        simd_shuffle_lanes_8(vc, _mm_setr_epi8(-128, -128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128)));
+    const SIMD_INT p1 = _mm512_or_si512(_mm512_or_si512(
+        simd_shuffle_lanes_8(va, _mm_setr_epi8(-128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128, 10, -128)),
+        simd_shuffle_lanes_8(vb, _mm_setr_epi8(5, -128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128, 10))),
+        simd_shuffle_lanes_8(vc, _mm_setr_epi8(-128, 5, -128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128)));
+    const SIMD_INT p2 = _mm512_or_si512(_mm512_or_si512(
+        simd_shuffle_lanes_8(va, _mm_setr_epi8(-128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15, -128, -128)),
+        simd_shuffle_lanes_8(vb, _mm_setr_epi8(-128, -128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15, -128))),
+        simd_shuffle_lanes_8(vc, _mm_setr_epi8(10, -128, -128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15)));
+    _mm512_storeu_si512(sa, _mm512_permutex2var_epi64(_mm512_permutex2var_epi64(p0, _mm512_setr_epi64(0, 1, 8, 9, 0, 0, 2, 3), p1),
+                                                      _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 6, 7), p2));
+    _mm512_storeu_si512(sa + 64, _mm512_permutex2var_epi64(_mm512_permutex2var_epi64(p0, _mm512_setr_epi64(10, 11, 0, 0, 4, 5, 12, 13), p1),
+                                                           _mm512_setr_epi64(0, 1, 10, 11, 4, 5, 6, 7), p2));
+    _mm512_storeu_si512(sa + 128, _mm512_permutex2var_epi64(_mm512_permutex2var_epi64(p0, _mm512_setr_epi64(0, 0, 6, 7, 14, 15, 0, 0), p1),
+                                                            _mm512_setr_epi64(12, 13, 2, 3, 4, 5, 14, 15), p2));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{
+    // Interleave 32-bit groups of components, then bytes in each group
+    const __m128i vmsk = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const SIMD_INT vab_lo = _mm512_permutex2var_epi64(va, _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11), vb);
+    const SIMD_INT vab_hi = _mm512_permutex2var_epi64(va, _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15), vb);
+    const SIMD_INT vcd_lo = _mm512_permutex2var_epi64(vc, _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11), vd);
+    const SIMD_INT vcd_hi = _mm512_permutex2var_epi64(vc, _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15), vd);
+    _mm512_storeu_si512(sa, simd_shuffle_lanes_8(_mm512_permutex2var_epi32(vab_lo, _mm512_setr_epi32(0, 8, 16, 24, 1, 9, 17, 25, 2, 10, 18, 26, 3, 11, 19, 27), vcd_lo), vmsk));
+    _mm512_storeu_si512(sa + 64, simd_shuffle_lanes_8(_mm512_permutex2var_epi32(vab_lo, _mm512_setr_epi32(4, 12, 20, 28, 5, 13, 21, 29, 6, 14, 22, 30, 7, 15, 23, 31), vcd_lo), vmsk));
+    _mm512_storeu_si512(sa + 128, simd_shuffle_lanes_8(_mm512_permutex2var_epi32(vab_hi, _mm512_setr_epi32(0, 8, 16, 24, 1, 9, 17, 25, 2, 10, 18, 26, 3, 11, 19, 27), vcd_hi), vmsk));
+    _mm512_storeu_si512(sa + 192, simd_shuffle_lanes_8(_mm512_permutex2var_epi32(vab_hi, _mm512_setr_epi32(4, 12, 20, 28, 5, 13, 21, 29, 6, 14, 22, 30, 7, 15, 23, 31), vcd_hi), vmsk));
+}
+
+
+/**************************
+ *  Transpose intrinsics
+ **************************/
+/*!
+ *  Transpose a square tile, sb[j * ldb + i] = sa[i * lda + j].
+ *  Rows of \c sa are loaded into registers, transposed with shuffles and
+ *  stored as rows of \c sb. Leading dimensions are in elements, rows need
+ *  not be aligned and tiles must not overlap.
+ */
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    __m128 r0 = _mm_loadu_ps(sa);
+    __m128 r1 = _mm_loadu_ps(sa + lda);
+    __m128 r2 = _mm_loadu_ps(sa + 2 * lda);
+    __m128 r3 = _mm_loadu_ps(sa + 3 * lda);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(sb, r0);
+    _mm_storeu_ps(sb + ldb, r1);
+    _mm_storeu_ps(sb + 2 * ldb, r2);
+    _mm_storeu_ps(sb + 3 * ldb, r3);
+}
 
 static SIMD_FUNC_INLINE
-void simd_storeu(float * const sa, const SIMD_FLT va)
-{ _mm512_storeu_ps(sa, va); }
+void simd_transpose8x8_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    const __m256 r0 = _mm256_loadu_ps(sa);
+    const __m256 r1 = _mm256_loadu_ps(sa + lda);
+    const __m256 r2 = _mm256_loadu_ps(sa + 2 * lda);
+    const __m256 r3 = _mm256_loadu_ps(sa + 3 * lda);
+    const __m256 r4 = _mm256_loadu_ps(sa + 4 * lda);
+    const __m256 r5 = _mm256_loadu_ps(sa + 5 * lda);
+    const __m256 r6 = _mm256_loadu_ps(sa + 6 * lda);
+    const __m256 r7 = _mm256_loadu_ps(sa + 7 * lda);
+
+    // Pairs of rows, then 4x4 blocks in each 128-bit lane
+    const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+    const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+    const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    const __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+    const __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+    const __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+    const __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+    const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+    // Swap 128-bit lanes between upper and lower rows
+    _mm256_storeu_ps(sb, _mm256_permute2f128_ps(s0, s4, 0x20));
+    _mm256_storeu_ps(sb + ldb, _mm256_permute2f128_ps(s1, s5, 0x20));
+    _mm256_storeu_ps(sb + 2 * ldb, _mm256_permute2f128_ps(s2, s6, 0x20));
+    _mm256_storeu_ps(sb + 3 * ldb, _mm256_permute2f128_ps(s3, s7, 0x20));
+    _mm256_storeu_ps(sb + 4 * ldb, _mm256_permute2f128_ps(s0, s4, 0x31));
+    _mm256_storeu_ps(sb + 5 * ldb, _mm256_permute2f128_ps(s1, s5, 0x31));
+    _mm256_storeu_ps(sb + 6 * ldb, _mm256_permute2f128_ps(s2, s6, 0x31));
+    _mm256_storeu_ps(sb + 7 * ldb, _mm256_permute2f128_ps(s3, s7, 0x31));
+}
 
 static SIMD_FUNC_INLINE
-void simd_store(double * const sa, const SIMD_DBL va)
-{ _mm512_store_pd(sa, va); }
+void simd_transpose16x16_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    __m512 r[16], s[16];
+    for (int32_t i = 0; i < 16; ++i)
+        r[i] = _mm512_loadu_ps(sa + i * lda);
+
+    // 4x4 blocks in each 128-bit lane, s[4 * g + j] holds column 4 * lane + j of rows 4g to 4g + 3
+    // Unpacks as two-source permutes, _mm512_unpack*_ps trip -Wuninitialized in GCC 12
+    const __m512i vunpacklo = _mm512_setr_epi32(0, 16, 1, 17, 4, 20, 5, 21, 8, 24, 9, 25, 12, 28, 13, 29);
+    const __m512i vunpackhi = _mm512_setr_epi32(2, 18, 3, 19, 6, 22, 7, 23, 10, 26, 11, 27, 14, 30, 15, 31);
+    for (int32_t g = 0; g < 4; ++g) {
+        const __m512 t0 = _mm512_permutex2var_ps(r[4 * g], vunpacklo, r[4 * g + 1]);
+        const __m512 t1 = _mm512_permutex2var_ps(r[4 * g], vunpackhi, r[4 * g + 1]);
+        const __m512 t2 = _mm512_permutex2var_ps(r[4 * g + 2], vunpacklo, r[4 * g + 3]);
+        const __m512 t3 = _mm512_permutex2var_ps(r[4 * g + 2], vunpackhi, r[4 * g + 3]);
+        s[4 * g] = _mm512_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        s[4 * g + 1] = _mm512_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        s[4 * g + 2] = _mm512_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        s[4 * g + 3] = _mm512_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    }
+
+    // 4x4 transpose of 128-bit lanes among blocks of the same column
+    const __m512i vlo = _mm512_setr_epi32(0, 1, 2, 3, 16, 17, 18, 19, 4, 5, 6, 7, 20, 21, 22, 23);
+    const __m512i vhi = _mm512_setr_epi32(8, 9, 10, 11, 24, 25, 26, 27, 12, 13, 14, 15, 28, 29, 30, 31);
+    const __m512i veven = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 16, 17, 18, 19, 20, 21, 22, 23);
+    const __m512i vodd = _mm512_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15, 24, 25, 26, 27, 28, 29, 30, 31);
+    for (int32_t j = 0; j < 4; ++j) {
+        const __m512 x01_lo = _mm512_permutex2var_ps(s[j], vlo, s[4 + j]);
+        const __m512 x01_hi = _mm512_permutex2var_ps(s[j], vhi, s[4 + j]);
+        const __m512 x23_lo = _mm512_permutex2var_ps(s[8 + j], vlo, s[12 + j]);
+        const __m512 x23_hi = _mm512_permutex2var_ps(s[8 + j], vhi, s[12 + j]);
+        _mm512_storeu_ps(sb + j * ldb, _mm512_permutex2var_ps(x01_lo, veven, x23_lo));
+        _mm512_storeu_ps(sb + (4 + j) * ldb, _mm512_permutex2var_ps(x01_lo, vodd, x23_lo));
+        _mm512_storeu_ps(sb + (8 + j) * ldb, _mm512_permutex2var_ps(x01_hi, veven, x23_hi));
+        _mm512_storeu_ps(sb + (12 + j) * ldb, _mm512_permutex2var_ps(x01_hi, vodd, x23_hi));
+    }
+}
 
 static SIMD_FUNC_INLINE
-void simd_storeu(double * const sa, const SIMD_DBL va)
-{ _mm512_storeu_pd(sa, va); }
+void simd_transpose4x4_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    const __m256d r0 = _mm256_loadu_pd(sa);
+    const __m256d r1 = _mm256_loadu_pd(sa + lda);
+    const __m256d r2 = _mm256_loadu_pd(sa + 2 * lda);
+    const __m256d r3 = _mm256_loadu_pd(sa + 3 * lda);
+    const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+    _mm256_storeu_pd(sb, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(sb + ldb, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(sb + 2 * ldb, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(sb + 3 * ldb, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    const __m512d r0 = _mm512_loadu_pd(sa);
+    const __m512d r1 = _mm512_loadu_pd(sa + lda);
+    const __m512d r2 = _mm512_loadu_pd(sa + 2 * lda);
+    const __m512d r3 = _mm512_loadu_pd(sa + 3 * lda);
+    const __m512d r4 = _mm512_loadu_pd(sa + 4 * lda);
+    const __m512d r5 = _mm512_loadu_pd(sa + 5 * lda);
+    const __m512d r6 = _mm512_loadu_pd(sa + 6 * lda);
+    const __m512d r7 = _mm512_loadu_pd(sa + 7 * lda);
+
+    // Pairs of rows, then pairs of 128-bit lanes, then 256-bit halves
+    const __m512i vunpacklo = _mm512_setr_epi64(0, 8, 2, 10, 4, 12, 6, 14);
+    const __m512i vunpackhi = _mm512_setr_epi64(1, 9, 3, 11, 5, 13, 7, 15);
+    const __m512d t0 = _mm512_permutex2var_pd(r0, vunpacklo, r1);
+    const __m512d t1 = _mm512_permutex2var_pd(r0, vunpackhi, r1);
+    const __m512d t2 = _mm512_permutex2var_pd(r2, vunpacklo, r3);
+    const __m512d t3 = _mm512_permutex2var_pd(r2, vunpackhi, r3);
+    const __m512d t4 = _mm512_permutex2var_pd(r4, vunpacklo, r5);
+    const __m512d t5 = _mm512_permutex2var_pd(r4, vunpackhi, r5);
+    const __m512d t6 = _mm512_permutex2var_pd(r6, vunpacklo, r7);
+    const __m512d t7 = _mm512_permutex2var_pd(r6, vunpackhi, r7);
+    const __m512d u0 = _mm512_permutex2var_pd(t0, _mm512_setr_epi64(0, 1, 8, 9, 4, 5, 12, 13), t2);
+    const __m512d u1 = _mm512_permutex2var_pd(t0, _mm512_setr_epi64(2, 3, 10, 11, 6, 7, 14, 15), t2);
+    const __m512d u2 = _mm512_permutex2var_pd(t1, _mm512_setr_epi64(0, 1, 8, 9, 4, 5, 12, 13), t3);
+    const __m512d u3 = _mm512_permutex2var_pd(t1, _mm512_setr_epi64(2, 3, 10, 11, 6, 7, 14, 15), t3);
+    const __m512d u4 = _mm512_permutex2var_pd(t4, _mm512_setr_epi64(0, 1, 8, 9, 4, 5, 12, 13), t6);
+    const __m512d u5 = _mm512_permutex2var_pd(t4, _mm512_setr_epi64(2, 3, 10, 11, 6, 7, 14, 15), t6);
+    const __m512d u6 = _mm512_permutex2var_pd(t5, _mm512_setr_epi64(0, 1, 8, 9, 4, 5, 12, 13), t7);
+    const __m512d u7 = _mm512_permutex2var_pd(t5, _mm512_setr_epi64(2, 3, 10, 11, 6, 7, 14, 15), t7);
+    _mm512_storeu_pd(sb, _mm512_permutex2var_pd(u0, _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11), u4));
+    _mm512_storeu_pd(sb + ldb, _mm512_permutex2var_pd(u2, _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11), u6));
+    _mm512_storeu_pd(sb + 2 * ldb, _mm512_permutex2var_pd(u1, _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11), u5));
+    _mm512_storeu_pd(sb + 3 * ldb, _mm512_permutex2var_pd(u3, _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11), u7));
+    _mm512_storeu_pd(sb + 4 * ldb, _mm512_permutex2var_pd(u0, _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15), u4));
+    _mm512_storeu_pd(sb + 5 * ldb, _mm512_permutex2var_pd(u2, _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15), u6));
+    _mm512_storeu_pd(sb + 6 * ldb, _mm512_permutex2var_pd(u1, _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15), u5));
+    _mm512_storeu_pd(sb + 7 * ldb, _mm512_permutex2var_pd(u3, _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15), u7));
+}
+
+
+/*************************
+ *  Gather instructions  *
+ *************************/
+/*!
+ *  Gather, lane i is loaded from sa[idx[i]], one 32-bit index per lane.
+ *  Indices need not be sorted or distinct and are not range-checked.
+ */
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_gather(const float * const sa, const int32_t * const idx)
+{ return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, _mm512_loadu_si512(idx), sa, 4); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_gather(const double * const sa, const int32_t * const idx)
+{ return _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, _mm256_loadu_si256((const __m256i *)idx), sa, 8); }
+
+
+/************************
+ *  Align instructions  *
+ ************************/
+/*!
+ *  Lanes N .. N + nlanes - 1 of the concatenation of vb (low lanes) and va
+ *  (high lanes), 0 <= N <= nlanes. Vectors at consecutive aligned addresses
+ *  give the vector at an unaligned offset of N elements.
+ */
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_alignr(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    if (N >= 16)
+        return va;
+    return _mm512_castsi512_ps(_mm512_maskz_alignr_epi32(0xFFFF, _mm512_castps_si512(va), _mm512_castps_si512(vb), N & 15));
+}
+
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_alignr(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    if (N >= 8)
+        return va;
+    return _mm512_castsi512_pd(_mm512_maskz_alignr_epi64(0xFF, _mm512_castpd_si512(va), _mm512_castpd_si512(vb), N & 7));
+}
+
+
+/***********************
+ *  Scan instructions  *
+ ***********************/
+/*!
+ *  Inclusive prefix sums of the lanes of va plus the carry *vc (all lanes
+ *  equal), by log2(nlanes) steps of lane shifts and adds. The sum of va is
+ *  broadcast and added to *vc, the carry of the next vector, so that one
+ *  add per vector is on the loop-carried path.
+ */
+//! Lane shifts are rotations with the wrapped lanes masked to zero
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_32(const SIMD_INT va, SIMD_INT * const vc)
+{
+    SIMD_INT vs = _mm512_add_epi32(va, _mm512_maskz_alignr_epi32(0xFFFE, va, va, 15));
+    vs = _mm512_add_epi32(vs, _mm512_maskz_alignr_epi32(0xFFFC, vs, vs, 14));
+    vs = _mm512_add_epi32(vs, _mm512_maskz_alignr_epi32(0xFFF0, vs, vs, 12));
+    vs = _mm512_add_epi32(vs, _mm512_maskz_alignr_epi32(0xFF00, vs, vs, 8));
+    const SIMD_INT vp = *vc;
+    *vc = _mm512_add_epi32(vp, _mm512_maskz_permutexvar_epi32(0xFFFF, _mm512_set1_epi32(15), vs));
+    return _mm512_add_epi32(vs, vp);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_64(const SIMD_INT va, SIMD_INT * const vc)
+{
+    SIMD_INT vs = _mm512_add_epi64(va, _mm512_maskz_alignr_epi64(0xFE, va, va, 7));
+    vs = _mm512_add_epi64(vs, _mm512_maskz_alignr_epi64(0xFC, vs, vs, 6));
+    vs = _mm512_add_epi64(vs, _mm512_maskz_alignr_epi64(0xF0, vs, vs, 4));
+    const SIMD_INT vp = *vc;
+    *vc = _mm512_add_epi64(vp, _mm512_maskz_permutexvar_epi64(0xFF, _mm512_set1_epi64(7), vs));
+    return _mm512_add_epi64(vs, vp);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    __m512i vt = _mm512_castps_si512(va);
+    SIMD_FLT vs = _mm512_add_ps(va, _mm512_castsi512_ps(_mm512_maskz_alignr_epi32(0xFFFE, vt, vt, 15)));
+    vt = _mm512_castps_si512(vs);
+    vs = _mm512_add_ps(vs, _mm512_castsi512_ps(_mm512_maskz_alignr_epi32(0xFFFC, vt, vt, 14)));
+    vt = _mm512_castps_si512(vs);
+    vs = _mm512_add_ps(vs, _mm512_castsi512_ps(_mm512_maskz_alignr_epi32(0xFFF0, vt, vt, 12)));
+    vt = _mm512_castps_si512(vs);
+    vs = _mm512_add_ps(vs, _mm512_castsi512_ps(_mm512_maskz_alignr_epi32(0xFF00, vt, vt, 8)));
+    const SIMD_FLT vp = *vc;
+    *vc = _mm512_add_ps(vp, _mm512_maskz_permutexvar_ps(0xFFFF, _mm512_set1_epi32(15), vs));
+    return _mm512_add_ps(vs, vp);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    __m512i vt = _mm512_castpd_si512(va);
+    SIMD_DBL vs = _mm512_add_pd(va, _mm512_castsi512_pd(_mm512_maskz_alignr_epi64(0xFE, vt, vt, 7)));
+    vt = _mm512_castpd_si512(vs);
+    vs = _mm512_add_pd(vs, _mm512_castsi512_pd(_mm512_maskz_alignr_epi64(0xFC, vt, vt, 6)));
+    vt = _mm512_castpd_si512(vs);
+    vs = _mm512_add_pd(vs, _mm512_castsi512_pd(_mm512_maskz_alignr_epi64(0xF0, vt, vt, 4)));
+    const SIMD_DBL vp = *vc;
+    *vc = _mm512_add_pd(vp, _mm512_maskz_permutexvar_pd(0xFF, _mm512_set1_epi64(7), vs));
+    return _mm512_add_pd(vs, vp);
+}
+
+/*!
+ *  Exclusive prefix sums, lane i is the carry plus lanes 0 .. i-1 of va,
+ *  *vc is updated as by the inclusive sums
+ */
+//! Integer sums are exact, the exclusive sums are the inclusive sums less va
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_32(const SIMD_INT va, SIMD_INT * const vc)
+{ return _mm512_sub_epi32(simd_scan_32(va, vc), va); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_64(const SIMD_INT va, SIMD_INT * const vc)
+{ return _mm512_sub_epi64(simd_scan_64(va, vc), va); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan_excl(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    const SIMD_FLT vp = *vc;
+    return simd_alignr<15>(simd_scan(va, vc), vp);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan_excl(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    const SIMD_DBL vp = *vc;
+    return simd_alignr<7>(simd_scan(va, vc), vp);
+}
+
+
+}  // namespace avx512
+}  // namespace gvl
 
 
 #endif  // _AVX512_H
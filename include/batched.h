@@ -0,0 +1,201 @@
+/*!
+ *  \brief Batched operations on many small matrices
+ *  Matrices are stored in a compact layout: batches of one matrix per SIMD
+ *  lane, where element (i, j) of the matrices of a batch is one vector.
+ *  Vector instructions then work on whole matrices without padding rows to
+ *  the SIMD width or reducing horizontally, which pays off for sizes up to
+ *  about 16 where a row fills a fraction of a register.
+ *  - batch_pack()/batch_unpack(), convert n row-major matrices (vectors
+ *    are matrices with one column) from/to the compact layout
+ *  - batch_gemv(), y = A * x for every matrix of the batches
+ *  \note Compact arrays must be aligned to SIMD_WIDTH_BYTES and hold
+ *        batch_elems() elements
+ */
+#ifndef _BATCHED_H
+#define _BATCHED_H
+
+
+#include <stdint.h>
+#include <stddef.h>   // size_t
+#include "simd.h"
+#include "sysconf.h"
+#include "dispatch.h"  // lane_traits, steal_invoke
+#include "workpool.h"
+#include "transpose.h"
+
+
+namespace gvl {
+
+
+/*!
+ *  \class batch_traits
+ *  \brief SIMD datatype of batched matrices of type T, nlanes matrices per batch
+ */
+template <typename T>
+struct batch_traits: lane_traits<T>
+{ };
+
+//! Number of batches of \c n matrices
+template <typename T>
+static inline size_t batch_count(const size_t n)
+{ return (n + batch_traits<T>::nlanes - 1) / batch_traits<T>::nlanes; }
+
+//! Elements of a compact array of \c n matrices of \c rows x \c cols
+template <typename T>
+static inline size_t batch_elems(const size_t n, const size_t rows, const size_t cols)
+{ return batch_count<T>(n) * rows * cols * batch_traits<T>::nlanes; }
+
+/*!
+ *  Pack \c n row-major matrices of \c rows x \c cols into compact layout.
+ *  Matrix k starts at sa + k * rows * lda. Lanes past \c n in the last
+ *  batch are zeroed.
+ */
+template <typename T>
+static void batch_pack(T * const sb, const T * const sa, const size_t n, const size_t rows, const size_t cols, const size_t lda)
+{
+    const size_t nlanes = batch_traits<T>::nlanes;
+    const size_t melems = rows * cols;
+    const size_t nb = batch_count<T>(n);
+    for (size_t b = 0; b < nb; ++b) {
+        T * const pb = sb + b * melems * nlanes;
+        const size_t nk = (n - b * nlanes < nlanes) ? (n - b * nlanes) : (nlanes);
+
+        // Contiguous matrices, a batch is the transpose of nlanes x melems
+        if (lda == cols && nk == nlanes) {
+            transpose(pb, nlanes, sa + b * nlanes * melems, melems, nlanes, melems);
+            continue;
+        }
+
+        for (size_t k = 0; k < nlanes; ++k) {
+            const T * const pa = sa + (b * nlanes + k) * rows * lda;
+            for (size_t i = 0; i < rows; ++i)
+                for (size_t j = 0; j < cols; ++j)
+                    pb[(i * cols + j) * nlanes + k] = (k < nk) ? (pa[i * lda + j]) : ((T)0);
+        }
+    }
+}
+
+/*!
+ *  Unpack compact layout into \c n row-major matrices of \c rows x \c cols,
+ *  matrix k starts at sb + k * rows * ldb
+ */
+template <typename T>
+static void batch_unpack(T * const sb, const size_t ldb, const T * const sa, const size_t n, const size_t rows, const size_t cols)
+{
+    const size_t nlanes = batch_traits<T>::nlanes;
+    const size_t melems = rows * cols;
+    const size_t nb = batch_count<T>(n);
+    for (size_t b = 0; b < nb; ++b) {
+        const T * const pa = sa + b * melems * nlanes;
+        const size_t nk = (n - b * nlanes < nlanes) ? (n - b * nlanes) : (nlanes);
+
+        if (ldb == cols && nk == nlanes) {
+            transpose(sb + b * nlanes * melems, melems, pa, nlanes, melems, nlanes);
+            continue;
+        }
+
+        for (size_t k = 0; k < nk; ++k) {
+            T * const pb = sb + (b * nlanes + k) * rows * ldb;
+            for (size_t i = 0; i < rows; ++i)
+                for (size_t j = 0; j < cols; ++j)
+                    pb[i * ldb + j] = pa[(i * cols + j) * nlanes + k];
+        }
+    }
+}
+
+/*!
+ *  Range functor of batch_gemv(), computes batches [lo, hi).
+ *  Rows are processed four at a time so that each vector of x loaded is
+ *  used by four independent accumulators.
+ */
+template <typename T>
+struct batch_gemv_range
+{
+    typedef typename batch_traits<T>::vtype vtype;
+
+    T * const yc;
+    const T * const ac;
+    const T * const xc;
+    const size_t rows;
+    const size_t cols;
+
+    batch_gemv_range(T * const y, const T * const a, const T * const x, const size_t r, const size_t c):
+        yc(y), ac(a), xc(x), rows(r), cols(c)
+    { }
+
+    void operator()(const size_t lo, const size_t hi) const
+    {
+        const size_t nlanes = batch_traits<T>::nlanes;
+        for (size_t b = lo; b < hi; ++b) {
+            const T * const pa = ac + b * rows * cols * nlanes;
+            const T * const px = xc + b * cols * nlanes;
+            T * const py = yc + b * rows * nlanes;
+
+            size_t i = 0;
+            for (; i + 4 <= rows; i += 4) {
+                const T * const pa0 = pa + i * cols * nlanes;
+                const T * const pa1 = pa0 + cols * nlanes;
+                const T * const pa2 = pa1 + cols * nlanes;
+                const T * const pa3 = pa2 + cols * nlanes;
+                vtype vy0, vy1, vy2, vy3;
+                simd_set_zero(&vy0);
+                simd_set_zero(&vy1);
+                simd_set_zero(&vy2);
+                simd_set_zero(&vy3);
+                for (size_t j = 0; j < cols; ++j) {
+                    const vtype vx = simd_load(px + j * nlanes);
+                    vy0 = simd_fmadd(simd_load(pa0 + j * nlanes), vx, vy0);
+                    vy1 = simd_fmadd(simd_load(pa1 + j * nlanes), vx, vy1);
+                    vy2 = simd_fmadd(simd_load(pa2 + j * nlanes), vx, vy2);
+                    vy3 = simd_fmadd(simd_load(pa3 + j * nlanes), vx, vy3);
+                }
+                simd_store(py + i * nlanes, vy0);
+                simd_store(py + (i + 1) * nlanes, vy1);
+                simd_store(py + (i + 2) * nlanes, vy2);
+                simd_store(py + (i + 3) * nlanes, vy3);
+            }
+            for (; i < rows; ++i) {
+                const T * const pai = pa + i * cols * nlanes;
+                vtype vy;
+                simd_set_zero(&vy);
+                for (size_t j = 0; j < cols; ++j)
+                    vy = simd_fmadd(simd_load(pai + j * nlanes), simd_load(px + j * nlanes), vy);
+                simd_store(py + i * nlanes, vy);
+            }
+        }
+    }
+};
+
+/*!
+ *  Matrix-vector products y = A * x of \c n matrices of \c rows x \c cols
+ *  in compact layout, see batch_pack()
+ *  \param[out] yc Compact vectors of \c rows elements
+ *  \param[in] ac Compact matrices
+ *  \param[in] xc Compact vectors of \c cols elements
+ *  \param[in] run_par Batches are scheduled among the OpenMP threads set by
+ *             SYSCONF, ranges of batches take about a quarter of L2
+ */
+template <typename T>
+static void batch_gemv(T * const yc, const T * const ac, const T * const xc, const size_t n, const size_t rows, const size_t cols, const bool run_par = false)
+{
+    const size_t nb = batch_count<T>(n);
+    if (nb == 0 || rows == 0)
+        return;
+
+    const batch_gemv_range<T> kernel(yc, ac, xc, rows, cols);
+    const int32_t nthreads = ((SYSCONF::get_omp() & run_par) == true) ? (SYSCONF::get_threads()) : (1);
+    if (nthreads > 1 && nb > 1) {
+        const size_t batch_bytes = (rows * cols + rows + cols) * batch_traits<T>::nlanes * sizeof(T);
+        const size_t leaf = (SYSCONF::get_L2_sz() / 4) / batch_bytes;
+        steal_run(nb, 1, (leaf > 1) ? (leaf) : (1), steal_invoke<batch_gemv_range<T> >, (const void *)&kernel, nthreads);
+    }
+    else {
+        kernel(0, nb);
+    }
+}
+
+
+}  // namespace gvl
+
+
+#endif  // _BATCHED_H
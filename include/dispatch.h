@@ -0,0 +1,203 @@
+/*!
+ *  \brief Multi-core dispatcher using OpenMP or a work-stealing pool
+ *  Splits an index range in chunks that are multiples of both the SIMD width
+ *  and the cache line size, so threads never share a cache line at chunk
+ *  edges and every chunk starts at a full vector. Chunks are sized from the
+ *  L2 capacity reported by SYSCONF and each thread runs the vector kernel on
+ *  its chunks.
+ *  \note Chunk boundaries are relative to index 0, arrays are assumed to be
+ *        allocated with SIMD_WIDTH_BYTES (or cache line) alignment
+ */
+#ifndef _DISPATCH_H
+#define _DISPATCH_H
+
+
+#include <stdint.h>
+#include <stddef.h>   // size_t
+#include "simd.h"
+#include "utils.h"    // setOmpEnv
+#include "sysconf.h"
+#include "affinity.h"
+#include "workpool.h"
+
+
+#if defined(_OPENMP)
+#   include <omp.h>
+#endif
+
+
+namespace gvl {
+
+
+/*!
+ *  \class lane_traits
+ *  \brief SIMD datatype of elements of type T and its number of lanes
+ *  \note Lanes are counted from the datatype, MMX floating-point is scalar
+ */
+template <typename T>
+struct lane_traits;
+
+template <>
+struct lane_traits<int32_t>
+{
+    typedef SIMD_INT vtype;
+    static const size_t nlanes = sizeof(SIMD_INT) / sizeof(int32_t);
+};
+
+template <>
+struct lane_traits<int64_t>
+{
+    typedef SIMD_INT vtype;
+    static const size_t nlanes = sizeof(SIMD_INT) / sizeof(int64_t);
+};
+
+template <>
+struct lane_traits<float>
+{
+    typedef SIMD_FLT vtype;
+    static const size_t nlanes = sizeof(SIMD_FLT) / sizeof(float);
+};
+
+template <>
+struct lane_traits<double>
+{
+    typedef SIMD_DBL vtype;
+    static const size_t nlanes = sizeof(SIMD_DBL) / sizeof(double);
+};
+
+//! Parts per thread of kernels split into parts of uneven cost, to steal
+const size_t STEAL_PARTS_PER_THREAD = 4;
+
+/*!
+ *  Set number of threads used by parallel_for() when not given explicitly.
+ *  If \c nthreads < 1, the environment variable OMP_NUM_THREADS is used.
+ *  \return Number of threads set
+ */
+static inline int32_t set_dispatch_threads(const int32_t nthreads)
+{ return setOmpEnv(nthreads); }
+
+//! Number of threads used by parallel_for() when not given explicitly
+static inline int32_t get_dispatch_threads()
+{
+#if defined(_OPENMP)
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+/*!
+ *  Pin the threads used by parallel_for() following \c policy, so chunks
+ *  keep their L1/L2 locality across calls (see affinity.h)
+ *  \return Number of threads pinned
+ */
+static inline int32_t set_dispatch_affinity(const affinity_policy policy, const int32_t * const cpus = NULL, const int32_t ncpus = 0)
+{ return set_affinity(policy, get_dispatch_threads(), cpus, ncpus); }
+
+/*!
+ *  Smallest chunk in elements of \c elem_bytes bytes, a multiple of the
+ *  SIMD width and of the cache line size
+ */
+static inline size_t dispatch_grain(const size_t elem_bytes)
+{
+    const size_t line = SYSCONF::get_line_sz();
+    const size_t qbytes = (line > (size_t)SIMD_WIDTH_BYTES) ? (line) : ((size_t)SIMD_WIDTH_BYTES);
+    return (qbytes >= elem_bytes) ? (qbytes / elem_bytes) : (1);
+}
+
+/*!
+ *  Chunk size in elements for \c n elements among \c nthreads threads.
+ *  A chunk of one array takes a quarter of L2, leaving room for the other
+ *  operands of a kernel, but is reduced so that all threads get work.
+ */
+static inline size_t dispatch_chunk(const size_t n, const size_t elem_bytes, const int32_t nthreads)
+{
+    const size_t grain = dispatch_grain(elem_bytes);
+    size_t chunk = (SYSCONF::get_L2_sz() / 4) / elem_bytes;
+    if (nthreads > 1) {
+        const size_t per_thread = (n + nthreads - 1) / nthreads;
+        if (chunk > per_thread)
+            chunk = per_thread;
+    }
+    chunk = ((chunk + grain - 1) / grain) * grain;
+    return (chunk > 0) ? (chunk) : (grain);
+}
+
+/*!
+ *  Range function of the work-stealing pool, forwards to the kernel functor
+ */
+template <typename K>
+static void steal_invoke(const void *ctx, const size_t lo, const size_t hi)
+{ (*(const K *)ctx)(lo, hi); }
+
+/*!
+ *  Run \c kernel over [0, n) on the work-stealing pool (see workpool.h).
+ *  Ranges split at SIMD/cache-line aligned boundaries, as in parallel_for().
+ *  \param[in] nthreads Number of threads, if < 1 uses get_dispatch_threads()
+ *  \param[in] leaf Elements below which ranges are not split, if 0 about
+ *             64 leaves per thread
+ */
+template <typename K>
+static SIMD_FUNC_INLINE void steal_for(const size_t n, const K &kernel, const int32_t nthreads = 0, const size_t leaf = 0)
+{
+    const int32_t nt = (nthreads > 0) ? (nthreads) : (get_dispatch_threads());
+    const size_t grain = dispatch_grain(sizeof(typename K::stype));
+    size_t lf = (leaf > 0) ? (leaf) : (n / ((size_t)nt * 64));
+    lf = ((lf + grain - 1) / grain) * grain;
+    steal_run(n, grain, (lf > grain) ? (lf) : (grain), steal_invoke<K>, (const void *)&kernel, nt);
+}
+
+//! Parts of \c n items (rows, slices, ...) for \c nthreads threads
+static inline size_t steal_parts(const size_t n, const int32_t nthreads)
+{
+    const size_t np = STEAL_PARTS_PER_THREAD * (size_t)nthreads;
+    return (np < n) ? (np) : (n);
+}
+
+/*!
+ *  Run \c kernel over parts [0, np) on the work-stealing pool, one part at
+ *  a time, or by the calling thread if \c nthreads < 2 or there is one part
+ */
+template <typename K>
+static inline void steal_parts_for(const size_t np, const K &kernel, const int32_t nthreads)
+{
+    if (nthreads > 1 && np > 1)
+        steal_run(np, 1, 1, steal_invoke<K>, (const void *)&kernel, nthreads);
+    else
+        kernel(0, np);
+}
+
+/*!
+ *  Run \c kernel over [0, n) split in SIMD/cache-line aligned chunks.
+ *  Functor K provides:
+ *  - typedef stype, element type used to size chunks
+ *  - void operator()(begin, end) const, processes elements [begin, end)
+ *  Uses the work-stealing pool instead of OpenMP if selected with
+ *  set_dispatch_backend().
+ *  \param[in] nthreads Number of threads, if < 1 uses get_dispatch_threads()
+ */
+template <typename K>
+static SIMD_FUNC_INLINE void parallel_for(const size_t n, const K &kernel, const int32_t nthreads = 0)
+{
+    if (get_dispatch_backend() == DISPATCH_STEALING) {
+        steal_for(n, kernel, nthreads);
+        return;
+    }
+
+    const int32_t nt = (nthreads > 0) ? (nthreads) : (get_dispatch_threads());
+    const size_t chunk = dispatch_chunk(n, sizeof(typename K::stype), nt);
+    const int64_t nchunks = (int64_t)((n + chunk - 1) / chunk);
+
+    #pragma omp parallel for default(shared) schedule(static) num_threads(nt) if (nt > 1 && nchunks > 1)
+    for (int64_t c = 0; c < nchunks; ++c) {
+        const size_t lo = (size_t)c * chunk;
+        const size_t hi = (lo + chunk < n) ? (lo + chunk) : (n);
+        kernel(lo, hi);
+    }
+}
+
+
+}  // namespace gvl
+
+
+#endif  // _DISPATCH_H
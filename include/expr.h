@@ -0,0 +1,363 @@
+/*!
+ *  \brief C++ expression templates for array arithmetic
+ *  Array expressions such as d = a + b * c - e are built as a tree of
+ *  lightweight nodes and evaluated in a single SIMD loop on assignment,
+ *  without intermediate arrays. A multiply followed by an add/subtract is
+ *  contracted into simd_fmadd()/simd_fmsub().
+ *  \note Requires vector classes (vec.h)
+ */
+#ifndef _EXPR_H
+#define _EXPR_H
+
+
+#include <stdint.h>
+#include <stdlib.h>   // NULL
+#include "arena.h"    // heap_allocator
+#include "vec.h"
+
+
+namespace gvl {
+
+
+/*!
+ *  \struct vexpr
+ *  \brief Base of array expression nodes (CRTP)
+ *
+ *  Every node E provides:
+ *  - size(), number of elements or 0 if it adapts to any size (scalars)
+ *  - load(i, n), SIMD datatype with elements [i, i+n), n <= nstreams
+ */
+template <typename T, typename E>
+struct vexpr
+{
+    SIMD_FUNC_INLINE const E & self() const
+    { return static_cast<const E &>(*this); }
+};
+
+
+template <typename T, typename A = heap_allocator> class varray;
+
+/*!
+ *  Nodes are held by value, arrays by reference so they are not copied.
+ *  Expressions are meant to be evaluated in the statement that builds them.
+ */
+template <typename E>
+struct expr_ref
+{ typedef const E type; };
+
+template <typename T, typename A>
+struct expr_ref< varray<T, A> >
+{ typedef const varray<T, A> & type; };
+
+//! Prevents deduction of T from scalar operands, e.g. x * 2 with double arrays
+template <typename T>
+struct expr_scalar_type
+{ typedef T type; };
+
+
+/*******************
+ *  Operator tags  *
+ *******************/
+template <typename T>
+struct expr_op_add
+{
+    static SIMD_FUNC_INLINE typename vec_traits<T>::vtype apply(const typename vec_traits<T>::vtype va, const typename vec_traits<T>::vtype vb)
+    { return vec_traits<T>::add(va, vb); }
+};
+
+template <typename T>
+struct expr_op_sub
+{
+    static SIMD_FUNC_INLINE typename vec_traits<T>::vtype apply(const typename vec_traits<T>::vtype va, const typename vec_traits<T>::vtype vb)
+    { return vec_traits<T>::sub(va, vb); }
+};
+
+template <typename T>
+struct expr_op_mul
+{
+    static SIMD_FUNC_INLINE typename vec_traits<T>::vtype apply(const typename vec_traits<T>::vtype va, const typename vec_traits<T>::vtype vb)
+    { return vec_traits<T>::mul(va, vb); }
+};
+
+template <typename T>
+struct expr_op_div
+{
+    static SIMD_FUNC_INLINE typename vec_traits<T>::vtype apply(const typename vec_traits<T>::vtype va, const typename vec_traits<T>::vtype vb)
+    { return vec_traits<T>::div(va, vb); }
+};
+
+
+/***********
+ *  Nodes  *
+ ***********/
+//! Scalar broadcast to all elements
+template <typename T>
+class expr_scalar: public vexpr< T, expr_scalar<T> >
+{
+    private:
+        typename vec_traits<T>::vtype v;
+
+    public:
+        explicit expr_scalar(const T sa): v(vec_traits<T>::set(sa))
+        { }
+
+        SIMD_FUNC_INLINE size_t size() const
+        { return 0; }
+
+        SIMD_FUNC_INLINE typename vec_traits<T>::vtype load(const size_t, const size_t) const
+        { return v; }
+};
+
+//! Element-wise binary operation
+template <typename T, typename L, typename R, typename OP>
+class expr_binary: public vexpr< T, expr_binary<T, L, R, OP> >
+{
+    private:
+        typename expr_ref<L>::type l;
+        typename expr_ref<R>::type r;
+
+    public:
+        expr_binary(const L &la, const R &ra): l(la), r(ra)
+        { }
+
+        SIMD_FUNC_INLINE const L & lhs() const
+        { return l; }
+
+        SIMD_FUNC_INLINE const R & rhs() const
+        { return r; }
+
+        SIMD_FUNC_INLINE size_t size() const
+        { return l.size() ? l.size() : r.size(); }
+
+        SIMD_FUNC_INLINE typename vec_traits<T>::vtype load(const size_t i, const size_t n) const
+        { return OP::apply(l.load(i, n), r.load(i, n)); }
+};
+
+//! Contracted a * b + c (SUB = false) or a * b - c (SUB = true)
+template <typename T, typename A, typename B, typename C, bool SUB>
+class expr_fma: public vexpr< T, expr_fma<T, A, B, C, SUB> >
+{
+    private:
+        typename expr_ref<A>::type a;
+        typename expr_ref<B>::type b;
+        typename expr_ref<C>::type c;
+
+    public:
+        expr_fma(const A &aa, const B &ba, const C &ca): a(aa), b(ba), c(ca)
+        { }
+
+        SIMD_FUNC_INLINE size_t size() const
+        { return a.size() ? a.size() : (b.size() ? b.size() : c.size()); }
+
+        SIMD_FUNC_INLINE typename vec_traits<T>::vtype load(const size_t i, const size_t n) const
+        {
+            if (SUB)
+                return vec_traits<T>::fmsub(a.load(i, n), b.load(i, n), c.load(i, n));
+            return vec_traits<T>::fmadd(a.load(i, n), b.load(i, n), c.load(i, n));
+        }
+};
+
+
+/*!
+ *  \class varray
+ *  \brief Array of T elements that can be assigned array expressions
+ *
+ *  Arrays either own an aligned buffer or wrap user memory (no copy).
+ *  Assignment evaluates the expression in one pass: a partial vector peels
+ *  until the destination is aligned, full vectors are stored aligned, and a
+ *  partial vector handles the remainder.
+ *  Element-wise aliasing (a = a * b) is allowed, shifted views of the same
+ *  memory are not.
+ *  Owned buffers come from allocator policy A (heap_allocator,
+ *  pool_allocator or arena_allocator, see arena.h).
+ *  \note If allocation fails the array is empty, size() == 0
+ */
+template <typename T, typename A>
+class varray: public vexpr< T, varray<T, A> >
+{
+    public:
+        typedef T stype;
+        typedef vec_traits<T> traits;
+        typedef typename traits::vtype vtype;
+
+    private:
+        T *p;
+        size_t n;
+        bool owner;
+
+        void allocate(const size_t na)
+        {
+            p = NULL;
+            n = 0;
+            owner = true;
+            if (na > 0 && (p = (T *)A::allocate(na * sizeof(T))))
+                n = na;
+        }
+
+        template <typename E>
+        SIMD_FUNC_INLINE void eval(const E &e)
+        {
+            const size_t nstreams = traits::nstreams;
+            const size_t mis = ((size_t)p & (SIMD_WIDTH_BYTES - 1)) / sizeof(T);
+            size_t i = (mis) ? (nstreams - mis) : (0);
+            if (i > n)
+                i = n;
+            if (i > 0)
+                traits::storeu(p, e.load(0, i), i);
+            for (; i + nstreams <= n; i+=nstreams)
+                traits::store(p + i, e.load(i, nstreams), nstreams, false);
+            if (i < n)
+                traits::storeu(p + i, e.load(i, n - i), n - i);
+        }
+
+    public:
+        /******************
+         *  Constructors  *
+         ******************/
+        //! Allocates \c na uninitialized elements
+        explicit varray(const size_t na)
+        { allocate(na); }
+
+        //! Wraps \c na elements of user memory, which is not freed
+        varray(T * const sa, const size_t na): p(sa), n(na), owner(false)
+        { }
+
+        //! Copy constructor, always allocates
+        varray(const varray &va)
+        {
+            allocate(va.n);
+            eval(va);
+        }
+
+        //! Allocates and evaluates expression
+        template <typename E>
+        varray(const vexpr<T, E> &e)
+        {
+            allocate(e.self().size());
+            eval(e.self());
+        }
+
+        ~varray()
+        {
+            if (owner)
+                A::deallocate(p);
+        }
+
+        /*************
+         *  Get/set  *
+         *************/
+        SIMD_FUNC_INLINE size_t size() const
+        { return n; }
+
+        SIMD_FUNC_INLINE T * data()
+        { return p; }
+
+        SIMD_FUNC_INLINE const T * data() const
+        { return p; }
+
+        SIMD_FUNC_INLINE T & operator[](const size_t i)
+        { return p[i]; }
+
+        SIMD_FUNC_INLINE const T & operator[](const size_t i) const
+        { return p[i]; }
+
+        SIMD_FUNC_INLINE vtype load(const size_t i, const size_t nn) const
+        { return traits::loadu(p + i, nn); }
+
+        /****************
+         *  Assignment  *
+         ****************/
+        //! Sizes must match, elements are copied
+        varray & operator=(const varray &va)
+        {
+            if (this != &va)
+                eval(va);
+            return *this;
+        }
+
+        template <typename E>
+        SIMD_FUNC_INLINE varray & operator=(const vexpr<T, E> &e)
+        { eval(e.self()); return *this; }
+
+        //! Broadcast scalar to all elements
+        SIMD_FUNC_INLINE varray & operator=(const T sa)
+        { eval(expr_scalar<T>(sa)); return *this; }
+
+        template <typename E>
+        SIMD_FUNC_INLINE varray & operator+=(const vexpr<T, E> &e)
+        { eval(expr_binary<T, varray, E, expr_op_add<T> >(*this, e.self())); return *this; }
+
+        template <typename E>
+        SIMD_FUNC_INLINE varray & operator-=(const vexpr<T, E> &e)
+        { eval(expr_binary<T, varray, E, expr_op_sub<T> >(*this, e.self())); return *this; }
+
+        template <typename E>
+        SIMD_FUNC_INLINE varray & operator*=(const vexpr<T, E> &e)
+        { eval(expr_binary<T, varray, E, expr_op_mul<T> >(*this, e.self())); return *this; }
+
+        template <typename E>
+        SIMD_FUNC_INLINE varray & operator/=(const vexpr<T, E> &e)
+        { eval(expr_binary<T, varray, E, expr_op_div<T> >(*this, e.self())); return *this; }
+};
+
+
+/***************
+ *  Operators  *
+ ***************/
+#define EXPR_BINARY_OPERATOR(OPER, OP) \
+template <typename T, typename L, typename R> \
+static SIMD_FUNC_INLINE expr_binary<T, L, R, OP<T> > \
+operator OPER(const vexpr<T, L> &l, const vexpr<T, R> &r) \
+{ return expr_binary<T, L, R, OP<T> >(l.self(), r.self()); } \
+\
+template <typename T, typename L> \
+static SIMD_FUNC_INLINE expr_binary<T, L, expr_scalar<T>, OP<T> > \
+operator OPER(const vexpr<T, L> &l, const typename expr_scalar_type<T>::type sr) \
+{ return expr_binary<T, L, expr_scalar<T>, OP<T> >(l.self(), expr_scalar<T>(sr)); } \
+\
+template <typename T, typename R> \
+static SIMD_FUNC_INLINE expr_binary<T, expr_scalar<T>, R, OP<T> > \
+operator OPER(const typename expr_scalar_type<T>::type sl, const vexpr<T, R> &r) \
+{ return expr_binary<T, expr_scalar<T>, R, OP<T> >(expr_scalar<T>(sl), r.self()); }
+
+EXPR_BINARY_OPERATOR(+, expr_op_add)
+EXPR_BINARY_OPERATOR(-, expr_op_sub)
+EXPR_BINARY_OPERATOR(*, expr_op_mul)
+EXPR_BINARY_OPERATOR(/, expr_op_div)
+#undef EXPR_BINARY_OPERATOR
+
+/*
+ *  Multiply-add/subtract contraction, these overloads are more specialized
+ *  than the generic ones and are selected when an operand is a product.
+ *  \note c - a * b is not contracted
+ */
+template <typename T, typename A, typename B, typename R>
+static SIMD_FUNC_INLINE expr_fma<T, A, B, R, false>
+operator+(const vexpr<T, expr_binary<T, A, B, expr_op_mul<T> > > &l, const vexpr<T, R> &r)
+{ return expr_fma<T, A, B, R, false>(l.self().lhs(), l.self().rhs(), r.self()); }
+
+template <typename T, typename L, typename A, typename B>
+static SIMD_FUNC_INLINE expr_fma<T, A, B, L, false>
+operator+(const vexpr<T, L> &l, const vexpr<T, expr_binary<T, A, B, expr_op_mul<T> > > &r)
+{ return expr_fma<T, A, B, L, false>(r.self().lhs(), r.self().rhs(), l.self()); }
+
+template <typename T, typename A, typename B, typename C, typename D>
+static SIMD_FUNC_INLINE expr_fma<T, A, B, expr_binary<T, C, D, expr_op_mul<T> >, false>
+operator+(const vexpr<T, expr_binary<T, A, B, expr_op_mul<T> > > &l, const vexpr<T, expr_binary<T, C, D, expr_op_mul<T> > > &r)
+{ return expr_fma<T, A, B, expr_binary<T, C, D, expr_op_mul<T> >, false>(l.self().lhs(), l.self().rhs(), r.self()); }
+
+template <typename T, typename A, typename B, typename R>
+static SIMD_FUNC_INLINE expr_fma<T, A, B, R, true>
+operator-(const vexpr<T, expr_binary<T, A, B, expr_op_mul<T> > > &l, const vexpr<T, R> &r)
+{ return expr_fma<T, A, B, R, true>(l.self().lhs(), l.self().rhs(), r.self()); }
+
+
+typedef varray<int32_t> int32_a;
+typedef varray<float> flt32_a;
+typedef varray<double> flt64_a;
+
+
+}  // namespace gvl
+
+
+#endif  // _EXPR_H
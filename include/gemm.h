@@ -0,0 +1,359 @@
+/*!
+ *  \brief General matrix-matrix multiply, C = alpha * A * B + beta * C
+ *  Row-major single/double-precision matrices with leading dimensions.
+ *  Loops follow the BLIS layering:
+ *  - jc, columns of B and C in blocks of NC, packed B block fits in L3
+ *  - pc, inner dimension in blocks of KC, B micro-panel (KC x NR) fits in L1
+ *  - ic, rows of A and C in blocks of MC, packed A block fits in L2
+ *  - jr/ir, register tiles of MR x NR computed by the micro-kernel
+ *  A and B blocks are packed so the micro-kernel reads both with unit
+ *  stride, alpha is applied while packing A. Cache sizes are read from
+ *  SYSCONF (see sysconf.h) and tiles are chosen per SIMD interface to fill
+ *  its register file with accumulators.
+ *  \note Packing, and the B panels multiplied by each packed A block, are
+ *        distributed with the work-stealing pool (workpool.h)
+ */
+#ifndef _GEMM_H
+#define _GEMM_H
+
+
+#include <stdint.h>
+#include <stddef.h>   // size_t
+#include "simd.h"
+#include "sysconf.h"
+#include "dispatch.h"  // lane_traits, steal_parts_for
+#include "workpool.h"
+#include "arena.h"     // pool_malloc, pool_free
+
+
+namespace gvl {
+
+
+/*!
+ *  \class gemm_traits
+ *  \brief Micro-kernel tile of type T, mr rows by nv vectors (nr elements)
+ *  Accumulators take mr * nv registers, leaving registers for nv vectors
+ *  of B and a broadcast element of A:
+ *  - AVX-512, 14 x 2 vectors of 32 registers (14x32 single-precision)
+ *  - AVX/AVX2 and SSE, 6 x 2 vectors of 16 registers (6x16 on AVX2)
+ *  - AVX2x2 and generic, 6 x 1 vector (a vector may span two registers)
+ *  - scalar, 4 x 1 emulated vector
+ *  - MMX, 4 x 4 elements (floating-point vectors are scalar)
+ */
+template <typename T>
+struct gemm_traits;
+
+#if defined(SIMD_AVX512)
+#   define GEMM_MR 14
+#   define GEMM_NV 2
+#elif defined(SIMD_AVX2) || defined(SIMD_AVX) || defined(SIMD_SSE4_2) || defined(SIMD_SSE2)
+#   define GEMM_MR 6
+#   define GEMM_NV 2
+#elif defined(SIMD_AVX2X2) || defined(SIMD_GENERIC)
+#   define GEMM_MR 6
+#   define GEMM_NV 1
+#elif defined(SIMD_SCALAR)
+#   define GEMM_MR 4
+#   define GEMM_NV 1
+#else
+#   define GEMM_MR 4
+#   define GEMM_NV 4
+#endif
+
+template <>
+struct gemm_traits<float>: lane_traits<float>
+{
+    static const size_t mr = GEMM_MR;
+    static const size_t nv = GEMM_NV;
+    static const size_t nr = GEMM_NV * nlanes;
+};
+
+template <>
+struct gemm_traits<double>: lane_traits<double>
+{
+    static const size_t mr = GEMM_MR;
+    static const size_t nv = GEMM_NV;
+    static const size_t nr = GEMM_NV * nlanes;
+};
+
+#undef GEMM_MR
+#undef GEMM_NV
+
+/*!
+ *  \struct gemm_blocking
+ *  \brief Cache block sizes in elements, see gemm_block_sizes()
+ */
+struct gemm_blocking {
+    size_t mc;
+    size_t kc;
+    size_t nc;
+};
+
+/*!
+ *  Block sizes of type T from the cache sizes:
+ *  - KC, a B micro-panel of KC x NR takes half of L1
+ *  - MC, a packed A block of MC x KC takes half of L2, multiple of MR
+ *  - NC, a packed B block of KC x NC takes half of L3, multiple of NR
+ */
+template <typename T>
+static inline gemm_blocking gemm_block_sizes()
+{
+    typedef gemm_traits<T> tr;
+    gemm_blocking bs;
+    bs.kc = (SYSCONF::get_L1_sz() / 2) / (tr::nr * sizeof(T));
+    bs.kc = (bs.kc > 16) ? (bs.kc & ~(size_t)7) : (16);
+    bs.mc = ((SYSCONF::get_L2_sz() / 2) / (bs.kc * sizeof(T))) / tr::mr * tr::mr;
+    bs.mc = (bs.mc > tr::mr) ? (bs.mc) : (tr::mr);
+    bs.nc = ((SYSCONF::get_L3_sz() / 2) / (bs.kc * sizeof(T))) / tr::nr * tr::nr;
+    bs.nc = (bs.nc > tr::nr) ? (bs.nc) : (tr::nr);
+    return bs;
+}
+
+/*!
+ *  Micro-kernel, MR x NR tile of C from packed micro-panels of A (KC x MR)
+ *  and B (KC x NR). On the first KC block C is scaled by \c beta (not read
+ *  if 0), on later blocks the tile is accumulated into C.
+ */
+template <typename T>
+static SIMD_FUNC_INLINE void gemm_ukernel(const size_t kc, const T *pa, const T *pb, T * const sc, const size_t ldc,
+                                          const T beta, const bool first)
+{
+    typedef gemm_traits<T> tr;
+    typedef typename tr::vtype vtype;
+
+    vtype vc[tr::mr][tr::nv];
+    for (size_t i = 0; i < tr::mr; ++i)
+        for (size_t v = 0; v < tr::nv; ++v)
+            simd_set_zero(&vc[i][v]);
+
+    for (size_t p = 0; p < kc; ++p) {
+        vtype vb[tr::nv];
+        for (size_t v = 0; v < tr::nv; ++v)
+            vb[v] = simd_load(pb + v * tr::nlanes);
+        for (size_t i = 0; i < tr::mr; ++i) {
+            const vtype va = simd_set(pa[i]);
+            for (size_t v = 0; v < tr::nv; ++v)
+                vc[i][v] = simd_fmadd(va, vb[v], vc[i][v]);
+        }
+        pa += tr::mr;
+        pb += tr::nr;
+    }
+
+    if (!first) {
+        for (size_t i = 0; i < tr::mr; ++i)
+            for (size_t v = 0; v < tr::nv; ++v)
+                simd_storeu(sc + i * ldc + v * tr::nlanes, simd_add(simd_loadu(sc + i * ldc + v * tr::nlanes), vc[i][v]));
+    }
+    else if (beta != (T)0) {
+        const vtype vbeta = simd_set(beta);
+        for (size_t i = 0; i < tr::mr; ++i)
+            for (size_t v = 0; v < tr::nv; ++v)
+                simd_storeu(sc + i * ldc + v * tr::nlanes, simd_fmadd(vbeta, simd_loadu(sc + i * ldc + v * tr::nlanes), vc[i][v]));
+    }
+    else {
+        for (size_t i = 0; i < tr::mr; ++i)
+            for (size_t v = 0; v < tr::nv; ++v)
+                simd_storeu(sc + i * ldc + v * tr::nlanes, vc[i][v]);
+    }
+}
+
+/*!
+ *  Micro-kernel on an edge tile of \c mr x \c nr elements, computed in an
+ *  aligned buffer and merged into C
+ */
+template <typename T>
+static void gemm_ukernel_edge(const size_t kc, const T * const pa, const T * const pb, T * const sc, const size_t ldc,
+                              const T beta, const bool first, const size_t mr, const size_t nr)
+{
+    typedef gemm_traits<T> tr;
+    T ct[tr::mr * tr::nr] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    gemm_ukernel(kc, pa, pb, ct, tr::nr, (T)0, true);
+    for (size_t i = 0; i < mr; ++i)
+        for (size_t j = 0; j < nr; ++j) {
+            T * const c = sc + i * ldc + j;
+            if (!first)
+                *c += ct[i * tr::nr + j];
+            else if (beta != (T)0)
+                *c = beta * *c + ct[i * tr::nr + j];
+            else
+                *c = ct[i * tr::nr + j];
+        }
+}
+
+/*!
+ *  Range functor packing MR-row panels [lo, hi) of an A block (rows x kc),
+ *  panels are kc x MR scaled by alpha, rows past \c rows are zeroed
+ */
+template <typename T>
+struct gemm_pack_a_range
+{
+    T * const pa;
+    const T * const sa;
+    const size_t lda;
+    const size_t rows;
+    const size_t kc;
+    const T alpha;
+
+    gemm_pack_a_range(T * const p, const T * const a, const size_t ld, const size_t r, const size_t k, const T al):
+        pa(p), sa(a), lda(ld), rows(r), kc(k), alpha(al)
+    { }
+
+    void operator()(const size_t lo, const size_t hi) const
+    {
+        const size_t mr = gemm_traits<T>::mr;
+        for (size_t r = lo; r < hi; ++r) {
+            T * const dst = pa + r * mr * kc;
+            const size_t i0 = r * mr;
+            const size_t ni = (rows - i0 < mr) ? (rows - i0) : (mr);
+            for (size_t i = 0; i < ni; ++i) {
+                const T * const src = sa + (i0 + i) * lda;
+                for (size_t p = 0; p < kc; ++p)
+                    dst[p * mr + i] = alpha * src[p];
+            }
+            for (size_t i = ni; i < mr; ++i)
+                for (size_t p = 0; p < kc; ++p)
+                    dst[p * mr + i] = (T)0;
+        }
+    }
+};
+
+/*!
+ *  Range functor packing NR-column panels [lo, hi) of a B block (kc x cols),
+ *  panels are kc x NR, columns past \c cols are zeroed
+ */
+template <typename T>
+struct gemm_pack_b_range
+{
+    T * const pb;
+    const T * const sb;
+    const size_t ldb;
+    const size_t cols;
+    const size_t kc;
+
+    gemm_pack_b_range(T * const p, const T * const b, const size_t ld, const size_t c, const size_t k):
+        pb(p), sb(b), ldb(ld), cols(c), kc(k)
+    { }
+
+    void operator()(const size_t lo, const size_t hi) const
+    {
+        const size_t nr = gemm_traits<T>::nr;
+        for (size_t q = lo; q < hi; ++q) {
+            T * const dst = pb + q * nr * kc;
+            const size_t j0 = q * nr;
+            const size_t nj = (cols - j0 < nr) ? (cols - j0) : (nr);
+            for (size_t p = 0; p < kc; ++p) {
+                const T * const src = sb + p * ldb + j0;
+                for (size_t j = 0; j < nj; ++j)
+                    dst[p * nr + j] = src[j];
+                for (size_t j = nj; j < nr; ++j)
+                    dst[p * nr + j] = (T)0;
+            }
+        }
+    }
+};
+
+/*!
+ *  Range functor of the macro-kernel, tasks [lo, hi) are NR column panels
+ *  of the packed B block, each multiplied by the whole packed A block
+ */
+template <typename T>
+struct gemm_macro_range
+{
+    T * const sc;
+    const size_t ldc;
+    const T * const pa;
+    const T * const pb;
+    const size_t rows;
+    const size_t cols;
+    const size_t kc;
+    const T beta;
+    const bool first;
+
+    gemm_macro_range(T * const c, const size_t ld, const T * const a, const T * const b, const size_t r, const size_t cl,
+                     const size_t k, const T bt, const bool f):
+        sc(c), ldc(ld), pa(a), pb(b), rows(r), cols(cl), kc(k), beta(bt), first(f)
+    { }
+
+    void operator()(const size_t lo, const size_t hi) const
+    {
+        const size_t mr = gemm_traits<T>::mr;
+        const size_t nr = gemm_traits<T>::nr;
+        for (size_t q = lo; q < hi; ++q) {
+            const size_t j0 = q * nr;
+            const size_t nj = (cols - j0 < nr) ? (cols - j0) : (nr);
+            const T * const b = pb + j0 * kc;
+            for (size_t i = 0; i < rows; i += mr) {
+                const T * const a = pa + i * kc;
+                const size_t ni = (rows - i < mr) ? (rows - i) : (mr);
+                if (ni == mr && nj == nr)
+                    gemm_ukernel(kc, a, b, sc + i * ldc + j0, ldc, beta, first);
+                else
+                    gemm_ukernel_edge(kc, a, b, sc + i * ldc + j0, ldc, beta, first, ni, nj);
+            }
+        }
+    }
+};
+
+/*!
+ *  C = alpha * A * B + beta * C for row-major matrices, A is m x k, B is
+ *  k x n and C is m x n. If \c beta is 0, C is not read.
+ *  \param[in] run_par Packing and tiles are scheduled among the OpenMP
+ *             threads set by SYSCONF
+ *  \return 0 if successful, else packing buffers could not be allocated
+ */
+template <typename T>
+static int gemm(T * const sc, const size_t ldc, const T * const sa, const size_t lda, const T * const sb, const size_t ldb,
+                const size_t m, const size_t n, const size_t k, const T alpha = (T)1, const T beta = (T)0, const bool run_par = false)
+{
+    typedef gemm_traits<T> tr;
+    if (m == 0 || n == 0)
+        return 0;
+
+    // Empty product only scales C
+    if (k == 0 || alpha == (T)0) {
+        for (size_t i = 0; i < m; ++i)
+            for (size_t j = 0; j < n; ++j)
+                sc[i * ldc + j] = (beta != (T)0) ? (beta * sc[i * ldc + j]) : ((T)0);
+        return 0;
+    }
+
+    const gemm_blocking bs = gemm_block_sizes<T>();
+    const size_t kc_max = (k < bs.kc) ? (k) : (bs.kc);
+    const size_t nc_max = (n < bs.nc) ? (n) : (bs.nc);
+    const size_t mc_max = (m < bs.mc) ? (m) : (bs.mc);
+    T * const pa = (T *)pool_malloc(((mc_max + tr::mr - 1) / tr::mr) * tr::mr * kc_max * sizeof(T));
+    T * const pb = (T *)pool_malloc(((nc_max + tr::nr - 1) / tr::nr) * tr::nr * kc_max * sizeof(T));
+    if (!pa || !pb) {
+        pool_free(pa);
+        pool_free(pb);
+        return -1;
+    }
+
+    // Each MC x KC block of A is packed once and used by all panels of the
+    // packed B block while it stays in L2
+    const int32_t nthreads = ((SYSCONF::get_omp() & run_par) == true) ? (SYSCONF::get_threads()) : (1);
+    for (size_t jc = 0; jc < n; jc += bs.nc) {
+        const size_t nc = (n - jc < bs.nc) ? (n - jc) : (bs.nc);
+        const size_t npanels = (nc + tr::nr - 1) / tr::nr;
+        for (size_t pc = 0; pc < k; pc += bs.kc) {
+            const size_t kc = (k - pc < bs.kc) ? (k - pc) : (bs.kc);
+            steal_parts_for(npanels, gemm_pack_b_range<T>(pb, sb + pc * ldb + jc, ldb, nc, kc), nthreads);
+            for (size_t ic = 0; ic < m; ic += bs.mc) {
+                const size_t mc = (m - ic < bs.mc) ? (m - ic) : (bs.mc);
+                const size_t mpanels = (mc + tr::mr - 1) / tr::mr;
+                steal_parts_for(mpanels, gemm_pack_a_range<T>(pa, sa + ic * lda + pc, lda, mc, kc, alpha), nthreads);
+                steal_parts_for(npanels, gemm_macro_range<T>(sc + ic * ldc + jc, ldc, pa, pb, mc, nc, kc, beta, pc == 0), nthreads);
+            }
+        }
+    }
+
+    pool_free(pa);
+    pool_free(pb);
+    return 0;
+}
+
+
+}  // namespace gvl
+
+
+#endif  // _GEMM_H
@@ -0,0 +1,1822 @@
+/*!
+ *  \defgroup GENERIC Generic
+ *  \brief SIMD interface using GCC/Clang vector extensions (configurable width)
+ *
+ *  Vector registers are declared with __attribute__((vector_size(N))) and
+ *  lowered by the compiler to the vector units enabled by the compiler flags.
+ *  Widths larger than the native registers are split into multiple registers,
+ *  which exposes extra instruction-level parallelism.
+ *
+ *  Width is selected with SIMD_GENERIC_BYTES (16, 32, 64, or 128), by default
+ *  the width of the widest vector unit enabled.
+ *
+ *  Operations follow the SSE4.2 interface extended to the full register width:
+ *  "halves" refer to the full register, except 128-bit shifts which operate
+ *  on each 128-bit block (as in AVX2).
+ *
+ *  Interface Legend:\n
+ *  simd_*_iXX = signed XX-bit integers\n
+ *  simd_*_uXX = unsigned XX-bit integers\n
+ *  simd_*_fXX = floating-point XX-bit elements\n
+ *  simd_*_XX  = unsigned/signed XX-bit integers\n
+ *  simd_*_XX  = (set functions) specifies width to consider for integer types\n
+ *  simd_*     = datatype obtained from function overloading and parameters
+ */
+#ifndef _GENERIC_H
+#define _GENERIC_H
+
+
+#include "compiler_attributes.h"
+#include "compiler_builtins.h"
+#include <stdint.h>
+#include <stddef.h>   // size_t
+#include <string.h>   // memcpy
+#include <math.h>     // lrint
+
+
+#if !defined(__GNUC__)
+#   error "Generic SIMD interface requires GCC/Clang vector extensions."
+#endif
+
+
+#if !defined(SIMD_GENERIC_BYTES)
+#   if defined(__AVX512F__)
+#       define SIMD_GENERIC_BYTES 64
+#   elif defined(__AVX__)
+#       define SIMD_GENERIC_BYTES 32
+#   else
+#       define SIMD_GENERIC_BYTES 16
+#   endif
+#endif
+
+#if SIMD_GENERIC_BYTES != 16 && SIMD_GENERIC_BYTES != 32 && SIMD_GENERIC_BYTES != 64 && SIMD_GENERIC_BYTES != 128
+#   error "SIMD_GENERIC_BYTES has to be 16, 32, 64, or 128."
+#endif
+
+
+#ifndef _SHUFFLE_CTRL_
+#define _SHUFFLE_CTRL_
+/*!
+ *  Control values for shuffle operations
+ *  \todo Move this enum to a global area, all SIMD modes will use it
+ */
+enum SHUFFLE_CTRL { XCHG = 0, // Exchange lower/upper halfs of register
+                    XCHG8,    // Exchange pairs of 8-bit elements
+                    XCHG16,   // Exchange pairs of 16-bit elements
+                    XCHG32,   // Exchange pairs of 32-bit elements
+                    XCHG64,   // Exchange pairs of 64-bit elements
+                    DUPL,     // Duplicate lower half into upper half of register
+                    DUPH };   // Duplicate upper half into lower half of register
+#endif
+
+
+/*
+ *  Vectors wider than the enabled vector units are passed in memory.
+ *  Interface functions are inlined and user code passing SIMD types by value
+ *  is compiled with the same flags, so the ABI note is silenced for the
+ *  rest of the translation unit.
+ */
+#if !defined(__clang__)
+#   pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+
+namespace gvl {
+namespace generic {
+
+
+const int32_t SIMD_WIDTH_BITS = SIMD_GENERIC_BYTES * 8;
+const int32_t SIMD_WIDTH_BYTES = SIMD_GENERIC_BYTES;
+const int32_t SIMD_STREAMS_8 = SIMD_WIDTH_BYTES;
+const int32_t SIMD_STREAMS_16 = SIMD_WIDTH_BYTES / 2;
+const int32_t SIMD_STREAMS_32 = SIMD_WIDTH_BYTES / 4;
+const int32_t SIMD_STREAMS_64 = SIMD_WIDTH_BYTES / 8;
+
+/*
+ *  Element views of a vector register, converted with C-style casts
+ *  (bitwise reinterpretation). Integer arithmetic uses unsigned views
+ *  so overflow wraps around as in vector units.
+ */
+typedef int8_t   vi8_t  __attribute__((__vector_size__(SIMD_GENERIC_BYTES)));
+typedef uint8_t  vu8_t  __attribute__((__vector_size__(SIMD_GENERIC_BYTES)));
+typedef int16_t  vi16_t __attribute__((__vector_size__(SIMD_GENERIC_BYTES)));
+typedef uint16_t vu16_t __attribute__((__vector_size__(SIMD_GENERIC_BYTES)));
+typedef int32_t  vi32_t __attribute__((__vector_size__(SIMD_GENERIC_BYTES)));
+typedef uint32_t vu32_t __attribute__((__vector_size__(SIMD_GENERIC_BYTES)));
+typedef int64_t  vi64_t __attribute__((__vector_size__(SIMD_GENERIC_BYTES)));
+typedef uint64_t vu64_t __attribute__((__vector_size__(SIMD_GENERIC_BYTES)));
+typedef float    vf32_t __attribute__((__vector_size__(SIMD_GENERIC_BYTES)));
+typedef double   vf64_t __attribute__((__vector_size__(SIMD_GENERIC_BYTES)));
+
+typedef vi64_t SIMD_INT;
+typedef vf32_t SIMD_FLT;
+typedef vf64_t SIMD_DBL;
+
+
+/***********************
+ *  Misc instructions  *
+ ***********************/
+static SIMD_FUNC_INLINE
+void simd_prefetch(const void *sa, const int32_t hint = 0)
+{
+    switch (hint) {
+        case 1: __prefetchw((char *)sa); break;
+        default: __prefetchr((char *)sa); break;
+    }
+}
+
+
+/*****************************
+ *  Arithmetic instructions  *
+ *****************************/
+static SIMD_FUNC_INLINE
+SIMD_INT simd_add_8(const SIMD_INT va, const SIMD_INT vb)
+{ return (SIMD_INT)((vu8_t)va + (vu8_t)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_add_16(const SIMD_INT va, const SIMD_INT vb)
+{ return (SIMD_INT)((vu16_t)va + (vu16_t)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_add_32(const SIMD_INT va, const SIMD_INT vb)
+{ return (SIMD_INT)((vu32_t)va + (vu32_t)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_add_64(const SIMD_INT va, const SIMD_INT vb)
+{ return (SIMD_INT)((vu64_t)va + (vu64_t)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_add(const SIMD_FLT va, const SIMD_FLT vb)
+{ return va + vb; }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_add(const SIMD_DBL va, const SIMD_DBL vb)
+{ return va + vb; }
+
+/*!
+ *  Horizontal operations store pairwise results from first operand in lower
+ *  half and from second operand in upper half.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_hadd_16(const SIMD_INT va, const SIMD_INT vb)
+{
+    const int32_t mid = SIMD_STREAMS_16 / 2;
+    const vu16_t va16 = (vu16_t)va, vb16 = (vu16_t)vb;
+    vu16_t vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va16[2 * i] + va16[2 * i + 1];
+        vc[i + mid] = vb16[2 * i] + vb16[2 * i + 1];
+    }
+    return (SIMD_INT)vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_hadd_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    const vu32_t va32 = (vu32_t)va, vb32 = (vu32_t)vb;
+    vu32_t vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va32[2 * i] + va32[2 * i + 1];
+        vc[i + mid] = vb32[2 * i] + vb32[2 * i + 1];
+    }
+    return (SIMD_INT)vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_hadd(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va[2 * i] + va[2 * i + 1];
+        vc[i + mid] = vb[2 * i] + vb[2 * i + 1];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_hadd(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va[2 * i] + va[2 * i + 1];
+        vc[i + mid] = vb[2 * i] + vb[2 * i + 1];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sub_8(const SIMD_INT va, const SIMD_INT vb)
+{ return (SIMD_INT)((vu8_t)va - (vu8_t)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sub_16(const SIMD_INT va, const SIMD_INT vb)
+{ return (SIMD_INT)((vu16_t)va - (vu16_t)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sub_32(const SIMD_INT va, const SIMD_INT vb)
+{ return (SIMD_INT)((vu32_t)va - (vu32_t)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sub_64(const SIMD_INT va, const SIMD_INT vb)
+{ return (SIMD_INT)((vu64_t)va - (vu64_t)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_sub(const SIMD_FLT va, const SIMD_FLT vb)
+{ return va - vb; }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_sub(const SIMD_DBL va, const SIMD_DBL vb)
+{ return va - vb; }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_hsub_16(const SIMD_INT va, const SIMD_INT vb)
+{
+    const int32_t mid = SIMD_STREAMS_16 / 2;
+    const vu16_t va16 = (vu16_t)va, vb16 = (vu16_t)vb;
+    vu16_t vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va16[2 * i] - va16[2 * i + 1];
+        vc[i + mid] = vb16[2 * i] - vb16[2 * i + 1];
+    }
+    return (SIMD_INT)vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_hsub_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    const vu32_t va32 = (vu32_t)va, vb32 = (vu32_t)vb;
+    vu32_t vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va32[2 * i] - va32[2 * i + 1];
+        vc[i + mid] = vb32[2 * i] - vb32[2 * i + 1];
+    }
+    return (SIMD_INT)vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_hsub(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va[2 * i] - va[2 * i + 1];
+        vc[i + mid] = vb[2 * i] - vb[2 * i + 1];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_hsub(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va[2 * i] - va[2 * i + 1];
+        vc[i + mid] = vb[2 * i] - vb[2 * i + 1];
+    }
+    return vc;
+}
+
+//! \note Contracted into FMA instructions when enabled (-mfma)
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_fmadd(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc)
+{ return va * vb + vc; }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_fmadd(const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc)
+{ return va * vb + vc; }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_fmsub(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc)
+{ return va * vb - vc; }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_fmsub(const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc)
+{ return va * vb - vc; }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_16(const SIMD_INT va, const SIMD_INT vb)
+{ return (SIMD_INT)((vu16_t)va * (vu16_t)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_32(const SIMD_INT va, const SIMD_INT vb)
+{ return (SIMD_INT)((vu32_t)va * (vu32_t)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_64(const SIMD_INT va, const SIMD_INT vb)
+{ return (SIMD_INT)((vu64_t)va * (vu64_t)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_mul(const SIMD_FLT va, const SIMD_FLT vb)
+{ return va * vb; }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_mul(const SIMD_DBL va, const SIMD_DBL vb)
+{ return va * vb; }
+
+/*!
+ *  Widening multiplications use the even elements of the operands,
+ *  extended in place within the wider elements.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_i16_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    const vi32_t va32 = (vi32_t)((vu32_t)va << 16) >> 16;
+    const vi32_t vb32 = (vi32_t)((vu32_t)vb << 16) >> 16;
+    return (SIMD_INT)(va32 * vb32);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_i32_64(const SIMD_INT va, const SIMD_INT vb)
+{
+    const vi64_t va64 = (vi64_t)((vu64_t)va << 32) >> 32;
+    const vi64_t vb64 = (vi64_t)((vu64_t)vb << 32) >> 32;
+    return va64 * vb64;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_u16_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    const vu32_t vmsk = (vu32_t)simd_sub_32(va, va) + 0xFFFF;
+    return (SIMD_INT)(((vu32_t)va & vmsk) * ((vu32_t)vb & vmsk));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_u32_64(const SIMD_INT va, const SIMD_INT vb)
+{
+    const vu64_t vmsk = (vu64_t)simd_sub_64(va, va) + 0xFFFFFFFF;
+    return (SIMD_INT)(((vu64_t)va & vmsk) * ((vu64_t)vb & vmsk));
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_div(const SIMD_FLT va, const SIMD_FLT vb)
+{ return va / vb; }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_div(const SIMD_DBL va, const SIMD_DBL vb)
+{ return va / vb; }
+
+//! \note Compilers lower sqrt of each element to vector instructions
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_sqrt(const SIMD_FLT va)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc[i] = __builtin_sqrtf(va[i]);
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_sqrt(const SIMD_DBL va)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc[i] = __builtin_sqrt(va[i]);
+    return vc;
+}
+
+
+/**************************
+ *  Logical instructions  *
+ **************************/
+static SIMD_FUNC_INLINE
+SIMD_INT simd_and(const SIMD_INT va, const SIMD_INT vb)
+{ return va & vb; }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_and(const SIMD_FLT va, const SIMD_INT vb)
+{
+    //! \note Used to mask vector elements
+    return (SIMD_FLT)((SIMD_INT)va & vb);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_and(const SIMD_DBL va, const SIMD_INT vb)
+{
+    //! \note Used to mask vector elements
+    return (SIMD_DBL)((SIMD_INT)va & vb);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_or(const SIMD_INT va, const SIMD_INT vb)
+{ return va | vb; }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_xor(const SIMD_INT va, const SIMD_INT vb)
+{ return va ^ vb; }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_and(const SIMD_FLT va, const SIMD_FLT vb)
+{ return (SIMD_FLT)((SIMD_INT)va & (SIMD_INT)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_and(const SIMD_DBL va, const SIMD_DBL vb)
+{ return (SIMD_DBL)((SIMD_INT)va & (SIMD_INT)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_or(const SIMD_FLT va, const SIMD_FLT vb)
+{ return (SIMD_FLT)((SIMD_INT)va | (SIMD_INT)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_or(const SIMD_DBL va, const SIMD_DBL vb)
+{ return (SIMD_DBL)((SIMD_INT)va | (SIMD_INT)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_xor(const SIMD_FLT va, const SIMD_FLT vb)
+{ return (SIMD_FLT)((SIMD_INT)va ^ (SIMD_INT)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_xor(const SIMD_DBL va, const SIMD_DBL vb)
+{ return (SIMD_DBL)((SIMD_INT)va ^ (SIMD_INT)vb); }
+
+/*!
+ *  Shift counts larger than the element width produce zero,
+ *  same as vector units.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sll_16(const SIMD_INT va, const int8_t shft)
+{
+    const uint8_t s = (uint8_t)shft;
+    return (s < 16) ? (SIMD_INT)((vu16_t)va << s) : (va ^ va);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sll_32(const SIMD_INT va, const int8_t shft)
+{
+    const uint8_t s = (uint8_t)shft;
+    return (s < 32) ? (SIMD_INT)((vu32_t)va << s) : (va ^ va);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sll_64(const SIMD_INT va, const int8_t shft)
+{
+    const uint8_t s = (uint8_t)shft;
+    return (s < 64) ? (SIMD_INT)((vu64_t)va << s) : (va ^ va);
+}
+
+//! \note Shift bytes within each 128-bit block
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sll_128(const SIMD_INT va, const int8_t shft)
+{
+    const int32_t s = (uint8_t)shft;
+    const vu8_t va8 = (vu8_t)va;
+    vu8_t vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i)
+        vc[i] = ((i & 15) >= s) ? va8[i - s] : 0;
+    return (SIMD_INT)vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_srl_16(const SIMD_INT va, const int8_t shft)
+{
+    const uint8_t s = (uint8_t)shft;
+    return (s < 16) ? (SIMD_INT)((vu16_t)va >> s) : (va ^ va);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_srl_32(const SIMD_INT va, const int8_t shft)
+{
+    const uint8_t s = (uint8_t)shft;
+    return (s < 32) ? (SIMD_INT)((vu32_t)va >> s) : (va ^ va);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_srl_64(const SIMD_INT va, const int8_t shft)
+{
+    const uint8_t s = (uint8_t)shft;
+    return (s < 64) ? (SIMD_INT)((vu64_t)va >> s) : (va ^ va);
+}
+
+//! \note Shift bytes within each 128-bit block
+static SIMD_FUNC_INLINE
+SIMD_INT simd_srl_128(const SIMD_INT va, const int8_t shft)
+{
+    const int32_t s = (uint8_t)shft;
+    const vu8_t va8 = (vu8_t)va;
+    vu8_t vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i)
+        vc[i] = ((i & 15) + s < 16) ? va8[i + s] : 0;
+    return (SIMD_INT)vc;
+}
+
+
+/**************************
+ *  Compare instructions  *
+ **************************/
+/*!
+ *  Comparisons set all bits of elements where the condition holds
+ *  and clear them otherwise, results are used as masks.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmpeq_32(const SIMD_INT va, const SIMD_INT vb)
+{ return (SIMD_INT)((vi32_t)va == (vi32_t)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmpgt_i32(const SIMD_INT va, const SIMD_INT vb)
+{ return (SIMD_INT)((vi32_t)va > (vi32_t)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmplt_i32(const SIMD_INT va, const SIMD_INT vb)
+{ return (SIMD_INT)((vi32_t)va < (vi32_t)vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpeq(const SIMD_FLT va, const SIMD_FLT vb)
+{ return (SIMD_FLT)(va == vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpeq(const SIMD_DBL va, const SIMD_DBL vb)
+{ return (SIMD_DBL)(va == vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpneq(const SIMD_FLT va, const SIMD_FLT vb)
+{ return (SIMD_FLT)(va != vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpneq(const SIMD_DBL va, const SIMD_DBL vb)
+{ return (SIMD_DBL)(va != vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmplt(const SIMD_FLT va, const SIMD_FLT vb)
+{ return (SIMD_FLT)(va < vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmplt(const SIMD_DBL va, const SIMD_DBL vb)
+{ return (SIMD_DBL)(va < vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmple(const SIMD_FLT va, const SIMD_FLT vb)
+{ return (SIMD_FLT)(va <= vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmple(const SIMD_DBL va, const SIMD_DBL vb)
+{ return (SIMD_DBL)(va <= vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpgt(const SIMD_FLT va, const SIMD_FLT vb)
+{ return (SIMD_FLT)(va > vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpgt(const SIMD_DBL va, const SIMD_DBL vb)
+{ return (SIMD_DBL)(va > vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpge(const SIMD_FLT va, const SIMD_FLT vb)
+{ return (SIMD_FLT)(va >= vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpge(const SIMD_DBL va, const SIMD_DBL vb)
+{ return (SIMD_DBL)(va >= vb); }
+
+/*!
+ *  Select elements from second operand where mask is set,
+ *  otherwise select elements from first operand.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_blend(const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vmsk)
+{ return (va & ~vmsk) | (vb & vmsk); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_blend(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vmsk)
+{ return (SIMD_FLT)simd_blend((SIMD_INT)va, (SIMD_INT)vb, (SIMD_INT)vmsk); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_blend(const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vmsk)
+{ return (SIMD_DBL)simd_blend((SIMD_INT)va, (SIMD_INT)vb, (SIMD_INT)vmsk); }
+
+
+/*********************************
+ *  Merge and pack instructions  *
+ *********************************/
+/*!
+ *  Merge low/high halves of first operand into lower half
+ *  and low/high halves of second operand into upper half.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_merge_lo(const SIMD_INT va, const SIMD_INT vb)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va[i];
+        vc[i + mid] = vb[i];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_merge_lo(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va[i];
+        vc[i + mid] = vb[i];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_merge_lo(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va[i];
+        vc[i + mid] = vb[i];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_merge_hi(const SIMD_INT va, const SIMD_INT vb)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va[i + mid];
+        vc[i + mid] = vb[i + mid];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_merge_hi(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va[i + mid];
+        vc[i + mid] = vb[i + mid];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_merge_hi(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va[i + mid];
+        vc[i + mid] = vb[i + mid];
+    }
+    return vc;
+}
+
+
+/**************************
+ *  Shuffle instructions  *
+ **************************/
+/*!
+ *  Pack even elements into lower half and odd elements into upper half.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_pack_8(const SIMD_INT va)
+{
+    const int32_t mid = SIMD_STREAMS_8 / 2;
+    const vu8_t va8 = (vu8_t)va;
+    vu8_t vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va8[2 * i];
+        vc[i + mid] = va8[2 * i + 1];
+    }
+    return (SIMD_INT)vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_pack_16(const SIMD_INT va)
+{
+    const int32_t mid = SIMD_STREAMS_16 / 2;
+    const vu16_t va16 = (vu16_t)va;
+    vu16_t vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va16[2 * i];
+        vc[i + mid] = va16[2 * i + 1];
+    }
+    return (SIMD_INT)vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_pack_32(const SIMD_INT va)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    const vu32_t va32 = (vu32_t)va;
+    vu32_t vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va32[2 * i];
+        vc[i + mid] = va32[2 * i + 1];
+    }
+    return (SIMD_INT)vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_pack(const SIMD_FLT va)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc[i] = va[2 * i];
+        vc[i + mid] = va[2 * i + 1];
+    }
+    return vc;
+}
+
+//! \note Shuffle assumes that vector register width is a multiple of 32
+static SIMD_FUNC_INLINE
+SIMD_INT simd_shuffle(const SIMD_INT va, const SHUFFLE_CTRL ctrl)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_INT vc = va;
+    switch (ctrl) {
+        case XCHG:
+            for (int32_t i = 0; i < mid; ++i) {
+                vc[i] = va[i + mid];
+                vc[i + mid] = va[i];
+            }
+            break;
+        case XCHG8:
+            vc = (SIMD_INT)(((vu16_t)va << 8) | ((vu16_t)va >> 8));
+            break;
+        case XCHG16:
+            vc = (SIMD_INT)(((vu32_t)va << 16) | ((vu32_t)va >> 16));
+            break;
+        case XCHG32:
+            vc = (SIMD_INT)(((vu64_t)va << 32) | ((vu64_t)va >> 32));
+            break;
+        case XCHG64:
+            for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+                vc[i] = va[i ^ 1];
+            break;
+        case DUPL:
+            for (int32_t i = 0; i < mid; ++i)
+                vc[i + mid] = va[i];
+            break;
+        case DUPH:
+            for (int32_t i = 0; i < mid; ++i)
+                vc[i] = va[i + mid];
+            break;
+        default: break;
+    }
+    return vc;
+}
+
+//! \note Shuffle assumes that vector register width is a multiple of 32
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_shuffle(const SIMD_FLT va, const SHUFFLE_CTRL ctrl)
+{
+    switch (ctrl) {
+        case XCHG: return (SIMD_FLT)simd_shuffle((SIMD_INT)va, XCHG); break;
+        case XCHG32: return (SIMD_FLT)simd_shuffle((SIMD_INT)va, XCHG32); break;
+        case XCHG64: return (SIMD_FLT)simd_shuffle((SIMD_INT)va, XCHG64); break;
+        case DUPL: return (SIMD_FLT)simd_shuffle((SIMD_INT)va, DUPL); break;
+        case DUPH: return (SIMD_FLT)simd_shuffle((SIMD_INT)va, DUPH); break;
+        default: return va; break;
+    }
+}
+
+//! \note Shuffle assumes that vector register width is a multiple of 32
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_shuffle(const SIMD_DBL va, const SHUFFLE_CTRL ctrl)
+{
+    switch (ctrl) {
+        case XCHG: return (SIMD_DBL)simd_shuffle((SIMD_INT)va, XCHG); break;
+        case XCHG64: return (SIMD_DBL)simd_shuffle((SIMD_INT)va, XCHG64); break;
+        case DUPL: return (SIMD_DBL)simd_shuffle((SIMD_INT)va, DUPL); break;
+        case DUPH: return (SIMD_DBL)simd_shuffle((SIMD_INT)va, DUPH); break;
+        default: return va; break;
+    }
+}
+
+
+/**************************
+ *  Convert instructions  *
+ **************************/
+/*!
+ *  Widening conversions use the lower elements of the operand,
+ *  narrowing conversions set the upper elements to zero.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_i16_i32(const SIMD_INT va)
+{
+    const vi16_t va16 = (vi16_t)va;
+    vi32_t vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc[i] = va16[i];
+    return (SIMD_INT)vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_i32_i64(const SIMD_INT va)
+{
+    const vi32_t va32 = (vi32_t)va;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc[i] = va32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_i32_f32(const SIMD_INT va)
+{ return __builtin_convertvector((vi32_t)va, SIMD_FLT); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_i32_f64(const SIMD_INT va)
+{
+    const vi32_t va32 = (vi32_t)va;
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc[i] = (double)va32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_i64_f32(const SIMD_INT va)
+{
+    SIMD_FLT vc = (SIMD_FLT)(va ^ va);
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc[i] = (float)va[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_i64_f64(const SIMD_INT va)
+{ return __builtin_convertvector(va, SIMD_DBL); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_u16_i32(const SIMD_INT va)
+{
+    const vu16_t va16 = (vu16_t)va;
+    vi32_t vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc[i] = va16[i];
+    return (SIMD_INT)vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_u32_i64(const SIMD_INT va)
+{
+    const vu32_t va32 = (vu32_t)va;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc[i] = va32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_u32_f32(const SIMD_INT va)
+{ return __builtin_convertvector((vu32_t)va, SIMD_FLT); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_u32_f64(const SIMD_INT va)
+{
+    const vu32_t va32 = (vu32_t)va;
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc[i] = (double)va32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_u64_f32(const SIMD_INT va)
+{
+    const vu64_t va64 = (vu64_t)va;
+    SIMD_FLT vc = (SIMD_FLT)(va ^ va);
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc[i] = (float)va64[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_u64_f64(const SIMD_INT va)
+{ return __builtin_convertvector((vu64_t)va, SIMD_DBL); }
+
+//! \note Rounding uses current rounding mode, same as vector units
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_f32_i32(const SIMD_FLT va)
+{
+    vi32_t vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc[i] = (int32_t)lrintf(va[i]);
+    return (SIMD_INT)vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_f32_f64(const SIMD_FLT va)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc[i] = (double)va[i];
+    return vc;
+}
+
+//! \note Rounding uses current rounding mode, same as vector units
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_f64_i32(const SIMD_DBL va)
+{
+    vi32_t vc = (vi32_t)((SIMD_INT)va ^ (SIMD_INT)va);
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc[i] = (int32_t)lrint(va[i]);
+    return (SIMD_INT)vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_f64_f32(const SIMD_DBL va)
+{
+    SIMD_FLT vc = (SIMD_FLT)((SIMD_INT)va ^ (SIMD_INT)va);
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc[i] = (float)va[i];
+    return vc;
+}
+
+
+/**********************
+ *  Set instructions  *
+ **********************/
+/*!
+ *  Set vector to zero. Use pointer for function overloading.
+ */
+static SIMD_FUNC_INLINE
+void simd_set_zero(SIMD_INT * const va)
+{ *va = SIMD_INT(); }
+
+static SIMD_FUNC_INLINE
+void simd_set_zero(SIMD_FLT * const va)
+{ *va = SIMD_FLT(); }
+
+static SIMD_FUNC_INLINE
+void simd_set_zero(SIMD_DBL * const va)
+{ *va = SIMD_DBL(); }
+
+/*!
+ *  Set vector with 32/64 elements.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const int32_t sa)
+{ return (SIMD_INT)(vi32_t() + sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set_64(const int32_t sa)
+{ return SIMD_INT() + (int64_t)sa; }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const uint32_t sa)
+{ return (SIMD_INT)(vu32_t() + sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set_64(const uint32_t sa)
+{ return SIMD_INT() + (int64_t)sa; }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const int64_t sa)
+{ return SIMD_INT() + sa; }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const uint64_t sa)
+{ return (SIMD_INT)(vu64_t() + sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_set(const float sa)
+{ return SIMD_FLT() + sa; }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_set(const double sa)
+{ return SIMD_DBL() + sa; }
+
+/*!
+ *  Set vector given an array.
+ *  Only required for non-contiguous 32-bit elements due to in-between padding,
+ *  64-bit elements can use load instructions.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const int32_t * const sa, const size_t n)
+{
+    SIMD_INT va = SIMD_INT();
+    if (n == (size_t)SIMD_STREAMS_64) {
+        for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+            va[i] = sa[i];
+    }
+    else if (n == (size_t)SIMD_STREAMS_32) {
+        vi32_t va32;
+        memcpy(&va32, sa, sizeof(va32));
+        va = (SIMD_INT)va32;
+    }
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const uint32_t * const sa, const size_t n)
+{
+    SIMD_INT va = SIMD_INT();
+    if (n == (size_t)SIMD_STREAMS_64) {
+        for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+            va[i] = sa[i];
+    }
+    else if (n == (size_t)SIMD_STREAMS_32) {
+        vu32_t va32;
+        memcpy(&va32, sa, sizeof(va32));
+        va = (SIMD_INT)va32;
+    }
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const int64_t * const sa, const size_t n)
+{
+    SIMD_INT va = SIMD_INT();
+    if (n == (size_t)SIMD_STREAMS_64)
+        memcpy(&va, sa, sizeof(va));
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const uint64_t * const sa, const size_t n)
+{
+    SIMD_INT va = SIMD_INT();
+    if (n == (size_t)SIMD_STREAMS_64)
+        memcpy(&va, sa, sizeof(va));
+    return va;
+}
+
+
+/***********************
+ *  Load instructions  *
+ ***********************/
+/*!
+ *  Loads/stores copy through memcpy to avoid aliasing issues, compilers emit
+ *  single vector moves. Aligned variants let the compiler assume alignment.
+ *  Streaming hints are accepted for compatibility and ignored.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const void * const sa)
+{
+    SIMD_INT va;
+    memcpy(&va, sa, sizeof(va));
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const void * const sa)
+{ return simd_loadu(SIMD_ASSUME_ALIGNED(sa, SIMD_WIDTH_BYTES)); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const int8_t * const sa)
+{ return simd_load((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const int8_t * const sa)
+{ return simd_loadu((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const int16_t * const sa)
+{ return simd_load((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const int16_t * const sa)
+{ return simd_loadu((const void *)sa); }
+
+/*!
+ *  Load first n elements, remaining elements are set to zero.
+ *  Negative n loads into the upper |n| elements.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const int32_t * const sa, const int32_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    (void)strmHint;
+    if (n == SIMD_STREAMS_32 || n == -SIMD_STREAMS_32)
+        return simd_load((const void *)sa);
+    vi32_t va = vi32_t();
+    if (n > 0 && n < SIMD_STREAMS_32) {
+        for (int32_t i = 0; i < n; ++i)
+            va[i] = sa[i];
+    }
+    else if (n < 0 && n > -SIMD_STREAMS_32) {
+        for (int32_t i = SIMD_STREAMS_32 + n, j = 0; i < SIMD_STREAMS_32; ++i, ++j)
+            va[i] = sa[j];
+    }
+    return (SIMD_INT)va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const int32_t * const sa, const size_t n = SIMD_STREAMS_32)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        return simd_loadu((const void *)sa);
+    vi32_t va = vi32_t();
+    if (n < (size_t)SIMD_STREAMS_32)
+        for (size_t i = 0; i < n; ++i)
+            va[i] = sa[i];
+    return (SIMD_INT)va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const uint8_t * const sa)
+{ return simd_load((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const uint8_t * const sa)
+{ return simd_loadu((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const uint16_t * const sa)
+{ return simd_load((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const uint16_t * const sa)
+{ return simd_loadu((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const uint32_t * const sa)
+{ return simd_load((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const uint32_t * const sa)
+{ return simd_loadu((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const int64_t * const sa)
+{ return simd_load((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const int64_t * const sa)
+{ return simd_loadu((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const uint64_t * const sa)
+{ return simd_load((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const uint64_t * const sa)
+{ return simd_loadu((const void *)sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_loadu(const float * const sa, const size_t n = SIMD_STREAMS_32)
+{
+    SIMD_FLT va = SIMD_FLT();
+    if (n == (size_t)SIMD_STREAMS_32)
+        memcpy(&va, sa, sizeof(va));
+    else if (n < (size_t)SIMD_STREAMS_32)
+        for (size_t i = 0; i < n; ++i)
+            va[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_load(const float * const sa, const size_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    (void)strmHint;
+    return simd_loadu((const float *)SIMD_ASSUME_ALIGNED(sa, SIMD_WIDTH_BYTES), n);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_loadu(const double * const sa, const size_t n = SIMD_STREAMS_64)
+{
+    SIMD_DBL va = SIMD_DBL();
+    if (n == (size_t)SIMD_STREAMS_64)
+        memcpy(&va, sa, sizeof(va));
+    else if (n < (size_t)SIMD_STREAMS_64)
+        for (size_t i = 0; i < n; ++i)
+            va[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_load(const double * const sa, const size_t n = SIMD_STREAMS_64, const bool strmHint = false)
+{
+    (void)strmHint;
+    return simd_loadu((const double *)SIMD_ASSUME_ALIGNED(sa, SIMD_WIDTH_BYTES), n);
+}
+
+
+/************************
+ *  Store instructions  *
+ ************************/
+static SIMD_FUNC_INLINE
+void simd_storeu(void * const sa, const SIMD_INT va)
+{ memcpy(sa, &va, sizeof(va)); }
+
+static SIMD_FUNC_INLINE
+void simd_store(void * const sa, const SIMD_INT va)
+{ simd_storeu(SIMD_ASSUME_ALIGNED(sa, SIMD_WIDTH_BYTES), va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(int8_t * const sa, const SIMD_INT va)
+{ simd_store((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(int8_t * const sa, const SIMD_INT va)
+{ simd_storeu((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(int16_t * const sa, const SIMD_INT va)
+{ simd_store((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(int16_t * const sa, const SIMD_INT va)
+{ simd_storeu((void *)sa, va); }
+
+/*!
+ *  Store first n elements.
+ *  Negative n stores the upper |n| elements.
+ */
+static SIMD_FUNC_INLINE
+void simd_store(int32_t * const sa, const SIMD_INT va, const int32_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    (void)strmHint;
+    const vi32_t va32 = (vi32_t)va;
+    if (n == SIMD_STREAMS_32 || n == -SIMD_STREAMS_32) {
+        simd_store((void *)sa, va);
+    }
+    else if (n > 0 && n < SIMD_STREAMS_32) {
+        for (int32_t i = 0; i < n; ++i)
+            sa[i] = va32[i];
+    }
+    else if (n < 0 && n > -SIMD_STREAMS_32) {
+        for (int32_t i = SIMD_STREAMS_32 + n, j = 0; i < SIMD_STREAMS_32; ++i, ++j)
+            sa[j] = va32[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(int32_t * const sa, const SIMD_INT va, const size_t n = SIMD_STREAMS_32)
+{
+    const vi32_t va32 = (vi32_t)va;
+    if (n == (size_t)SIMD_STREAMS_32)
+        simd_storeu((void *)sa, va);
+    else if (n < (size_t)SIMD_STREAMS_32)
+        for (size_t i = 0; i < n; ++i)
+            sa[i] = va32[i];
+}
+
+static SIMD_FUNC_INLINE
+void simd_store(uint8_t * const sa, const SIMD_INT va)
+{ simd_store((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(uint8_t * const sa, const SIMD_INT va)
+{ simd_storeu((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(uint16_t * const sa, const SIMD_INT va)
+{ simd_store((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(uint16_t * const sa, const SIMD_INT va)
+{ simd_storeu((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(uint32_t * const sa, const SIMD_INT va)
+{ simd_store((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(uint32_t * const sa, const SIMD_INT va)
+{ simd_storeu((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(int64_t * const sa, const SIMD_INT va)
+{ simd_store((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(int64_t * const sa, const SIMD_INT va)
+{ simd_storeu((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(uint64_t * const sa, const SIMD_INT va)
+{ simd_store((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(uint64_t * const sa, const SIMD_INT va)
+{ simd_storeu((void *)sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(float * const sa, const SIMD_FLT va, const size_t n = SIMD_STREAMS_32)
+{
+    if (n == (size_t)SIMD_STREAMS_32)
+        memcpy(sa, &va, sizeof(va));
+    else if (n < (size_t)SIMD_STREAMS_32)
+        for (size_t i = 0; i < n; ++i)
+            sa[i] = va[i];
+}
+
+static SIMD_FUNC_INLINE
+void simd_store(float * const sa, const SIMD_FLT va, const size_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    (void)strmHint;
+    simd_storeu((float *)SIMD_ASSUME_ALIGNED(sa, SIMD_WIDTH_BYTES), va, n);
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(double * const sa, const SIMD_DBL va, const size_t n = SIMD_STREAMS_64)
+{
+    if (n == (size_t)SIMD_STREAMS_64)
+        memcpy(sa, &va, sizeof(va));
+    else if (n < (size_t)SIMD_STREAMS_64)
+        for (size_t i = 0; i < n; ++i)
+            sa[i] = va[i];
+}
+
+static SIMD_FUNC_INLINE
+void simd_store(double * const sa, const SIMD_DBL va, const size_t n = SIMD_STREAMS_64, const bool strmHint = false)
+{
+    (void)strmHint;
+    simd_storeu((double *)SIMD_ASSUME_ALIGNED(sa, SIMD_WIDTH_BYTES), va, n);
+}
+
+
+/*****************************
+ *  Interleave instructions  *
+ *****************************/
+/*!
+ *  Load records of 2/3/4 components (array of structures) and split them
+ *  into one vector per component (structure of arrays), e.g., xyz points
+ *  or RGB/RGBA pixels. simd_store_interleave* is the inverse.
+ *  Each call reads/writes 2/3/4 vectors of consecutive elements, pointers
+ *  need not be aligned.
+ *  Element loops with fixed trip counts, compilers turn them into shuffles
+ *  of the target when possible.
+ */
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        (*va)[i] = sa[2 * i];
+        (*vb)[i] = sa[2 * i + 1];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        (*va)[i] = sa[3 * i];
+        (*vb)[i] = sa[3 * i + 1];
+        (*vc)[i] = sa[3 * i + 2];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc, SIMD_FLT * const vd)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        (*va)[i] = sa[4 * i];
+        (*vb)[i] = sa[4 * i + 1];
+        (*vc)[i] = sa[4 * i + 2];
+        (*vd)[i] = sa[4 * i + 3];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(float * const sa, const SIMD_FLT va, const SIMD_FLT vb)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        sa[2 * i] = va[i];
+        sa[2 * i + 1] = vb[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        sa[3 * i] = va[i];
+        sa[3 * i + 1] = vb[i];
+        sa[3 * i + 2] = vc[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc, const SIMD_FLT vd)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        sa[4 * i] = va[i];
+        sa[4 * i + 1] = vb[i];
+        sa[4 * i + 2] = vc[i];
+        sa[4 * i + 3] = vd[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        (*va)[i] = sa[2 * i];
+        (*vb)[i] = sa[2 * i + 1];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        (*va)[i] = sa[3 * i];
+        (*vb)[i] = sa[3 * i + 1];
+        (*vc)[i] = sa[3 * i + 2];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc, SIMD_DBL * const vd)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        (*va)[i] = sa[4 * i];
+        (*vb)[i] = sa[4 * i + 1];
+        (*vc)[i] = sa[4 * i + 2];
+        (*vd)[i] = sa[4 * i + 3];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(double * const sa, const SIMD_DBL va, const SIMD_DBL vb)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        sa[2 * i] = va[i];
+        sa[2 * i + 1] = vb[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        sa[3 * i] = va[i];
+        sa[3 * i + 1] = vb[i];
+        sa[3 * i + 2] = vc[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc, const SIMD_DBL vd)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        sa[4 * i] = va[i];
+        sa[4 * i + 1] = vb[i];
+        sa[4 * i + 2] = vc[i];
+        sa[4 * i + 3] = vd[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    vi32_t va_i32, vb_i32;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        va_i32[i] = sa[2 * i];
+        vb_i32[i] = sa[2 * i + 1];
+    }
+    *va = (SIMD_INT)va_i32;
+    *vb = (SIMD_INT)vb_i32;
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    vi32_t va_i32, vb_i32, vc_i32;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        va_i32[i] = sa[3 * i];
+        vb_i32[i] = sa[3 * i + 1];
+        vc_i32[i] = sa[3 * i + 2];
+    }
+    *va = (SIMD_INT)va_i32;
+    *vb = (SIMD_INT)vb_i32;
+    *vc = (SIMD_INT)vc_i32;
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    vi32_t va_i32, vb_i32, vc_i32, vd_i32;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        va_i32[i] = sa[4 * i];
+        vb_i32[i] = sa[4 * i + 1];
+        vc_i32[i] = sa[4 * i + 2];
+        vd_i32[i] = sa[4 * i + 3];
+    }
+    *va = (SIMD_INT)va_i32;
+    *vb = (SIMD_INT)vb_i32;
+    *vc = (SIMD_INT)vc_i32;
+    *vd = (SIMD_INT)vd_i32;
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{
+    const vi32_t va_i32 = (vi32_t)va;
+    const vi32_t vb_i32 = (vi32_t)vb;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        sa[2 * i] = va_i32[i];
+        sa[2 * i + 1] = vb_i32[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{
+    const vi32_t va_i32 = (vi32_t)va;
+    const vi32_t vb_i32 = (vi32_t)vb;
+    const vi32_t vc_i32 = (vi32_t)vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        sa[3 * i] = va_i32[i];
+        sa[3 * i + 1] = vb_i32[i];
+        sa[3 * i + 2] = vc_i32[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{
+    const vi32_t va_i32 = (vi32_t)va;
+    const vi32_t vb_i32 = (vi32_t)vb;
+    const vi32_t vc_i32 = (vi32_t)vc;
+    const vi32_t vd_i32 = (vi32_t)vd;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        sa[4 * i] = va_i32[i];
+        sa[4 * i + 1] = vb_i32[i];
+        sa[4 * i + 2] = vc_i32[i];
+        sa[4 * i + 3] = vd_i32[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    vu8_t va_u8, vb_u8;
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i) {
+        va_u8[i] = sa[2 * i];
+        vb_u8[i] = sa[2 * i + 1];
+    }
+    *va = (SIMD_INT)va_u8;
+    *vb = (SIMD_INT)vb_u8;
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    vu8_t va_u8, vb_u8, vc_u8;
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i) {
+        va_u8[i] = sa[3 * i];
+        vb_u8[i] = sa[3 * i + 1];
+        vc_u8[i] = sa[3 * i + 2];
+    }
+    *va = (SIMD_INT)va_u8;
+    *vb = (SIMD_INT)vb_u8;
+    *vc = (SIMD_INT)vc_u8;
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    vu8_t va_u8, vb_u8, vc_u8, vd_u8;
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i) {
+        va_u8[i] = sa[4 * i];
+        vb_u8[i] = sa[4 * i + 1];
+        vc_u8[i] = sa[4 * i + 2];
+        vd_u8[i] = sa[4 * i + 3];
+    }
+    *va = (SIMD_INT)va_u8;
+    *vb = (SIMD_INT)vb_u8;
+    *vc = (SIMD_INT)vc_u8;
+    *vd = (SIMD_INT)vd_u8;
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{
+    const vu8_t va_u8 = (vu8_t)va;
+    const vu8_t vb_u8 = (vu8_t)vb;
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i) {
+        sa[2 * i] = va_u8[i];
+        sa[2 * i + 1] = vb_u8[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{
+    const vu8_t va_u8 = (vu8_t)va;
+    const vu8_t vb_u8 = (vu8_t)vb;
+    const vu8_t vc_u8 = (vu8_t)vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i) {
+        sa[3 * i] = va_u8[i];
+        sa[3 * i + 1] = vb_u8[i];
+        sa[3 * i + 2] = vc_u8[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{
+    const vu8_t va_u8 = (vu8_t)va;
+    const vu8_t vb_u8 = (vu8_t)vb;
+    const vu8_t vc_u8 = (vu8_t)vc;
+    const vu8_t vd_u8 = (vu8_t)vd;
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i) {
+        sa[4 * i] = va_u8[i];
+        sa[4 * i + 1] = vb_u8[i];
+        sa[4 * i + 2] = vc_u8[i];
+        sa[4 * i + 3] = vd_u8[i];
+    }
+}
+
+
+/****************************
+ *  Transpose instructions  *
+ ****************************/
+/*!
+ *  Transpose a square tile, sb[j * ldb + i] = sa[i * lda + j].
+ *  Rows of \c sa are loaded into registers, transposed with shuffles and
+ *  stored as rows of \c sb. Leading dimensions are in elements, rows need
+ *  not be aligned and tiles must not overlap.
+ */
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    for (int32_t i = 0; i < 4; ++i)
+        for (int32_t j = 0; j < 4; ++j)
+            sb[j * ldb + i] = sa[i * lda + j];
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    for (int32_t i = 0; i < 8; ++i)
+        for (int32_t j = 0; j < 8; ++j)
+            sb[j * ldb + i] = sa[i * lda + j];
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    for (int32_t i = 0; i < 4; ++i)
+        for (int32_t j = 0; j < 4; ++j)
+            sb[j * ldb + i] = sa[i * lda + j];
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    for (int32_t i = 0; i < 8; ++i)
+        for (int32_t j = 0; j < 8; ++j)
+            sb[j * ldb + i] = sa[i * lda + j];
+}
+
+
+/*************************
+ *  Gather instructions  *
+ *************************/
+/*!
+ *  Gather, lane i is loaded from sa[idx[i]], one 32-bit index per lane.
+ *  Indices need not be sorted or distinct and are not range-checked.
+ */
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_gather(const float * const sa, const int32_t * const idx)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc[i] = sa[idx[i]];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_gather(const double * const sa, const int32_t * const idx)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc[i] = sa[idx[i]];
+    return vc;
+}
+
+
+/************************
+ *  Align instructions  *
+ ************************/
+/*!
+ *  Lanes N .. N + nlanes - 1 of the concatenation of vb (low lanes) and va
+ *  (high lanes), 0 <= N <= nlanes. Vectors at consecutive aligned addresses
+ *  give the vector at an unaligned offset of N elements.
+ */
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_alignr(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc[i] = (i + N < SIMD_STREAMS_32) ? (vb[i + N]) : (va[i + N - SIMD_STREAMS_32]);
+    return vc;
+}
+
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_alignr(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc[i] = (i + N < SIMD_STREAMS_64) ? (vb[i + N]) : (va[i + N - SIMD_STREAMS_64]);
+    return vc;
+}
+
+
+/***********************
+ *  Scan instructions  *
+ ***********************/
+/*!
+ *  Inclusive prefix sums of the lanes of va plus the carry *vc (all lanes
+ *  equal), lane by lane. The sum of va is added to *vc, the carry of the
+ *  next vector.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_32(const SIMD_INT va, SIMD_INT * const vc)
+{
+    vu32_t vs = (vu32_t)va;
+    for (int32_t i = 1; i < SIMD_STREAMS_32; ++i)
+        vs[i] += vs[i - 1];
+    const vu32_t vp = (vu32_t)*vc;
+    *vc = (SIMD_INT)(vp + vs[SIMD_STREAMS_32 - 1]);
+    return (SIMD_INT)(vs + vp);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_64(const SIMD_INT va, SIMD_INT * const vc)
+{
+    vu64_t vs = (vu64_t)va;
+    for (int32_t i = 1; i < SIMD_STREAMS_64; ++i)
+        vs[i] += vs[i - 1];
+    const vu64_t vp = (vu64_t)*vc;
+    *vc = (SIMD_INT)(vp + vs[SIMD_STREAMS_64 - 1]);
+    return (SIMD_INT)(vs + vp);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    SIMD_FLT vs = va;
+    for (int32_t i = 1; i < SIMD_STREAMS_32; ++i)
+        vs[i] += vs[i - 1];
+    const SIMD_FLT vp = *vc;
+    *vc = vp + vs[SIMD_STREAMS_32 - 1];
+    return vs + vp;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    SIMD_DBL vs = va;
+    for (int32_t i = 1; i < SIMD_STREAMS_64; ++i)
+        vs[i] += vs[i - 1];
+    const SIMD_DBL vp = *vc;
+    *vc = vp + vs[SIMD_STREAMS_64 - 1];
+    return vs + vp;
+}
+
+/*!
+ *  Exclusive prefix sums, lane i is the carry plus lanes 0 .. i-1 of va,
+ *  *vc is updated as by the inclusive sums
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_32(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const vu32_t vp = (vu32_t)*vc;
+    const vu32_t vs = (vu32_t)simd_scan_32(va, vc);
+    vu32_t vb;
+    vb[0] = vp[0];
+    for (int32_t i = 1; i < SIMD_STREAMS_32; ++i)
+        vb[i] = vs[i - 1];
+    return (SIMD_INT)vb;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_64(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const vu64_t vp = (vu64_t)*vc;
+    const vu64_t vs = (vu64_t)simd_scan_64(va, vc);
+    vu64_t vb;
+    vb[0] = vp[0];
+    for (int32_t i = 1; i < SIMD_STREAMS_64; ++i)
+        vb[i] = vs[i - 1];
+    return (SIMD_INT)vb;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan_excl(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    const SIMD_FLT vp = *vc;
+    return simd_alignr<SIMD_STREAMS_32 - 1>(simd_scan(va, vc), vp);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan_excl(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    const SIMD_DBL vp = *vc;
+    return simd_alignr<SIMD_STREAMS_64 - 1>(simd_scan(va, vc), vp);
+}
+
+
+}  // namespace generic
+}  // namespace gvl
+
+
+#endif  // _GENERIC_H
+
@@ -0,0 +1,64 @@
+/*!
+ *  \brief Huge-page backed buffers
+ *  Large arrays streamed by SIMD kernels touch a new 4 KiB page every few
+ *  vectors, huge pages (2 MiB on x86-64) reduce DTLB misses, in particular
+ *  for gathers. Modes, from most to least explicit:
+ *  - HUGEPAGE_HUGETLB, reserved huge pages (MAP_HUGETLB, hugetlbfs pool set
+ *    with vm.nr_hugepages), falls back to HUGEPAGE_THP if none are available
+ *  - HUGEPAGE_THP, huge page aligned memory advised with MADV_HUGEPAGE for
+ *    transparent huge pages, falls back to normal pages if THP is disabled
+ *  Huge page buffers are recorded by address with the mode obtained, see
+ *  get_hugepage_mode(), and are released with hugepage_free(). Normal page
+ *  buffers are plain posix_memalign() ones, free() also releases them.
+ */
+#ifndef _HUGEPAGE_H
+#define _HUGEPAGE_H
+
+
+#include <stdint.h>
+#include <stddef.h>   // size_t
+
+
+namespace gvl {
+
+
+//! Huge page modes
+enum hugepage_mode {
+    HUGEPAGE_NONE,    //!< Normal pages
+    HUGEPAGE_THP,     //!< Transparent huge pages (madvise)
+    HUGEPAGE_HUGETLB  //!< Reserved huge pages (MAP_HUGETLB)
+};
+
+//! Size of a huge page in bytes, 2 MiB if unknown
+size_t get_hugepage_sz();
+
+/*!
+ *  Allocate \c bytes with at least \c align alignment, backed by huge pages
+ *  if possible. When huge pages are used, the mapping starts on a huge page
+ *  and its size is rounded up to a multiple of the huge page size.
+ *  \param[in] mode Requested mode, HUGEPAGE_NONE uses posix_memalign()
+ *  \return 0 on success, error number otherwise
+ */
+int hugepage_malloc(void ** const sa, const size_t align, const size_t bytes, const hugepage_mode mode);
+
+//! Release buffer of hugepage_malloc()
+void hugepage_free(void * const sa);
+
+/*!
+ *  Mode obtained for buffer \c sa of hugepage_malloc()
+ *  \note HUGEPAGE_THP means the buffer is eligible, the kernel assigns huge
+ *        pages on first touch (see get_hugepage_bytes())
+ */
+hugepage_mode get_hugepage_mode(const void * const sa);
+
+/*!
+ *  Bytes of [sa, sa + bytes) currently backed by huge pages, from
+ *  /proc/self/smaps (counts whole memory mappings overlapping the range)
+ */
+size_t get_hugepage_bytes(const void * const sa, const size_t bytes);
+
+
+}  // namespace gvl
+
+
+#endif  // _HUGEPAGE_H
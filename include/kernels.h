@@ -0,0 +1,419 @@
+/*!
+ *  \brief C++ array kernels
+ *  Element-wise operations over arrays of any length and alignment.
+ *  Each kernel peels until the output is aligned, runs an aligned or an
+ *  unaligned inner loop depending on the relative alignment of the inputs,
+ *  and finishes with a partial (masked) vector for the remainder.
+ *  Kernels accept every arithmetic element type. 8/16/32/64-bit integers,
+ *  float and double use SIMD datatypes, other types run one element at a
+ *  time and their loops are left to the compiler.
+ *  \note The AVX, AVX2 and AVX-512 interfaces lack 8/16/64-bit integer
+ *        add/sub/multiply, so those widths run one element at a time there
+ *  \note Requires vector classes (vec.h)
+ */
+#ifndef _KERNELS_H
+#define _KERNELS_H
+
+
+#include <stdint.h>
+#include <stdlib.h>   // NULL, posix_memalign
+#include "vec.h"
+#include "arena.h"    // heap_allocator
+#include "sysconf.h"
+#include "dispatch.h"
+
+
+namespace gvl {
+
+
+/*!
+ *  \class kernel_traits
+ *  \brief Vector type and operations used by the kernels for elements of type T
+ *  Element types without vector classes are their own vector type of one
+ *  stream, kernel loops then step one element at a time.
+ */
+template <typename T>
+struct kernel_traits
+{
+    typedef T stype;
+    typedef T vtype;
+    static const size_t nstreams = 1;
+
+    static SIMD_FUNC_INLINE vtype set(const T sa)
+    { return sa; }
+
+    static SIMD_FUNC_INLINE vtype add(const vtype va, const vtype vb)
+    { return (T)(va + vb); }
+
+    static SIMD_FUNC_INLINE vtype sub(const vtype va, const vtype vb)
+    { return (T)(va - vb); }
+
+    static SIMD_FUNC_INLINE vtype mul(const vtype va, const vtype vb)
+    { return (T)(va * vb); }
+
+    static SIMD_FUNC_INLINE vtype fmadd(const vtype va, const vtype vb, const vtype vc)
+    { return (T)(va * vb + vc); }
+
+    static SIMD_FUNC_INLINE vtype load(const T * const sa, const size_t, const bool)
+    { return *sa; }
+
+    static SIMD_FUNC_INLINE vtype loadu(const T * const sa, const size_t)
+    { return *sa; }
+
+    static SIMD_FUNC_INLINE void store(T * const sa, const vtype va, const size_t, const bool)
+    { *sa = va; }
+
+    static SIMD_FUNC_INLINE void storeu(T * const sa, const vtype va, const size_t)
+    { *sa = va; }
+};
+
+template <>
+struct kernel_traits<int32_t>: vec_traits<int32_t>
+{ typedef int32_t stype; };
+
+//! Unsigned 32-bit integers share the signed operations, low 32 bits are equal
+template <>
+struct kernel_traits<uint32_t>: vec_traits<int32_t>
+{
+    typedef uint32_t stype;
+
+    static SIMD_FUNC_INLINE vtype set(const uint32_t sa)
+    { return simd_set((int32_t)sa); }
+
+    static SIMD_FUNC_INLINE vtype load(const uint32_t * const sa, const size_t n, const bool strmHint)
+    { return vec_traits<int32_t>::load((const int32_t *)sa, n, strmHint); }
+
+    static SIMD_FUNC_INLINE vtype loadu(const uint32_t * const sa, const size_t n)
+    { return vec_traits<int32_t>::loadu((const int32_t *)sa, n); }
+
+    static SIMD_FUNC_INLINE void store(uint32_t * const sa, const vtype va, const size_t n, const bool strmHint)
+    { vec_traits<int32_t>::store((int32_t *)sa, va, n, strmHint); }
+
+    static SIMD_FUNC_INLINE void storeu(uint32_t * const sa, const vtype va, const size_t n)
+    { vec_traits<int32_t>::storeu((int32_t *)sa, va, n); }
+};
+
+template <>
+struct kernel_traits<float>: vec_traits<float>
+{ typedef float stype; };
+
+template <>
+struct kernel_traits<double>: vec_traits<double>
+{ typedef double stype; };
+
+#if defined(SIMD_SSE4_2) || defined(SIMD_AVX2X2) || defined(SIMD_GENERIC) || defined(SIMD_SCALAR)
+//! Broadcast integer \c sa to all lanes
+template <typename T>
+static SIMD_FUNC_INLINE SIMD_INT kernel_int_set(const T sa)
+{
+    T tmp[SIMD_WIDTH_BYTES / sizeof(T)] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    for (size_t i = 0; i < SIMD_WIDTH_BYTES / sizeof(T); ++i)
+        tmp[i] = sa;
+    return simd_load(tmp);
+}
+
+/*!
+ *  Load \c n integers, less than a full vector goes through an aligned
+ *  buffer and clears the remaining lanes
+ */
+template <bool ALIGNED, typename T>
+static SIMD_FUNC_INLINE SIMD_INT kernel_int_load(const T * const sa, const size_t n)
+{
+    const size_t nstreams = SIMD_WIDTH_BYTES / sizeof(T);
+    if (n == nstreams)
+        return (ALIGNED) ? (simd_load(sa)) : (simd_loadu(sa));
+    T tmp[SIMD_WIDTH_BYTES / sizeof(T)] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    for (size_t i = 0; i < nstreams; ++i)
+        tmp[i] = (i < n) ? (sa[i]) : ((T)0);
+    return simd_load(tmp);
+}
+
+//! Store \c n integers, less than a full vector goes through an aligned buffer
+template <bool ALIGNED, typename T>
+static SIMD_FUNC_INLINE void kernel_int_store(T * const sa, const SIMD_INT va, const size_t n)
+{
+    const size_t nstreams = SIMD_WIDTH_BYTES / sizeof(T);
+    if (n == nstreams) {
+        if (ALIGNED)
+            simd_store(sa, va);
+        else
+            simd_storeu(sa, va);
+        return;
+    }
+    T tmp[SIMD_WIDTH_BYTES / sizeof(T)] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    simd_store(tmp, va);
+    for (size_t i = 0; i < n; ++i)
+        sa[i] = tmp[i];
+}
+
+//! Multiply 8-bit integers (low 8 bits of the products) in even and odd bytes of 16-bit lanes
+static SIMD_FUNC_INLINE SIMD_INT kernel_mul_8(const SIMD_INT va, const SIMD_INT vb)
+{
+    const SIMD_INT veven = simd_and(simd_mul_16(va, vb), simd_set((int32_t)0x00FF00FF));
+    const SIMD_INT vodd = simd_mul_16(simd_srl_16(va, 8), simd_srl_16(vb, 8));
+    return simd_or(veven, simd_sll_16(vodd, 8));
+}
+
+#define KERNEL_TRAITS_INT(STYPE, BITS, MUL) \
+template <> \
+struct kernel_traits<STYPE> \
+{ \
+    typedef STYPE stype; \
+    typedef SIMD_INT vtype; \
+    static const size_t nstreams = SIMD_WIDTH_BYTES / sizeof(STYPE); \
+\
+    static SIMD_FUNC_INLINE vtype set(const STYPE sa) \
+    { return kernel_int_set(sa); } \
+\
+    static SIMD_FUNC_INLINE vtype add(const vtype va, const vtype vb) \
+    { return simd_add_##BITS(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype sub(const vtype va, const vtype vb) \
+    { return simd_sub_##BITS(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype mul(const vtype va, const vtype vb) \
+    { return MUL(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype fmadd(const vtype va, const vtype vb, const vtype vc) \
+    { return simd_add_##BITS(MUL(va, vb), vc); } \
+\
+    static SIMD_FUNC_INLINE vtype load(const STYPE * const sa, const size_t n, const bool) \
+    { return kernel_int_load<true>(sa, n); } \
+\
+    static SIMD_FUNC_INLINE vtype loadu(const STYPE * const sa, const size_t n) \
+    { return kernel_int_load<false>(sa, n); } \
+\
+    static SIMD_FUNC_INLINE void store(STYPE * const sa, const vtype va, const size_t n, const bool) \
+    { kernel_int_store<true>(sa, va, n); } \
+\
+    static SIMD_FUNC_INLINE void storeu(STYPE * const sa, const vtype va, const size_t n) \
+    { kernel_int_store<false>(sa, va, n); } \
+};
+
+KERNEL_TRAITS_INT(int8_t, 8, kernel_mul_8)
+KERNEL_TRAITS_INT(uint8_t, 8, kernel_mul_8)
+KERNEL_TRAITS_INT(int16_t, 16, simd_mul_16)
+KERNEL_TRAITS_INT(uint16_t, 16, simd_mul_16)
+KERNEL_TRAITS_INT(int64_t, 64, simd_mul_64)
+KERNEL_TRAITS_INT(uint64_t, 64, simd_mul_64)
+#undef KERNEL_TRAITS_INT
+#endif
+
+/*!
+ *  Load \c n elements, aligned version is resolved at compile time
+ */
+template <bool ALIGNED, typename T>
+static SIMD_FUNC_INLINE typename kernel_traits<T>::vtype kernel_load(const T * const sa, const size_t n)
+{
+    if (ALIGNED)
+        return kernel_traits<T>::load(sa, n, false);
+    return kernel_traits<T>::loadu(sa, n);
+}
+
+//! True if \c sa has the same misalignment as \c sc, so both align after peeling
+template <typename T>
+static SIMD_FUNC_INLINE bool kernel_coaligned(const T * const sc, const T * const sa)
+{ return (((size_t)sc ^ (size_t)sa) & (SIMD_WIDTH_BYTES - 1)) == 0; }
+
+/*!
+ *  Driver shared by array kernels
+ *  Functor K provides:
+ *  - bool coaligned(sc), inputs share the misalignment of output \c sc
+ *  - template <bool ALIGNED> vtype apply(i, n), result for elements [i, i+n)
+ */
+template <typename T, typename K>
+static SIMD_FUNC_INLINE void kernel_run(T * const sc, const K &k, const size_t n)
+{
+    typedef kernel_traits<T> traits;
+    const size_t nstreams = traits::nstreams;
+
+    // Peel until output is aligned to a vector (to an element for scalar types)
+    const size_t mis = ((size_t)sc & (nstreams * sizeof(T) - 1)) / sizeof(T);
+    size_t i = (mis) ? (nstreams - mis) : (0);
+    if (i > n)
+        i = n;
+    if (i > 0)
+        traits::storeu(sc, k.template apply<false>(0, i), i);
+
+    if (k.coaligned(sc)) {
+        for (; i + nstreams <= n; i+=nstreams)
+            traits::store(sc + i, k.template apply<true>(i, nstreams), nstreams, false);
+    } else {
+        for (; i + nstreams <= n; i+=nstreams)
+            traits::store(sc + i, k.template apply<false>(i, nstreams), nstreams, false);
+    }
+
+    // Masked tail
+    if (i < n)
+        traits::storeu(sc + i, k.template apply<false>(i, n - i), n - i);
+}
+
+
+/**************
+ *  Functors  *
+ **************/
+template <typename T>
+struct kernel_add
+{
+    const T *sa, *sb;
+    kernel_add(const T * const a, const T * const b): sa(a), sb(b) { }
+
+    SIMD_FUNC_INLINE bool coaligned(const T * const sc) const
+    { return kernel_coaligned(sc, sa) && kernel_coaligned(sc, sb); }
+
+    template <bool ALIGNED>
+    SIMD_FUNC_INLINE typename kernel_traits<T>::vtype apply(const size_t i, const size_t n) const
+    { return kernel_traits<T>::add(kernel_load<ALIGNED>(sa + i, n), kernel_load<ALIGNED>(sb + i, n)); }
+};
+
+template <typename T>
+struct kernel_sub
+{
+    const T *sa, *sb;
+    kernel_sub(const T * const a, const T * const b): sa(a), sb(b) { }
+
+    SIMD_FUNC_INLINE bool coaligned(const T * const sc) const
+    { return kernel_coaligned(sc, sa) && kernel_coaligned(sc, sb); }
+
+    template <bool ALIGNED>
+    SIMD_FUNC_INLINE typename kernel_traits<T>::vtype apply(const size_t i, const size_t n) const
+    { return kernel_traits<T>::sub(kernel_load<ALIGNED>(sa + i, n), kernel_load<ALIGNED>(sb + i, n)); }
+};
+
+template <typename T>
+struct kernel_mul
+{
+    const T *sa, *sb;
+    kernel_mul(const T * const a, const T * const b): sa(a), sb(b) { }
+
+    SIMD_FUNC_INLINE bool coaligned(const T * const sc) const
+    { return kernel_coaligned(sc, sa) && kernel_coaligned(sc, sb); }
+
+    template <bool ALIGNED>
+    SIMD_FUNC_INLINE typename kernel_traits<T>::vtype apply(const size_t i, const size_t n) const
+    { return kernel_traits<T>::mul(kernel_load<ALIGNED>(sa + i, n), kernel_load<ALIGNED>(sb + i, n)); }
+};
+
+template <typename T>
+struct kernel_fma
+{
+    const T *sa, *sb, *sd;
+    kernel_fma(const T * const a, const T * const b, const T * const d): sa(a), sb(b), sd(d) { }
+
+    SIMD_FUNC_INLINE bool coaligned(const T * const sc) const
+    { return kernel_coaligned(sc, sa) && kernel_coaligned(sc, sb) && kernel_coaligned(sc, sd); }
+
+    template <bool ALIGNED>
+    SIMD_FUNC_INLINE typename kernel_traits<T>::vtype apply(const size_t i, const size_t n) const
+    { return kernel_traits<T>::fmadd(kernel_load<ALIGNED>(sa + i, n), kernel_load<ALIGNED>(sb + i, n), kernel_load<ALIGNED>(sd + i, n)); }
+};
+
+template <typename T>
+struct kernel_scale
+{
+    const typename kernel_traits<T>::vtype vs;
+    const T *sa;
+    kernel_scale(const T s, const T * const a): vs(kernel_traits<T>::set(s)), sa(a) { }
+
+    SIMD_FUNC_INLINE bool coaligned(const T * const sc) const
+    { return kernel_coaligned(sc, sa); }
+
+    template <bool ALIGNED>
+    SIMD_FUNC_INLINE typename kernel_traits<T>::vtype apply(const size_t i, const size_t n) const
+    { return kernel_traits<T>::mul(vs, kernel_load<ALIGNED>(sa + i, n)); }
+};
+
+template <typename T>
+struct kernel_axpy
+{
+    const typename kernel_traits<T>::vtype vs;
+    const T *sx, *sy;
+    kernel_axpy(const T s, const T * const x, const T * const y): vs(kernel_traits<T>::set(s)), sx(x), sy(y) { }
+
+    SIMD_FUNC_INLINE bool coaligned(const T * const sc) const
+    { return kernel_coaligned(sc, sx) && kernel_coaligned(sc, sy); }
+
+    template <bool ALIGNED>
+    SIMD_FUNC_INLINE typename kernel_traits<T>::vtype apply(const size_t i, const size_t n) const
+    { return kernel_traits<T>::fmadd(vs, kernel_load<ALIGNED>(sx + i, n), kernel_load<ALIGNED>(sy + i, n)); }
+};
+
+
+/*************
+ *  Kernels  *
+ *************/
+//! sc[i] = sa[i] + sb[i]
+template <typename T>
+static SIMD_FUNC_INLINE void add(T * const sc, const T * const sa, const T * const sb, const size_t n)
+{ kernel_run(sc, kernel_add<T>(sa, sb), n); }
+
+//! sc[i] = sa[i] - sb[i]
+template <typename T>
+static SIMD_FUNC_INLINE void sub(T * const sc, const T * const sa, const T * const sb, const size_t n)
+{ kernel_run(sc, kernel_sub<T>(sa, sb), n); }
+
+//! sc[i] = sa[i] * sb[i]
+template <typename T>
+static SIMD_FUNC_INLINE void mul(T * const sc, const T * const sa, const T * const sb, const size_t n)
+{ kernel_run(sc, kernel_mul<T>(sa, sb), n); }
+
+//! sc[i] = sa[i] * sb[i] + sd[i], fused if supported by SIMD interface
+template <typename T>
+static SIMD_FUNC_INLINE void fma(T * const sc, const T * const sa, const T * const sb, const T * const sd, const size_t n)
+{ kernel_run(sc, kernel_fma<T>(sa, sb, sd), n); }
+
+//! sc[i] = s * sa[i]
+template <typename T>
+static SIMD_FUNC_INLINE void scale(T * const sc, const typename kernel_traits<T>::stype s, const T * const sa, const size_t n)
+{ kernel_run(sc, kernel_scale<T>(s, sa), n); }
+
+//! sc[i] = s * sx[i] + sy[i]
+template <typename T>
+static SIMD_FUNC_INLINE void axpy(T * const sc, const typename kernel_traits<T>::stype s, const T * const sx, const T * const sy, const size_t n)
+{ kernel_run(sc, kernel_axpy<T>(s, sx, sy), n); }
+
+
+//! Range functor for parallel_for(), adds elements [lo, hi)
+template <typename T>
+struct kernel_add_range
+{
+    typedef T stype;
+    T *sc;
+    const T *sa, *sb;
+    kernel_add_range(T * const c, const T * const a, const T * const b): sc(c), sa(a), sb(b) { }
+
+    SIMD_FUNC_INLINE void operator()(const size_t lo, const size_t hi) const
+    { add(sc + lo, sa + lo, sb + lo, hi - lo); }
+};
+
+/*!
+ *  Add arrays element-wise into a new array from allocator policy A, e.g.,
+ *  pool_allocator (release with pool_free()) or arena_allocator (released
+ *  with the arena), see arena.h.
+ *  Work is dispatched with parallel_for() among the OpenMP threads set by SYSCONF.
+ *  \return NULL if allocation fails
+ */
+template <typename T, typename A>
+static SIMD_FUNC_INLINE T * add(const T * const sa, const T * const sb, const size_t n, const bool run_par, const A &)
+{
+    T *sc = (T *)A::allocate(n * sizeof(T));
+    if (sc) {
+        const int32_t nthreads = ((SYSCONF::get_omp() & run_par) == true) ? (SYSCONF::get_threads()) : (1);
+        parallel_for(n, kernel_add_range<T>(sc, sa, sb), nthreads);
+    }
+    return sc;
+}
+
+/*!
+ *  Add arrays element-wise into a new aligned array (caller frees it).
+ *  \return NULL if allocation fails
+ */
+template <typename T>
+static SIMD_FUNC_INLINE T * add(const T * const sa, const T * const sb, const size_t n = kernel_traits<T>::nstreams, const bool run_par = true)
+{ return add(sa, sb, n, run_par, heap_allocator()); }
+
+
+}  // namespace gvl
+
+
+#endif  // _KERNELS_H
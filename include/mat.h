@@ -0,0 +1,327 @@
+/*!
+ *  \brief Fixed-size small matrices, mat<T, R, C>
+ *  Dimensions are template parameters (2x2 to 8x8 in mind), so loops over
+ *  rows, columns and vectors have constant trip counts and are unrolled by
+ *  the compiler into register-resident SIMD code for the selected interface.
+ *  Matrices are stored column-major with columns padded to whole vectors:
+ *  - products combine columns of the left operand scaled by broadcast
+ *    elements of the right one (multiply-adds, no horizontal sums),
+ *  - column vectors, mat<T, N, 1>, fit in one register for N up to the
+ *    SIMD width, so matrix-vector products are matrix products,
+ *  - inverse and determinant use Gauss-Jordan elimination by column
+ *    operations, one vector operation per column.
+ *  \note Padding elements are kept zero by every operation
+ */
+#ifndef _MAT_H
+#define _MAT_H
+
+
+#include <stdint.h>
+#include <stddef.h>   // size_t
+#include "simd.h"
+#include "dispatch.h"  // lane_traits
+
+
+namespace gvl {
+
+
+/*!
+ *  \class mat_traits
+ *  \brief SIMD datatype of matrix columns of type T
+ */
+template <typename T>
+struct mat_traits: lane_traits<T>
+{ };
+
+
+/*!
+ *  \class mat
+ *  \brief Matrix of R x C elements of type T (float, double)
+ *  Column j holds elements (0..R-1, j) followed by zeros up to ld elements,
+ *  a whole number (nv) of vectors.
+ *  Memory access does not assume alignment and the storage is not
+ *  over-aligned, so objects can live in standard containers (C++98
+ *  allocators only guarantee alignment of the element type).
+ */
+template <typename T, size_t R, size_t C>
+class mat
+{
+    public:
+        typedef T stype;
+        typedef mat_traits<T> traits;
+        typedef typename traits::vtype vtype;
+        static const size_t nlanes = traits::nlanes;
+        static const size_t nv = (R + nlanes - 1) / nlanes;
+        static const size_t ld = nv * nlanes;
+        static const size_t rows = R;
+        static const size_t cols = C;
+
+    private:
+        T a[C * ld];
+
+    public:
+        /******************
+         *  Constructors  *
+         ******************/
+        //! Constructor with no parameters, elements are set to zero
+        mat()
+        {
+            for (size_t i = 0; i < C * ld; ++i)
+                a[i] = (T)0;
+        }
+
+        //! Constructor from R x C row-major elements
+        explicit mat(const T * const sa)
+        {
+            for (size_t i = 0; i < C * ld; ++i)
+                a[i] = (T)0;
+            load(sa);
+        }
+
+        //! Ones on the diagonal
+        static mat identity()
+        {
+            mat ma;
+            for (size_t i = 0; i < R && i < C; ++i)
+                ma(i, i) = (T)1;
+            return ma;
+        }
+
+        /*************
+         *  Get/set  *
+         *************/
+        SIMD_FUNC_INLINE T & operator()(const size_t i, const size_t j)
+        { return a[j * ld + i]; }
+
+        SIMD_FUNC_INLINE T operator()(const size_t i, const size_t j) const
+        { return a[j * ld + i]; }
+
+        //! Column-major padded elements
+        SIMD_FUNC_INLINE T * data()
+        { return a; }
+
+        SIMD_FUNC_INLINE const T * data() const
+        { return a; }
+
+        //! Vector \c v of column \c j
+        SIMD_FUNC_INLINE vtype col(const size_t j, const size_t v) const
+        { return simd_loadu(a + j * ld + v * nlanes); }
+
+        SIMD_FUNC_INLINE void set_col(const size_t j, const size_t v, const vtype va)
+        { simd_storeu(a + j * ld + v * nlanes, va); }
+
+        //! Read R x C row-major elements
+        SIMD_FUNC_INLINE void load(const T * const sa)
+        {
+            for (size_t i = 0; i < R; ++i)
+                for (size_t j = 0; j < C; ++j)
+                    a[j * ld + i] = sa[i * C + j];
+        }
+
+        //! Write R x C row-major elements
+        SIMD_FUNC_INLINE void store(T * const sa) const
+        {
+            for (size_t i = 0; i < R; ++i)
+                for (size_t j = 0; j < C; ++j)
+                    sa[i * C + j] = a[j * ld + i];
+        }
+
+        /****************
+         *  Operations  *
+         ****************/
+        SIMD_FUNC_INLINE mat & operator+=(const mat &mb)
+        {
+            for (size_t j = 0; j < C; ++j)
+                for (size_t v = 0; v < nv; ++v)
+                    set_col(j, v, simd_add(col(j, v), mb.col(j, v)));
+            return *this;
+        }
+
+        SIMD_FUNC_INLINE mat & operator-=(const mat &mb)
+        {
+            for (size_t j = 0; j < C; ++j)
+                for (size_t v = 0; v < nv; ++v)
+                    set_col(j, v, simd_sub(col(j, v), mb.col(j, v)));
+            return *this;
+        }
+
+        SIMD_FUNC_INLINE mat & operator*=(const T sb)
+        {
+            const vtype vb = simd_set(sb);
+            for (size_t j = 0; j < C; ++j)
+                for (size_t v = 0; v < nv; ++v)
+                    set_col(j, v, simd_mul(col(j, v), vb));
+            return *this;
+        }
+
+        SIMD_FUNC_INLINE mat operator+(const mat &mb) const
+        { mat mc(*this); mc += mb; return mc; }
+
+        SIMD_FUNC_INLINE mat operator-(const mat &mb) const
+        { mat mc(*this); mc -= mb; return mc; }
+
+        SIMD_FUNC_INLINE mat operator*(const T sb) const
+        { mat mc(*this); mc *= sb; return mc; }
+
+        /*!
+         *  Product with a C x K matrix, column j of the result is the sum of
+         *  columns k scaled by mb(k, j)
+         */
+        template <size_t K>
+        SIMD_FUNC_INLINE mat<T, R, K> operator*(const mat<T, C, K> &mb) const
+        {
+            mat<T, R, K> mc;
+            for (size_t j = 0; j < K; ++j)
+                for (size_t v = 0; v < nv; ++v) {
+                    vtype vc = simd_mul(col(0, v), simd_set(mb(0, j)));
+                    for (size_t k = 1; k < C; ++k)
+                        vc = simd_fmadd(col(k, v), simd_set(mb(k, j)), vc);
+                    mc.set_col(j, v, vc);
+                }
+            return mc;
+        }
+};
+
+template <typename T, size_t R, size_t C>
+static SIMD_FUNC_INLINE mat<T, R, C> operator*(const T sa, const mat<T, R, C> &mb)
+{ return mb * sa; }
+
+
+/*!
+ *  Transpose by elements, square tiles of 4 and 8 use the in-register tile
+ *  transposes of the SIMD interface when columns are not padded
+ */
+template <typename T, size_t R, size_t C>
+struct mat_transpose
+{
+    static SIMD_FUNC_INLINE void run(mat<T, C, R> &mb, const mat<T, R, C> &ma)
+    {
+        for (size_t i = 0; i < R; ++i)
+            for (size_t j = 0; j < C; ++j)
+                mb(j, i) = ma(i, j);
+    }
+};
+
+#define MAT_TRANSPOSE_TILE(STYPE, N, FUNC) \
+template <> \
+struct mat_transpose<STYPE, N, N> \
+{ \
+    static SIMD_FUNC_INLINE void run(mat<STYPE, N, N> &mb, const mat<STYPE, N, N> &ma) \
+    { \
+        if (mat<STYPE, N, N>::ld == N) { \
+            FUNC(mb.data(), N, ma.data(), N); \
+        } \
+        else { \
+            for (size_t i = 0; i < N; ++i) \
+                for (size_t j = 0; j < N; ++j) \
+                    mb(j, i) = ma(i, j); \
+        } \
+    } \
+};
+
+MAT_TRANSPOSE_TILE(float, 4, simd_transpose4x4_f32)
+MAT_TRANSPOSE_TILE(float, 8, simd_transpose8x8_f32)
+MAT_TRANSPOSE_TILE(double, 4, simd_transpose4x4_f64)
+MAT_TRANSPOSE_TILE(double, 8, simd_transpose8x8_f64)
+
+#undef MAT_TRANSPOSE_TILE
+
+template <typename T, size_t R, size_t C>
+static SIMD_FUNC_INLINE mat<T, C, R> transpose(const mat<T, R, C> &ma)
+{
+    mat<T, C, R> mb;
+    mat_transpose<T, R, C>::run(mb, ma);
+    return mb;
+}
+
+
+/*!
+ *  Gauss-Jordan elimination by column operations with partial pivoting
+ *  along rows, reduces \c ma to identity and applies the same operations
+ *  to \c mb (if not NULL), which becomes mb * ma^-1
+ *  \return Determinant of \c ma, 0 if singular (\c ma and \c mb are then
+ *          partially reduced)
+ */
+template <typename T, size_t N, size_t M>
+static SIMD_FUNC_INLINE T mat_eliminate(mat<T, N, N> &ma, mat<T, M, N> * const mb)
+{
+    typedef typename mat<T, N, N>::vtype vtype;
+    const size_t nva = mat<T, N, N>::nv;
+    const size_t nvb = mat<T, M, N>::nv;
+    T det = (T)1;
+
+    for (size_t k = 0; k < N; ++k) {
+        // Pivot, largest element of row k in columns k..N-1
+        size_t p = k;
+        for (size_t j = k + 1; j < N; ++j) {
+            const T x = ma(k, j), y = ma(k, p);
+            if (((x < 0) ? (-x) : (x)) > ((y < 0) ? (-y) : (y)))
+                p = j;
+        }
+        const T piv = ma(k, p);
+        if (piv == (T)0)
+            return (T)0;
+        if (p != k) {
+            det = -det;
+            for (size_t v = 0; v < nva; ++v) {
+                const vtype vk = ma.col(k, v);
+                ma.set_col(k, v, ma.col(p, v));
+                ma.set_col(p, v, vk);
+            }
+            if (mb)
+                for (size_t v = 0; v < nvb; ++v) {
+                    const vtype vk = mb->col(k, v);
+                    mb->set_col(k, v, mb->col(p, v));
+                    mb->set_col(p, v, vk);
+                }
+        }
+        det *= piv;
+
+        // Unit pivot, then zero the rest of row k
+        const vtype vinv = simd_set((T)1 / piv);
+        for (size_t v = 0; v < nva; ++v)
+            ma.set_col(k, v, simd_mul(ma.col(k, v), vinv));
+        if (mb)
+            for (size_t v = 0; v < nvb; ++v)
+                mb->set_col(k, v, simd_mul(mb->col(k, v), vinv));
+
+        for (size_t j = 0; j < N; ++j) {
+            if (j == k)
+                continue;
+            const vtype vf = simd_set(-ma(k, j));
+            for (size_t v = 0; v < nva; ++v)
+                ma.set_col(j, v, simd_fmadd(ma.col(k, v), vf, ma.col(j, v)));
+            if (mb)
+                for (size_t v = 0; v < nvb; ++v)
+                    mb->set_col(j, v, simd_fmadd(mb->col(k, v), vf, mb->col(j, v)));
+        }
+    }
+
+    return det;
+}
+
+//! Determinant of a square matrix
+template <typename T, size_t N>
+static SIMD_FUNC_INLINE T determinant(const mat<T, N, N> &ma)
+{
+    mat<T, N, N> mw(ma);
+    return mat_eliminate(mw, (mat<T, N, N> *)NULL);
+}
+
+/*!
+ *  Inverse of a square matrix
+ *  \return 0 if successful, -1 if \c ma is singular (\c mb is undefined)
+ */
+template <typename T, size_t N>
+static SIMD_FUNC_INLINE int inverse(mat<T, N, N> &mb, const mat<T, N, N> &ma)
+{
+    mat<T, N, N> mw(ma);
+    mb = mat<T, N, N>::identity();
+    return (mat_eliminate(mw, &mb) == (T)0) ? (-1) : (0);
+}
+
+
+}  // namespace gvl
+
+
+#endif  // _MAT_H
@@ -6,6 +6,7 @@
  *  Support '_t' C datatypes
  */
 #include <stdint.h>
+#include <stddef.h>   // size_t
 
 
 /*
@@ -31,6 +32,10 @@
 #endif
 
 
+namespace gvl {
+namespace mmx {
+
+
 /*
  *  MMX 64-bit wide vector units
  *  Define constants required for SIMD module to function properly.
@@ -411,6 +416,15 @@ static SIMD_FUNC_INLINE
 SIMD_DBL simd_load(const double * const sa)
 { return (SIMD_DBL)(*sa); }
 
+//! Floating-point elements are scalar, no alignment is needed
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_loadu(const float * const sa)
+{ return (SIMD_FLT)(*sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_loadu(const double * const sa)
+{ return (SIMD_DBL)(*sa); }
+
 
 /*******************************
  *  Store intrinsics
@@ -455,6 +469,405 @@ static SIMD_FUNC_INLINE
 void simd_store(double * const sa, const SIMD_DBL va)
 { sa[0] = (double)va; }
 
+static SIMD_FUNC_INLINE
+void simd_storeu(float * const sa, const SIMD_FLT va)
+{ sa[0] = (float)va; }
+
+static SIMD_FUNC_INLINE
+void simd_storeu(double * const sa, const SIMD_DBL va)
+{ sa[0] = (double)va; }
+
+
+/***************************
+ *  Interleave intrinsics
+ ***************************/
+/*!
+ *  Load records of 2/3/4 components (array of structures) and split them
+ *  into one vector per component (structure of arrays), e.g., xyz points
+ *  or RGB/RGBA pixels. simd_store_interleave* is the inverse.
+ *  Each call reads/writes 2/3/4 vectors of consecutive elements, pointers
+ *  need not be aligned.
+ *  Floating-point vectors hold a single element, a record.
+ */
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb)
+{
+    *va = sa[0];
+    *vb = sa[1];
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc)
+{
+    *va = sa[0];
+    *vb = sa[1];
+    *vc = sa[2];
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc, SIMD_FLT * const vd)
+{
+    *va = sa[0];
+    *vb = sa[1];
+    *vc = sa[2];
+    *vd = sa[3];
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(float * const sa, const SIMD_FLT va, const SIMD_FLT vb)
+{
+    sa[0] = va;
+    sa[1] = vb;
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc)
+{
+    sa[0] = va;
+    sa[1] = vb;
+    sa[2] = vc;
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc, const SIMD_FLT vd)
+{
+    sa[0] = va;
+    sa[1] = vb;
+    sa[2] = vc;
+    sa[3] = vd;
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb)
+{
+    *va = sa[0];
+    *vb = sa[1];
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc)
+{
+    *va = sa[0];
+    *vb = sa[1];
+    *vc = sa[2];
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc, SIMD_DBL * const vd)
+{
+    *va = sa[0];
+    *vb = sa[1];
+    *vc = sa[2];
+    *vd = sa[3];
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(double * const sa, const SIMD_DBL va, const SIMD_DBL vb)
+{
+    sa[0] = va;
+    sa[1] = vb;
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc)
+{
+    sa[0] = va;
+    sa[1] = vb;
+    sa[2] = vc;
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc, const SIMD_DBL vd)
+{
+    sa[0] = va;
+    sa[1] = vb;
+    sa[2] = vc;
+    sa[3] = vd;
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    const SIMD_INT v0 = simd_load(sa);
+    const SIMD_INT v1 = simd_load(sa + 2);
+    *va = _mm_unpacklo_pi32(v0, v1);
+    *vb = _mm_unpackhi_pi32(v0, v1);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    const SIMD_INT v0 = simd_load(sa);
+    const SIMD_INT v1 = simd_load(sa + 2);
+    const SIMD_INT v2 = simd_load(sa + 4);
+    *va = _mm_unpacklo_pi32(v0, _mm_srli_si64(v1, 0x20));
+    *vb = _mm_unpackhi_pi32(v0, _mm_slli_si64(v2, 0x20));
+    *vc = _mm_unpacklo_pi32(v1, _mm_srli_si64(v2, 0x20));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    const SIMD_INT v0 = simd_load(sa);
+    const SIMD_INT v1 = simd_load(sa + 2);
+    const SIMD_INT v2 = simd_load(sa + 4);
+    const SIMD_INT v3 = simd_load(sa + 6);
+    *va = _mm_unpacklo_pi32(v0, v2);
+    *vb = _mm_unpackhi_pi32(v0, v2);
+    *vc = _mm_unpacklo_pi32(v1, v3);
+    *vd = _mm_unpackhi_pi32(v1, v3);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{
+    simd_store(sa, _mm_unpacklo_pi32(va, vb));
+    simd_store(sa + 2, _mm_unpackhi_pi32(va, vb));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{
+    simd_store(sa, _mm_unpacklo_pi32(va, vb));
+    simd_store(sa + 2, _mm_unpacklo_pi32(vc, _mm_srli_si64(va, 0x20)));
+    simd_store(sa + 4, _mm_unpackhi_pi32(vb, vc));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{
+    simd_store(sa, _mm_unpacklo_pi32(va, vb));
+    simd_store(sa + 2, _mm_unpacklo_pi32(vc, vd));
+    simd_store(sa + 4, _mm_unpackhi_pi32(va, vb));
+    simd_store(sa + 6, _mm_unpackhi_pi32(vc, vd));
+}
+
+/*!
+ *  8-bit records (e.g., pixels) of 2/4 components use 16-bit packs. MMX has
+ *  no byte shuffle, 3 components fall back to scalar element copies through
+ *  memory.
+ */
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    const SIMD_INT vmsk = _mm_set1_pi16(0x00FF);
+    const SIMD_INT v0 = *(const SIMD_INT *)sa;
+    const SIMD_INT v1 = *(const SIMD_INT *)(sa + 8);
+    *va = _mm_packs_pu16(_mm_and_si64(v0, vmsk), _mm_and_si64(v1, vmsk));
+    *vb = _mm_packs_pu16(_mm_srli_pi16(v0, 8), _mm_srli_pi16(v1, 8));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    uint8_t tmp[3][8] SIMD_ALIGNED(8);
+    for (int32_t i = 0; i < 8; ++i) {
+        tmp[0][i] = sa[3 * i];
+        tmp[1][i] = sa[3 * i + 1];
+        tmp[2][i] = sa[3 * i + 2];
+    }
+    *va = *(const SIMD_INT *)tmp[0];
+    *vb = *(const SIMD_INT *)tmp[1];
+    *vc = *(const SIMD_INT *)tmp[2];
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    // Components (0, 2) and (1, 3), then split each pair
+    SIMD_INT vac0, vbd0, vac1, vbd1;
+    simd_load_deinterleave2(sa, &vac0, &vbd0);
+    simd_load_deinterleave2(sa + 16, &vac1, &vbd1);
+    const SIMD_INT vmsk = _mm_set1_pi16(0x00FF);
+    *va = _mm_packs_pu16(_mm_and_si64(vac0, vmsk), _mm_and_si64(vac1, vmsk));
+    *vb = _mm_packs_pu16(_mm_and_si64(vbd0, vmsk), _mm_and_si64(vbd1, vmsk));
+    *vc = _mm_packs_pu16(_mm_srli_pi16(vac0, 8), _mm_srli_pi16(vac1, 8));
+    *vd = _mm_packs_pu16(_mm_srli_pi16(vbd0, 8), _mm_srli_pi16(vbd1, 8));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{
+    *(SIMD_INT *)sa = _mm_unpacklo_pi8(va, vb);
+    *(SIMD_INT *)(sa + 8) = _mm_unpackhi_pi8(va, vb);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{
+    uint8_t tmp[3][8] SIMD_ALIGNED(8);
+    *(SIMD_INT *)tmp[0] = va;
+    *(SIMD_INT *)tmp[1] = vb;
+    *(SIMD_INT *)tmp[2] = vc;
+    for (int32_t i = 0; i < 8; ++i) {
+        sa[3 * i] = tmp[0][i];
+        sa[3 * i + 1] = tmp[1][i];
+        sa[3 * i + 2] = tmp[2][i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{
+    const SIMD_INT vab_lo = _mm_unpacklo_pi8(va, vb);
+    const SIMD_INT vab_hi = _mm_unpackhi_pi8(va, vb);
+    const SIMD_INT vcd_lo = _mm_unpacklo_pi8(vc, vd);
+    const SIMD_INT vcd_hi = _mm_unpackhi_pi8(vc, vd);
+    *(SIMD_INT *)sa = _mm_unpacklo_pi16(vab_lo, vcd_lo);
+    *(SIMD_INT *)(sa + 8) = _mm_unpackhi_pi16(vab_lo, vcd_lo);
+    *(SIMD_INT *)(sa + 16) = _mm_unpacklo_pi16(vab_hi, vcd_hi);
+    *(SIMD_INT *)(sa + 24) = _mm_unpackhi_pi16(vab_hi, vcd_hi);
+}
+
+
+/**************************
+ *  Transpose intrinsics
+ **************************/
+/*!
+ *  Transpose a square tile, sb[j * ldb + i] = sa[i * lda + j].
+ *  Rows of \c sa are loaded into registers, transposed with shuffles and
+ *  stored as rows of \c sb. Leading dimensions are in elements, rows need
+ *  not be aligned and tiles must not overlap.
+ */
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    for (int32_t i = 0; i < 4; ++i)
+        for (int32_t j = 0; j < 4; ++j)
+            sb[j * ldb + i] = sa[i * lda + j];
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    for (int32_t i = 0; i < 8; ++i)
+        for (int32_t j = 0; j < 8; ++j)
+            sb[j * ldb + i] = sa[i * lda + j];
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    for (int32_t i = 0; i < 4; ++i)
+        for (int32_t j = 0; j < 4; ++j)
+            sb[j * ldb + i] = sa[i * lda + j];
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    for (int32_t i = 0; i < 8; ++i)
+        for (int32_t j = 0; j < 8; ++j)
+            sb[j * ldb + i] = sa[i * lda + j];
+}
+
+
+/*************************
+ *  Gather instructions  *
+ *************************/
+/*!
+ *  Gather, lane i is loaded from sa[idx[i]], one 32-bit index per lane.
+ *  Indices need not be sorted or distinct and are not range-checked.
+ */
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_gather(const float * const sa, const int32_t * const idx)
+{ return (SIMD_FLT)sa[idx[0]]; }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_gather(const double * const sa, const int32_t * const idx)
+{ return (SIMD_DBL)sa[idx[0]]; }
+
+
+/************************
+ *  Align instructions  *
+ ************************/
+/*!
+ *  Lanes N .. N + nlanes - 1 of the concatenation of vb (low lanes) and va
+ *  (high lanes), 0 <= N <= nlanes. Vectors at consecutive aligned addresses
+ *  give the vector at an unaligned offset of N elements.
+ */
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_alignr(const SIMD_FLT va, const SIMD_FLT vb)
+{ return (N <= 0) ? (vb) : (va); }
+
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_alignr(const SIMD_DBL va, const SIMD_DBL vb)
+{ return (N <= 0) ? (vb) : (va); }
+
+
+/***********************
+ *  Scan instructions  *
+ ***********************/
+/*!
+ *  Inclusive prefix sums of the lanes of va plus the carry *vc (all lanes
+ *  equal), by log2(nlanes) steps of lane shifts and adds. The sum of va is
+ *  broadcast and added to *vc, the carry of the next vector, so that one
+ *  add per vector is on the loop-carried path.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_32(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const SIMD_INT vs = _mm_add_pi32(va, _mm_slli_si64(va, 32));
+    const SIMD_INT vp = *vc;
+    *vc = _mm_add_pi32(vp, _mm_unpackhi_pi32(vs, vs));
+    return _mm_add_pi32(vs, vp);
+}
+
+//! No 64-bit adds in MMX, the single lane is added in general registers
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_64(const SIMD_INT va, SIMD_INT * const vc)
+{
+    *vc = _mm_cvtsi64_m64((int64_t)((uint64_t)_mm_cvtm64_si64(va) + (uint64_t)_mm_cvtm64_si64(*vc)));
+    return *vc;
+}
+
+//! Floating-point elements are scalar
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan(const SIMD_FLT va, SIMD_FLT * const vc)
+{ return (*vc += va); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan(const SIMD_DBL va, SIMD_DBL * const vc)
+{ return (*vc += va); }
+
+/*!
+ *  Exclusive prefix sums, lane i is the carry plus lanes 0 .. i-1 of va,
+ *  *vc is updated as by the inclusive sums
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_32(const SIMD_INT va, SIMD_INT * const vc)
+{ return _mm_sub_pi32(simd_scan_32(va, vc), va); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_64(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const SIMD_INT vp = *vc;
+    simd_scan_64(va, vc);
+    return vp;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan_excl(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    const SIMD_FLT vp = *vc;
+    *vc += va;
+    return vp;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan_excl(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    const SIMD_DBL vp = *vc;
+    *vc += va;
+    return vp;
+}
+
+
+}  // namespace mmx
+}  // namespace gvl
+
 
 #endif  // _MMX_H
 
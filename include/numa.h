@@ -0,0 +1,88 @@
+/*!
+ *  \brief NUMA page placement
+ *  Memory policies for aligned buffers, applied with the mbind and
+ *  set_mempolicy system calls (no libnuma dependency):
+ *  - local, pages on the node of the allocating thread
+ *  - interleave, pages round-robin over all nodes
+ *  - partition, each chunk range of the OpenMP dispatcher on the node of the
+ *    thread that processes it, requires threads pinned with set_affinity()
+ *  Policies are hints, pages already touched are migrated if possible and
+ *  placement is left to first touch if the system does not support NUMA.
+ *  first_touch() initializes a buffer in parallel with the dispatcher
+ *  partitioning, so each thread touches (and places) the pages it works on.
+ */
+#ifndef _NUMA_H
+#define _NUMA_H
+
+
+#include <stdint.h>
+#include <stddef.h>   // size_t
+#include "dispatch.h"
+
+
+namespace gvl {
+
+
+//! Page placement policies
+enum numa_policy {
+    NUMA_DEFAULT,     //!< Kernel default, pages on the node of the first thread touching them
+    NUMA_LOCAL,       //!< Pages on the node of the allocating thread
+    NUMA_INTERLEAVE,  //!< Pages interleaved over all nodes
+    NUMA_PARTITION    //!< Pages on the node of the thread owning their dispatcher chunk
+};
+
+//! Number of NUMA nodes online, 1 if unknown
+int32_t numa_num_nodes();
+
+//! Node of logical CPU \c cpu, 0 if unknown
+int32_t numa_cpu_node(const int32_t cpu);
+
+/*!
+ *  Place pages of an array of \c nelems elements of \c elem_bytes bytes
+ *  following \c policy, \c sa should be page-aligned.
+ *  For NUMA_PARTITION, chunks are computed as parallel_for() does with
+ *  \c nthreads threads (if < 1 uses get_dispatch_threads()), it is refused
+ *  with the work-stealing backend, whose chunks have no owner thread.
+ *  \return 0 on success, -1 if policy could not be applied
+ */
+int32_t numa_place(void * const sa, const size_t nelems, const size_t elem_bytes, const numa_policy policy, const int32_t nthreads = 0);
+
+/*!
+ *  Set policy for future allocations of calling thread (NUMA_DEFAULT,
+ *  NUMA_LOCAL or NUMA_INTERLEAVE)
+ *  \return 0 on success, -1 otherwise
+ */
+int32_t numa_thread_policy(const numa_policy policy);
+
+
+//! Range functor for first_touch(), sets elements [lo, hi)
+template <typename T>
+struct first_touch_range
+{
+    typedef T stype;
+    T *sa;
+    T value;
+    first_touch_range(T * const a, const T v): sa(a), value(v) { }
+
+    void operator()(const size_t lo, const size_t hi) const
+    {
+        for (size_t i = lo; i < hi; ++i)
+            sa[i] = value;
+    }
+};
+
+/*!
+ *  Initialize \c n elements to \c value with parallel_for(), each thread
+ *  touches the pages of the chunks it processes in later parallel_for() calls
+ *  with the same number of threads (OpenMP backend).
+ *  \param[in] nthreads Number of threads, if < 1 uses get_dispatch_threads()
+ */
+template <typename T>
+static inline void first_touch(T * const sa, const size_t n, const T value = T(), const int32_t nthreads = 0)
+{ parallel_for(n, first_touch_range<T>(sa, value), nthreads); }
+
+
+}  // namespace gvl
+
+
+#endif  // _NUMA_H
@@ -6,6 +6,8 @@
  *  Support '_t' C datatypes
  */
 #include <stdint.h>
+#include <stddef.h>   // size_t
+#include <math.h>     // sqrt, lrint
 
 
 /*
@@ -29,17 +31,61 @@
 */
 
 
+#ifndef _SHUFFLE_CTRL_
+#define _SHUFFLE_CTRL_
+/*!
+ *  Control values for shuffle operations
+ *  \todo Move this enum to a global area, all SIMD modes will use it
+ */
+enum SHUFFLE_CTRL { XCHG = 0, // Exchange lower/upper halfs of register
+                    XCHG8,    // Exchange pairs of 8-bit elements
+                    XCHG16,   // Exchange pairs of 16-bit elements
+                    XCHG32,   // Exchange pairs of 32-bit elements
+                    XCHG64,   // Exchange pairs of 64-bit elements
+                    DUPL,     // Duplicate lower half into upper half of register
+                    DUPH };   // Duplicate upper half into lower half of register
+#endif
+
+
+namespace gvl {
+namespace scalar {
+
+
 /*
- *  Disable SIMD for scalar mode, no vector units
+ *  Scalar mode, no vector units
+ *  Vector registers are emulated with fixed-length arrays of the same width
+ *  as SSE4.2, so code written for the SIMD interface runs unchanged.
+ *  Every operation is a fixed trip count loop over the elements, which
+ *  compilers are able to unroll and auto-vectorize (SLP) when possible.
  *  Define constants required for SIMD module to function properly.
  */
-const int32_t SIMD_WIDTH_BYTES = 8;
-const int32_t SIMD_STREAMS_16 = 1;
-const int32_t SIMD_STREAMS_32 = 1;
-const int32_t SIMD_STREAMS_64 = 1;
-typedef int SIMD_INT;
-typedef float SIMD_FLT;
-typedef double SIMD_DBL;
+const int32_t SIMD_WIDTH_BITS = 128;
+const int32_t SIMD_WIDTH_BYTES = SIMD_WIDTH_BITS / 8;
+const int32_t SIMD_STREAMS_8 = SIMD_WIDTH_BYTES;
+const int32_t SIMD_STREAMS_16 = SIMD_WIDTH_BYTES / 2;
+const int32_t SIMD_STREAMS_32 = SIMD_WIDTH_BYTES / 4;
+const int32_t SIMD_STREAMS_64 = SIMD_WIDTH_BYTES / 8;
+
+typedef union SIMD_ALIGNED(SIMD_WIDTH_BYTES) {
+    int8_t   i8[SIMD_STREAMS_8];
+    uint8_t  u8[SIMD_STREAMS_8];
+    int16_t  i16[SIMD_STREAMS_16];
+    uint16_t u16[SIMD_STREAMS_16];
+    int32_t  i32[SIMD_STREAMS_32];
+    uint32_t u32[SIMD_STREAMS_32];
+    int64_t  i64[SIMD_STREAMS_64];
+    uint64_t u64[SIMD_STREAMS_64];
+} SIMD_INT;
+
+typedef union SIMD_ALIGNED(SIMD_WIDTH_BYTES) {
+    float    f32[SIMD_STREAMS_32];
+    uint32_t u32[SIMD_STREAMS_32];  // bitwise access for logical operations
+} SIMD_FLT;
+
+typedef union SIMD_ALIGNED(SIMD_WIDTH_BYTES) {
+    double   f64[SIMD_STREAMS_64];
+    uint64_t u64[SIMD_STREAMS_64];  // bitwise access for logical operations
+} SIMD_DBL;
 
 
 /*
@@ -51,42 +97,2065 @@ typedef double SIMD_DBL;
  *  simd_*_XX  = unsigned/signed XX-bit integers
  *  simd_*_XX  = (set functions) specifies width to consider for integer types
  *  simd_*     = datatype obtained from function overloading and parameters
+ *
+ *  NOTE: integer arithmetic is performed on unsigned elements so that
+ *  overflow wraps around as in vector units.
+ */
+
+
+/***********************
+ *  Misc instructions  *
+ ***********************/
+static SIMD_FUNC_INLINE
+void simd_prefetch(const void *sa, const int32_t hint = 0)
+{
+    switch (hint) {
+        case 1: __prefetchw((char *)sa); break;
+        default: __prefetchr((char *)sa); break;
+    }
+}
+
+
+/*****************************
+ *  Arithmetic instructions  *
+ *****************************/
+static SIMD_FUNC_INLINE
+SIMD_INT simd_add_8(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i)
+        vc.u8[i] = (uint8_t)(va.u8[i] + vb.u8[i]);
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_add_16(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_16; ++i)
+        vc.u16[i] = (uint16_t)(va.u16[i] + vb.u16[i]);
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_add_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = va.u32[i] + vb.u32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_add_64(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = va.u64[i] + vb.u64[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_add(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.f32[i] = va.f32[i] + vb.f32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_add(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.f64[i] = va.f64[i] + vb.f64[i];
+    return vc;
+}
+
+/*!
+ *  Horizontal operations store pairwise results from first operand in lower
+ *  half and from second operand in upper half.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_hadd_16(const SIMD_INT va, const SIMD_INT vb)
+{
+    const int32_t mid = SIMD_STREAMS_16 / 2;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.u16[i] = (uint16_t)(va.u16[2 * i] + va.u16[2 * i + 1]);
+        vc.u16[i + mid] = (uint16_t)(vb.u16[2 * i] + vb.u16[2 * i + 1]);
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_hadd_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.u32[i] = va.u32[2 * i] + va.u32[2 * i + 1];
+        vc.u32[i + mid] = vb.u32[2 * i] + vb.u32[2 * i + 1];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_hadd(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.f32[i] = va.f32[2 * i] + va.f32[2 * i + 1];
+        vc.f32[i + mid] = vb.f32[2 * i] + vb.f32[2 * i + 1];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_hadd(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.f64[i] = va.f64[2 * i] + va.f64[2 * i + 1];
+        vc.f64[i + mid] = vb.f64[2 * i] + vb.f64[2 * i + 1];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sub_8(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i)
+        vc.u8[i] = (uint8_t)(va.u8[i] - vb.u8[i]);
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sub_16(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_16; ++i)
+        vc.u16[i] = (uint16_t)(va.u16[i] - vb.u16[i]);
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sub_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = va.u32[i] - vb.u32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sub_64(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = va.u64[i] - vb.u64[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_sub(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.f32[i] = va.f32[i] - vb.f32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_sub(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.f64[i] = va.f64[i] - vb.f64[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_hsub_16(const SIMD_INT va, const SIMD_INT vb)
+{
+    const int32_t mid = SIMD_STREAMS_16 / 2;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.u16[i] = (uint16_t)(va.u16[2 * i] - va.u16[2 * i + 1]);
+        vc.u16[i + mid] = (uint16_t)(vb.u16[2 * i] - vb.u16[2 * i + 1]);
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_hsub_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.u32[i] = va.u32[2 * i] - va.u32[2 * i + 1];
+        vc.u32[i + mid] = vb.u32[2 * i] - vb.u32[2 * i + 1];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_hsub(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.f32[i] = va.f32[2 * i] - va.f32[2 * i + 1];
+        vc.f32[i + mid] = vb.f32[2 * i] - vb.f32[2 * i + 1];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_hsub(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.f64[i] = va.f64[2 * i] - va.f64[2 * i + 1];
+        vc.f64[i + mid] = vb.f64[2 * i] - vb.f64[2 * i + 1];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_fmadd(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc)
+{
+    SIMD_FLT vd;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vd.f32[i] = va.f32[i] * vb.f32[i] + vc.f32[i];
+    return vd;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_fmadd(const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc)
+{
+    SIMD_DBL vd;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vd.f64[i] = va.f64[i] * vb.f64[i] + vc.f64[i];
+    return vd;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_fmsub(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc)
+{
+    SIMD_FLT vd;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vd.f32[i] = va.f32[i] * vb.f32[i] - vc.f32[i];
+    return vd;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_fmsub(const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc)
+{
+    SIMD_DBL vd;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vd.f64[i] = va.f64[i] * vb.f64[i] - vc.f64[i];
+    return vd;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_16(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_16; ++i)
+        vc.u16[i] = (uint16_t)((uint32_t)va.u16[i] * vb.u16[i]);
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = va.u32[i] * vb.u32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_64(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = va.u64[i] * vb.u64[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_mul(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.f32[i] = va.f32[i] * vb.f32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_mul(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.f64[i] = va.f64[i] * vb.f64[i];
+    return vc;
+}
+
+/*!
+ *  Widening multiplications use the even elements of the operands.
  */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_i16_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.i32[i] = (int32_t)va.i16[2 * i] * (int32_t)vb.i16[2 * i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_i32_64(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.i64[i] = (int64_t)va.i32[2 * i] * (int64_t)vb.i32[2 * i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_u16_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = (uint32_t)va.u16[2 * i] * (uint32_t)vb.u16[2 * i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_mul_u32_64(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = (uint64_t)va.u32[2 * i] * (uint64_t)vb.u32[2 * i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_div(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.f32[i] = va.f32[i] / vb.f32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_div(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.f64[i] = va.f64[i] / vb.f64[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_sqrt(const SIMD_FLT va)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.f32[i] = sqrtf(va.f32[i]);
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_sqrt(const SIMD_DBL va)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.f64[i] = sqrt(va.f64[i]);
+    return vc;
+}
 
 
 /**************************
- *  Arithmetic intrinsics
+ *  Logical instructions  *
  **************************/
+static SIMD_FUNC_INLINE
+SIMD_INT simd_and(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = va.u64[i] & vb.u64[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_and(const SIMD_FLT va, const SIMD_INT vb)
+{
+    //! \note Used to mask vector elements
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = va.u32[i] & vb.u32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_and(const SIMD_DBL va, const SIMD_INT vb)
+{
+    //! \note Used to mask vector elements
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = va.u64[i] & vb.u64[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_or(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = va.u64[i] | vb.u64[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_xor(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = va.u64[i] ^ vb.u64[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_and(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = va.u32[i] & vb.u32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_and(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = va.u64[i] & vb.u64[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_or(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = va.u32[i] | vb.u32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_or(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = va.u64[i] | vb.u64[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_xor(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = va.u32[i] ^ vb.u32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_xor(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = va.u64[i] ^ vb.u64[i];
+    return vc;
+}
+
+/*!
+ *  Shift counts larger than the element width produce zero,
+ *  same as vector units.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sll_16(const SIMD_INT va, const int8_t shft)
+{
+    const uint8_t s = (uint8_t)shft;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_16; ++i)
+        vc.u16[i] = (s < 16) ? (uint16_t)(va.u16[i] << s) : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sll_32(const SIMD_INT va, const int8_t shft)
+{
+    const uint8_t s = (uint8_t)shft;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = (s < 32) ? (va.u32[i] << s) : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sll_64(const SIMD_INT va, const int8_t shft)
+{
+    const uint8_t s = (uint8_t)shft;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = (s < 64) ? (va.u64[i] << s) : 0;
+    return vc;
+}
+
+//! \note 128-bit shifts are in bytes, same as SSE4.2
+static SIMD_FUNC_INLINE
+SIMD_INT simd_sll_128(const SIMD_INT va, const int8_t shft)
+{
+    const int32_t s = (uint8_t)shft;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i)
+        vc.u8[i] = (i >= s) ? va.u8[i - s] : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_srl_16(const SIMD_INT va, const int8_t shft)
+{
+    const uint8_t s = (uint8_t)shft;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_16; ++i)
+        vc.u16[i] = (s < 16) ? (uint16_t)(va.u16[i] >> s) : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_srl_32(const SIMD_INT va, const int8_t shft)
+{
+    const uint8_t s = (uint8_t)shft;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = (s < 32) ? (va.u32[i] >> s) : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_srl_64(const SIMD_INT va, const int8_t shft)
+{
+    const uint8_t s = (uint8_t)shft;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = (s < 64) ? (va.u64[i] >> s) : 0;
+    return vc;
+}
+
+//! \note 128-bit shifts are in bytes, same as SSE4.2
+static SIMD_FUNC_INLINE
+SIMD_INT simd_srl_128(const SIMD_INT va, const int8_t shft)
+{
+    const int32_t s = (uint8_t)shft;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i)
+        vc.u8[i] = (i + s < SIMD_STREAMS_8) ? va.u8[i + s] : 0;
+    return vc;
+}
+
+
+/**************************
+ *  Compare instructions  *
+ **************************/
+/*!
+ *  Comparisons set all bits of elements where the condition holds
+ *  and clear them otherwise, results are used as masks.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmpeq_32(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.i32[i] = (va.i32[i] == vb.i32[i]) ? -1 : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmpgt_i32(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.i32[i] = (va.i32[i] > vb.i32[i]) ? -1 : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmplt_i32(const SIMD_INT va, const SIMD_INT vb)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.i32[i] = (va.i32[i] < vb.i32[i]) ? -1 : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpeq(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = (va.f32[i] == vb.f32[i]) ? 0xFFFFFFFF : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpeq(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = (va.f64[i] == vb.f64[i]) ? ~(uint64_t)0 : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpneq(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = (va.f32[i] != vb.f32[i]) ? 0xFFFFFFFF : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpneq(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = (va.f64[i] != vb.f64[i]) ? ~(uint64_t)0 : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmplt(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = (va.f32[i] < vb.f32[i]) ? 0xFFFFFFFF : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmplt(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = (va.f64[i] < vb.f64[i]) ? ~(uint64_t)0 : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmple(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = (va.f32[i] <= vb.f32[i]) ? 0xFFFFFFFF : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmple(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = (va.f64[i] <= vb.f64[i]) ? ~(uint64_t)0 : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpgt(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = (va.f32[i] > vb.f32[i]) ? 0xFFFFFFFF : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpgt(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = (va.f64[i] > vb.f64[i]) ? ~(uint64_t)0 : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpge(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = (va.f32[i] >= vb.f32[i]) ? 0xFFFFFFFF : 0;
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpge(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = (va.f64[i] >= vb.f64[i]) ? ~(uint64_t)0 : 0;
+    return vc;
+}
+
+/*!
+ *  Select elements from second operand where mask is set,
+ *  otherwise select elements from first operand.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_blend(const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vmsk)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = (va.u64[i] & ~vmsk.u64[i]) | (vb.u64[i] & vmsk.u64[i]);
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_blend(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vmsk)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.u32[i] = (va.u32[i] & ~vmsk.u32[i]) | (vb.u32[i] & vmsk.u32[i]);
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_blend(const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vmsk)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.u64[i] = (va.u64[i] & ~vmsk.u64[i]) | (vb.u64[i] & vmsk.u64[i]);
+    return vc;
+}
+
+
+/*********************************
+ *  Merge and pack instructions  *
+ *********************************/
+/*!
+ *  Merge low/high halves of first operand into lower half
+ *  and low/high halves of second operand into upper half.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_merge_lo(const SIMD_INT va, const SIMD_INT vb)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.u64[i] = va.u64[i];
+        vc.u64[i + mid] = vb.u64[i];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_merge_lo(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.f32[i] = va.f32[i];
+        vc.f32[i + mid] = vb.f32[i];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_merge_lo(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.f64[i] = va.f64[i];
+        vc.f64[i + mid] = vb.f64[i];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_merge_hi(const SIMD_INT va, const SIMD_INT vb)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.u64[i] = va.u64[i + mid];
+        vc.u64[i + mid] = vb.u64[i + mid];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_merge_hi(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.f32[i] = va.f32[i + mid];
+        vc.f32[i + mid] = vb.f32[i + mid];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_merge_hi(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.f64[i] = va.f64[i + mid];
+        vc.f64[i + mid] = vb.f64[i + mid];
+    }
+    return vc;
+}
+
+
+/**************************
+ *  Shuffle instructions  *
+ **************************/
+/*!
+ *  Pack even elements into lower half and odd elements into upper half.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_pack_8(const SIMD_INT va)
+{
+    const int32_t mid = SIMD_STREAMS_8 / 2;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.u8[i] = va.u8[2 * i];
+        vc.u8[i + mid] = va.u8[2 * i + 1];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_pack_16(const SIMD_INT va)
+{
+    const int32_t mid = SIMD_STREAMS_16 / 2;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.u16[i] = va.u16[2 * i];
+        vc.u16[i + mid] = va.u16[2 * i + 1];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_pack_32(const SIMD_INT va)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    SIMD_INT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.u32[i] = va.u32[2 * i];
+        vc.u32[i + mid] = va.u32[2 * i + 1];
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_pack(const SIMD_FLT va)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < mid; ++i) {
+        vc.f32[i] = va.f32[2 * i];
+        vc.f32[i + mid] = va.f32[2 * i + 1];
+    }
+    return vc;
+}
+
+//! \note Shuffle assumes that vector register width is a multiple of 32
+static SIMD_FUNC_INLINE
+SIMD_INT simd_shuffle(const SIMD_INT va, const SHUFFLE_CTRL ctrl)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_INT vc;
+    switch (ctrl) {
+        case XCHG:
+            for (int32_t i = 0; i < mid; ++i) {
+                vc.u64[i] = va.u64[i + mid];
+                vc.u64[i + mid] = va.u64[i];
+            }
+            break;
+        case XCHG8:
+            for (int32_t i = 0; i < SIMD_STREAMS_8; ++i)
+                vc.u8[i] = va.u8[i ^ 1];
+            break;
+        case XCHG16:
+            for (int32_t i = 0; i < SIMD_STREAMS_16; ++i)
+                vc.u16[i] = va.u16[i ^ 1];
+            break;
+        case XCHG32:
+            for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+                vc.u32[i] = va.u32[i ^ 1];
+            break;
+        case XCHG64:
+            for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+                vc.u64[i] = va.u64[i ^ 1];
+            break;
+        case DUPL:
+            for (int32_t i = 0; i < mid; ++i)
+                vc.u64[i] = vc.u64[i + mid] = va.u64[i];
+            break;
+        case DUPH:
+            for (int32_t i = 0; i < mid; ++i)
+                vc.u64[i] = vc.u64[i + mid] = va.u64[i + mid];
+            break;
+        default: vc = va; break;
+    }
+    return vc;
+}
+
+//! \note Shuffle assumes that vector register width is a multiple of 32
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_shuffle(const SIMD_FLT va, const SHUFFLE_CTRL ctrl)
+{
+    const int32_t mid = SIMD_STREAMS_32 / 2;
+    SIMD_FLT vc;
+    switch (ctrl) {
+        case XCHG:
+            for (int32_t i = 0; i < mid; ++i) {
+                vc.u32[i] = va.u32[i + mid];
+                vc.u32[i + mid] = va.u32[i];
+            }
+            break;
+        case XCHG32:
+            for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+                vc.u32[i] = va.u32[i ^ 1];
+            break;
+        case XCHG64:
+            for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+                vc.u32[i] = va.u32[i ^ 2];
+            break;
+        case DUPL:
+            for (int32_t i = 0; i < mid; ++i)
+                vc.u32[i] = vc.u32[i + mid] = va.u32[i];
+            break;
+        case DUPH:
+            for (int32_t i = 0; i < mid; ++i)
+                vc.u32[i] = vc.u32[i + mid] = va.u32[i + mid];
+            break;
+        default: vc = va; break;
+    }
+    return vc;
+}
+
+//! \note Shuffle assumes that vector register width is a multiple of 32
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_shuffle(const SIMD_DBL va, const SHUFFLE_CTRL ctrl)
+{
+    const int32_t mid = SIMD_STREAMS_64 / 2;
+    SIMD_DBL vc;
+    switch (ctrl) {
+        case XCHG:
+            for (int32_t i = 0; i < mid; ++i) {
+                vc.u64[i] = va.u64[i + mid];
+                vc.u64[i + mid] = va.u64[i];
+            }
+            break;
+        case XCHG64:
+            for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+                vc.u64[i] = va.u64[i ^ 1];
+            break;
+        case DUPL:
+            for (int32_t i = 0; i < mid; ++i)
+                vc.u64[i] = vc.u64[i + mid] = va.u64[i];
+            break;
+        case DUPH:
+            for (int32_t i = 0; i < mid; ++i)
+                vc.u64[i] = vc.u64[i + mid] = va.u64[i + mid];
+            break;
+        default: vc = va; break;
+    }
+    return vc;
+}
+
+
+/**************************
+ *  Convert instructions  *
+ **************************/
+/*!
+ *  Widening conversions use the lower elements of the operand,
+ *  narrowing conversions set the upper elements to zero.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_i16_i32(const SIMD_INT va)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.i32[i] = (int32_t)va.i16[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_i32_i64(const SIMD_INT va)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.i64[i] = (int64_t)va.i32[i];
+    return vc;
+}
 
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_i32_f32(const SIMD_INT va)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.f32[i] = (float)va.i32[i];
+    return vc;
+}
 
-/********************************
- *  Integral logical intrinsics
- ********************************/
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_i32_f64(const SIMD_INT va)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.f64[i] = (double)va.i32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_i64_f32(const SIMD_INT va)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        vc.f32[i] = (float)va.i64[i];
+        vc.f32[i + SIMD_STREAMS_64] = 0.0f;
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_i64_f64(const SIMD_INT va)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.f64[i] = (double)va.i64[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_u16_i32(const SIMD_INT va)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.i32[i] = (int32_t)va.u16[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_u32_i64(const SIMD_INT va)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.i64[i] = (int64_t)va.u32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_u32_f32(const SIMD_INT va)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.f32[i] = (float)va.u32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_u32_f64(const SIMD_INT va)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.f64[i] = (double)va.u32[i];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_u64_f32(const SIMD_INT va)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        vc.f32[i] = (float)va.u64[i];
+        vc.f32[i + SIMD_STREAMS_64] = 0.0f;
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_u64_f64(const SIMD_INT va)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.f64[i] = (double)va.u64[i];
+    return vc;
+}
+
+//! \note Rounding uses current rounding mode, same as vector units
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_f32_i32(const SIMD_FLT va)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.i32[i] = (int32_t)lrintf(va.f32[i]);
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cvt_f32_f64(const SIMD_FLT va)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.f64[i] = (double)va.f32[i];
+    return vc;
+}
+
+//! \note Rounding uses current rounding mode, same as vector units
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cvt_f64_i32(const SIMD_DBL va)
+{
+    SIMD_INT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        vc.i32[i] = (int32_t)lrint(va.f64[i]);
+        vc.i32[i + SIMD_STREAMS_64] = 0;
+    }
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cvt_f64_f32(const SIMD_DBL va)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        vc.f32[i] = (float)va.f64[i];
+        vc.f32[i + SIMD_STREAMS_64] = 0.0f;
+    }
+    return vc;
+}
+
+
+/**********************
+ *  Set instructions  *
+ **********************/
+/*!
+ *  Set vector to zero. Use pointer for function overloading.
+ */
+static SIMD_FUNC_INLINE
+void simd_set_zero(SIMD_INT * const va)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        va->u64[i] = 0;
+}
+
+static SIMD_FUNC_INLINE
+void simd_set_zero(SIMD_FLT * const va)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        va->f32[i] = 0.0f;
+}
+
+static SIMD_FUNC_INLINE
+void simd_set_zero(SIMD_DBL * const va)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        va->f64[i] = 0.0;
+}
+
+/*!
+ *  Set vector with 32/64 elements.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const int32_t sa)
+{
+    SIMD_INT va;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        va.i32[i] = sa;
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set_64(const int32_t sa)
+{
+    SIMD_INT va;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        va.i64[i] = (int64_t)sa;
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const uint32_t sa)
+{
+    SIMD_INT va;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        va.u32[i] = sa;
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set_64(const uint32_t sa)
+{
+    SIMD_INT va;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        va.u64[i] = (uint64_t)sa;
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const int64_t sa)
+{
+    SIMD_INT va;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        va.i64[i] = sa;
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const uint64_t sa)
+{
+    SIMD_INT va;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        va.u64[i] = sa;
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_set(const float sa)
+{
+    SIMD_FLT va;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        va.f32[i] = sa;
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_set(const double sa)
+{
+    SIMD_DBL va;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        va.f64[i] = sa;
+    return va;
+}
+
+/*!
+ *  Set vector given an array.
+ *  Only required for non-contiguous 32-bit elements due to in-between padding,
+ *  64-bit elements can use load instructions.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const int32_t * const sa, const size_t n)
+{
+    SIMD_INT va;
+    simd_set_zero(&va);
+    if (n == (size_t)SIMD_STREAMS_64)
+        for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+            va.i64[i] = (int64_t)sa[i];
+    else if (n == (size_t)SIMD_STREAMS_32)
+        for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+            va.i32[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const uint32_t * const sa, const size_t n)
+{
+    SIMD_INT va;
+    simd_set_zero(&va);
+    if (n == (size_t)SIMD_STREAMS_64)
+        for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+            va.i64[i] = (int64_t)sa[i];
+    else if (n == (size_t)SIMD_STREAMS_32)
+        for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+            va.u32[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const int64_t * const sa, const size_t n)
+{
+    SIMD_INT va;
+    simd_set_zero(&va);
+    if (n == (size_t)SIMD_STREAMS_64)
+        for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+            va.i64[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_set(const uint64_t * const sa, const size_t n)
+{
+    SIMD_INT va;
+    simd_set_zero(&va);
+    if (n == (size_t)SIMD_STREAMS_64)
+        for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+            va.u64[i] = sa[i];
+    return va;
+}
+
+
+/***********************
+ *  Load instructions  *
+ ***********************/
+/*!
+ *  Aligned and unaligned loads are the same operation in scalar mode.
+ *  Streaming hints are accepted for compatibility and ignored.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const int8_t * const sa)
+{
+    SIMD_INT va;
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i)
+        va.i8[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const int8_t * const sa)
+{ return simd_load(sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const int16_t * const sa)
+{
+    SIMD_INT va;
+    for (int32_t i = 0; i < SIMD_STREAMS_16; ++i)
+        va.i16[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const int16_t * const sa)
+{ return simd_load(sa); }
+
+/*!
+ *  Load first n elements, remaining elements are set to zero.
+ *  Negative n loads into the upper |n| elements.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const int32_t * const sa, const int32_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    (void)strmHint;
+    SIMD_INT va;
+    simd_set_zero(&va);
+    if (n > 0 && n <= SIMD_STREAMS_32) {
+        for (int32_t i = 0; i < n; ++i)
+            va.i32[i] = sa[i];
+    }
+    else if (n < 0 && n >= -SIMD_STREAMS_32) {
+        for (int32_t i = SIMD_STREAMS_32 + n, j = 0; i < SIMD_STREAMS_32; ++i, ++j)
+            va.i32[i] = sa[j];
+    }
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const int32_t * const sa, const size_t n = SIMD_STREAMS_32)
+{
+    SIMD_INT va;
+    simd_set_zero(&va);
+    if (n <= (size_t)SIMD_STREAMS_32)
+        for (size_t i = 0; i < n; ++i)
+            va.i32[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const uint8_t * const sa)
+{
+    SIMD_INT va;
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i)
+        va.u8[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const uint8_t * const sa)
+{ return simd_load(sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const uint16_t * const sa)
+{
+    SIMD_INT va;
+    for (int32_t i = 0; i < SIMD_STREAMS_16; ++i)
+        va.u16[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const uint16_t * const sa)
+{ return simd_load(sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const uint32_t * const sa)
+{
+    SIMD_INT va;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        va.u32[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const uint32_t * const sa)
+{ return simd_load(sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const int64_t * const sa)
+{
+    SIMD_INT va;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        va.i64[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const int64_t * const sa)
+{ return simd_load(sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_load(const uint64_t * const sa)
+{
+    SIMD_INT va;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        va.u64[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_loadu(const uint64_t * const sa)
+{ return simd_load(sa); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_load(const float * const sa, const size_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    (void)strmHint;
+    SIMD_FLT va;
+    simd_set_zero(&va);
+    if (n <= (size_t)SIMD_STREAMS_32)
+        for (size_t i = 0; i < n; ++i)
+            va.f32[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_loadu(const float * const sa, const size_t n = SIMD_STREAMS_32)
+{ return simd_load(sa, n); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_load(const double * const sa, const size_t n = SIMD_STREAMS_64, const bool strmHint = false)
+{
+    (void)strmHint;
+    SIMD_DBL va;
+    simd_set_zero(&va);
+    if (n <= (size_t)SIMD_STREAMS_64)
+        for (size_t i = 0; i < n; ++i)
+            va.f64[i] = sa[i];
+    return va;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_loadu(const double * const sa, const size_t n = SIMD_STREAMS_64)
+{ return simd_load(sa, n); }
+
+
+/************************
+ *  Store instructions  *
+ ************************/
+static SIMD_FUNC_INLINE
+void simd_store(int8_t * const sa, const SIMD_INT va)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i)
+        sa[i] = va.i8[i];
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(int8_t * const sa, const SIMD_INT va)
+{ simd_store(sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(int16_t * const sa, const SIMD_INT va)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_16; ++i)
+        sa[i] = va.i16[i];
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(int16_t * const sa, const SIMD_INT va)
+{ simd_store(sa, va); }
+
+/*!
+ *  Store first n elements.
+ *  Negative n stores the upper |n| elements.
+ */
+static SIMD_FUNC_INLINE
+void simd_store(int32_t * const sa, const SIMD_INT va, const int32_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    (void)strmHint;
+    if (n > 0 && n <= SIMD_STREAMS_32) {
+        for (int32_t i = 0; i < n; ++i)
+            sa[i] = va.i32[i];
+    }
+    else if (n < 0 && n >= -SIMD_STREAMS_32) {
+        for (int32_t i = SIMD_STREAMS_32 + n, j = 0; i < SIMD_STREAMS_32; ++i, ++j)
+            sa[j] = va.i32[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(int32_t * const sa, const SIMD_INT va, const size_t n = SIMD_STREAMS_32)
+{
+    if (n <= (size_t)SIMD_STREAMS_32)
+        for (size_t i = 0; i < n; ++i)
+            sa[i] = va.i32[i];
+}
+
+static SIMD_FUNC_INLINE
+void simd_store(uint8_t * const sa, const SIMD_INT va)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i)
+        sa[i] = va.u8[i];
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(uint8_t * const sa, const SIMD_INT va)
+{ simd_store(sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(uint16_t * const sa, const SIMD_INT va)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_16; ++i)
+        sa[i] = va.u16[i];
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(uint16_t * const sa, const SIMD_INT va)
+{ simd_store(sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(uint32_t * const sa, const SIMD_INT va)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        sa[i] = va.u32[i];
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(uint32_t * const sa, const SIMD_INT va)
+{ simd_store(sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(int64_t * const sa, const SIMD_INT va)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        sa[i] = va.i64[i];
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(int64_t * const sa, const SIMD_INT va)
+{ simd_store(sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(uint64_t * const sa, const SIMD_INT va)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        sa[i] = va.u64[i];
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(uint64_t * const sa, const SIMD_INT va)
+{ simd_store(sa, va); }
+
+static SIMD_FUNC_INLINE
+void simd_store(float * const sa, const SIMD_FLT va, const size_t n = SIMD_STREAMS_32, const bool strmHint = false)
+{
+    (void)strmHint;
+    if (n <= (size_t)SIMD_STREAMS_32)
+        for (size_t i = 0; i < n; ++i)
+            sa[i] = va.f32[i];
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(float * const sa, const SIMD_FLT va, const size_t n = SIMD_STREAMS_32)
+{ simd_store(sa, va, n); }
+
+static SIMD_FUNC_INLINE
+void simd_store(double * const sa, const SIMD_DBL va, const size_t n = SIMD_STREAMS_64, const bool strmHint = false)
+{
+    (void)strmHint;
+    if (n <= (size_t)SIMD_STREAMS_64)
+        for (size_t i = 0; i < n; ++i)
+            sa[i] = va.f64[i];
+}
+
+static SIMD_FUNC_INLINE
+void simd_storeu(double * const sa, const SIMD_DBL va, const size_t n = SIMD_STREAMS_64)
+{ simd_store(sa, va, n); }
 
 
 /*****************************
- *  Shift/Shuffle intrinsics
+ *  Interleave instructions  *
  *****************************/
+/*!
+ *  Load records of 2/3/4 components (array of structures) and split them
+ *  into one vector per component (structure of arrays), e.g., xyz points
+ *  or RGB/RGBA pixels. simd_store_interleave* is the inverse.
+ *  Each call reads/writes 2/3/4 vectors of consecutive elements, pointers
+ *  need not be aligned.
+ */
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        va->f32[i] = sa[2 * i];
+        vb->f32[i] = sa[2 * i + 1];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        va->f32[i] = sa[3 * i];
+        vb->f32[i] = sa[3 * i + 1];
+        vc->f32[i] = sa[3 * i + 2];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc, SIMD_FLT * const vd)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        va->f32[i] = sa[4 * i];
+        vb->f32[i] = sa[4 * i + 1];
+        vc->f32[i] = sa[4 * i + 2];
+        vd->f32[i] = sa[4 * i + 3];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(float * const sa, const SIMD_FLT va, const SIMD_FLT vb)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        sa[2 * i] = va.f32[i];
+        sa[2 * i + 1] = vb.f32[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        sa[3 * i] = va.f32[i];
+        sa[3 * i + 1] = vb.f32[i];
+        sa[3 * i + 2] = vc.f32[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc, const SIMD_FLT vd)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        sa[4 * i] = va.f32[i];
+        sa[4 * i + 1] = vb.f32[i];
+        sa[4 * i + 2] = vc.f32[i];
+        sa[4 * i + 3] = vd.f32[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        va->f64[i] = sa[2 * i];
+        vb->f64[i] = sa[2 * i + 1];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        va->f64[i] = sa[3 * i];
+        vb->f64[i] = sa[3 * i + 1];
+        vc->f64[i] = sa[3 * i + 2];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc, SIMD_DBL * const vd)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        va->f64[i] = sa[4 * i];
+        vb->f64[i] = sa[4 * i + 1];
+        vc->f64[i] = sa[4 * i + 2];
+        vd->f64[i] = sa[4 * i + 3];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(double * const sa, const SIMD_DBL va, const SIMD_DBL vb)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        sa[2 * i] = va.f64[i];
+        sa[2 * i + 1] = vb.f64[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        sa[3 * i] = va.f64[i];
+        sa[3 * i + 1] = vb.f64[i];
+        sa[3 * i + 2] = vc.f64[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc, const SIMD_DBL vd)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i) {
+        sa[4 * i] = va.f64[i];
+        sa[4 * i + 1] = vb.f64[i];
+        sa[4 * i + 2] = vc.f64[i];
+        sa[4 * i + 3] = vd.f64[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        va->i32[i] = sa[2 * i];
+        vb->i32[i] = sa[2 * i + 1];
+    }
+}
 
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        va->i32[i] = sa[3 * i];
+        vb->i32[i] = sa[3 * i + 1];
+        vc->i32[i] = sa[3 * i + 2];
+    }
+}
 
-/*******************
- *  Set intrinsics
- *******************/
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        va->i32[i] = sa[4 * i];
+        vb->i32[i] = sa[4 * i + 1];
+        vc->i32[i] = sa[4 * i + 2];
+        vd->i32[i] = sa[4 * i + 3];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        sa[2 * i] = va.i32[i];
+        sa[2 * i + 1] = vb.i32[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        sa[3 * i] = va.i32[i];
+        sa[3 * i + 1] = vb.i32[i];
+        sa[3 * i + 2] = vc.i32[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i) {
+        sa[4 * i] = va.i32[i];
+        sa[4 * i + 1] = vb.i32[i];
+        sa[4 * i + 2] = vc.i32[i];
+        sa[4 * i + 3] = vd.i32[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i) {
+        va->u8[i] = sa[2 * i];
+        vb->u8[i] = sa[2 * i + 1];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i) {
+        va->u8[i] = sa[3 * i];
+        vb->u8[i] = sa[3 * i + 1];
+        vc->u8[i] = sa[3 * i + 2];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i) {
+        va->u8[i] = sa[4 * i];
+        vb->u8[i] = sa[4 * i + 1];
+        vc->u8[i] = sa[4 * i + 2];
+        vd->u8[i] = sa[4 * i + 3];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i) {
+        sa[2 * i] = va.u8[i];
+        sa[2 * i + 1] = vb.u8[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i) {
+        sa[3 * i] = va.u8[i];
+        sa[3 * i + 1] = vb.u8[i];
+        sa[3 * i + 2] = vc.u8[i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{
+    for (int32_t i = 0; i < SIMD_STREAMS_8; ++i) {
+        sa[4 * i] = va.u8[i];
+        sa[4 * i + 1] = vb.u8[i];
+        sa[4 * i + 2] = vc.u8[i];
+        sa[4 * i + 3] = vd.u8[i];
+    }
+}
+
+
+/****************************
+ *  Transpose instructions  *
+ ****************************/
+/*!
+ *  Transpose a square tile, sb[j * ldb + i] = sa[i * lda + j].
+ *  Rows of \c sa are loaded into registers, transposed with shuffles and
+ *  stored as rows of \c sb. Leading dimensions are in elements, rows need
+ *  not be aligned and tiles must not overlap.
+ */
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    for (int32_t i = 0; i < 4; ++i)
+        for (int32_t j = 0; j < 4; ++j)
+            sb[j * ldb + i] = sa[i * lda + j];
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    for (int32_t i = 0; i < 8; ++i)
+        for (int32_t j = 0; j < 8; ++j)
+            sb[j * ldb + i] = sa[i * lda + j];
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    for (int32_t i = 0; i < 4; ++i)
+        for (int32_t j = 0; j < 4; ++j)
+            sb[j * ldb + i] = sa[i * lda + j];
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    for (int32_t i = 0; i < 8; ++i)
+        for (int32_t j = 0; j < 8; ++j)
+            sb[j * ldb + i] = sa[i * lda + j];
+}
+
+
+/*************************
+ *  Gather instructions  *
+ *************************/
+/*!
+ *  Gather, lane i is loaded from sa[idx[i]], one 32-bit index per lane.
+ *  Indices need not be sorted or distinct and are not range-checked.
+ */
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_gather(const float * const sa, const int32_t * const idx)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.f32[i] = sa[idx[i]];
+    return vc;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_gather(const double * const sa, const int32_t * const idx)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.f64[i] = sa[idx[i]];
+    return vc;
+}
+
+
+/************************
+ *  Align instructions  *
+ ************************/
+/*!
+ *  Lanes N .. N + nlanes - 1 of the concatenation of vb (low lanes) and va
+ *  (high lanes), 0 <= N <= nlanes. Vectors at consecutive aligned addresses
+ *  give the vector at an unaligned offset of N elements.
+ */
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_alignr(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    SIMD_FLT vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc.f32[i] = (i + N < SIMD_STREAMS_32) ? (vb.f32[i + N]) : (va.f32[i + N - SIMD_STREAMS_32]);
+    return vc;
+}
+
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_alignr(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    SIMD_DBL vc;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc.f64[i] = (i + N < SIMD_STREAMS_64) ? (vb.f64[i + N]) : (va.f64[i + N - SIMD_STREAMS_64]);
+    return vc;
+}
 
 
 /***********************
- *  Convert intrinsics
+ *  Scan instructions  *
  ***********************/
+/*!
+ *  Inclusive prefix sums of the lanes of va plus the carry *vc (all lanes
+ *  equal), lane by lane. The sum of va is added to *vc, the carry of the
+ *  next vector.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_32(const SIMD_INT va, SIMD_INT * const vc)
+{
+    SIMD_INT vs;
+    uint32_t s = vc->u32[0];
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vs.u32[i] = (s += va.u32[i]);
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc->u32[i] = s;
+    return vs;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_64(const SIMD_INT va, SIMD_INT * const vc)
+{
+    SIMD_INT vs;
+    uint64_t s = vc->u64[0];
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vs.u64[i] = (s += va.u64[i]);
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc->u64[i] = s;
+    return vs;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    SIMD_FLT vs;
+    float s = 0.0f;
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vs.f32[i] = (s += va.f32[i]) + vc->f32[0];
+    for (int32_t i = 0; i < SIMD_STREAMS_32; ++i)
+        vc->f32[i] = vs.f32[SIMD_STREAMS_32 - 1];
+    return vs;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    SIMD_DBL vs;
+    double s = 0.0;
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vs.f64[i] = (s += va.f64[i]) + vc->f64[0];
+    for (int32_t i = 0; i < SIMD_STREAMS_64; ++i)
+        vc->f64[i] = vs.f64[SIMD_STREAMS_64 - 1];
+    return vs;
+}
+
+/*!
+ *  Exclusive prefix sums, lane i is the carry plus lanes 0 .. i-1 of va,
+ *  *vc is updated as by the inclusive sums
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_32(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const SIMD_INT vp = *vc;
+    const SIMD_INT vs = simd_scan_32(va, vc);
+    SIMD_INT vb;
+    vb.u32[0] = vp.u32[0];
+    for (int32_t i = 1; i < SIMD_STREAMS_32; ++i)
+        vb.u32[i] = vs.u32[i - 1];
+    return vb;
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_64(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const SIMD_INT vp = *vc;
+    const SIMD_INT vs = simd_scan_64(va, vc);
+    SIMD_INT vb;
+    vb.u64[0] = vp.u64[0];
+    for (int32_t i = 1; i < SIMD_STREAMS_64; ++i)
+        vb.u64[i] = vs.u64[i - 1];
+    return vb;
+}
 
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan_excl(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    const SIMD_FLT vp = *vc;
+    return simd_alignr<SIMD_STREAMS_32 - 1>(simd_scan(va, vc), vp);
+}
 
-/********************
- *  Load intrinsics
- ********************/
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan_excl(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    const SIMD_DBL vp = *vc;
+    return simd_alignr<SIMD_STREAMS_64 - 1>(simd_scan(va, vc), vp);
+}
 
 
-/*******************************
- *  Store intrinsics
- *******************************/
+}  // namespace scalar
+}  // namespace gvl
 
 
 #endif  // _SCALAR_H
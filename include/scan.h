@@ -0,0 +1,297 @@
+/*!
+ *  \brief Prefix sums (scans) of int32_t, int64_t, float and double arrays
+ *  - inclusive_scan(), sb[i] = init + sa[0] + ... + sa[i]
+ *  - exclusive_scan(), sb[i] = init + sa[0] + ... + sa[i - 1]
+ *  Each vector is summed in-register by log2(nlanes) shift-and-add steps
+ *  (simd_scan() of the SIMD interface) and its last lane is carried to the
+ *  next vector, so the loop-carried dependency is one add per vector
+ *  instead of one per element.
+ *  Large arrays are scanned by threads in two passes over parts of the
+ *  array: sums of the parts, then scans of the parts from the prefix sums
+ *  of the part sums.
+ *  \note sb may be sa (in-place), integer sums wrap around
+ */
+#ifndef _SCAN_H
+#define _SCAN_H
+
+
+#include <stdint.h>
+#include <stddef.h>   // size_t
+#include <string.h>   // memcpy
+#include "simd.h"
+#include "sysconf.h"
+#include "dispatch.h"  // lane_traits, steal_parts_for
+#include "workpool.h"
+#include "arena.h"     // pool_malloc, pool_free
+
+
+namespace gvl {
+
+
+/*!
+ *  \class scan_traits
+ *  \brief SIMD datatype and in-register scans of elements of type T
+ *  Scalar integer adds take one cycle, so integer scans only use vectors
+ *  of more than two lanes (vectorize).
+ */
+template <typename T>
+struct scan_traits;
+
+template <>
+struct scan_traits<int32_t>: lane_traits<int32_t>
+{
+    static const bool vectorize = (nlanes > 2);
+
+    static SIMD_FUNC_INLINE vtype incl(const vtype va, vtype * const vc)
+    { return simd_scan_32(va, vc); }
+
+    static SIMD_FUNC_INLINE vtype excl(const vtype va, vtype * const vc)
+    { return simd_scan_excl_32(va, vc); }
+
+    static SIMD_FUNC_INLINE int32_t add(const int32_t sa, const int32_t sb)
+    { return (int32_t)((uint32_t)sa + (uint32_t)sb); }
+};
+
+template <>
+struct scan_traits<int64_t>: lane_traits<int64_t>
+{
+    static const bool vectorize = (nlanes > 2);
+
+    static SIMD_FUNC_INLINE vtype incl(const vtype va, vtype * const vc)
+    { return simd_scan_64(va, vc); }
+
+    static SIMD_FUNC_INLINE vtype excl(const vtype va, vtype * const vc)
+    { return simd_scan_excl_64(va, vc); }
+
+    static SIMD_FUNC_INLINE int64_t add(const int64_t sa, const int64_t sb)
+    { return (int64_t)((uint64_t)sa + (uint64_t)sb); }
+};
+
+template <>
+struct scan_traits<float>: lane_traits<float>
+{
+    static const bool vectorize = (nlanes > 1);
+
+    static SIMD_FUNC_INLINE vtype incl(const vtype va, vtype * const vc)
+    { return simd_scan(va, vc); }
+
+    static SIMD_FUNC_INLINE vtype excl(const vtype va, vtype * const vc)
+    { return simd_scan_excl(va, vc); }
+
+    static SIMD_FUNC_INLINE float add(const float sa, const float sb)
+    { return sa + sb; }
+};
+
+template <>
+struct scan_traits<double>: lane_traits<double>
+{
+    static const bool vectorize = (nlanes > 1);
+
+    static SIMD_FUNC_INLINE vtype incl(const vtype va, vtype * const vc)
+    { return simd_scan(va, vc); }
+
+    static SIMD_FUNC_INLINE vtype excl(const vtype va, vtype * const vc)
+    { return simd_scan_excl(va, vc); }
+
+    static SIMD_FUNC_INLINE double add(const double sa, const double sb)
+    { return sa + sb; }
+};
+
+/*!
+ *  Scan of \c n elements from \c init by one thread
+ *  \return init plus the sum of the elements
+ *  \note Vectors are moved with memcpy(), compiled to unaligned vector
+ *        loads/stores, as not every interface loads all integer types
+ */
+template <typename T, bool EXCL>
+static T scan_serial(T * const sb, const T * const sa, const size_t n, const T init)
+{
+    typedef scan_traits<T> traits;
+    typedef typename traits::vtype vtype;
+    const size_t nlanes = traits::nlanes;
+
+    T sc[nlanes];
+    for (size_t k = 0; k < nlanes; ++k)
+        sc[k] = init;
+    vtype vinit;
+    memcpy(&vinit, sc, sizeof(vtype));
+
+    // The carry stays in a register, its address is not taken out of the loop
+    vtype vc = vinit;
+    size_t i = 0;
+    for (; traits::vectorize && i + nlanes <= n; i += nlanes) {
+        vtype va;
+        memcpy(&va, sa + i, sizeof(vtype));
+        const vtype vs = (EXCL) ? (traits::excl(va, &vc)) : (traits::incl(va, &vc));
+        memcpy(sb + i, &vs, sizeof(vtype));
+    }
+    const vtype vlast = vc;
+    memcpy(sc, &vlast, sizeof(vtype));
+
+    T s = sc[0];
+    for (; i < n; ++i) {
+        const T a = sa[i];
+        if (EXCL)
+            sb[i] = s;
+        s = traits::add(s, a);
+        if (!EXCL)
+            sb[i] = s;
+    }
+    return s;
+}
+
+//! Sum of \c n elements, integer loops are vectorized by the compiler
+template <typename T>
+static T scan_sum(const T * const sa, const size_t n)
+{
+    T s = (T)0;
+    for (size_t i = 0; i < n; ++i)
+        s = scan_traits<T>::add(s, sa[i]);
+    return s;
+}
+
+//! Floating-point sums in four vector accumulators (reassociated)
+template <typename T, typename V>
+static T scan_sum_vec(const T * const sa, const size_t n)
+{
+    const size_t nlanes = sizeof(V) / sizeof(T);
+    V v0, v1, v2, v3;
+    simd_set_zero(&v0);
+    simd_set_zero(&v1);
+    simd_set_zero(&v2);
+    simd_set_zero(&v3);
+
+    size_t i = 0;
+    for (; i + 4 * nlanes <= n; i += 4 * nlanes) {
+        v0 = simd_add(v0, simd_loadu(sa + i));
+        v1 = simd_add(v1, simd_loadu(sa + i + nlanes));
+        v2 = simd_add(v2, simd_loadu(sa + i + 2 * nlanes));
+        v3 = simd_add(v3, simd_loadu(sa + i + 3 * nlanes));
+    }
+    v0 = simd_add(simd_add(v0, v1), simd_add(v2, v3));
+
+    T sc[nlanes];
+    memcpy(sc, &v0, sizeof(V));
+    T s = (T)0;
+    for (size_t k = 0; k < nlanes; ++k)
+        s += sc[k];
+    for (; i < n; ++i)
+        s += sa[i];
+    return s;
+}
+
+static inline float scan_sum(const float * const sa, const size_t n)
+{ return scan_sum_vec<float, SIMD_FLT>(sa, n); }
+
+static inline double scan_sum(const double * const sa, const size_t n)
+{ return scan_sum_vec<double, SIMD_DBL>(sa, n); }
+
+//! First element of part \c p of \c np parts of \c n elements
+static inline size_t scan_split(const size_t n, const size_t np, const size_t p)
+{ return (size_t)((uint64_t)n * p / np); }
+
+//! Range functor of the first pass, sums of parts [lo, hi)
+template <typename T>
+struct scan_sum_range
+{
+    T * const sums;
+    const T * const sa;
+    const size_t n;
+    const size_t np;
+
+    scan_sum_range(T * const s, const T * const a, const size_t m, const size_t parts):
+        sums(s), sa(a), n(m), np(parts)
+    { }
+
+    void operator()(const size_t lo, const size_t hi) const
+    {
+        for (size_t p = lo; p < hi; ++p) {
+            const size_t i0 = scan_split(n, np, p);
+            sums[p] = scan_sum(sa + i0, scan_split(n, np, p + 1) - i0);
+        }
+    }
+};
+
+//! Range functor of the second pass, scans of parts [lo, hi) from their offsets
+template <typename T, bool EXCL>
+struct scan_part_range
+{
+    T * const sb;
+    const T * const sa;
+    const T * const offs;
+    const size_t n;
+    const size_t np;
+
+    scan_part_range(T * const b, const T * const a, const T * const o, const size_t m, const size_t parts):
+        sb(b), sa(a), offs(o), n(m), np(parts)
+    { }
+
+    void operator()(const size_t lo, const size_t hi) const
+    {
+        for (size_t p = lo; p < hi; ++p) {
+            const size_t i0 = scan_split(n, np, p);
+            scan_serial<T, EXCL>(sb + i0, sa + i0, scan_split(n, np, p + 1) - i0, offs[p]);
+        }
+    }
+};
+
+/*!
+ *  Scan by one thread, or by two passes over parts when the array does
+ *  not fit in L2 and several threads are enabled, falls back to one thread
+ *  if the part sums cannot be allocated
+ */
+template <typename T, bool EXCL>
+static T scan_run(T * const sb, const T * const sa, const size_t n, const T init, const bool run_par)
+{
+    const int32_t nthreads = ((SYSCONF::get_omp() & run_par) == true) ? (SYSCONF::get_threads()) : (1);
+    if (nthreads <= 1 || n * sizeof(T) <= SYSCONF::get_L2_sz())
+        return scan_serial<T, EXCL>(sb, sa, n, init);
+
+    const size_t np = steal_parts(n, nthreads);
+    T * const sums = (T *)pool_malloc(2 * np * sizeof(T));
+    if (!sums)
+        return scan_serial<T, EXCL>(sb, sa, n, init);
+    T * const offs = sums + np;
+
+    steal_parts_for(np, scan_sum_range<T>(sums, sa, n, np), nthreads);
+
+    T s = init;
+    for (size_t p = 0; p < np; ++p) {
+        offs[p] = s;
+        s = scan_traits<T>::add(s, sums[p]);
+    }
+
+    steal_parts_for(np, scan_part_range<T, EXCL>(sb, sa, offs, n, np), nthreads);
+
+    pool_free(sums);
+    return s;
+}
+
+/*!
+ *  Inclusive prefix sums, sb[i] = init + sa[0] + ... + sa[i]
+ *  \param[out] sb Sums, may be \c sa
+ *  \param[in] run_par Arrays larger than L2 are scanned in two passes by
+ *             the OpenMP threads set by SYSCONF
+ *  \return init plus the sum of the \c n elements
+ */
+template <typename T>
+static T inclusive_scan(T * const sb, const T * const sa, const size_t n, const T init = (T)0, const bool run_par = false)
+{ return scan_run<T, false>(sb, sa, n, init, run_par); }
+
+/*!
+ *  Exclusive prefix sums, sb[i] = init + sa[0] + ... + sa[i - 1], e.g.
+ *  offsets of rows from row lengths
+ *  \param[out] sb Sums, may be \c sa
+ *  \param[in] run_par Arrays larger than L2 are scanned in two passes by
+ *             the OpenMP threads set by SYSCONF
+ *  \return init plus the sum of the \c n elements, the offset past the end
+ */
+template <typename T>
+static T exclusive_scan(T * const sb, const T * const sa, const size_t n, const T init = (T)0, const bool run_par = false)
+{ return scan_run<T, true>(sb, sa, n, init, run_par); }
+
+
+}  // namespace gvl
+
+
+#endif  // _SCAN_H
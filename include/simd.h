@@ -4,8 +4,16 @@
 /*
  *  If SIMD_MODE is enabled, use compiler flags to auto-select best SIMD mode supported
  *  Auto-select SIMD support has priority over specific SIMD support
+ *  If no SIMD support is found, fallback to scalar mode (SIMD_SCALAR)
+ *  Generic mode (SIMD_GENERIC) uses compiler vector extensions and is only
+ *  selected explicitly, width is set with SIMD_GENERIC_BYTES
+ *  AVX2x2 mode (SIMD_AVX2X2) emulates 512-bit vectors with pairs of AVX2
+ *  registers and is only selected explicitly
  */
 #if defined(SIMD_MODE)
+#   undef SIMD_SCALAR
+#   undef SIMD_GENERIC
+#   undef SIMD_AVX2X2
 #   undef SIMD_AVX512
 #   undef SIMD_AVX2
 #   undef SIMD_AVX
@@ -26,6 +34,8 @@
 #       define SIMD_SSE2
 #   elif defined(__MMX__)
 #       define SIMD_MMX
+#   else
+#       define SIMD_SCALAR
 #   endif
 #else
 #   define SIMD_MODE
@@ -35,29 +45,81 @@
 /*
  *  Identify the SIMD mode requested and include SIMD interface
  *  SIMD_MODE has to be defined to access available SIMD features
+ *  SIMD_NAMESPACE names the namespace of the selected SIMD interface
  */
-#if defined(SIMD_AVX512)
+#if defined(SIMD_SCALAR)
+#   include "scalar.h"
+#   define SIMD_NAMESPACE scalar
+#elif defined(SIMD_GENERIC)
+#   include "generic.h"
+#   define SIMD_NAMESPACE generic
+#elif defined(SIMD_AVX512)
 #   include "avx512.h"
+#   define SIMD_NAMESPACE avx512
+#elif defined(SIMD_AVX2X2)
+#   include "avx2x2.h"
+#   define SIMD_NAMESPACE avx2x2
 #elif defined(SIMD_AVX2)
 #   include "avx2.h"
+#   define SIMD_NAMESPACE avx2
 #elif defined(SIMD_AVX)
 #   include "avx.h"
+#   define SIMD_NAMESPACE avx
 #elif defined(SIMD_SSE4_2)
 #   include "sse4_2.h"
+#   define SIMD_NAMESPACE sse42
 #elif defined(SIMD_SSE2)
 #   include "sse2.h"
+#   define SIMD_NAMESPACE sse2
 #elif defined(SIMD_MMX)
 #   include "mmx.h"
+#   define SIMD_NAMESPACE mmx
 #else
-#   undef SIMD_MODE
+#   define SIMD_SCALAR
 #   include "scalar.h"
+#   define SIMD_NAMESPACE scalar
 #endif
 
 
+/*
+ *  Each SIMD interface lives in its own namespace (gvl::sse42, gvl::avx2, ...),
+ *  so several interfaces can be included in the same translation unit.
+ *  The selected interface is aliased as gvl::native and its names are made
+ *  visible unqualified, e.g. SIMD_INT and simd_add_32().
+ *
+ *  A kernel written with unqualified names can be instantiated once per
+ *  interface by including it inside each namespace:
+ *
+ *      namespace gvl { namespace sse42 {
+ *      #   include "kernel.inc"
+ *      } }
+ *      namespace gvl { namespace avx2 {
+ *      #   include "kernel.inc"
+ *      } }
+ *
+ *  NOTE: the translation unit has to be compiled with flags (or target pragmas)
+ *  that enable every instruction set included.
+ */
+namespace gvl {
+namespace native = SIMD_NAMESPACE;
+}
+using namespace gvl::native;
+
+
+/*
+ *  simd.h only provides the SIMD interface, modules built on it are opt-in:
+ *  - sysconf.h, dispatch.h, affinity.h, workpool.h, numa.h, hugepage.h and
+ *    arena.h, compiled in the library objects (src/)
+ *  - transpose.h, batched.h, gemm.h, mat.h, spmv.h, stencil.h, scan.h,
+ *    vec.h, expr.h, kernels.h and soa.h, header-only, multi-threaded
+ *    kernels dispatch through dispatch.h
+ */
+
+
 /*
  *  General form of macros provided by compiler/architecture settings
- *  Use SIMD_WIDTH_BYTES provided by SIMD modules
- *  NOTE: This macros will not be correct if multiple SIMD interfaces are loaded
+ *  Use SIMD_WIDTH_BYTES provided by the selected SIMD module (gvl::native),
+ *  qualify the constant, e.g. gvl::avx2::SIMD_WIDTH_BYTES, for other modules
  */
 #define __SIMD_ALIGN__ SIMD_ALIGNED(SIMD_WIDTH_BYTES)
 #define __SIMD_ASSUME_ALIGNED__(a) SIMD_ASSUME_ALIGNED(a, SIMD_WIDTH_BYTES)
@@ -0,0 +1,529 @@
+/*!
+ *  \brief Structure-of-arrays containers
+ *  Records stored as an array of structs turn every field load into a
+ *  gather. These containers store each field contiguously so field-wise
+ *  kernels use unit-stride vector loads:
+ *  - soa<T0, ..., T7>, one aligned array per field
+ *  - aosoa<T0, ..., T7>, blocks of \c block records, each block stores one
+ *    SIMD-width run per field (SIMD_STREAMS_32 records for 32-bit fields,
+ *    SIMD_STREAMS_64 for 64-bit fields), fields of a record stay close in
+ *    memory
+ *  Fields are given as template parameters, unused ones default to
+ *  soa_none (up to SOA_MAX_FIELDS). Field I is accessed with field<I>(),
+ *  get<I>() and, as vectors, load<I>()/store<I>(). Storage comes from
+ *  allocator policy A (heap_allocator, pool_allocator or arena_allocator,
+ *  see arena.h), given after the fields.
+ *  Capacity is a whole number of blocks and elements past size() are kept
+ *  zero, so kernels can process the tail with full vectors.
+ *  push_back() appends and erase() moves the last record into the erased
+ *  slot, so records stay dense (order is not preserved).
+ *  \note Records are copied with memcpy(), fields must be plain data types
+ *        with sizes that are powers of two up to SIMD_WIDTH_BYTES
+ *  \note Containers build on every SIMD interface, vector access needs the
+ *        vector classes, include vec.h to use load<I>()/store<I>()
+ */
+#ifndef _SOA_H
+#define _SOA_H
+
+
+#include <stdint.h>
+#include <stddef.h>   // size_t
+#include <string.h>   // memcpy, memset
+#include "simd.h"     // SIMD_WIDTH_BYTES
+#include "arena.h"    // allocator policies
+
+
+namespace gvl {
+
+
+// Vector classes (vec.h), only needed by load<I>()/store<I>()
+template <typename T>
+class vec;
+
+//! Maximum number of fields of a record
+const int32_t SOA_MAX_FIELDS = 8;
+
+//! Placeholder for unused fields
+struct soa_none {};
+
+
+/*!
+ *  \struct soa_types
+ *  \brief List of field types
+ */
+template <typename T0, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7>
+struct soa_types
+{
+    typedef T0 t0;
+    typedef T1 t1;
+    typedef T2 t2;
+    typedef T3 t3;
+    typedef T4 t4;
+    typedef T5 t5;
+    typedef T6 t6;
+    typedef T7 t7;
+};
+
+//! Type of field I of list L
+template <int I, typename L>
+struct soa_type;
+
+#define SOA_TYPE(I) \
+template <typename L> \
+struct soa_type<I, L> \
+{ typedef typename L::t##I type; };
+
+SOA_TYPE(0)
+SOA_TYPE(1)
+SOA_TYPE(2)
+SOA_TYPE(3)
+SOA_TYPE(4)
+SOA_TYPE(5)
+SOA_TYPE(6)
+SOA_TYPE(7)
+#undef SOA_TYPE
+
+//! Bytes of a field, 0 for unused fields
+template <typename T>
+struct soa_sizeof
+{ static const size_t value = sizeof(T); };
+
+template <>
+struct soa_sizeof<soa_none>
+{ static const size_t value = 0; };
+
+//! Bytes of fields [0, I) of a record
+template <int I, typename L>
+struct soa_prefix
+{ static const size_t value = soa_prefix<I - 1, L>::value + soa_sizeof<typename soa_type<I - 1, L>::type>::value; };
+
+template <typename L>
+struct soa_prefix<0, L>
+{ static const size_t value = 0; };
+
+//! Smallest field size of fields [0, I), 0 if none
+template <int I, typename L>
+struct soa_minsize
+{
+    static const size_t prev = soa_minsize<I - 1, L>::value;
+    static const size_t sz = soa_sizeof<typename soa_type<I - 1, L>::type>::value;
+    static const size_t value = (sz == 0 || (prev > 0 && prev < sz)) ? (prev) : (sz);
+};
+
+template <typename L>
+struct soa_minsize<0, L>
+{ static const size_t value = 0; };
+
+/*!
+ *  \struct soa_layout
+ *  \brief Record layout of field list L
+ */
+template <typename L>
+struct soa_layout
+{
+    //! Bytes of a record
+    static const size_t row_bytes = soa_prefix<SOA_MAX_FIELDS, L>::value;
+
+    //! Records per block, the smallest field fills one SIMD register
+    static const size_t block = SIMD_WIDTH_BYTES / soa_minsize<SOA_MAX_FIELDS, L>::value;
+
+    //! Bytes of field \c i
+    static size_t size(const int32_t i)
+    {
+        static const size_t sizes[SOA_MAX_FIELDS] = {
+            soa_sizeof<typename L::t0>::value, soa_sizeof<typename L::t1>::value,
+            soa_sizeof<typename L::t2>::value, soa_sizeof<typename L::t3>::value,
+            soa_sizeof<typename L::t4>::value, soa_sizeof<typename L::t5>::value,
+            soa_sizeof<typename L::t6>::value, soa_sizeof<typename L::t7>::value
+        };
+        return sizes[i];
+    }
+
+    //! Bytes of fields [0, i) of a record
+    static size_t prefix(const int32_t i)
+    {
+        size_t bytes = 0;
+        for (int32_t j = 0; j < i; ++j)
+            bytes += size(j);
+        return bytes;
+    }
+
+    //! Records rounded up to whole blocks
+    static size_t padded(const size_t n)
+    { return (n + block - 1) / block * block; }
+};
+
+
+/*!
+ *  \class soa
+ *  \brief Structure of arrays, field I of record i is field<I>()[i]
+ *  Each field array is aligned and padded to whole SIMD registers.
+ *  \note If allocation fails, reserve(), resize() and push_back() return
+ *        false and the container is unchanged
+ */
+template <typename T0, typename T1 = soa_none, typename T2 = soa_none, typename T3 = soa_none,
+          typename T4 = soa_none, typename T5 = soa_none, typename T6 = soa_none, typename T7 = soa_none,
+          typename A = heap_allocator>
+class soa
+{
+    public:
+        typedef soa_types<T0, T1, T2, T3, T4, T5, T6, T7> types;
+        typedef soa_layout<types> layout;
+
+        //! Type of field I and its vector class
+        template <int I>
+        struct field_type
+        {
+            typedef typename soa_type<I, types>::type type;
+            typedef vec<type> vtype;
+        };
+
+        static const size_t block = layout::block;
+
+    private:
+        char *p;
+        size_t n;
+        size_t cap;
+
+        // Fields arrays are consecutive, each cap elements long
+        char * field_ptr(const int32_t f, const size_t i) const
+        { return p + cap * layout::prefix(f) + i * layout::size(f); }
+
+        void zero(const size_t lo, const size_t hi)
+        {
+            for (int32_t f = 0; f < SOA_MAX_FIELDS; ++f)
+                if (layout::size(f) > 0)
+                    memset(field_ptr(f, lo), 0, (hi - lo) * layout::size(f));
+        }
+
+        template <int I>
+        void set(const size_t i, const typename field_type<I>::type &x)
+        { memcpy(field_ptr(I, i), &x, soa_sizeof<typename field_type<I>::type>::value); }
+
+        // Not copyable
+        soa(const soa &);
+        soa & operator=(const soa &);
+
+    public:
+        /******************
+         *  Constructors  *
+         ******************/
+        soa(): p(NULL), n(0), cap(0)
+        { }
+
+        //! \c na zero-initialized records, empty if allocation fails
+        explicit soa(const size_t na): p(NULL), n(0), cap(0)
+        { resize(na); }
+
+        ~soa()
+        { A::deallocate(p); }
+
+        /*************
+         *  Get/set  *
+         *************/
+        size_t size() const
+        { return n; }
+
+        //! Records up to the end of the last block in use
+        size_t padded_size() const
+        { return layout::padded(n); }
+
+        size_t capacity() const
+        { return cap; }
+
+        bool empty() const
+        { return n == 0; }
+
+        //! Array of field I, aligned and padded with zeros to capacity()
+        template <int I>
+        typename field_type<I>::type * field()
+        { return (typename field_type<I>::type *)field_ptr(I, 0); }
+
+        template <int I>
+        const typename field_type<I>::type * field() const
+        { return (const typename field_type<I>::type *)field_ptr(I, 0); }
+
+        //! Field I of record \c i
+        template <int I>
+        typename field_type<I>::type & get(const size_t i)
+        { return field<I>()[i]; }
+
+        template <int I>
+        const typename field_type<I>::type & get(const size_t i) const
+        { return field<I>()[i]; }
+
+        //! Vector of field I starting at record \c i, a multiple of the vector length
+        template <int I>
+        SIMD_FUNC_INLINE typename field_type<I>::vtype load(const size_t i) const
+        {
+            typedef typename field_type<I>::vtype vtype;
+            return vtype(vtype::traits::load(field<I>() + i, vtype::nstreams, false));
+        }
+
+        //! Store vector into field I starting at record \c i, a multiple of the vector length
+        template <int I>
+        SIMD_FUNC_INLINE void store(const size_t i, const typename field_type<I>::vtype &va)
+        {
+            typedef typename field_type<I>::vtype vtype;
+            vtype::traits::store(field<I>() + i, va.get_vector(), vtype::nstreams, false);
+        }
+
+        /***************
+         *  Modifiers  *
+         ***************/
+        //! Capacity for at least \c nc records
+        bool reserve(const size_t nc)
+        {
+            if (nc <= cap)
+                return true;
+
+            const size_t ncap = layout::padded(nc);
+            char * const np = (char *)A::allocate(ncap * layout::row_bytes);
+            if (!np)
+                return false;
+            for (int32_t f = 0; f < SOA_MAX_FIELDS; ++f) {
+                const size_t sz = layout::size(f);
+                if (sz == 0)
+                    continue;
+                char * const fp = np + ncap * layout::prefix(f);
+                if (n > 0)
+                    memcpy(fp, field_ptr(f, 0), n * sz);
+                memset(fp + n * sz, 0, (ncap - n) * sz);
+            }
+            A::deallocate(p);
+            p = np;
+            cap = ncap;
+            return true;
+        }
+
+        //! New records are zero, removed ones are zeroed
+        bool resize(const size_t na)
+        {
+            if (na > n && !reserve(na))
+                return false;
+            if (na < n)
+                zero(na, n);
+            n = na;
+            return true;
+        }
+
+        //! Append record, capacity grows geometrically
+        bool push_back(const T0 &x0, const T1 &x1 = T1(), const T2 &x2 = T2(), const T3 &x3 = T3(),
+                       const T4 &x4 = T4(), const T5 &x5 = T5(), const T6 &x6 = T6(), const T7 &x7 = T7())
+        {
+            if (n == cap && !reserve((cap > 0) ? (2 * cap) : (block)))
+                return false;
+            set<0>(n, x0); set<1>(n, x1); set<2>(n, x2); set<3>(n, x3);
+            set<4>(n, x4); set<5>(n, x5); set<6>(n, x6); set<7>(n, x7);
+            ++n;
+            return true;
+        }
+
+        //! Remove record \c i, the last record takes its place
+        void erase(const size_t i)
+        {
+            --n;
+            if (i != n)
+                for (int32_t f = 0; f < SOA_MAX_FIELDS; ++f)
+                    memcpy(field_ptr(f, i), field_ptr(f, n), layout::size(f));
+            zero(n, n + 1);
+        }
+
+        //! Zero all records, capacity is kept
+        void clear()
+        { resize(0); }
+};
+
+
+/*!
+ *  \class aosoa
+ *  \brief Array of structures of arrays, blocks of \c block records
+ *  Block b stores \c block consecutive values of each field, field I of
+ *  record i is field<I>(i / block)[i % block].
+ *  \note If allocation fails, reserve(), resize() and push_back() return
+ *        false and the container is unchanged
+ */
+template <typename T0, typename T1 = soa_none, typename T2 = soa_none, typename T3 = soa_none,
+          typename T4 = soa_none, typename T5 = soa_none, typename T6 = soa_none, typename T7 = soa_none,
+          typename A = heap_allocator>
+class aosoa
+{
+    public:
+        typedef soa_types<T0, T1, T2, T3, T4, T5, T6, T7> types;
+        typedef soa_layout<types> layout;
+
+        //! Type of field I and its vector class
+        template <int I>
+        struct field_type
+        {
+            typedef typename soa_type<I, types>::type type;
+            typedef vec<type> vtype;
+        };
+
+        //! Records per block
+        static const size_t block = layout::block;
+        //! Bytes per block
+        static const size_t block_bytes = layout::block * layout::row_bytes;
+
+    private:
+        char *p;
+        size_t n;
+        size_t cap;
+
+        char * field_ptr(const int32_t f, const size_t i) const
+        { return p + (i / block) * block_bytes + block * layout::prefix(f) + (i % block) * layout::size(f); }
+
+        void zero_record(const size_t i)
+        {
+            for (int32_t f = 0; f < SOA_MAX_FIELDS; ++f)
+                memset(field_ptr(f, i), 0, layout::size(f));
+        }
+
+        template <int I>
+        void set(const size_t i, const typename field_type<I>::type &x)
+        { memcpy(field_ptr(I, i), &x, soa_sizeof<typename field_type<I>::type>::value); }
+
+        aosoa(const aosoa &);
+        aosoa & operator=(const aosoa &);
+
+    public:
+        /******************
+         *  Constructors  *
+         ******************/
+        aosoa(): p(NULL), n(0), cap(0)
+        { }
+
+        //! \c na zero-initialized records, empty if allocation fails
+        explicit aosoa(const size_t na): p(NULL), n(0), cap(0)
+        { resize(na); }
+
+        ~aosoa()
+        { A::deallocate(p); }
+
+        /*************
+         *  Get/set  *
+         *************/
+        size_t size() const
+        { return n; }
+
+        size_t padded_size() const
+        { return layout::padded(n); }
+
+        size_t capacity() const
+        { return cap; }
+
+        bool empty() const
+        { return n == 0; }
+
+        //! Blocks in use
+        size_t nblocks() const
+        { return (n + block - 1) / block; }
+
+        //! Values of field I in block \c b, aligned
+        template <int I>
+        typename field_type<I>::type * field(const size_t b)
+        { return (typename field_type<I>::type *)(p + b * block_bytes + block * soa_prefix<I, types>::value); }
+
+        template <int I>
+        const typename field_type<I>::type * field(const size_t b) const
+        { return (const typename field_type<I>::type *)(p + b * block_bytes + block * soa_prefix<I, types>::value); }
+
+        //! Field I of record \c i
+        template <int I>
+        typename field_type<I>::type & get(const size_t i)
+        { return field<I>(i / block)[i % block]; }
+
+        template <int I>
+        const typename field_type<I>::type & get(const size_t i) const
+        { return field<I>(i / block)[i % block]; }
+
+        /*!
+         *  Vector \c k of field I in block \c b, fields wider than the
+         *  smallest one span block_vectors<I>() vectors per block
+         */
+        template <int I>
+        SIMD_FUNC_INLINE typename field_type<I>::vtype load(const size_t b, const size_t k = 0) const
+        {
+            typedef typename field_type<I>::vtype vtype;
+            return vtype(vtype::traits::load(field<I>(b) + k * vtype::nstreams, vtype::nstreams, false));
+        }
+
+        template <int I>
+        SIMD_FUNC_INLINE void store(const size_t b, const typename field_type<I>::vtype &va, const size_t k = 0)
+        {
+            typedef typename field_type<I>::vtype vtype;
+            vtype::traits::store(field<I>(b) + k * vtype::nstreams, va.get_vector(), vtype::nstreams, false);
+        }
+
+        //! Vectors of field I per block
+        template <int I>
+        static size_t block_vectors()
+        { return block / field_type<I>::vtype::nstreams; }
+
+        /***************
+         *  Modifiers  *
+         ***************/
+        //! Capacity for at least \c nc records
+        bool reserve(const size_t nc)
+        {
+            if (nc <= cap)
+                return true;
+
+            const size_t ncap = layout::padded(nc);
+            char * const np = (char *)A::allocate(ncap / block * block_bytes);
+            if (!np)
+                return false;
+            // Blocks do not depend on capacity, copy blocks in use
+            const size_t used = nblocks() * block_bytes;
+            if (used > 0)
+                memcpy(np, p, used);
+            memset(np + used, 0, ncap / block * block_bytes - used);
+            A::deallocate(p);
+            p = np;
+            cap = ncap;
+            return true;
+        }
+
+        //! New records are zero, removed ones are zeroed
+        bool resize(const size_t na)
+        {
+            if (na > n && !reserve(na))
+                return false;
+            for (size_t i = na; i < n; ++i)
+                zero_record(i);
+            n = na;
+            return true;
+        }
+
+        //! Append record, capacity grows geometrically
+        bool push_back(const T0 &x0, const T1 &x1 = T1(), const T2 &x2 = T2(), const T3 &x3 = T3(),
+                       const T4 &x4 = T4(), const T5 &x5 = T5(), const T6 &x6 = T6(), const T7 &x7 = T7())
+        {
+            if (n == cap && !reserve((cap > 0) ? (2 * cap) : (block)))
+                return false;
+            set<0>(n, x0); set<1>(n, x1); set<2>(n, x2); set<3>(n, x3);
+            set<4>(n, x4); set<5>(n, x5); set<6>(n, x6); set<7>(n, x7);
+            ++n;
+            return true;
+        }
+
+        //! Remove record \c i, the last record takes its place
+        void erase(const size_t i)
+        {
+            --n;
+            if (i != n)
+                for (int32_t f = 0; f < SOA_MAX_FIELDS; ++f)
+                    memcpy(field_ptr(f, i), field_ptr(f, n), layout::size(f));
+            zero_record(n);
+        }
+
+        //! Zero all records, capacity is kept
+        void clear()
+        { resize(0); }
+};
+
+
+}  // namespace gvl
+
+
+#endif  // _SOA_H
@@ -0,0 +1,406 @@
+/*!
+ *  \brief Sparse matrix-vector multiply, y = A * x
+ *  Two storage formats:
+ *  - csr_matrix, compressed sparse rows (row offsets, column indices and
+ *    values, caller-owned). Each row is a dot product of its values with
+ *    elements of x gathered by column index, reduced horizontally.
+ *  - sell_matrix, SELL-C-sigma: rows in slices of C rows (C = SIMD width),
+ *    stored column-major within a slice and padded to its longest row, so
+ *    one vector holds one nonzero of C rows and no horizontal sum is
+ *    needed. Rows are sorted by length within windows of sigma rows before
+ *    slicing, which keeps padding low for irregular (e.g. graph) matrices.
+ *  Rows (slices) are split among threads into ranges of equal nonzeros
+ *  (stored elements), scheduled with the work-stealing pool (workpool.h).
+ *  \note Column indices are int32_t (the index type of gather instructions)
+ */
+#ifndef _SPMV_H
+#define _SPMV_H
+
+
+#include <stdint.h>
+#include <stddef.h>   // size_t
+#include <algorithm>  // lower_bound, stable_sort
+#include "simd.h"
+#include "sysconf.h"
+#include "dispatch.h"  // lane_traits, steal_parts_for
+#include "workpool.h"
+#include "arena.h"     // allocator policies
+
+
+namespace gvl {
+
+
+/*!
+ *  \class spmv_traits
+ *  \brief SIMD datatype of sparse matrices of type T, C = nlanes
+ */
+template <typename T>
+struct spmv_traits: lane_traits<T>
+{ };
+
+/*!
+ *  First row (slice) of part \c p of \c np, such that parts hold equal
+ *  numbers of elements according to offsets ptr[0..n]
+ */
+static inline size_t spmv_split(const size_t * const ptr, const size_t n, const size_t p, const size_t np)
+{
+    if (p >= np)
+        return n;
+    const size_t target = ptr[0] + (ptr[n] - ptr[0]) * p / np;
+    return (size_t)(std::lower_bound(ptr, ptr + n, target) - ptr);
+}
+
+
+/*********
+ *  CSR  *
+ *********/
+/*!
+ *  \class csr_matrix
+ *  \brief View of a CSR matrix of nrows x ncols elements of type T
+ *  Row i has nonzeros row_ptr[i] .. row_ptr[i + 1] - 1 of col_idx and val.
+ */
+template <typename T>
+struct csr_matrix
+{
+    size_t nrows;
+    size_t ncols;
+    const size_t *row_ptr;   // nrows + 1 offsets
+    const int32_t *col_idx;
+    const T *val;
+
+    csr_matrix(const size_t r, const size_t c, const size_t * const ptr, const int32_t * const idx, const T * const v):
+        nrows(r), ncols(c), row_ptr(ptr), col_idx(idx), val(v)
+    { }
+
+    size_t nnz() const
+    { return row_ptr[nrows] - row_ptr[0]; }
+};
+
+/*!
+ *  Dot product of \c len values with elements of x gathered at \c idx.
+ *  Two accumulators hide the latency of gathers and multiply-adds.
+ */
+template <typename T>
+static SIMD_FUNC_INLINE T csr_row_dot(const T * const val, const int32_t * const idx, const size_t len, const T * const x)
+{
+    typedef typename spmv_traits<T>::vtype vtype;
+    const size_t nlanes = spmv_traits<T>::nlanes;
+    vtype acc0, acc1;
+    simd_set_zero(&acc0);
+    simd_set_zero(&acc1);
+
+    size_t k = 0;
+    for (; k + 2 * nlanes <= len; k += 2 * nlanes) {
+        acc0 = simd_fmadd(simd_loadu(val + k), simd_gather(x, idx + k), acc0);
+        acc1 = simd_fmadd(simd_loadu(val + k + nlanes), simd_gather(x, idx + k + nlanes), acc1);
+    }
+    if (k + nlanes <= len) {
+        acc0 = simd_fmadd(simd_loadu(val + k), simd_gather(x, idx + k), acc0);
+        k += nlanes;
+    }
+
+    T lanes[nlanes];
+    simd_storeu(lanes, simd_add(acc0, acc1));
+    T sum = (T)0;
+    for (size_t l = 0; l < nlanes; ++l)
+        sum += lanes[l];
+    for (; k < len; ++k)
+        sum += val[k] * x[idx[k]];
+    return sum;
+}
+
+//! Range functor of spmv() on CSR, computes parts [lo, hi) of np
+template <typename T>
+struct csr_spmv_range
+{
+    T * const y;
+    const csr_matrix<T> &a;
+    const T * const x;
+    const size_t np;
+
+    csr_spmv_range(T * const yy, const csr_matrix<T> &aa, const T * const xx, const size_t n):
+        y(yy), a(aa), x(xx), np(n)
+    { }
+
+    void operator()(const size_t lo, const size_t hi) const
+    {
+        const size_t r0 = spmv_split(a.row_ptr, a.nrows, lo, np);
+        const size_t r1 = spmv_split(a.row_ptr, a.nrows, hi, np);
+        for (size_t i = r0; i < r1; ++i) {
+            const size_t k = a.row_ptr[i];
+            y[i] = csr_row_dot(a.val + k, a.col_idx + k, a.row_ptr[i + 1] - k, x);
+        }
+    }
+};
+
+/*!
+ *  y = A * x with A in CSR format
+ *  \param[out] y Vector of a.nrows elements
+ *  \param[in] x Vector of a.ncols elements
+ *  \param[in] run_par Rows are split among the OpenMP threads set by SYSCONF
+ *             into ranges of equal nonzeros
+ */
+template <typename T>
+static void spmv(T * const y, const csr_matrix<T> &a, const T * const x, const bool run_par = false)
+{
+    if (a.nrows == 0)
+        return;
+
+    const int32_t nthreads = ((SYSCONF::get_omp() & run_par) == true) ? (SYSCONF::get_threads()) : (1);
+    const size_t np = steal_parts(a.nrows, nthreads);
+    steal_parts_for(np, csr_spmv_range<T>(y, a, x, np), nthreads);
+}
+
+
+/******************
+ *  SELL-C-sigma  *
+ ******************/
+//! Orders rows by decreasing length
+struct sell_longer
+{
+    const size_t *row_ptr;
+
+    explicit sell_longer(const size_t * const ptr): row_ptr(ptr)
+    { }
+
+    bool operator()(const int32_t i, const int32_t j) const
+    { return row_ptr[i + 1] - row_ptr[i] > row_ptr[j + 1] - row_ptr[j]; }
+};
+
+/*!
+ *  \class sell_matrix
+ *  \brief SELL-C-sigma matrix of type T, C = spmv_traits<T>::nlanes
+ *  Slice s holds rows perm[s * C] .. perm[s * C + C - 1] (-1 past the last
+ *  row), element j of lane l is at slice_ptr[s] + j * C + l. Padding has
+ *  value zero and repeats the last column index of its row, so x is read
+ *  where the row already reads it.
+ *  Arrays come from allocator policy A (heap_allocator, pool_allocator or
+ *  arena_allocator, see arena.h).
+ *  \note If allocation fails, assign() returns false and the matrix is
+ *        unchanged
+ */
+template <typename T, typename A = heap_allocator>
+class sell_matrix
+{
+    public:
+        typedef typename spmv_traits<T>::vtype vtype;
+        static const size_t C = spmv_traits<T>::nlanes;
+
+    private:
+        size_t nrows;
+        size_t ncols;
+        size_t nslices;
+        size_t sigma_rows;
+        size_t *sptr;
+        int32_t *perm;
+        int32_t *idx;
+        T *v;
+
+        void release()
+        {
+            A::deallocate(sptr);
+            A::deallocate(perm);
+            A::deallocate(idx);
+            A::deallocate(v);
+        }
+
+        // Not copyable
+        sell_matrix(const sell_matrix &);
+        sell_matrix & operator=(const sell_matrix &);
+
+    public:
+        /******************
+         *  Constructors  *
+         ******************/
+        sell_matrix(): nrows(0), ncols(0), nslices(0), sigma_rows(0), sptr(NULL), perm(NULL), idx(NULL), v(NULL)
+        { }
+
+        //! Conversion of \c a, empty if allocation fails
+        sell_matrix(const csr_matrix<T> &a, const size_t sigma):
+            nrows(0), ncols(0), nslices(0), sigma_rows(0), sptr(NULL), perm(NULL), idx(NULL), v(NULL)
+        { assign(a, sigma); }
+
+        ~sell_matrix()
+        { release(); }
+
+        /*!
+         *  Convert CSR matrix \c a. Rows are sorted by decreasing length
+         *  (stable) within windows of \c sigma rows, rounded up to a multiple
+         *  of C; sigma <= C keeps the original row order.
+         *  \return true if successful
+         */
+        bool assign(const csr_matrix<T> &a, const size_t sigma)
+        {
+            const size_t ns = (a.nrows + C - 1) / C;
+            const size_t sg = (sigma > C) ? (((sigma + C - 1) / C) * C) : (C);
+
+            int32_t * const p = (int32_t *)A::allocate((ns * C + 1) * sizeof(int32_t));
+            size_t * const sp = (size_t *)A::allocate((ns + 1) * sizeof(size_t));
+            if (p == NULL || sp == NULL) {
+                A::deallocate(p);
+                A::deallocate(sp);
+                return false;
+            }
+
+            // Row order, sorted within sigma windows
+            for (size_t i = 0; i < ns * C; ++i)
+                p[i] = (i < a.nrows) ? ((int32_t)i) : (-1);
+            if (sg > C)
+                for (size_t w = 0; w < a.nrows; w += sg)
+                    std::stable_sort(p + w, p + ((w + sg < a.nrows) ? (w + sg) : (a.nrows)), sell_longer(a.row_ptr));
+
+            // Slice offsets, width of a slice is its longest row
+            sp[0] = 0;
+            for (size_t s = 0; s < ns; ++s) {
+                size_t width = 0;
+                for (size_t l = 0; l < C; ++l) {
+                    const int32_t r = p[s * C + l];
+                    if (r >= 0 && a.row_ptr[r + 1] - a.row_ptr[r] > width)
+                        width = a.row_ptr[r + 1] - a.row_ptr[r];
+                }
+                sp[s + 1] = sp[s] + width * C;
+            }
+
+            int32_t * const pi = (int32_t *)A::allocate((sp[ns] + 1) * sizeof(int32_t));
+            T * const pv = (T *)A::allocate((sp[ns] + 1) * sizeof(T));
+            if (pi == NULL || pv == NULL) {
+                A::deallocate(p);
+                A::deallocate(sp);
+                A::deallocate(pi);
+                A::deallocate(pv);
+                return false;
+            }
+
+            for (size_t s = 0; s < ns; ++s) {
+                const size_t width = (sp[s + 1] - sp[s]) / C;
+                for (size_t l = 0; l < C; ++l) {
+                    const int32_t r = p[s * C + l];
+                    const size_t k0 = (r >= 0) ? (a.row_ptr[r]) : (0);
+                    const size_t len = (r >= 0) ? (a.row_ptr[r + 1] - k0) : (0);
+                    for (size_t j = 0; j < width; ++j) {
+                        const size_t e = sp[s] + j * C + l;
+                        pi[e] = (j < len) ? (a.col_idx[k0 + j]) : ((len > 0) ? (a.col_idx[k0 + len - 1]) : (0));
+                        pv[e] = (j < len) ? (a.val[k0 + j]) : ((T)0);
+                    }
+                }
+            }
+
+            release();
+            nrows = a.nrows;
+            ncols = a.ncols;
+            nslices = ns;
+            sigma_rows = sg;
+            sptr = sp;
+            perm = p;
+            idx = pi;
+            v = pv;
+            return true;
+        }
+
+        /*************
+         *  Get/set  *
+         *************/
+        size_t rows() const
+        { return nrows; }
+
+        size_t cols() const
+        { return ncols; }
+
+        size_t slices() const
+        { return nslices; }
+
+        //! Sorting window in rows
+        size_t sigma() const
+        { return sigma_rows; }
+
+        //! Stored elements including padding
+        size_t elems() const
+        { return (sptr) ? (sptr[nslices]) : (0); }
+
+        //! Offsets of slices, slices() + 1 elements
+        const size_t * slice_ptr() const
+        { return sptr; }
+
+        //! Original row of each lane, -1 for lanes past the last row
+        const int32_t * row_perm() const
+        { return perm; }
+
+        const int32_t * col_idx() const
+        { return idx; }
+
+        const T * val() const
+        { return v; }
+};
+
+//! Range functor of spmv() on SELL-C-sigma, computes parts [lo, hi) of np
+template <typename T, typename A>
+struct sell_spmv_range
+{
+    typedef typename spmv_traits<T>::vtype vtype;
+
+    T * const y;
+    const sell_matrix<T, A> &a;
+    const T * const x;
+    const size_t np;
+
+    sell_spmv_range(T * const yy, const sell_matrix<T, A> &aa, const T * const xx, const size_t n):
+        y(yy), a(aa), x(xx), np(n)
+    { }
+
+    void operator()(const size_t lo, const size_t hi) const
+    {
+        const size_t C = sell_matrix<T, A>::C;
+        const size_t * const sp = a.slice_ptr();
+        const int32_t * const perm = a.row_perm();
+        const size_t s0 = spmv_split(sp, a.slices(), lo, np);
+        const size_t s1 = spmv_split(sp, a.slices(), hi, np);
+        for (size_t s = s0; s < s1; ++s) {
+            const T * const pv = a.val() + sp[s];
+            const int32_t * const pi = a.col_idx() + sp[s];
+            const size_t width = (sp[s + 1] - sp[s]) / C;
+            vtype acc0, acc1;
+            simd_set_zero(&acc0);
+            simd_set_zero(&acc1);
+
+            size_t j = 0;
+            for (; j + 2 <= width; j += 2) {
+                acc0 = simd_fmadd(simd_load(pv + j * C), simd_gather(x, pi + j * C), acc0);
+                acc1 = simd_fmadd(simd_load(pv + (j + 1) * C), simd_gather(x, pi + (j + 1) * C), acc1);
+            }
+            if (j < width)
+                acc0 = simd_fmadd(simd_load(pv + j * C), simd_gather(x, pi + j * C), acc0);
+
+            T lanes[C];
+            simd_storeu(lanes, simd_add(acc0, acc1));
+            for (size_t l = 0; l < C; ++l) {
+                const int32_t r = perm[s * C + l];
+                if (r >= 0)
+                    y[r] = lanes[l];
+            }
+        }
+    }
+};
+
+/*!
+ *  y = A * x with A in SELL-C-sigma format
+ *  \param[out] y Vector of a.rows() elements, in original row order
+ *  \param[in] x Vector of a.cols() elements
+ *  \param[in] run_par Slices are split among the OpenMP threads set by
+ *             SYSCONF into ranges of equal stored elements
+ */
+template <typename T, typename A>
+static void spmv(T * const y, const sell_matrix<T, A> &a, const T * const x, const bool run_par = false)
+{
+    if (a.slices() == 0)
+        return;
+
+    const int32_t nthreads = ((SYSCONF::get_omp() & run_par) == true) ? (SYSCONF::get_threads()) : (1);
+    const size_t np = steal_parts(a.slices(), nthreads);
+    steal_parts_for(np, sell_spmv_range<T, A>(y, a, x, np), nthreads);
+}
+
+
+}  // namespace gvl
+
+
+#endif  // _SPMV_H
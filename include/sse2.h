@@ -6,6 +6,7 @@
  *  Support '_t' C datatypes
  */
 #include <stdint.h>
+#include <stddef.h>   // size_t
 
 
 /*
@@ -31,6 +32,10 @@
 #endif
 
 
+namespace gvl {
+namespace sse2 {
+
+
 /*
  *  SSE2 128-bit wide vector units
  *  Define constants required for SIMD module to function properly.
@@ -714,5 +719,440 @@ void simd_storeu(double * const sa, const SIMD_DBL va)
 { _mm_storeu_pd(sa, va); }
 
 
+/***************************
+ *  Interleave intrinsics
+ ***************************/
+/*!
+ *  Load records of 2/3/4 components (array of structures) and split them
+ *  into one vector per component (structure of arrays), e.g., xyz points
+ *  or RGB/RGBA pixels. simd_store_interleave* is the inverse.
+ *  Each call reads/writes 2/3/4 vectors of consecutive elements, pointers
+ *  need not be aligned.
+ */
+//! Lane I of va, lane J of vb, lane K of vc and lane L of vd
+template <int I, int J, int K, int L>
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_gather_lanes(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc, const SIMD_FLT vd)
+{
+    return _mm_shuffle_ps(_mm_shuffle_ps(va, vb, _MM_SHUFFLE(J, J, I, I)),
+                          _mm_shuffle_ps(vc, vd, _MM_SHUFFLE(L, L, K, K)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb)
+{
+    const SIMD_FLT v0 = _mm_loadu_ps(sa);
+    const SIMD_FLT v1 = _mm_loadu_ps(sa + 4);
+    *va = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0));
+    *vb = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc)
+{
+    const SIMD_FLT v0 = _mm_loadu_ps(sa);
+    const SIMD_FLT v1 = _mm_loadu_ps(sa + 4);
+    const SIMD_FLT v2 = _mm_loadu_ps(sa + 8);
+    *va = simd_gather_lanes<0, 3, 2, 1>(v0, v0, v1, v2);
+    *vb = simd_gather_lanes<1, 0, 3, 2>(v0, v1, v1, v2);
+    *vc = simd_gather_lanes<2, 1, 0, 3>(v0, v1, v2, v2);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc, SIMD_FLT * const vd)
+{
+    SIMD_FLT v0 = _mm_loadu_ps(sa);
+    SIMD_FLT v1 = _mm_loadu_ps(sa + 4);
+    SIMD_FLT v2 = _mm_loadu_ps(sa + 8);
+    SIMD_FLT v3 = _mm_loadu_ps(sa + 12);
+    _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+    *va = v0;
+    *vb = v1;
+    *vc = v2;
+    *vd = v3;
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(float * const sa, const SIMD_FLT va, const SIMD_FLT vb)
+{
+    _mm_storeu_ps(sa, _mm_unpacklo_ps(va, vb));
+    _mm_storeu_ps(sa + 4, _mm_unpackhi_ps(va, vb));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc)
+{
+    _mm_storeu_ps(sa, simd_gather_lanes<0, 0, 0, 1>(va, vb, vc, va));
+    _mm_storeu_ps(sa + 4, simd_gather_lanes<1, 1, 2, 2>(vb, vc, va, vb));
+    _mm_storeu_ps(sa + 8, simd_gather_lanes<2, 3, 3, 3>(vc, va, vb, vc));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc, const SIMD_FLT vd)
+{
+    SIMD_FLT v0 = va, v1 = vb, v2 = vc, v3 = vd;
+    _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+    _mm_storeu_ps(sa, v0);
+    _mm_storeu_ps(sa + 4, v1);
+    _mm_storeu_ps(sa + 8, v2);
+    _mm_storeu_ps(sa + 12, v3);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb)
+{
+    const SIMD_DBL v0 = _mm_loadu_pd(sa);
+    const SIMD_DBL v1 = _mm_loadu_pd(sa + 2);
+    *va = _mm_unpacklo_pd(v0, v1);
+    *vb = _mm_unpackhi_pd(v0, v1);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc)
+{
+    const SIMD_DBL v0 = _mm_loadu_pd(sa);
+    const SIMD_DBL v1 = _mm_loadu_pd(sa + 2);
+    const SIMD_DBL v2 = _mm_loadu_pd(sa + 4);
+    *va = _mm_shuffle_pd(v0, v1, 0x2);
+    *vb = _mm_shuffle_pd(v0, v2, 0x1);
+    *vc = _mm_shuffle_pd(v1, v2, 0x2);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc, SIMD_DBL * const vd)
+{
+    const SIMD_DBL v0 = _mm_loadu_pd(sa);
+    const SIMD_DBL v1 = _mm_loadu_pd(sa + 2);
+    const SIMD_DBL v2 = _mm_loadu_pd(sa + 4);
+    const SIMD_DBL v3 = _mm_loadu_pd(sa + 6);
+    *va = _mm_unpacklo_pd(v0, v2);
+    *vb = _mm_unpackhi_pd(v0, v2);
+    *vc = _mm_unpacklo_pd(v1, v3);
+    *vd = _mm_unpackhi_pd(v1, v3);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(double * const sa, const SIMD_DBL va, const SIMD_DBL vb)
+{
+    _mm_storeu_pd(sa, _mm_unpacklo_pd(va, vb));
+    _mm_storeu_pd(sa + 2, _mm_unpackhi_pd(va, vb));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc)
+{
+    _mm_storeu_pd(sa, _mm_shuffle_pd(va, vb, 0x0));
+    _mm_storeu_pd(sa + 2, _mm_shuffle_pd(vc, va, 0x2));
+    _mm_storeu_pd(sa + 4, _mm_shuffle_pd(vb, vc, 0x3));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc, const SIMD_DBL vd)
+{
+    _mm_storeu_pd(sa, _mm_unpacklo_pd(va, vb));
+    _mm_storeu_pd(sa + 2, _mm_unpacklo_pd(vc, vd));
+    _mm_storeu_pd(sa + 4, _mm_unpackhi_pd(va, vb));
+    _mm_storeu_pd(sa + 6, _mm_unpackhi_pd(vc, vd));
+}
+
+//! 32-bit integers use the single-precision shuffles
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    SIMD_FLT fa, fb;
+    simd_load_deinterleave2((const float *)sa, &fa, &fb);
+    *va = _mm_castps_si128(fa);
+    *vb = _mm_castps_si128(fb);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    SIMD_FLT fa, fb, fc;
+    simd_load_deinterleave3((const float *)sa, &fa, &fb, &fc);
+    *va = _mm_castps_si128(fa);
+    *vb = _mm_castps_si128(fb);
+    *vc = _mm_castps_si128(fc);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    SIMD_FLT fa, fb, fc, fd;
+    simd_load_deinterleave4((const float *)sa, &fa, &fb, &fc, &fd);
+    *va = _mm_castps_si128(fa);
+    *vb = _mm_castps_si128(fb);
+    *vc = _mm_castps_si128(fc);
+    *vd = _mm_castps_si128(fd);
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{ simd_store_interleave2((float *)sa, _mm_castsi128_ps(va), _mm_castsi128_ps(vb)); }
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{ simd_store_interleave3((float *)sa, _mm_castsi128_ps(va), _mm_castsi128_ps(vb), _mm_castsi128_ps(vc)); }
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{ simd_store_interleave4((float *)sa, _mm_castsi128_ps(va), _mm_castsi128_ps(vb), _mm_castsi128_ps(vc), _mm_castsi128_ps(vd)); }
+
+//! 8-bit records (e.g., pixels) use 16-bit packs, 3 components go through memory
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    const SIMD_INT vmsk = _mm_set1_epi16(0x00FF);
+    const SIMD_INT v0 = _mm_loadu_si128((SIMD_INT *)sa);
+    const SIMD_INT v1 = _mm_loadu_si128((SIMD_INT *)(sa + 16));
+    *va = _mm_packus_epi16(_mm_and_si128(v0, vmsk), _mm_and_si128(v1, vmsk));
+    *vb = _mm_packus_epi16(_mm_srli_epi16(v0, 8), _mm_srli_epi16(v1, 8));
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    uint8_t tmp[3][16] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    for (int32_t i = 0; i < 16; ++i) {
+        tmp[0][i] = sa[3 * i];
+        tmp[1][i] = sa[3 * i + 1];
+        tmp[2][i] = sa[3 * i + 2];
+    }
+    *va = _mm_load_si128((SIMD_INT *)tmp[0]);
+    *vb = _mm_load_si128((SIMD_INT *)tmp[1]);
+    *vc = _mm_load_si128((SIMD_INT *)tmp[2]);
+}
+
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    // Components (0, 2) and (1, 3), then split each pair
+    SIMD_INT vac0, vbd0, vac1, vbd1;
+    simd_load_deinterleave2(sa, &vac0, &vbd0);
+    simd_load_deinterleave2(sa + 32, &vac1, &vbd1);
+    const SIMD_INT vmsk = _mm_set1_epi16(0x00FF);
+    *va = _mm_packus_epi16(_mm_and_si128(vac0, vmsk), _mm_and_si128(vac1, vmsk));
+    *vb = _mm_packus_epi16(_mm_and_si128(vbd0, vmsk), _mm_and_si128(vbd1, vmsk));
+    *vc = _mm_packus_epi16(_mm_srli_epi16(vac0, 8), _mm_srli_epi16(vac1, 8));
+    *vd = _mm_packus_epi16(_mm_srli_epi16(vbd0, 8), _mm_srli_epi16(vbd1, 8));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{
+    _mm_storeu_si128((SIMD_INT *)sa, _mm_unpacklo_epi8(va, vb));
+    _mm_storeu_si128((SIMD_INT *)(sa + 16), _mm_unpackhi_epi8(va, vb));
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{
+    uint8_t tmp[3][16] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+    _mm_store_si128((SIMD_INT *)tmp[0], va);
+    _mm_store_si128((SIMD_INT *)tmp[1], vb);
+    _mm_store_si128((SIMD_INT *)tmp[2], vc);
+    for (int32_t i = 0; i < 16; ++i) {
+        sa[3 * i] = tmp[0][i];
+        sa[3 * i + 1] = tmp[1][i];
+        sa[3 * i + 2] = tmp[2][i];
+    }
+}
+
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{
+    const SIMD_INT vab_lo = _mm_unpacklo_epi8(va, vb);
+    const SIMD_INT vab_hi = _mm_unpackhi_epi8(va, vb);
+    const SIMD_INT vcd_lo = _mm_unpacklo_epi8(vc, vd);
+    const SIMD_INT vcd_hi = _mm_unpackhi_epi8(vc, vd);
+    _mm_storeu_si128((SIMD_INT *)sa, _mm_unpacklo_epi16(vab_lo, vcd_lo));
+    _mm_storeu_si128((SIMD_INT *)(sa + 16), _mm_unpackhi_epi16(vab_lo, vcd_lo));
+    _mm_storeu_si128((SIMD_INT *)(sa + 32), _mm_unpacklo_epi16(vab_hi, vcd_hi));
+    _mm_storeu_si128((SIMD_INT *)(sa + 48), _mm_unpackhi_epi16(vab_hi, vcd_hi));
+}
+
+
+/**************************
+ *  Transpose intrinsics
+ **************************/
+/*!
+ *  Transpose a square tile, sb[j * ldb + i] = sa[i * lda + j].
+ *  Rows of \c sa are loaded into registers, transposed with shuffles and
+ *  stored as rows of \c sb. Leading dimensions are in elements, rows need
+ *  not be aligned and tiles must not overlap.
+ */
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    __m128 r0 = _mm_loadu_ps(sa);
+    __m128 r1 = _mm_loadu_ps(sa + lda);
+    __m128 r2 = _mm_loadu_ps(sa + 2 * lda);
+    __m128 r3 = _mm_loadu_ps(sa + 3 * lda);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(sb, r0);
+    _mm_storeu_ps(sb + ldb, r1);
+    _mm_storeu_ps(sb + 2 * ldb, r2);
+    _mm_storeu_ps(sb + 3 * ldb, r3);
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    simd_transpose4x4_f32(sb, ldb, sa, lda);
+    simd_transpose4x4_f32(sb + 4, ldb, sa + 4 * lda, lda);
+    simd_transpose4x4_f32(sb + 4 * ldb, ldb, sa + 4, lda);
+    simd_transpose4x4_f32(sb + 4 * ldb + 4, ldb, sa + 4 * lda + 4, lda);
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    // 2x2 blocks
+    for (int32_t i = 0; i < 4; i+=2)
+        for (int32_t j = 0; j < 4; j+=2) {
+            const __m128d r0 = _mm_loadu_pd(sa + i * lda + j);
+            const __m128d r1 = _mm_loadu_pd(sa + (i + 1) * lda + j);
+            _mm_storeu_pd(sb + j * ldb + i, _mm_unpacklo_pd(r0, r1));
+            _mm_storeu_pd(sb + (j + 1) * ldb + i, _mm_unpackhi_pd(r0, r1));
+        }
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    simd_transpose4x4_f64(sb, ldb, sa, lda);
+    simd_transpose4x4_f64(sb + 4, ldb, sa + 4 * lda, lda);
+    simd_transpose4x4_f64(sb + 4 * ldb, ldb, sa + 4, lda);
+    simd_transpose4x4_f64(sb + 4 * ldb + 4, ldb, sa + 4 * lda + 4, lda);
+}
+
+
+/*************************
+ *  Gather instructions  *
+ *************************/
+/*!
+ *  Gather, lane i is loaded from sa[idx[i]], one 32-bit index per lane.
+ *  Indices need not be sorted or distinct and are not range-checked.
+ */
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_gather(const float * const sa, const int32_t * const idx)
+{ return _mm_set_ps(sa[idx[3]], sa[idx[2]], sa[idx[1]], sa[idx[0]]); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_gather(const double * const sa, const int32_t * const idx)
+{ return _mm_set_pd(sa[idx[1]], sa[idx[0]]); }
+
+
+/************************
+ *  Align instructions  *
+ ************************/
+/*!
+ *  Lanes N .. N + nlanes - 1 of the concatenation of vb (low lanes) and va
+ *  (high lanes), 0 <= N <= nlanes. Vectors at consecutive aligned addresses
+ *  give the vector at an unaligned offset of N elements.
+ */
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_alignr(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    if (N <= 0)
+        return vb;
+    if (N >= 4)
+        return va;
+    return _mm_castsi128_ps(_mm_or_si128(_mm_srli_si128(_mm_castps_si128(vb), (4 * N) & 15),
+                                         _mm_slli_si128(_mm_castps_si128(va), (16 - 4 * N) & 15)));
+}
+
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_alignr(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    if (N <= 0)
+        return vb;
+    if (N >= 2)
+        return va;
+    return _mm_shuffle_pd(vb, va, 1);
+}
+
+
+/***********************
+ *  Scan instructions  *
+ ***********************/
+/*!
+ *  Inclusive prefix sums of the lanes of va plus the carry *vc (all lanes
+ *  equal), by log2(nlanes) steps of lane shifts and adds. The sum of va is
+ *  broadcast and added to *vc, the carry of the next vector, so that one
+ *  add per vector is on the loop-carried path.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_32(const SIMD_INT va, SIMD_INT * const vc)
+{
+    SIMD_INT vs = _mm_add_epi32(va, _mm_slli_si128(va, 4));
+    vs = _mm_add_epi32(vs, _mm_slli_si128(vs, 8));
+    const SIMD_INT vp = *vc;
+    *vc = _mm_add_epi32(vp, _mm_shuffle_epi32(vs, 0xFF));
+    return _mm_add_epi32(vs, vp);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_64(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const SIMD_INT vs = _mm_add_epi64(va, _mm_slli_si128(va, 8));
+    const SIMD_INT vp = *vc;
+    *vc = _mm_add_epi64(vp, _mm_shuffle_epi32(vs, 0xEE));
+    return _mm_add_epi64(vs, vp);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    SIMD_FLT vs = _mm_add_ps(va, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(va), 4)));
+    vs = _mm_add_ps(vs, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(vs), 8)));
+    const SIMD_FLT vp = *vc;
+    *vc = _mm_add_ps(vp, _mm_shuffle_ps(vs, vs, 0xFF));
+    return _mm_add_ps(vs, vp);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    const SIMD_DBL vs = _mm_add_pd(va, _mm_castsi128_pd(_mm_slli_si128(_mm_castpd_si128(va), 8)));
+    const SIMD_DBL vp = *vc;
+    *vc = _mm_add_pd(vp, _mm_unpackhi_pd(vs, vs));
+    return _mm_add_pd(vs, vp);
+}
+
+/*!
+ *  Exclusive prefix sums, lane i is the carry plus lanes 0 .. i-1 of va,
+ *  *vc is updated as by the inclusive sums
+ */
+//! Integer sums are exact, the exclusive sums are the inclusive sums less va
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_32(const SIMD_INT va, SIMD_INT * const vc)
+{ return _mm_sub_epi32(simd_scan_32(va, vc), va); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_64(const SIMD_INT va, SIMD_INT * const vc)
+{ return _mm_sub_epi64(simd_scan_64(va, vc), va); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan_excl(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    const SIMD_FLT vp = *vc;
+    return simd_alignr<3>(simd_scan(va, vc), vp);
+}
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan_excl(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    const SIMD_DBL vp = *vc;
+    return simd_alignr<1>(simd_scan(va, vc), vp);
+}
+
+
+}  // namespace sse2
+}  // namespace gvl
+
+
 #endif  // _SSE2_H
 
@@ -30,6 +30,15 @@
 #define _SSE4_2_H
 
 
+#include "compiler_attributes.h"
+#include "compiler_builtins.h"
+#include <nmmintrin.h>
+#if defined(__FMA__)
+#   include <immintrin.h>  // _mm_fmadd_ps and others
+#endif
+//#include <x86intrin.h>
+#include <stdint.h>
+#include <stddef.h>   // size_t
 #include <stdio.h>
 #include <stdlib.h>   // NULL, free, posix_memalign, getenv, atoi
 #include <iostream>
@@ -54,7 +63,8 @@ enum SHUFFLE_CTRL { XCHG = 0, // Exchange lower/upper halfs of register
 
 
 //! \note Include comments inside namespace for correct module listing in documentation
-namespace SSE4_2 {
+namespace gvl {
+namespace sse42 {
 
 
 /*
@@ -964,19 +974,10 @@ namespace SSE4_2 {
  */
 
 
-#include "compiler_attributes.h"
-#include "compiler_builtins.h"
-#include <nmmintrin.h>
-//#include <x86intrin.h>
-#include <stdint.h>
-
-
-// NOTE: GCC 4.8 does not considers 'const' variables as 'const literals' for macros.
-// This was fixed for GCC 5.3+.
-#define SIMD_WIDTH_BITS 128
-#define SIMD_WIDTH_BYTES ((SIMD_WIDTH_BITS) / 8)
-//const int32_t SIMD_WIDTH_BITS = 128;
-//const int32_t SIMD_WIDTH_BYTES = SIMD_WIDTH_BITS / 8;
+// NOTE: GCC 4.8 does not considers 'const' variables as 'const literals' for macros,
+// so SIMD_ALIGNED(SIMD_WIDTH_BYTES) requires GCC 5.3+.
+const int32_t SIMD_WIDTH_BITS = 128;
+const int32_t SIMD_WIDTH_BYTES = SIMD_WIDTH_BITS / 8;
 const int32_t SIMD_STREAMS_8 = SIMD_WIDTH_BYTES;
 const int32_t SIMD_STREAMS_16 = SIMD_WIDTH_BYTES / sizeof(int16_t);
 const int32_t SIMD_STREAMS_32 = SIMD_WIDTH_BYTES / sizeof(int32_t);
@@ -1233,6 +1234,30 @@ static SIMD_FUNC_INLINE
 SIMD_INT simd_xor(const SIMD_INT va, const SIMD_INT vb)
 { return _mm_xor_si128(va, vb); }
 
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_and(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm_and_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_and(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm_and_pd(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_or(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm_or_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_or(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm_or_pd(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_xor(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm_xor_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_xor(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm_xor_pd(va, vb); }
+
 static SIMD_FUNC_INLINE
 SIMD_INT simd_sll_16(const SIMD_INT va, const int8_t shft)
 { return _mm_slli_epi16(va, shft); }
@@ -1316,6 +1341,90 @@ SIMD_INT simd_srl_128(const SIMD_INT va, const int8_t shft)
 }
 
 
+/**************************
+ *  Compare instructions  *
+ **************************/
+/*!
+ *  Comparisons set all bits of elements where the condition holds
+ *  and clear them otherwise, results are used as masks.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmpeq_32(const SIMD_INT va, const SIMD_INT vb)
+{ return _mm_cmpeq_epi32(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmpgt_i32(const SIMD_INT va, const SIMD_INT vb)
+{ return _mm_cmpgt_epi32(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_INT simd_cmplt_i32(const SIMD_INT va, const SIMD_INT vb)
+{ return _mm_cmplt_epi32(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpeq(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm_cmpeq_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpeq(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm_cmpeq_pd(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpneq(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm_cmpneq_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpneq(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm_cmpneq_pd(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmplt(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm_cmplt_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmplt(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm_cmplt_pd(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmple(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm_cmple_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmple(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm_cmple_pd(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpgt(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm_cmpgt_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpgt(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm_cmpgt_pd(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_cmpge(const SIMD_FLT va, const SIMD_FLT vb)
+{ return _mm_cmpge_ps(va, vb); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_cmpge(const SIMD_DBL va, const SIMD_DBL vb)
+{ return _mm_cmpge_pd(va, vb); }
+
+/*!
+ *  Select elements from second operand where mask is set,
+ *  otherwise select elements from first operand.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_blend(const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vmsk)
+{ return _mm_blendv_epi8(va, vb, vmsk); }
+
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_blend(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vmsk)
+{ return _mm_blendv_ps(va, vb, vmsk); }
+
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_blend(const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vmsk)
+{ return _mm_blendv_pd(va, vb, vmsk); }
+
+
 /*********************************
  *  Merge and pack instructions  *
  *********************************/
@@ -1941,7 +2050,7 @@ void simd_storeu(float * const sa, const SIMD_FLT va, const size_t n = SIMD_STRE
                     sa[i] = tmp[i];
             }
             break;
-        case 4: _mm_store_ps(sa, va); break;
+        case 4: _mm_storeu_ps(sa, va); break;
         default: break;
     }
 }
@@ -1967,547 +2076,452 @@ void simd_storeu(double * const sa, const SIMD_DBL va, const size_t n = SIMD_STR
 }
 
 
-
-///////////////////////////////////////////////////////////////////////////////
-
-/*
- *  Identify OpenMP support
- */
-#if defined(_OPENMP)
-#   include <omp.h>
-#endif
-
-#include <unistd.h>  // sysconf
-
+/*****************************
+ *  Interleave instructions  *
+ *****************************/
 /*!
- *  \brief Class to represent system configuration
+ *  Load records of 2/3/4 components (array of structures) and split them
+ *  into one vector per component (structure of arrays), e.g., xyz points
+ *  or RGB/RGBA pixels. simd_store_interleave* is the inverse.
+ *  Each call reads/writes 2/3/4 vectors of consecutive elements, pointers
+ *  need not be aligned.
  */
-class SYSCONF
-{
-    protected:
-        static bool omp_enabled;
-        static int32_t omp_threads;
-        static size_t L1l_elems_i32;
-        static size_t L1c_elems_i32;
-        static size_t L2l_elems_i32;
-        static size_t L2c_elems_i32;
-        static size_t page_sz;
-
-    public:
-        /************
-         *  OpenMP  *
-         ************/
-        /*!
-         *  If \c nthreads < 1, the environment variable OMP_NUM_THREADS is used
-         *  OpenMP only gets activated if set_omp() is invoked
-         *  \todo Fix logic of OpenMP setting
-         */
-        static void set_omp(const int32_t nthreads)
-        {
-        #if defined(_OPENMP)
-            if (nthreads == 0 || nthreads == 1) {
-                omp_threads = 1;
-                omp_enabled = false;
-            } else {
-                int32_t nt = atoi(getenv("OMP_NUM_THREADS"));
-                if (nt > 0)
-                    nt = (nthreads > 0) ? (nthreads) : (nt);
-                else
-                    nt = (nthreads > 0) ? (nthreads) : (1);
-                //omp_set_num_threads(nt);
-                omp_threads = nt;
-                omp_enabled = true;
-            }
-            //setenv("OMP_PROC_BIND","TRUE",1);
-            //setenv("GOMP_CPU_AFFINITY","0,2,4,6,1,3,5,7",1);
-            //setenv("GOMP_CPU_AFFINITY","0,1,2,3",1);
-            //setenv("OMP_PLACES","sockets{2}",1);
-            //setenv("OMP_PLACES","cores",1);
-            //setenv("OMP_PLACES","threads",1);
-        #else
-            (void)nthreads;
-            omp_threads = 1;
-            omp_enabled = false;
-        #endif
-        }
-
-        static bool get_omp()
-        { return omp_enabled; }
+//! Lane I of va, lane J of vb, lane K of vc and lane L of vd
+template <int I, int J, int K, int L>
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_gather_lanes(const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc, const SIMD_FLT vd)
+{
+    return _mm_shuffle_ps(_mm_shuffle_ps(va, vb, _MM_SHUFFLE(J, J, I, I)),
+                          _mm_shuffle_ps(vc, vd, _MM_SHUFFLE(L, L, K, K)), _MM_SHUFFLE(2, 0, 2, 0));
+}
 
-        static int32_t get_threads()
-        { return omp_threads; }
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb)
+{
+    const SIMD_FLT v0 = _mm_loadu_ps(sa);
+    const SIMD_FLT v1 = _mm_loadu_ps(sa + 4);
+    *va = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0));
+    *vb = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1));
+}
 
-        static void omp_settings()
-        {
-        #if defined(_OPENMP)
-            if (get_omp()) {
-                cout << "OpenMP is enabled" << endl;
-                cout << "OpenMP max threads = " << get_threads() << endl;
-            }
-            else {
-                cout << "OpenMP is disabled" << endl;
-            }
-        #else
-            omp_enabled = false;
-            cout << "OpenMP is disabled" << endl;
-        #endif
-        }
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc)
+{
+    const SIMD_FLT v0 = _mm_loadu_ps(sa);
+    const SIMD_FLT v1 = _mm_loadu_ps(sa + 4);
+    const SIMD_FLT v2 = _mm_loadu_ps(sa + 8);
+    *va = simd_gather_lanes<0, 3, 2, 1>(v0, v0, v1, v2);
+    *vb = simd_gather_lanes<1, 0, 3, 2>(v0, v1, v1, v2);
+    *vc = simd_gather_lanes<2, 1, 0, 3>(v0, v1, v2, v2);
+}
 
-        /*!
-         *  Initialize system configurations
-         */
-        static int32_t initSysconf()
-        {
-            omp_enabled = false;
-            omp_threads = 1;
-            L1l_elems_i32 = (size_t)getL1LineSz() / sizeof(int32_t);
-            L1c_elems_i32 = (size_t)getL1Sz() / sizeof(int32_t);
-            L2l_elems_i32 = (size_t)getL2LineSz() / sizeof(int32_t);
-            L2c_elems_i32 = (size_t)getL2Sz() / sizeof(int32_t);
-            page_sz = (size_t)getPageSz();
-
-            return 0;
-        }
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const float * const sa, SIMD_FLT * const va, SIMD_FLT * const vb, SIMD_FLT * const vc, SIMD_FLT * const vd)
+{
+    SIMD_FLT v0 = _mm_loadu_ps(sa);
+    SIMD_FLT v1 = _mm_loadu_ps(sa + 4);
+    SIMD_FLT v2 = _mm_loadu_ps(sa + 8);
+    SIMD_FLT v3 = _mm_loadu_ps(sa + 12);
+    _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+    *va = v0;
+    *vb = v1;
+    *vc = v2;
+    *vd = v3;
+}
 
-        /*!
-         *  Print some system configurations
-         */
-        static void printSysconf()
-        {
-            cout << "Number of processors online = " << getNumProcOnline() << endl;
-            cout << "Page size = " << getPageSz() << " B" << endl;
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(float * const sa, const SIMD_FLT va, const SIMD_FLT vb)
+{
+    _mm_storeu_ps(sa, _mm_unpacklo_ps(va, vb));
+    _mm_storeu_ps(sa + 4, _mm_unpackhi_ps(va, vb));
+}
 
-            cout << "L1 data cache size = " << getL1Sz() << " B" << endl;
-            cout << "L1 data cache line size = " << getL1LineSz() << " B" << endl;
-            cout << "L1 data cache associativity = " << getL1Assoc() << endl;
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc)
+{
+    _mm_storeu_ps(sa, simd_gather_lanes<0, 0, 0, 1>(va, vb, vc, va));
+    _mm_storeu_ps(sa + 4, simd_gather_lanes<1, 1, 2, 2>(vb, vc, va, vb));
+    _mm_storeu_ps(sa + 8, simd_gather_lanes<2, 3, 3, 3>(vc, va, vb, vc));
+}
 
-            cout << "L2 cache size = " << getL2Sz() << " B" << endl;
-            cout << "L2 cache line size = " << getL2LineSz() << " B" << endl;
-            cout << "L2 cache associativity = " << getL2Assoc() << endl;
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(float * const sa, const SIMD_FLT va, const SIMD_FLT vb, const SIMD_FLT vc, const SIMD_FLT vd)
+{
+    SIMD_FLT v0 = va, v1 = vb, v2 = vc, v3 = vd;
+    _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+    _mm_storeu_ps(sa, v0);
+    _mm_storeu_ps(sa + 4, v1);
+    _mm_storeu_ps(sa + 8, v2);
+    _mm_storeu_ps(sa + 12, v3);
+}
 
-            cout << "L3 cache size = " << getL3Sz() << " B" << endl;
-            cout << "L3 cache line size = " << getL3LineSz() << " B" << endl;
-            cout << "L3 cache associativity = " << getL3Assoc() << endl;
-        }
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb)
+{
+    const SIMD_DBL v0 = _mm_loadu_pd(sa);
+    const SIMD_DBL v1 = _mm_loadu_pd(sa + 2);
+    *va = _mm_unpacklo_pd(v0, v1);
+    *vb = _mm_unpackhi_pd(v0, v1);
+}
 
-        /*!
-         *  Get the number of processors currently online (available)
-         */
-        static long int getNumProcOnline()
-        { return sysconf(_SC_NPROCESSORS_ONLN); }
-        //{ return sysconf(_SC_NPROCESSORS_CONF); }
-
-        /*!
-         *  Get the size of page in bytes
-         */
-        static long int getPageSz()
-        { return sysconf(_SC_PAGESIZE); }
-        //{ return sysconf(_SC_PAGE_SIZE); }
-
-        /*!
-         *  Get the size in bytes of L1 data cache
-         */
-        static long int getL1Sz()
-        { return sysconf(_SC_LEVEL1_DCACHE_SIZE); }
-
-        /*!
-         *  Get the line size in bytes of L1 data cache
-         */
-        static long int getL1LineSz()
-        { return sysconf(_SC_LEVEL1_DCACHE_LINESIZE); }
-
-        /*!
-         *  Get the associativity of L1 data cache
-         */
-        static long int getL1Assoc()
-        { return sysconf(_SC_LEVEL1_DCACHE_ASSOC); }
-
-        /*!
-         *  Get the size in bytes of L2 cache
-         */
-        static long int getL2Sz()
-        { return sysconf(_SC_LEVEL2_CACHE_SIZE); }
-
-        /*!
-         *  Get the line size in bytes of L2 cache
-         */
-        static long int getL2LineSz()
-        { return sysconf(_SC_LEVEL2_CACHE_LINESIZE); }
-
-        /*!
-         *  Get the associativity of L2 cache
-         */
-        static long int getL2Assoc()
-        { return sysconf(_SC_LEVEL2_CACHE_ASSOC); }
-
-        /*!
-         *  Get the size in bytes of L3 cache
-         */
-        static long int getL3Sz()
-        { return sysconf(_SC_LEVEL3_CACHE_SIZE); }
-
-        /*!
-         *  Get the line size in bytes of L3 cache
-         */
-        static long int getL3LineSz()
-        { return sysconf(_SC_LEVEL3_CACHE_LINESIZE); }
-
-        /*!
-         *  Get the associativity of L3 cache
-         */
-        static long int getL3Assoc()
-        { return sysconf(_SC_LEVEL3_CACHE_ASSOC); }
-};
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc)
+{
+    const SIMD_DBL v0 = _mm_loadu_pd(sa);
+    const SIMD_DBL v1 = _mm_loadu_pd(sa + 2);
+    const SIMD_DBL v2 = _mm_loadu_pd(sa + 4);
+    *va = _mm_shuffle_pd(v0, v1, 0x2);
+    *vb = _mm_shuffle_pd(v0, v2, 0x1);
+    *vc = _mm_shuffle_pd(v1, v2, 0x2);
+}
 
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const double * const sa, SIMD_DBL * const va, SIMD_DBL * const vb, SIMD_DBL * const vc, SIMD_DBL * const vd)
+{
+    const SIMD_DBL v0 = _mm_loadu_pd(sa);
+    const SIMD_DBL v1 = _mm_loadu_pd(sa + 2);
+    const SIMD_DBL v2 = _mm_loadu_pd(sa + 4);
+    const SIMD_DBL v3 = _mm_loadu_pd(sa + 6);
+    *va = _mm_unpacklo_pd(v0, v2);
+    *vb = _mm_unpackhi_pd(v0, v2);
+    *vc = _mm_unpacklo_pd(v1, v3);
+    *vd = _mm_unpackhi_pd(v1, v3);
+}
 
-/*!
- *  \class base_v
- *  \brief Abstract class to represent a vector object
- */
-class base_v
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(double * const sa, const SIMD_DBL va, const SIMD_DBL vb)
 {
-    public:
-        virtual ~base_v() {};  //!< virtual destructor allows polymorphism to invoke derived destructors
-        static size_t get_nstreams() { return 0; };
-        static size_t get_nbytes() { return 0; };
-};
+    _mm_storeu_pd(sa, _mm_unpacklo_pd(va, vb));
+    _mm_storeu_pd(sa + 2, _mm_unpackhi_pd(va, vb));
+}
 
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc)
+{
+    _mm_storeu_pd(sa, _mm_shuffle_pd(va, vb, 0x0));
+    _mm_storeu_pd(sa + 2, _mm_shuffle_pd(vc, va, 0x2));
+    _mm_storeu_pd(sa + 4, _mm_shuffle_pd(vb, vc, 0x3));
+}
 
-#define VCLASS int32_v
-#define VTYPE SIMD_INT
-#define STYPE int32_t
-/*!
- *  \class int32_v
- *  \brief Class to represent a 32-bit integer vector
- */
-class VCLASS: public base_v
-{
-    private:
-        VTYPE v;
-        static const size_t nstreams = SIMD_STREAMS_32;
-        static const size_t nbytes = SIMD_WIDTH_BYTES;
-
-    public:
-
-        /******************
-         *  Constructors  *
-         ******************/
-        //! Constructor with no parameters
-        VCLASS()
-        { simd_set_zero(&v); }
-
-        //! (Low-level) Copy constructor
-        VCLASS(const VTYPE va): v(va)
-        { }
-
-        //! Copy constructor
-        VCLASS(const VCLASS &va): v(va.v)
-        { }
-
-        /*!
-         *  Constructor with scalar pointer parameter
-         *  Does not assumes \c sa alignment is conformant
-         */
-        VCLASS(const STYPE * const sa, const size_t n = nstreams)
-        { loadu(sa, n); }
-
-        ~VCLASS()
-        { }
-
-        /*************
-         *  Get/set  *
-         *************/
-        static SIMD_FUNC_INLINE size_t get_nstreams()
-        { return nstreams; }
-
-        static SIMD_FUNC_INLINE size_t get_nbytes()
-        { return nbytes; }
-
-        SIMD_FUNC_INLINE void set_vector(const VTYPE va)
-        { v = va; }
-
-        SIMD_FUNC_INLINE VTYPE get_vector() const
-        { return v; }
-
-        /****************
-         *  Operations  *
-         ****************/
-        SIMD_FUNC_INLINE VCLASS operator+(const VCLASS& vb) const
-        {
-            VCLASS vc(simd_add_32(v, vb.v));
-            return vc;
-        }
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(double * const sa, const SIMD_DBL va, const SIMD_DBL vb, const SIMD_DBL vc, const SIMD_DBL vd)
+{
+    _mm_storeu_pd(sa, _mm_unpacklo_pd(va, vb));
+    _mm_storeu_pd(sa + 2, _mm_unpacklo_pd(vc, vd));
+    _mm_storeu_pd(sa + 4, _mm_unpackhi_pd(va, vb));
+    _mm_storeu_pd(sa + 6, _mm_unpackhi_pd(vc, vd));
+}
 
-        /****************
-         *  Load/Store  *
-         ****************/
-        SIMD_FUNC_INLINE void load(const STYPE * const sa, const size_t n = nstreams, const bool strmHint = false)
-        { v = simd_load((const STYPE *)sa, n, strmHint); }
-
-        SIMD_FUNC_INLINE void store(STYPE * const sa, const size_t n = nstreams, const bool strmHint = false) const
-        { simd_store(sa, v, n, strmHint); }
-
-        SIMD_FUNC_INLINE void loadu(const STYPE * const sa, const size_t n = nstreams)
-        { v = simd_loadu((const STYPE *)sa, n); }
-
-        SIMD_FUNC_INLINE void storeu(STYPE * const sa, const size_t n = nstreams) const
-        { simd_storeu(sa, v, n); }
-};
-
-//! Kernel is memory-bound, use 2 threads to prevent bus contention
-static SIMD_FUNC_INLINE STYPE * add(const STYPE * const sa, const STYPE * const sb, const size_t n = SIMD_STREAMS_32, const bool run_par = true)
-{
-    STYPE *sc = NULL;
-    if (!posix_memalign((void **)&sc, SIMD_WIDTH_BYTES, n * sizeof(STYPE))) {
-        const size_t rem = n & (SIMD_STREAMS_32 - 1);
-        const size_t nn = n - rem;
-//        const size_t salign = (((size_t)sa & (SIMD_WIDTH_BYTES - 1)) | ((size_t)sb & (SIMD_WIDTH_BYTES - 1)));
-//      #pragma omp parallel for default(shared) schedule(static) num_threads(2) if ((SYSCONF::get_omp() & run_par) == true)
-        #pragma omp parallel for default(shared) schedule(static) if (run_par == true)
-        for (size_t i = 0; i < nn; i+=SIMD_STREAMS_32) {
-            VTYPE va, vb;
-//            if (salign == 0) {
-//                va = simd_load(sa + i, SIMD_STREAMS_32, true);
-//                vb = simd_load(sb + i, SIMD_STREAMS_32, true);
-//            } else {
-                va = simd_loadu(sa + i);
-                vb = simd_loadu(sb + i);
-//            }
-            vb = simd_add_32(va, vb);
-//            simd_store(sc + i, vb, SIMD_STREAMS_32, true);
-            simd_storeu(sc + i, vb);
-        }
-        for (size_t i = nn; i < n; ++i) {
-            sc[i] = sa[i] + sb[i];
-        }
-    }
-    (void)run_par;  // used in OpenMP pragma but compiler identifies it as not used
-    return sc;
+//! 32-bit integers use the single-precision shuffles
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    SIMD_FLT fa, fb;
+    simd_load_deinterleave2((const float *)sa, &fa, &fb);
+    *va = _mm_castps_si128(fa);
+    *vb = _mm_castps_si128(fb);
 }
-#undef STYPE
-#undef VTYPE
-#undef VCLASS
 
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    SIMD_FLT fa, fb, fc;
+    simd_load_deinterleave3((const float *)sa, &fa, &fb, &fc);
+    *va = _mm_castps_si128(fa);
+    *vb = _mm_castps_si128(fb);
+    *vc = _mm_castps_si128(fc);
+}
 
-#define VCLASS flt32_v
-#define VTYPE SIMD_FLT
-#define STYPE float
-/*!
- *  \class flt32_v
- *  \brief Class to represent a single-precision floating-point vector
- */
-class VCLASS: public base_v
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const int32_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
 {
-    private:
-        VTYPE v;
-        static const size_t nstreams = SIMD_STREAMS_32;
-        static const size_t nbytes = SIMD_WIDTH_BYTES;
+    SIMD_FLT fa, fb, fc, fd;
+    simd_load_deinterleave4((const float *)sa, &fa, &fb, &fc, &fd);
+    *va = _mm_castps_si128(fa);
+    *vb = _mm_castps_si128(fb);
+    *vc = _mm_castps_si128(fc);
+    *vd = _mm_castps_si128(fd);
+}
 
-    public:
-        /******************
-         *  Constructors  *
-         ******************/
-        VCLASS()
-        { simd_set_zero(&v); }
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{ simd_store_interleave2((float *)sa, _mm_castsi128_ps(va), _mm_castsi128_ps(vb)); }
 
-        VCLASS(const VTYPE va): v(va)
-        { }
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{ simd_store_interleave3((float *)sa, _mm_castsi128_ps(va), _mm_castsi128_ps(vb), _mm_castsi128_ps(vc)); }
 
-        VCLASS(const VCLASS &va): v(va.v)
-        { }
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(int32_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{ simd_store_interleave4((float *)sa, _mm_castsi128_ps(va), _mm_castsi128_ps(vb), _mm_castsi128_ps(vc), _mm_castsi128_ps(vd)); }
 
-        VCLASS(const STYPE * const sa, const size_t n = nstreams)
-        { loadu(sa, n); }
+//! 8-bit records (e.g., pixels) use byte shuffles
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave2(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb)
+{
+    const SIMD_INT vmsk = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    const SIMD_INT v0 = _mm_shuffle_epi8(_mm_loadu_si128((SIMD_INT *)sa), vmsk);
+    const SIMD_INT v1 = _mm_shuffle_epi8(_mm_loadu_si128((SIMD_INT *)(sa + 16)), vmsk);
+    *va = _mm_unpacklo_epi64(v0, v1);
+    *vb = _mm_unpackhi_epi64(v0, v1);
+}
 
-        ~VCLASS()
-        { }
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave3(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc)
+{
+    const SIMD_INT v0 = _mm_loadu_si128((SIMD_INT *)sa);
+    const SIMD_INT v1 = _mm_loadu_si128((SIMD_INT *)(sa + 16));
+    const SIMD_INT v2 = _mm_loadu_si128((SIMD_INT *)(sa + 32));
+    *va = _mm_or_si128(_mm_or_si128(
+              _mm_shuffle_epi8(v0, _mm_setr_epi8(0, 3, 6, 9, 12, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+              _mm_shuffle_epi8(v1, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, 2, 5, 8, 11, 14, -128, -128, -128, -128, -128))),
+              _mm_shuffle_epi8(v2, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 1, 4, 7, 10, 13)));
+    *vb = _mm_or_si128(_mm_or_si128(
+              _mm_shuffle_epi8(v0, _mm_setr_epi8(1, 4, 7, 10, 13, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+              _mm_shuffle_epi8(v1, _mm_setr_epi8(-128, -128, -128, -128, -128, 0, 3, 6, 9, 12, 15, -128, -128, -128, -128, -128))),
+              _mm_shuffle_epi8(v2, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 2, 5, 8, 11, 14)));
+    *vc = _mm_or_si128(_mm_or_si128(
+              _mm_shuffle_epi8(v0, _mm_setr_epi8(2, 5, 8, 11, 14, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+              _mm_shuffle_epi8(v1, _mm_setr_epi8(-128, -128, -128, -128, -128, 1, 4, 7, 10, 13, -128, -128, -128, -128, -128, -128))),
+              _mm_shuffle_epi8(v2, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 0, 3, 6, 9, 12, 15)));
+}
 
-        /*************
-         *  Get/set  *
-         *************/
-        static SIMD_FUNC_INLINE size_t get_nstreams()
-        { return nstreams; }
+static SIMD_FUNC_INLINE
+void simd_load_deinterleave4(const uint8_t * const sa, SIMD_INT * const va, SIMD_INT * const vb, SIMD_INT * const vc, SIMD_INT * const vd)
+{
+    // Group each component in a 32-bit lane, then transpose lanes
+    const SIMD_INT vmsk = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const SIMD_INT v0 = _mm_shuffle_epi8(_mm_loadu_si128((SIMD_INT *)sa), vmsk);
+    const SIMD_INT v1 = _mm_shuffle_epi8(_mm_loadu_si128((SIMD_INT *)(sa + 16)), vmsk);
+    const SIMD_INT v2 = _mm_shuffle_epi8(_mm_loadu_si128((SIMD_INT *)(sa + 32)), vmsk);
+    const SIMD_INT v3 = _mm_shuffle_epi8(_mm_loadu_si128((SIMD_INT *)(sa + 48)), vmsk);
+    const SIMD_INT t0 = _mm_unpacklo_epi32(v0, v1);
+    const SIMD_INT t1 = _mm_unpacklo_epi32(v2, v3);
+    const SIMD_INT t2 = _mm_unpackhi_epi32(v0, v1);
+    const SIMD_INT t3 = _mm_unpackhi_epi32(v2, v3);
+    *va = _mm_unpacklo_epi64(t0, t1);
+    *vb = _mm_unpackhi_epi64(t0, t1);
+    *vc = _mm_unpacklo_epi64(t2, t3);
+    *vd = _mm_unpackhi_epi64(t2, t3);
+}
 
-        static SIMD_FUNC_INLINE size_t get_nbytes()
-        { return nbytes; }
+static SIMD_FUNC_INLINE
+void simd_store_interleave2(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb)
+{
+    _mm_storeu_si128((SIMD_INT *)sa, _mm_unpacklo_epi8(va, vb));
+    _mm_storeu_si128((SIMD_INT *)(sa + 16), _mm_unpackhi_epi8(va, vb));
+}
 
-        SIMD_FUNC_INLINE void set_vector(const VTYPE va)
-        { v = va; }
+static SIMD_FUNC_INLINE
+void simd_store_interleave3(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc)
+{
+    _mm_storeu_si128((SIMD_INT *)sa, _mm_or_si128(_mm_or_si128(
+        _mm_shuffle_epi8(va, _mm_setr_epi8(0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128, -128, 5)),
+        _mm_shuffle_epi8(vb, _mm_setr_epi8(-128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128, -128))),
+        _mm_shuffle_epi8(vc, _mm_setr_epi8(-128, -128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128))));
+    _mm_storeu_si128((SIMD_INT *)(sa + 16), _mm_or_si128(_mm_or_si128(
+        _mm_shuffle_epi8(va, _mm_setr_epi8(-128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128, 10, -128)),
+        _mm_shuffle_epi8(vb, _mm_setr_epi8(5, -128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128, 10))),
+        _mm_shuffle_epi8(vc, _mm_setr_epi8(-128, 5, -128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128))));
+    _mm_storeu_si128((SIMD_INT *)(sa + 32), _mm_or_si128(_mm_or_si128(
+        _mm_shuffle_epi8(va, _mm_setr_epi8(-128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15, -128, -128)),
+        _mm_shuffle_epi8(vb, _mm_setr_epi8(-128, -128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15, -128))),
+        _mm_shuffle_epi8(vc, _mm_setr_epi8(10, -128, -128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15))));
+}
 
-        SIMD_FUNC_INLINE VTYPE get_vector() const
-        { return v; }
+static SIMD_FUNC_INLINE
+void simd_store_interleave4(uint8_t * const sa, const SIMD_INT va, const SIMD_INT vb, const SIMD_INT vc, const SIMD_INT vd)
+{
+    const SIMD_INT vab_lo = _mm_unpacklo_epi8(va, vb);
+    const SIMD_INT vab_hi = _mm_unpackhi_epi8(va, vb);
+    const SIMD_INT vcd_lo = _mm_unpacklo_epi8(vc, vd);
+    const SIMD_INT vcd_hi = _mm_unpackhi_epi8(vc, vd);
+    _mm_storeu_si128((SIMD_INT *)sa, _mm_unpacklo_epi16(vab_lo, vcd_lo));
+    _mm_storeu_si128((SIMD_INT *)(sa + 16), _mm_unpackhi_epi16(vab_lo, vcd_lo));
+    _mm_storeu_si128((SIMD_INT *)(sa + 32), _mm_unpacklo_epi16(vab_hi, vcd_hi));
+    _mm_storeu_si128((SIMD_INT *)(sa + 48), _mm_unpackhi_epi16(vab_hi, vcd_hi));
+}
 
-        /****************
-         *  Operations  *
-         ****************/
-        SIMD_FUNC_INLINE VCLASS operator+(const VCLASS& vb) const
-        {
-            VCLASS vc(simd_add(v, vb.v));
-            return vc;
-        }
 
-        /****************
-         *  Load/Store  *
-         ****************/
-        SIMD_FUNC_INLINE void load(const STYPE * const sa, const size_t n = nstreams, const bool strmHint = false)
-        { v = simd_load((const STYPE *)sa, n, strmHint); }
-
-        SIMD_FUNC_INLINE void store(STYPE * const sa, const size_t n = nstreams, const bool strmHint = false) const
-        { simd_store(sa, v, n, strmHint); }
-
-        SIMD_FUNC_INLINE void loadu(const STYPE * const sa, const size_t n = nstreams)
-        { v = simd_loadu((const STYPE *)sa, n); }
-
-        SIMD_FUNC_INLINE void storeu(STYPE * const sa, const size_t n = nstreams) const
-        { simd_storeu(sa, v, n); }
-};
-
-static SIMD_FUNC_INLINE STYPE * add(const STYPE * const sa, const STYPE * const sb, const size_t n = SIMD_STREAMS_32, const bool run_par = true)
-{
-    STYPE *sc = NULL;
-    if (!posix_memalign((void **)&sc, SIMD_WIDTH_BYTES, n * sizeof(STYPE))) {
-        const size_t rem = n & (SIMD_STREAMS_32 - 1);
-        const size_t nn = n - rem;
-        const size_t salign = (((size_t)sa & (SIMD_WIDTH_BYTES - 1)) | ((size_t)sb & (SIMD_WIDTH_BYTES - 1)));
-        #pragma omp parallel for default(shared) schedule(static) num_threads(SYSCONF::get_threads()) if ((SYSCONF::get_omp() & run_par) == true)
-        for (size_t i = 0; i < nn; i+=SIMD_STREAMS_32) {
-            VTYPE va, vb;
-            if (salign == 0) {
-                //va = simd_load(sa + i, SIMD_STREAMS_32, true);
-                //vb = simd_load(sb + i, SIMD_STREAMS_32, true);
-                va = simd_load(sa + i);
-                vb = simd_load(sb + i);
-            } else {
-                va = simd_loadu(sa + i);
-                vb = simd_loadu(sb + i);
-            }
-            vb = simd_add(va, vb);
-            simd_store(sc + i, vb, SIMD_STREAMS_32, true);
-        }
-        for (size_t i = nn; i < n; ++i) {
-            sc[i] = sa[i] + sb[i];
+/****************************
+ *  Transpose instructions  *
+ ****************************/
+/*!
+ *  Transpose a square tile, sb[j * ldb + i] = sa[i * lda + j].
+ *  Rows of \c sa are loaded into registers, transposed with shuffles and
+ *  stored as rows of \c sb. Leading dimensions are in elements, rows need
+ *  not be aligned and tiles must not overlap.
+ */
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    __m128 r0 = _mm_loadu_ps(sa);
+    __m128 r1 = _mm_loadu_ps(sa + lda);
+    __m128 r2 = _mm_loadu_ps(sa + 2 * lda);
+    __m128 r3 = _mm_loadu_ps(sa + 3 * lda);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(sb, r0);
+    _mm_storeu_ps(sb + ldb, r1);
+    _mm_storeu_ps(sb + 2 * ldb, r2);
+    _mm_storeu_ps(sb + 3 * ldb, r3);
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f32(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+{
+    simd_transpose4x4_f32(sb, ldb, sa, lda);
+    simd_transpose4x4_f32(sb + 4, ldb, sa + 4 * lda, lda);
+    simd_transpose4x4_f32(sb + 4 * ldb, ldb, sa + 4, lda);
+    simd_transpose4x4_f32(sb + 4 * ldb + 4, ldb, sa + 4 * lda + 4, lda);
+}
+
+static SIMD_FUNC_INLINE
+void simd_transpose4x4_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    // 2x2 blocks
+    for (int32_t i = 0; i < 4; i+=2)
+        for (int32_t j = 0; j < 4; j+=2) {
+            const __m128d r0 = _mm_loadu_pd(sa + i * lda + j);
+            const __m128d r1 = _mm_loadu_pd(sa + (i + 1) * lda + j);
+            _mm_storeu_pd(sb + j * ldb + i, _mm_unpacklo_pd(r0, r1));
+            _mm_storeu_pd(sb + (j + 1) * ldb + i, _mm_unpackhi_pd(r0, r1));
         }
-    }
-    (void)run_par;  // used in OpenMP pragma but compiler identifies it as not used
-    return sc;
 }
-#undef STYPE
-#undef VTYPE
-#undef VCLASS
+
+static SIMD_FUNC_INLINE
+void simd_transpose8x8_f64(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+{
+    simd_transpose4x4_f64(sb, ldb, sa, lda);
+    simd_transpose4x4_f64(sb + 4, ldb, sa + 4 * lda, lda);
+    simd_transpose4x4_f64(sb + 4 * ldb, ldb, sa + 4, lda);
+    simd_transpose4x4_f64(sb + 4 * ldb + 4, ldb, sa + 4 * lda + 4, lda);
+}
 
 
-#define VCLASS flt64_v
-#define VTYPE SIMD_DBL
-#define STYPE double
+/*************************
+ *  Gather instructions  *
+ *************************/
 /*!
- *  \class flt64_v
- *  \brief Class to represent a double-precision floating-point vector
+ *  Gather, lane i is loaded from sa[idx[i]], one 32-bit index per lane.
+ *  Indices need not be sorted or distinct and are not range-checked.
  */
-class VCLASS: public base_v
-{
-    private:
-        VTYPE v;
-        static const size_t nstreams = SIMD_STREAMS_64;
-        static const size_t nbytes = SIMD_WIDTH_BYTES;
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_gather(const float * const sa, const int32_t * const idx)
+{ return _mm_set_ps(sa[idx[3]], sa[idx[2]], sa[idx[1]], sa[idx[0]]); }
 
-    public:
-        /******************
-         *  Constructors  *
-         ******************/
-        VCLASS()
-        { simd_set_zero(&v); }
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_gather(const double * const sa, const int32_t * const idx)
+{ return _mm_set_pd(sa[idx[1]], sa[idx[0]]); }
 
-        VCLASS(const VTYPE va): v(va)
-        { }
 
-        VCLASS(const VCLASS &va): v(va.v)
-        { }
+/************************
+ *  Align instructions  *
+ ************************/
+/*!
+ *  Lanes N .. N + nlanes - 1 of the concatenation of vb (low lanes) and va
+ *  (high lanes), 0 <= N <= nlanes. Vectors at consecutive aligned addresses
+ *  give the vector at an unaligned offset of N elements.
+ */
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_alignr(const SIMD_FLT va, const SIMD_FLT vb)
+{
+    if (N <= 0)
+        return vb;
+    if (N >= 4)
+        return va;
+    return _mm_castsi128_ps(_mm_alignr_epi8(_mm_castps_si128(va), _mm_castps_si128(vb), (4 * N) & 15));
+}
+
+template <int N>
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_alignr(const SIMD_DBL va, const SIMD_DBL vb)
+{
+    if (N <= 0)
+        return vb;
+    if (N >= 2)
+        return va;
+    return _mm_shuffle_pd(vb, va, 1);
+}
 
-        VCLASS(const STYPE * const sa, const size_t n = nstreams)
-        { loadu(sa, n); }
 
-        ~VCLASS()
-        { }
+/***********************
+ *  Scan instructions  *
+ ***********************/
+/*!
+ *  Inclusive prefix sums of the lanes of va plus the carry *vc (all lanes
+ *  equal), by log2(nlanes) steps of lane shifts and adds. The sum of va is
+ *  broadcast and added to *vc, the carry of the next vector, so that one
+ *  add per vector is on the loop-carried path.
+ */
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_32(const SIMD_INT va, SIMD_INT * const vc)
+{
+    SIMD_INT vs = _mm_add_epi32(va, _mm_slli_si128(va, 4));
+    vs = _mm_add_epi32(vs, _mm_slli_si128(vs, 8));
+    const SIMD_INT vp = *vc;
+    *vc = _mm_add_epi32(vp, _mm_shuffle_epi32(vs, 0xFF));
+    return _mm_add_epi32(vs, vp);
+}
 
-        /*************
-         *  Get/set  *
-         *************/
-        static SIMD_FUNC_INLINE size_t get_nstreams()
-        { return nstreams; }
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_64(const SIMD_INT va, SIMD_INT * const vc)
+{
+    const SIMD_INT vs = _mm_add_epi64(va, _mm_slli_si128(va, 8));
+    const SIMD_INT vp = *vc;
+    *vc = _mm_add_epi64(vp, _mm_shuffle_epi32(vs, 0xEE));
+    return _mm_add_epi64(vs, vp);
+}
 
-        static SIMD_FUNC_INLINE size_t get_nbytes()
-        { return nbytes; }
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    SIMD_FLT vs = _mm_add_ps(va, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(va), 4)));
+    vs = _mm_add_ps(vs, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(vs), 8)));
+    const SIMD_FLT vp = *vc;
+    *vc = _mm_add_ps(vp, _mm_shuffle_ps(vs, vs, 0xFF));
+    return _mm_add_ps(vs, vp);
+}
 
-        SIMD_FUNC_INLINE void set_vector(const VTYPE va)
-        { v = va; }
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    const SIMD_DBL vs = _mm_add_pd(va, _mm_castsi128_pd(_mm_slli_si128(_mm_castpd_si128(va), 8)));
+    const SIMD_DBL vp = *vc;
+    *vc = _mm_add_pd(vp, _mm_unpackhi_pd(vs, vs));
+    return _mm_add_pd(vs, vp);
+}
 
-        SIMD_FUNC_INLINE VTYPE get_vector() const
-        { return v; }
+/*!
+ *  Exclusive prefix sums, lane i is the carry plus lanes 0 .. i-1 of va,
+ *  *vc is updated as by the inclusive sums
+ */
+//! Integer sums are exact, the exclusive sums are the inclusive sums less va
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_32(const SIMD_INT va, SIMD_INT * const vc)
+{ return _mm_sub_epi32(simd_scan_32(va, vc), va); }
 
-        /****************
-         *  Operations  *
-         ****************/
-        SIMD_FUNC_INLINE VCLASS operator+(const VCLASS& vb) const
-        {
-            VCLASS vc(simd_add(v, vb.v));
-            return vc;
-        }
+static SIMD_FUNC_INLINE
+SIMD_INT simd_scan_excl_64(const SIMD_INT va, SIMD_INT * const vc)
+{ return _mm_sub_epi64(simd_scan_64(va, vc), va); }
 
-        /****************
-         *  Load/Store  *
-         ****************/
-        SIMD_FUNC_INLINE void load(const STYPE * const sa, const size_t n = nstreams, const bool strmHint = false)
-        { v = simd_load((const STYPE *)sa, n, strmHint); }
-
-        SIMD_FUNC_INLINE void store(STYPE * const sa, const size_t n = nstreams, const bool strmHint = false) const
-        { simd_store(sa, v, n, strmHint); }
-
-        SIMD_FUNC_INLINE void loadu(const STYPE * const sa, const size_t n = nstreams)
-        { v = simd_loadu((const STYPE *)sa, n); }
-
-        SIMD_FUNC_INLINE void storeu(STYPE * const sa, const size_t n = nstreams) const
-        { simd_storeu(sa, v, n); }
-};
-
-static SIMD_FUNC_INLINE STYPE * add(const STYPE * const sa, const STYPE * const sb, const size_t n = SIMD_STREAMS_64, const bool run_par = true)
-{
-    STYPE *sc = NULL;
-    if (!posix_memalign((void **)&sc, SIMD_WIDTH_BYTES, n * sizeof(STYPE))) {
-        const size_t rem = n & (SIMD_STREAMS_64 - 1);
-        const size_t nn = n - rem;
-        const size_t salign = (((size_t)sa & (SIMD_WIDTH_BYTES - 1)) | ((size_t)sb & (SIMD_WIDTH_BYTES - 1)));
-        #pragma omp parallel for default(shared) schedule(static) num_threads(SYSCONF::get_threads()) if ((SYSCONF::get_omp() & run_par) == true)
-        for (size_t i = 0; i < nn; i+=SIMD_STREAMS_64) {
-            VTYPE va, vb;
-            if (salign == 0) {
-                //va = simd_load(sa + i, SIMD_STREAMS_64, true);
-                //vb = simd_load(sb + i, SIMD_STREAMS_64, true);
-                va = simd_load(sa + i);
-                vb = simd_load(sb + i);
-            } else {
-                va = simd_loadu(sa + i);
-                vb = simd_loadu(sb + i);
-            }
-            vb = simd_add(va, vb);
-            simd_store(sc + i, vb, SIMD_STREAMS_64, true);
-        }
-        for (size_t i = nn; i < n; ++i) {
-            sc[i] = sa[i] + sb[i];
-        }
-    }
-    (void)run_par;  // used in OpenMP pragma but compiler identifies it as not used
-    return sc;
+static SIMD_FUNC_INLINE
+SIMD_FLT simd_scan_excl(const SIMD_FLT va, SIMD_FLT * const vc)
+{
+    const SIMD_FLT vp = *vc;
+    return simd_alignr<3>(simd_scan(va, vc), vp);
 }
-#undef STYPE
-#undef VTYPE
-#undef VCLASS
-///////////////////////////////////////////////////////////////////////////////
-
 
-}  // SSE4_2 namespace
+static SIMD_FUNC_INLINE
+SIMD_DBL simd_scan_excl(const SIMD_DBL va, SIMD_DBL * const vc)
+{
+    const SIMD_DBL vp = *vc;
+    return simd_alignr<1>(simd_scan(va, vc), vp);
+}
 
 
-using namespace SSE4_2;
+}  // namespace sse42
+}  // namespace gvl
 
 
 #endif  // _SSE4_2_H
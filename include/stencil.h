@@ -0,0 +1,495 @@
+/*!
+ *  \brief Star stencils on 1D/2D/3D grids, out = f(neighbours of in)
+ *  A stencil is a functor (see stencil_op) called with the neighbours of
+ *  a vector of points at offsets -R..R along each axis, or weights given
+ *  as coefficients (stencil_coeffs). Rows are swept with aligned loads:
+ *  - x neighbours are built from a window of aligned vectors rotated in
+ *    registers along the row and combined with simd_alignr(), so each
+ *    input vector is loaded once per row,
+ *  - y and z neighbours are aligned loads of the rows and planes around,
+ *  - rows are tiled so that 2R + 2 row segments fit in half of L2 and, in
+ *    3D, so do 2R + 2 planes of a tile,
+ *  - stencil_run() optionally blocks time steps: slabs of planes along the
+ *    outermost axis are advanced several steps while they are in L2, each
+ *    step lagging R planes behind the previous one (time skewing).
+ *  Cache sizes are read from SYSCONF (see sysconf.h).
+ *  \note Points within R of the grid edges are boundary values, they are
+ *        never written and must be set in both buffers
+ */
+#ifndef _STENCIL_H
+#define _STENCIL_H
+
+
+#include <stdint.h>
+#include <stddef.h>   // size_t
+#include "simd.h"
+#include "sysconf.h"
+#include "dispatch.h"  // lane_traits, steal_parts_for
+#include "workpool.h"
+
+
+namespace gvl {
+
+
+/*!
+ *  \class stencil_traits
+ *  \brief SIMD datatype of grids of type T
+ */
+template <typename T>
+struct stencil_traits: lane_traits<T>
+{ };
+
+/*!
+ *  \class stencil_grid
+ *  \brief Layout of a grid of nx x ny x nz points of type T, x fastest
+ *  Rows are padded to ldx elements (whole vectors), planes are ldy = ny *
+ *  ldx elements apart. Arrays must be aligned to SIMD_WIDTH_BYTES and hold
+ *  elems() elements.
+ */
+template <typename T>
+struct stencil_grid
+{
+    size_t nx;
+    size_t ny;
+    size_t nz;
+    size_t ldx;
+    size_t ldy;
+
+    explicit stencil_grid(const size_t x, const size_t y = 1, const size_t z = 1):
+        nx(x), ny(y), nz(z),
+        ldx(((x + stencil_traits<T>::nlanes - 1) / stencil_traits<T>::nlanes) * stencil_traits<T>::nlanes),
+        ldy(ldx * y)
+    { }
+
+    size_t elems() const
+    { return ldy * nz; }
+
+    size_t index(const size_t x, const size_t y = 0, const size_t z = 0) const
+    { return z * ldy + y * ldx + x; }
+};
+
+/*!
+ *  \class stencil_star
+ *  \brief Neighbours of a vector of points in D dimensions up to radius R
+ *  Element R + d of x (y, z) is the vector at offset d along that axis,
+ *  element R is the points themselves.
+ */
+template <typename T, size_t D, size_t R>
+struct stencil_star
+{
+    typedef typename stencil_traits<T>::vtype vtype;
+    static const size_t dims = D;
+    static const size_t radius = R;
+
+    vtype x[2 * R + 1];
+    vtype y[(D > 1) ? (2 * R + 1) : (1)];
+    vtype z[(D > 2) ? (2 * R + 1) : (1)];
+};
+
+/*!
+ *  \class stencil_op
+ *  \brief Base of stencil functors
+ *  Derived classes provide vtype operator()(const star &s) const, the new
+ *  value of the points of s.
+ */
+template <typename T, size_t D, size_t R>
+struct stencil_op
+{
+    typedef T stype;
+    typedef stencil_star<T, D, R> star;
+    typedef typename star::vtype vtype;
+};
+
+/*!
+ *  \class stencil_coeffs
+ *  \brief Weighted sum of the neighbours
+ *  out = c * p + sum over axes and offsets d != 0 of w[R + d] * p(d)
+ */
+template <typename T, size_t D, size_t R>
+struct stencil_coeffs: public stencil_op<T, D, R>
+{
+    typedef stencil_op<T, D, R> base;
+    typedef typename base::star star;
+    typedef typename base::vtype vtype;
+
+    vtype c0;
+    vtype cx[2 * R + 1];
+    vtype cy[2 * R + 1];
+    vtype cz[2 * R + 1];
+
+    /*!
+     *  \param[in] c Weight of the points themselves
+     *  \param[in] wx, wy, wz Weights of offsets -R..R along each axis (2R + 1
+     *             elements, element R is ignored), NULL for unused axes
+     */
+    stencil_coeffs(const T c, const T * const wx, const T * const wy = NULL, const T * const wz = NULL)
+    {
+        c0 = simd_set(c);
+        for (size_t k = 0; k < 2 * R + 1; ++k) {
+            cx[k] = simd_set((wx && k != R) ? (wx[k]) : ((T)0));
+            cy[k] = simd_set((wy && k != R) ? (wy[k]) : ((T)0));
+            cz[k] = simd_set((wz && k != R) ? (wz[k]) : ((T)0));
+        }
+    }
+
+    SIMD_FUNC_INLINE vtype operator()(const star &s) const
+    {
+        vtype acc = simd_mul(c0, s.x[R]);
+        for (size_t k = 0; k < 2 * R + 1; ++k) {
+            if (k == R)
+                continue;
+            acc = simd_fmadd(cx[k], s.x[k], acc);
+            if (D > 1)
+                acc = simd_fmadd(cy[k], s.y[(D > 1) ? (k) : (0)], acc);
+            if (D > 2)
+                acc = simd_fmadd(cz[k], s.z[(D > 2) ? (k) : (0)], acc);
+        }
+        return acc;
+    }
+};
+
+
+/*************
+ *  Kernels  *
+ *************/
+/*!
+ *  x neighbours J, J - 1, .., 0 from a window w of 2K + 1 aligned vectors
+ *  centred on the current one, offset d = J - R is lane S of vector Q
+ */
+template <typename T, size_t R, size_t K, int J>
+struct stencil_shift_x
+{
+    typedef typename stencil_traits<T>::vtype vtype;
+    enum {
+        L = (int)stencil_traits<T>::nlanes,
+        Q = (J - (int)R + (int)K * L) / L - (int)K,
+        S = J - (int)R - Q * L
+    };
+
+    static SIMD_FUNC_INLINE void run(vtype * const sx, const vtype * const w)
+    {
+        sx[J] = simd_alignr<S>(w[(S == 0) ? ((int)K + Q) : ((int)K + Q + 1)], w[(int)K + Q]);
+        stencil_shift_x<T, R, K, J - 1>::run(sx, w);
+    }
+};
+
+template <typename T, size_t R, size_t K>
+struct stencil_shift_x<T, R, K, -1>
+{
+    typedef typename stencil_traits<T>::vtype vtype;
+
+    static SIMD_FUNC_INLINE void run(vtype * const, const vtype * const)
+    { }
+};
+
+//! Neighbours along an axis of stride \c ld, aligned loads
+template <typename T, size_t R, bool ON>
+struct stencil_axis
+{
+    typedef typename stencil_traits<T>::vtype vtype;
+
+    static SIMD_FUNC_INLINE void run(vtype * const sv, const T * const pa, const size_t ld, const vtype vc)
+    {
+        for (size_t k = 1; k <= R; ++k) {
+            sv[R - k] = simd_load(pa - k * ld);
+            sv[R + k] = simd_load(pa + k * ld);
+        }
+        sv[R] = vc;
+    }
+};
+
+template <typename T, size_t R>
+struct stencil_axis<T, R, false>
+{
+    typedef typename stencil_traits<T>::vtype vtype;
+
+    static SIMD_FUNC_INLINE void run(vtype * const, const T * const, const size_t, const vtype)
+    { }
+};
+
+/*!
+ *  \class stencil_kernel
+ *  \brief Sweeps of functor F over rows and boxes of points
+ */
+template <class F>
+struct stencil_kernel
+{
+    typedef typename F::stype T;
+    typedef typename F::star star;
+    typedef typename F::vtype vtype;
+    static const size_t L = stencil_traits<T>::nlanes;
+    static const size_t D = star::dims;
+    static const size_t R = star::radius;
+    static const size_t K = (R + L - 1) / L;
+    static const size_t W = 2 * K + 1;
+
+    //! Vector at element i + (j - K) * L of row \c pa, zero outside the row
+    static SIMD_FUNC_INLINE vtype window(const T * const pa, const size_t ldx, const size_t i, const size_t j)
+    {
+        vtype va;
+        if (i + j * L >= K * L && i + j * L - K * L < ldx)
+            va = simd_load(pa + i + j * L - K * L);
+        else
+            simd_set_zero(&va);
+        return va;
+    }
+
+    //! New value of the vector at \c pa, window \c w centred on it
+    static SIMD_FUNC_INLINE vtype apply(const F &f, star &s, const vtype * const w, const T * const pa, const size_t ldx, const size_t ldy)
+    {
+        stencil_shift_x<T, R, K, 2 * (int)R>::run(s.x, w);
+        stencil_axis<T, R, (D > 1)>::run(s.y, pa, ldx, w[K]);
+        stencil_axis<T, R, (D > 2)>::run(s.z, pa, ldy, w[K]);
+        return f(s);
+    }
+
+    //! Rotate the window by one vector
+    static SIMD_FUNC_INLINE void rotate(vtype * const w, const vtype vn)
+    {
+        for (size_t j = 0; j + 1 < W; ++j)
+            w[j] = w[j + 1];
+        w[W - 1] = vn;
+    }
+
+    /*!
+     *  Points [x0, x1) of a row, \c pa and \c pc are the input and output
+     *  rows, rows and planes around are \c ldx and \c ldy elements away
+     */
+    static void row(T * const pc, const T * const pa, const size_t ldx, const size_t ldy,
+                    const size_t x0, const size_t x1, const F &f)
+    {
+        // Local copy, coefficients stay in registers across the stores
+        const F fr(f);
+        vtype w[W];
+        star s;
+        size_t i = (x0 / L) * L;
+        for (size_t j = 0; j < W; ++j)
+            w[j] = window(pa, ldx, i, j);
+
+        while (i < x1) {
+            // Whole vectors with the window inside the row
+            if (i >= x0) {
+                for (; i + L <= x1 && i + (K + 2) * L <= ldx; i += L) {
+                    simd_store(pc + i, apply(fr, s, w, pa + i, ldx, ldy));
+                    rotate(w, simd_load(pa + i + (K + 1) * L));
+                }
+                if (i >= x1)
+                    break;
+            }
+
+            // Vectors at the ends of the range or of the row
+            const vtype vc = apply(fr, s, w, pa + i, ldx, ldy);
+            if (i >= x0 && i + L <= x1) {
+                simd_store(pc + i, vc);
+            }
+            else {
+                T lanes[L];
+                simd_storeu(lanes, vc);
+                for (size_t l = 0; l < L; ++l)
+                    if (i + l >= x0 && i + l < x1)
+                        pc[i + l] = lanes[l];
+            }
+            rotate(w, window(pa, ldx, i + L, W - 1));
+            i += L;
+        }
+    }
+
+    //! Points [lo[a], hi[a]) along axes a = x, y, z
+    static void box(T * const out, const T * const in, const stencil_grid<T> &g, const size_t * const lo, const size_t * const hi, const F &f)
+    {
+        for (size_t z = lo[2]; z < hi[2]; ++z)
+            for (size_t y = lo[1]; y < hi[1]; ++y) {
+                const size_t k = g.index(0, y, z);
+                row(out + k, in + k, g.ldx, g.ldy, lo[0], hi[0], f);
+            }
+    }
+};
+
+/*!
+ *  Range functor of the tile scheduler, sweeps boxes [b0, b1) of a region
+ *  cut into tiles of t[a] points along each axis (x tiles aligned)
+ */
+template <class F>
+struct stencil_range
+{
+    typedef typename F::stype T;
+
+    T * const out;
+    const T * const in;
+    const stencil_grid<T> &g;
+    const F &f;
+    size_t lo[3];
+    size_t hi[3];
+    size_t base[3];
+    size_t t[3];
+    size_t nt[3];
+
+    stencil_range(T * const c, const T * const a, const stencil_grid<T> &gg, const F &ff,
+                  const size_t * const l, const size_t * const h, const size_t * const tile):
+        out(c), in(a), g(gg), f(ff)
+    {
+        const size_t L = stencil_traits<T>::nlanes;
+        for (size_t k = 0; k < 3; ++k) {
+            lo[k] = l[k];
+            hi[k] = h[k];
+            base[k] = (k == 0) ? ((l[0] / L) * L) : (l[k]);
+            t[k] = tile[k];
+            nt[k] = (h[k] - base[k] + t[k] - 1) / t[k];
+        }
+    }
+
+    size_t count() const
+    { return nt[0] * nt[1] * nt[2]; }
+
+    void operator()(const size_t b0, const size_t b1) const
+    {
+        for (size_t b = b0; b < b1; ++b) {
+            const size_t i[3] = { b % nt[0], (b / nt[0]) % nt[1], b / (nt[0] * nt[1]) };
+            size_t bl[3], bh[3];
+            for (size_t k = 0; k < 3; ++k) {
+                bl[k] = base[k] + i[k] * t[k];
+                bh[k] = (bl[k] + t[k] < hi[k]) ? (bl[k] + t[k]) : (hi[k]);
+                bl[k] = (bl[k] > lo[k]) ? (bl[k]) : (lo[k]);
+            }
+            stencil_kernel<F>::box(out, in, g, bl, bh, f);
+        }
+    }
+};
+
+/*!
+ *  Sweep points [lo[a], hi[a]) of \c in into \c out. x (and y in 3D) are
+ *  tiled by cache size, the outermost axis is cut among threads.
+ */
+template <class F>
+static void stencil_region(typename F::stype * const out, const typename F::stype * const in, const stencil_grid<typename F::stype> &g,
+                          const F &f, const size_t * const lo, const size_t * const hi, const int32_t nthreads)
+{
+    typedef typename F::stype T;
+    const size_t L = stencil_traits<T>::nlanes;
+    const size_t D = F::star::dims;
+    const size_t R = F::star::radius;
+    for (size_t k = 0; k < 3; ++k)
+        if (hi[k] <= lo[k])
+            return;
+
+    // 2R + 2 row segments, or 2R + 2 tile planes, in half of L2
+    size_t tile[3] = { hi[0], hi[1], hi[2] };
+    if (D > 1) {
+        const size_t tx = ((SYSCONF::get_L2_sz() / 2) / ((2 * R + 2) * sizeof(T)) / L) * L;
+        tile[0] = (tx > L) ? (tx) : (L);
+    }
+    if (D > 2) {
+        const size_t ty = (SYSCONF::get_L2_sz() / 2) / ((2 * R + 2) * tile[0] * sizeof(T));
+        tile[1] = (ty > 1) ? (ty) : (1);
+    }
+
+    // Outermost axis in a few chunks per thread
+    const size_t o = D - 1;
+    const size_t len = hi[o] - lo[o];
+    size_t ninner = 1;
+    for (size_t k = 0; k < o; ++k)
+        ninner *= (hi[k] - lo[k] + tile[k] - 1) / tile[k];
+    const size_t want = STEAL_PARTS_PER_THREAD * (size_t)nthreads;
+    const size_t nchunks = (nthreads > 1 && want > ninner) ? ((want + ninner - 1) / ninner) : (1);
+    tile[o] = (len + nchunks - 1) / nchunks;
+    if (o == 0)
+        tile[0] = ((tile[0] + L - 1) / L) * L;
+
+    const stencil_range<F> kernel(out, in, g, f, lo, hi, tile);
+    steal_parts_for(kernel.count(), kernel, nthreads);
+}
+
+//! Interior of axis a, [R, n - R) for the D axes of the stencil
+template <typename T>
+static inline void stencil_interior(const stencil_grid<T> &g, const size_t D, const size_t R, size_t * const lo, size_t * const hi)
+{
+    const size_t n[3] = { g.nx, g.ny, g.nz };
+    for (size_t k = 0; k < 3; ++k) {
+        lo[k] = (k < D) ? (R) : (0);
+        hi[k] = (k < D) ? ((n[k] > R) ? (n[k] - R) : (0)) : (1);
+    }
+}
+
+/*!
+ *  One time step, out = f(in) on the interior points
+ *  \param[in] run_par Tiles are scheduled among the OpenMP threads set by
+ *             SYSCONF
+ */
+template <class F>
+static void stencil_sweep(typename F::stype * const out, const typename F::stype * const in, const stencil_grid<typename F::stype> &g,
+                          const F &f, const bool run_par = false)
+{
+    size_t lo[3], hi[3];
+    stencil_interior(g, F::star::dims, F::star::radius, lo, hi);
+    const int32_t nthreads = ((SYSCONF::get_omp() & run_par) == true) ? (SYSCONF::get_threads()) : (1);
+    stencil_region(out, in, g, f, lo, hi, nthreads);
+}
+
+/*!
+ *  \c steps time steps alternating between buffers \c a (initial values)
+ *  and \c b
+ *  \param[in] tblock Time steps per slab, 1 for one sweep per step. Slabs
+ *             of the outermost axis are sized so that they and the R
+ *             planes per step of skew fit in half of L2.
+ *  \param[in] run_par Tiles are scheduled among the OpenMP threads set by
+ *             SYSCONF
+ *  \return Buffer with the values after the last step, \c a or \c b
+ */
+template <class F>
+static typename F::stype * stencil_run(typename F::stype * const a, typename F::stype * const b, const stencil_grid<typename F::stype> &g,
+                                       const F &f, const size_t steps, const size_t tblock = 1, const bool run_par = false)
+{
+    typedef typename F::stype T;
+    const size_t L = stencil_traits<T>::nlanes;
+    const size_t D = F::star::dims;
+    const size_t R = F::star::radius;
+    const int32_t nthreads = ((SYSCONF::get_omp() & run_par) == true) ? (SYSCONF::get_threads()) : (1);
+    T *src = a, *dst = b;
+
+    size_t lo[3], hi[3];
+    stencil_interior(g, D, R, lo, hi);
+    if (tblock <= 1) {
+        for (size_t s = 0; s < steps; ++s) {
+            stencil_region(dst, src, g, f, lo, hi, nthreads);
+            T * const tmp = src; src = dst; dst = tmp;
+        }
+        return src;
+    }
+
+    // Planes of the outermost axis (elements in 1D) of both buffers in half of L2
+    const size_t o = D - 1;
+    const size_t plane = (D == 1) ? (sizeof(T)) : ((D == 2) ? (g.ldx * sizeof(T)) : (g.ldy * sizeof(T)));
+    const size_t cached = (SYSCONF::get_L2_sz() / 2) / (2 * plane);
+    for (size_t s = 0; s < steps; s += tblock) {
+        const size_t nt = (steps - s < tblock) ? (steps - s) : (tblock);
+        const size_t skew = R * nt;
+        size_t B = (cached > 4 * skew) ? (cached - 2 * skew) : (2 * skew);
+        if (o == 0)
+            B = ((B + L - 1) / L) * L;
+
+        // Step t of slab k covers [lo + k * B - t * R, lo + (k + 1) * B - t * R)
+        for (size_t k = 0; lo[o] + k * B < hi[o] + skew; ++k)
+            for (size_t t = 0; t < nt; ++t) {
+                size_t sl[3] = { lo[0], lo[1], lo[2] }, sh[3] = { hi[0], hi[1], hi[2] };
+                const size_t r0 = lo[o] + k * B, r1 = r0 + B;
+                sl[o] = (r0 >= lo[o] + t * R) ? (r0 - t * R) : (lo[o]);
+                sh[o] = (r1 >= lo[o] + t * R) ? (r1 - t * R) : (lo[o]);
+                sh[o] = (sh[o] < hi[o]) ? (sh[o]) : (hi[o]);
+                if ((t & 1) == 0)
+                    stencil_region(dst, src, g, f, sl, sh, nthreads);
+                else
+                    stencil_region(src, dst, g, f, sl, sh, nthreads);
+            }
+
+        if (nt & 1) {
+            T * const tmp = src; src = dst; dst = tmp;
+        }
+    }
+    return src;
+}
+
+
+}  // namespace gvl
+
+
+#endif  // _STENCIL_H
@@ -0,0 +1,270 @@
+#ifndef _SYSCONF_H
+#define _SYSCONF_H
+
+
+#include <stdint.h>
+#include <stdlib.h>   // getenv, atoi
+#include <unistd.h>   // sysconf
+#include <iostream>
+#include "utils.h"    // getL1Sz, getL2Sz, getL3Sz (CPUID with sysconf fallback)
+using std::cout;
+using std::endl;
+
+
+/*
+ *  Identify OpenMP support
+ */
+#if defined(_OPENMP)
+#   include <omp.h>
+#endif
+
+
+namespace gvl {
+
+
+/*!
+ *  \brief Class to represent system configuration
+ */
+class SYSCONF
+{
+    protected:
+        static bool initialized;
+        static bool omp_enabled;
+        static int32_t omp_threads;
+        static int32_t ncores;
+        static size_t L1l_sz;
+        static size_t L1c_sz;
+        static size_t L2l_sz;
+        static size_t L2c_sz;
+        static size_t L3c_sz;
+        static size_t L1l_elems_i32;
+        static size_t L1c_elems_i32;
+        static size_t L2l_elems_i32;
+        static size_t L2c_elems_i32;
+        static size_t page_sz;
+
+        //! Positive value or \c fallback, sysconf() returns 0 or -1 if unknown
+        static size_t valid_or(const long int val, const size_t fallback)
+        { return (val > 0) ? ((size_t)val) : (fallback); }
+
+    public:
+        /************
+         *  OpenMP  *
+         ************/
+        /*!
+         *  If \c nthreads < 1, the environment variable OMP_NUM_THREADS is used,
+         *  or the number of cores if it is not set
+         *  OpenMP only gets activated if set_omp() is invoked
+         */
+        static void set_omp(const int32_t nthreads)
+        {
+        #if defined(_OPENMP)
+            if (nthreads == 0 || nthreads == 1) {
+                omp_threads = 1;
+                omp_enabled = false;
+            } else {
+                const char *envval = getenv("OMP_NUM_THREADS");
+                const int32_t nt = (envval) ? (atoi(envval)) : (0);
+                if (nthreads > 0)
+                    omp_threads = nthreads;
+                else
+                    omp_threads = (nt > 0) ? (nt) : (get_ncores());
+                omp_enabled = true;
+            }
+            //setenv("OMP_PROC_BIND","TRUE",1);
+            //setenv("GOMP_CPU_AFFINITY","0,2,4,6,1,3,5,7",1);
+            //setenv("GOMP_CPU_AFFINITY","0,1,2,3",1);
+            //setenv("OMP_PLACES","sockets{2}",1);
+            //setenv("OMP_PLACES","cores",1);
+            //setenv("OMP_PLACES","threads",1);
+        #else
+            (void)nthreads;
+            omp_threads = 1;
+            omp_enabled = false;
+        #endif
+        }
+
+        static bool get_omp()
+        { return omp_enabled; }
+
+        static int32_t get_threads()
+        { return omp_threads; }
+
+        static void omp_settings()
+        {
+        #if defined(_OPENMP)
+            if (get_omp()) {
+                cout << "OpenMP is enabled" << endl;
+                cout << "OpenMP max threads = " << get_threads() << endl;
+            }
+            else {
+                cout << "OpenMP is disabled" << endl;
+            }
+        #else
+            omp_enabled = false;
+            cout << "OpenMP is disabled" << endl;
+        #endif
+        }
+
+        /*!
+         *  Initialize system configurations
+         *  Invoked once at startup (sysconf.cpp) and by the getters if used
+         *  earlier, calling it again re-reads the system values.
+         *  Unknown cache values fall back to common x86 sizes.
+         */
+        static int32_t initSysconf()
+        {
+            ncores = (int32_t)valid_or(getNumProcOnline(), 1);
+            L1l_sz = valid_or(getL1LineSz(), 64);
+            L1c_sz = valid_or(getL1Sz(), 32 * 1024);
+            L2l_sz = valid_or(getL2LineSz(), L1l_sz);
+            L2c_sz = valid_or(getL2Sz(), 256 * 1024);
+            L3c_sz = valid_or(getL3Sz(), L2c_sz);
+            page_sz = valid_or(getPageSz(), 4096);
+            L1l_elems_i32 = L1l_sz / sizeof(int32_t);
+            L1c_elems_i32 = L1c_sz / sizeof(int32_t);
+            L2l_elems_i32 = L2l_sz / sizeof(int32_t);
+            L2c_elems_i32 = L2c_sz / sizeof(int32_t);
+            initialized = true;
+
+            return 0;
+        }
+
+        /*********************
+         *  Cached settings  *
+         *********************/
+        static int32_t get_ncores()
+        { if (!initialized) initSysconf(); return ncores; }
+
+        static size_t get_page_sz()
+        { if (!initialized) initSysconf(); return page_sz; }
+
+        //! Cache line size in bytes (L1 data cache)
+        static size_t get_line_sz()
+        { if (!initialized) initSysconf(); return L1l_sz; }
+
+        static size_t get_L1_sz()
+        { if (!initialized) initSysconf(); return L1c_sz; }
+
+        static size_t get_L2_sz()
+        { if (!initialized) initSysconf(); return L2c_sz; }
+
+        static size_t get_L3_sz()
+        { if (!initialized) initSysconf(); return L3c_sz; }
+
+        //! Number of T elements in a cache line
+        template <typename T>
+        static size_t get_line_elems()
+        { return get_line_sz() / sizeof(T); }
+
+        //! Number of T elements that fit in L1 data cache
+        template <typename T>
+        static size_t get_L1_elems()
+        { return get_L1_sz() / sizeof(T); }
+
+        //! Number of T elements that fit in L2 cache
+        template <typename T>
+        static size_t get_L2_elems()
+        { return get_L2_sz() / sizeof(T); }
+
+        //! Number of T elements that fit in L3 cache
+        template <typename T>
+        static size_t get_L3_elems()
+        { return get_L3_sz() / sizeof(T); }
+
+        /*!
+         *  Print some system configurations
+         */
+        static void printSysconf()
+        {
+            cout << "Number of processors online = " << getNumProcOnline() << endl;
+            cout << "Page size = " << getPageSz() << " B" << endl;
+
+            cout << "L1 data cache size = " << getL1Sz() << " B" << endl;
+            cout << "L1 data cache line size = " << getL1LineSz() << " B" << endl;
+            cout << "L1 data cache associativity = " << getL1Assoc() << endl;
+
+            cout << "L2 cache size = " << getL2Sz() << " B" << endl;
+            cout << "L2 cache line size = " << getL2LineSz() << " B" << endl;
+            cout << "L2 cache associativity = " << getL2Assoc() << endl;
+
+            cout << "L3 cache size = " << getL3Sz() << " B" << endl;
+            cout << "L3 cache line size = " << getL3LineSz() << " B" << endl;
+            cout << "L3 cache associativity = " << getL3Assoc() << endl;
+        }
+
+        /*!
+         *  Get the number of processors currently online (available)
+         */
+        static long int getNumProcOnline()
+        { return sysconf(_SC_NPROCESSORS_ONLN); }
+        //{ return sysconf(_SC_NPROCESSORS_CONF); }
+
+        /*!
+         *  Get the size of page in bytes
+         */
+        static long int getPageSz()
+        { return sysconf(_SC_PAGESIZE); }
+        //{ return sysconf(_SC_PAGE_SIZE); }
+
+        /*!
+         *  Get the size in bytes of L1 data cache
+         */
+        static long int getL1Sz()
+        { return ::getL1Sz(); }
+
+        /*!
+         *  Get the line size in bytes of L1 data cache
+         */
+        static long int getL1LineSz()
+        { return ::getL1LineSz(); }
+
+        /*!
+         *  Get the associativity of L1 data cache
+         */
+        static long int getL1Assoc()
+        { return ::getL1Assoc(); }
+
+        /*!
+         *  Get the size in bytes of L2 cache
+         */
+        static long int getL2Sz()
+        { return ::getL2Sz(); }
+
+        /*!
+         *  Get the line size in bytes of L2 cache
+         */
+        static long int getL2LineSz()
+        { return ::getL2LineSz(); }
+
+        /*!
+         *  Get the associativity of L2 cache
+         */
+        static long int getL2Assoc()
+        { return ::getL2Assoc(); }
+
+        /*!
+         *  Get the size in bytes of L3 cache
+         */
+        static long int getL3Sz()
+        { return ::getL3Sz(); }
+
+        /*!
+         *  Get the line size in bytes of L3 cache
+         */
+        static long int getL3LineSz()
+        { return ::getL3LineSz(); }
+
+        /*!
+         *  Get the associativity of L3 cache
+         */
+        static long int getL3Assoc()
+        { return ::getL3Assoc(); }
+};
+
+
+}  // namespace gvl
+
+
+#endif  // _SYSCONF_H
+
@@ -0,0 +1,169 @@
+/*!
+ *  \brief Out-of-place matrix transpose, sb = sa^T
+ *  Row-major matrices with leading dimensions, blocked in three levels:
+ *  - blocks whose source and destination take half of L2, the unit of work
+ *    of the tile scheduler,
+ *  - sub-blocks whose source and destination take half of L1,
+ *  - register tiles transposed with simd_transpose*(), 8x8 (16x16 for
+ *    single-precision on AVX-512), edges are copied with scalar loops.
+ *  Cache sizes are read from SYSCONF (see sysconf.h).
+ *  \note Blocks are distributed with the work-stealing pool (workpool.h),
+ *        so uneven edge blocks balance among threads
+ */
+#ifndef _TRANSPOSE_H
+#define _TRANSPOSE_H
+
+
+#include <stdint.h>
+#include <stddef.h>   // size_t
+#include "simd.h"
+#include "sysconf.h"
+#include "dispatch.h"  // steal_invoke
+#include "workpool.h"
+
+
+namespace gvl {
+
+
+/*!
+ *  \class transpose_tile
+ *  \brief Register tile kernel of element type T
+ *  Provides size (tile side) and run(sb, ldb, sa, lda)
+ */
+template <typename T>
+struct transpose_tile;
+
+template <>
+struct transpose_tile<float>
+{
+#if defined(SIMD_AVX512)
+    static const size_t size = 16;
+
+    static SIMD_FUNC_INLINE void run(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+    { simd_transpose16x16_f32(sb, ldb, sa, lda); }
+#else
+    static const size_t size = 8;
+
+    static SIMD_FUNC_INLINE void run(float * const sb, const size_t ldb, const float * const sa, const size_t lda)
+    { simd_transpose8x8_f32(sb, ldb, sa, lda); }
+#endif
+};
+
+template <>
+struct transpose_tile<double>
+{
+    static const size_t size = 8;
+
+    static SIMD_FUNC_INLINE void run(double * const sb, const size_t ldb, const double * const sa, const size_t lda)
+    { simd_transpose8x8_f64(sb, ldb, sa, lda); }
+};
+
+/*!
+ *  Block side in elements such that a source and a destination block take
+ *  half of \c cache_bytes, a power-of-two multiple of the tile side
+ */
+template <typename T>
+static inline size_t transpose_block(const size_t cache_bytes)
+{
+    size_t side = transpose_tile<T>::size;
+    while (2 * (2 * side) * (2 * side) * sizeof(T) <= cache_bytes / 2)
+        side *= 2;
+    return side;
+}
+
+/*!
+ *  Transpose rows [i0, i1) and columns [j0, j1) of \c sa into \c sb,
+ *  by sub-blocks of \c side x \c side elements
+ */
+template <typename T>
+static void transpose_block_run(T * const sb, const size_t ldb, const T * const sa, const size_t lda,
+                                const size_t i0, const size_t i1, const size_t j0, const size_t j1, const size_t side)
+{
+    const size_t tile = transpose_tile<T>::size;
+    for (size_t ii = i0; ii < i1; ii += side) {
+        const size_t ie = (ii + side < i1) ? (ii + side) : (i1);
+        for (size_t jj = j0; jj < j1; jj += side) {
+            const size_t je = (jj + side < j1) ? (jj + side) : (j1);
+            size_t i = ii;
+            for (; i + tile <= ie; i += tile) {
+                size_t j = jj;
+                for (; j + tile <= je; j += tile)
+                    transpose_tile<T>::run(sb + j * ldb + i, ldb, sa + i * lda + j, lda);
+                // Remaining columns of tile rows
+                for (; j < je; ++j)
+                    for (size_t k = i; k < i + tile; ++k)
+                        sb[j * ldb + k] = sa[k * lda + j];
+            }
+            // Remaining rows
+            for (; i < ie; ++i)
+                for (size_t j = jj; j < je; ++j)
+                    sb[j * ldb + i] = sa[i * lda + j];
+        }
+    }
+}
+
+/*!
+ *  Range functor of the tile scheduler, transposes L2 blocks [lo, hi)
+ *  numbered row-major over the block grid of \c sa
+ */
+template <typename T>
+struct transpose_range
+{
+    T * const sb;
+    const size_t ldb;
+    const T * const sa;
+    const size_t lda;
+    const size_t rows;
+    const size_t cols;
+    const size_t nbcols;
+    const size_t l2_side;
+    const size_t l1_side;
+
+    transpose_range(T * const b, const size_t ldb_, const T * const a, const size_t lda_, const size_t r, const size_t c,
+                    const size_t l2, const size_t l1):
+        sb(b), ldb(ldb_), sa(a), lda(lda_), rows(r), cols(c), nbcols((c + l2 - 1) / l2), l2_side(l2), l1_side(l1)
+    { }
+
+    void operator()(const size_t lo, const size_t hi) const
+    {
+        for (size_t blk = lo; blk < hi; ++blk) {
+            const size_t i0 = (blk / nbcols) * l2_side;
+            const size_t j0 = (blk % nbcols) * l2_side;
+            const size_t i1 = (i0 + l2_side < rows) ? (i0 + l2_side) : (rows);
+            const size_t j1 = (j0 + l2_side < cols) ? (j0 + l2_side) : (cols);
+            transpose_block_run(sb, ldb, sa, lda, i0, i1, j0, j1, l1_side);
+        }
+    }
+};
+
+/*!
+ *  Out-of-place transpose of a \c rows x \c cols row-major matrix,
+ *  sb[j * ldb + i] = sa[i * lda + j]. Matrices must not overlap.
+ *  \param[in] ldb Leading dimension of \c sb, >= rows
+ *  \param[in] lda Leading dimension of \c sa, >= cols
+ *  \param[in] run_par L2 blocks are scheduled among the OpenMP threads set
+ *             by SYSCONF
+ */
+template <typename T>
+static void transpose(T * const sb, const size_t ldb, const T * const sa, const size_t lda, const size_t rows, const size_t cols, const bool run_par = false)
+{
+    if (rows == 0 || cols == 0)
+        return;
+
+    const size_t l1_side = transpose_block<T>(SYSCONF::get_L1_sz());
+    const size_t l2_side = transpose_block<T>(SYSCONF::get_L2_sz());
+    const transpose_range<T> kernel(sb, ldb, sa, lda, rows, cols, l2_side, l1_side);
+    const size_t nblocks = ((rows + l2_side - 1) / l2_side) * kernel.nbcols;
+
+    const int32_t nthreads = ((SYSCONF::get_omp() & run_par) == true) ? (SYSCONF::get_threads()) : (1);
+    if (nthreads > 1 && nblocks > 1)
+        steal_run(nblocks, 1, 1, steal_invoke<transpose_range<T> >, (const void *)&kernel, nthreads);
+    else
+        kernel(0, nblocks);
+}
+
+
+}  // namespace gvl
+
+
+#endif  // _TRANSPOSE_H
@@ -0,0 +1,354 @@
+/*!
+ *  \brief C++ object oriented interface
+ *  Vector class template wraps the SIMD datatypes of the selected SIMD interface.
+ *  Member functions and operators are thin inline wrappers, so code using
+ *  vector objects compiles to the same instructions as the simd_* functions.
+ *  \note Requires partial loads/stores, compares and blends, provided by the
+ *        SSE4.2, AVX, AVX2, AVX-512, AVX2x2, generic and scalar modes
+ */
+#ifndef _VEC_H
+#define _VEC_H
+
+
+#include <stdint.h>
+#include "simd.h"
+
+
+namespace gvl {
+
+
+/*!
+ *  \struct vec_traits
+ *  \brief Maps a scalar type to its SIMD datatype and interface functions
+ *
+ *  Only types with a specialization can be used with vec<T>. Operations not
+ *  supported by the SIMD interface for a type (e.g. integer division) are not
+ *  provided and fail to compile when used.
+ */
+template <typename T>
+struct vec_traits;
+
+template <>
+struct vec_traits<int32_t>
+{
+    typedef SIMD_INT vtype;
+    static const int32_t nstreams = SIMD_STREAMS_32;
+
+    static SIMD_FUNC_INLINE vtype zero()
+    { vtype va; simd_set_zero(&va); return va; }
+
+    static SIMD_FUNC_INLINE vtype set(const int32_t sa)
+    { return simd_set(sa); }
+
+    static SIMD_FUNC_INLINE vtype add(const vtype va, const vtype vb)
+    { return simd_add_32(va, vb); }
+
+    static SIMD_FUNC_INLINE vtype sub(const vtype va, const vtype vb)
+    { return simd_sub_32(va, vb); }
+
+    static SIMD_FUNC_INLINE vtype mul(const vtype va, const vtype vb)
+    { return simd_mul_32(va, vb); }
+
+    static SIMD_FUNC_INLINE vtype fmadd(const vtype va, const vtype vb, const vtype vc)
+    { return simd_add_32(simd_mul_32(va, vb), vc); }
+
+    static SIMD_FUNC_INLINE vtype fmsub(const vtype va, const vtype vb, const vtype vc)
+    { return simd_sub_32(simd_mul_32(va, vb), vc); }
+
+    static SIMD_FUNC_INLINE vtype bit_and(const vtype va, const vtype vb)
+    { return simd_and(va, vb); }
+
+    static SIMD_FUNC_INLINE vtype bit_or(const vtype va, const vtype vb)
+    { return simd_or(va, vb); }
+
+    static SIMD_FUNC_INLINE vtype bit_xor(const vtype va, const vtype vb)
+    { return simd_xor(va, vb); }
+
+    static SIMD_FUNC_INLINE vtype bit_not(const vtype va)
+    { return simd_xor(va, simd_set((int32_t)-1)); }
+
+    static SIMD_FUNC_INLINE vtype cmpeq(const vtype va, const vtype vb)
+    { return simd_cmpeq_32(va, vb); }
+
+    static SIMD_FUNC_INLINE vtype cmpneq(const vtype va, const vtype vb)
+    { return bit_not(simd_cmpeq_32(va, vb)); }
+
+    static SIMD_FUNC_INLINE vtype cmplt(const vtype va, const vtype vb)
+    { return simd_cmplt_i32(va, vb); }
+
+    static SIMD_FUNC_INLINE vtype cmple(const vtype va, const vtype vb)
+    { return bit_not(simd_cmpgt_i32(va, vb)); }
+
+    static SIMD_FUNC_INLINE vtype cmpgt(const vtype va, const vtype vb)
+    { return simd_cmpgt_i32(va, vb); }
+
+    static SIMD_FUNC_INLINE vtype cmpge(const vtype va, const vtype vb)
+    { return bit_not(simd_cmplt_i32(va, vb)); }
+
+    static SIMD_FUNC_INLINE vtype load(const int32_t * const sa, const size_t n, const bool strmHint)
+    { return simd_load(sa, (int32_t)n, strmHint); }
+
+    static SIMD_FUNC_INLINE vtype loadu(const int32_t * const sa, const size_t n)
+    { return simd_loadu(sa, n); }
+
+    static SIMD_FUNC_INLINE void store(int32_t * const sa, const vtype va, const size_t n, const bool strmHint)
+    { simd_store(sa, va, (int32_t)n, strmHint); }
+
+    static SIMD_FUNC_INLINE void storeu(int32_t * const sa, const vtype va, const size_t n)
+    { simd_storeu(sa, va, n); }
+};
+
+#define VEC_TRAITS_FP(STYPE, VTYPE, NSTREAMS) \
+template <> \
+struct vec_traits<STYPE> \
+{ \
+    typedef VTYPE vtype; \
+    static const int32_t nstreams = NSTREAMS; \
+\
+    static SIMD_FUNC_INLINE vtype zero() \
+    { vtype va; simd_set_zero(&va); return va; } \
+\
+    static SIMD_FUNC_INLINE vtype set(const STYPE sa) \
+    { return simd_set(sa); } \
+\
+    static SIMD_FUNC_INLINE vtype add(const vtype va, const vtype vb) \
+    { return simd_add(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype sub(const vtype va, const vtype vb) \
+    { return simd_sub(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype mul(const vtype va, const vtype vb) \
+    { return simd_mul(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype div(const vtype va, const vtype vb) \
+    { return simd_div(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype fmadd(const vtype va, const vtype vb, const vtype vc) \
+    { return simd_fmadd(va, vb, vc); } \
+\
+    static SIMD_FUNC_INLINE vtype fmsub(const vtype va, const vtype vb, const vtype vc) \
+    { return simd_fmsub(va, vb, vc); } \
+\
+    static SIMD_FUNC_INLINE vtype bit_and(const vtype va, const vtype vb) \
+    { return simd_and(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype bit_or(const vtype va, const vtype vb) \
+    { return simd_or(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype bit_xor(const vtype va, const vtype vb) \
+    { return simd_xor(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype cmpeq(const vtype va, const vtype vb) \
+    { return simd_cmpeq(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype cmpneq(const vtype va, const vtype vb) \
+    { return simd_cmpneq(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype cmplt(const vtype va, const vtype vb) \
+    { return simd_cmplt(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype cmple(const vtype va, const vtype vb) \
+    { return simd_cmple(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype cmpgt(const vtype va, const vtype vb) \
+    { return simd_cmpgt(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype cmpge(const vtype va, const vtype vb) \
+    { return simd_cmpge(va, vb); } \
+\
+    static SIMD_FUNC_INLINE vtype load(const STYPE * const sa, const size_t n, const bool strmHint) \
+    { return simd_load(sa, n, strmHint); } \
+\
+    static SIMD_FUNC_INLINE vtype loadu(const STYPE * const sa, const size_t n) \
+    { return simd_loadu(sa, n); } \
+\
+    static SIMD_FUNC_INLINE void store(STYPE * const sa, const vtype va, const size_t n, const bool strmHint) \
+    { simd_store(sa, va, n, strmHint); } \
+\
+    static SIMD_FUNC_INLINE void storeu(STYPE * const sa, const vtype va, const size_t n) \
+    { simd_storeu(sa, va, n); } \
+};
+
+VEC_TRAITS_FP(float, SIMD_FLT, SIMD_STREAMS_32)
+VEC_TRAITS_FP(double, SIMD_DBL, SIMD_STREAMS_64)
+#undef VEC_TRAITS_FP
+
+
+/*!
+ *  \class vec
+ *  \brief Class to represent a vector of T elements
+ *
+ *  The object holds a single SIMD register, no virtual functions or extra
+ *  members, so sizeof(vec<T>) == sizeof(vec<T>::vtype).
+ *  Comparison operators return vectors with all bits set in elements where
+ *  the condition holds, use select() to blend with them.
+ */
+template <typename T>
+class vec
+{
+    public:
+        typedef T stype;
+        typedef vec_traits<T> traits;
+        typedef typename traits::vtype vtype;
+        static const size_t nstreams = traits::nstreams;
+        static const size_t nbytes = SIMD_WIDTH_BYTES;
+
+    private:
+        vtype v;
+
+    public:
+        /******************
+         *  Constructors  *
+         ******************/
+        //! Constructor with no parameters, elements are set to zero
+        vec(): v(traits::zero())
+        { }
+
+        //! (Low-level) Constructor from SIMD datatype
+        vec(const vtype va): v(va)
+        { }
+
+        //! Broadcast constructor, all elements are set to \c sa
+        explicit vec(const T sa): v(traits::set(sa))
+        { }
+
+        /*!
+         *  Constructor with scalar pointer parameter
+         *  Does not assumes \c sa alignment is conformant
+         */
+        vec(const T * const sa, const size_t n = nstreams): v(traits::loadu(sa, n))
+        { }
+
+        /*************
+         *  Get/set  *
+         *************/
+        static SIMD_FUNC_INLINE size_t get_nstreams()
+        { return nstreams; }
+
+        static SIMD_FUNC_INLINE size_t get_nbytes()
+        { return nbytes; }
+
+        SIMD_FUNC_INLINE void set_vector(const vtype va)
+        { v = va; }
+
+        SIMD_FUNC_INLINE vtype get_vector() const
+        { return v; }
+
+        //! Read element \c i, goes through memory so avoid in inner loops
+        SIMD_FUNC_INLINE T operator[](const size_t i) const
+        {
+            T sa[nstreams] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+            traits::store(sa, v, nstreams, false);
+            return sa[i];
+        }
+
+        //! Write element \c i, goes through memory so avoid in inner loops
+        SIMD_FUNC_INLINE void insert(const size_t i, const T sa)
+        {
+            T sb[nstreams] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+            traits::store(sb, v, nstreams, false);
+            sb[i] = sa;
+            v = traits::load(sb, nstreams, false);
+        }
+
+        /****************
+         *  Operations  *
+         ****************/
+        SIMD_FUNC_INLINE vec operator+(const vec &vb) const
+        { return vec(traits::add(v, vb.v)); }
+
+        SIMD_FUNC_INLINE vec operator-(const vec &vb) const
+        { return vec(traits::sub(v, vb.v)); }
+
+        SIMD_FUNC_INLINE vec operator*(const vec &vb) const
+        { return vec(traits::mul(v, vb.v)); }
+
+        SIMD_FUNC_INLINE vec operator/(const vec &vb) const
+        { return vec(traits::div(v, vb.v)); }
+
+        SIMD_FUNC_INLINE vec operator-() const
+        { return vec(traits::sub(traits::zero(), v)); }
+
+        SIMD_FUNC_INLINE vec & operator+=(const vec &vb)
+        { v = traits::add(v, vb.v); return *this; }
+
+        SIMD_FUNC_INLINE vec & operator-=(const vec &vb)
+        { v = traits::sub(v, vb.v); return *this; }
+
+        SIMD_FUNC_INLINE vec & operator*=(const vec &vb)
+        { v = traits::mul(v, vb.v); return *this; }
+
+        SIMD_FUNC_INLINE vec & operator/=(const vec &vb)
+        { v = traits::div(v, vb.v); return *this; }
+
+        SIMD_FUNC_INLINE vec operator&(const vec &vb) const
+        { return vec(traits::bit_and(v, vb.v)); }
+
+        SIMD_FUNC_INLINE vec operator|(const vec &vb) const
+        { return vec(traits::bit_or(v, vb.v)); }
+
+        SIMD_FUNC_INLINE vec operator^(const vec &vb) const
+        { return vec(traits::bit_xor(v, vb.v)); }
+
+        SIMD_FUNC_INLINE vec operator~() const
+        { return vec(traits::bit_not(v)); }
+
+        SIMD_FUNC_INLINE vec & operator&=(const vec &vb)
+        { v = traits::bit_and(v, vb.v); return *this; }
+
+        SIMD_FUNC_INLINE vec & operator|=(const vec &vb)
+        { v = traits::bit_or(v, vb.v); return *this; }
+
+        SIMD_FUNC_INLINE vec & operator^=(const vec &vb)
+        { v = traits::bit_xor(v, vb.v); return *this; }
+
+        SIMD_FUNC_INLINE vec operator==(const vec &vb) const
+        { return vec(traits::cmpeq(v, vb.v)); }
+
+        SIMD_FUNC_INLINE vec operator!=(const vec &vb) const
+        { return vec(traits::cmpneq(v, vb.v)); }
+
+        SIMD_FUNC_INLINE vec operator<(const vec &vb) const
+        { return vec(traits::cmplt(v, vb.v)); }
+
+        SIMD_FUNC_INLINE vec operator<=(const vec &vb) const
+        { return vec(traits::cmple(v, vb.v)); }
+
+        SIMD_FUNC_INLINE vec operator>(const vec &vb) const
+        { return vec(traits::cmpgt(v, vb.v)); }
+
+        SIMD_FUNC_INLINE vec operator>=(const vec &vb) const
+        { return vec(traits::cmpge(v, vb.v)); }
+
+        /****************
+         *  Load/Store  *
+         ****************/
+        SIMD_FUNC_INLINE void load(const T * const sa, const size_t n = nstreams, const bool strmHint = false)
+        { v = traits::load(sa, n, strmHint); }
+
+        SIMD_FUNC_INLINE void store(T * const sa, const size_t n = nstreams, const bool strmHint = false) const
+        { traits::store(sa, v, n, strmHint); }
+
+        SIMD_FUNC_INLINE void loadu(const T * const sa, const size_t n = nstreams)
+        { v = traits::loadu(sa, n); }
+
+        SIMD_FUNC_INLINE void storeu(T * const sa, const size_t n = nstreams) const
+        { traits::storeu(sa, v, n); }
+};
+
+/*!
+ *  Select elements of \c vb where \c vmsk is set, otherwise elements of \c va.
+ */
+template <typename T>
+static SIMD_FUNC_INLINE vec<T> select(const vec<T> &vmsk, const vec<T> &vb, const vec<T> &va)
+{ return vec<T>(simd_blend(va.get_vector(), vb.get_vector(), vmsk.get_vector())); }
+
+typedef vec<int32_t> int32_v;
+typedef vec<float> flt32_v;
+typedef vec<double> flt64_v;
+
+
+}  // namespace gvl
+
+
+#endif  // _VEC_H
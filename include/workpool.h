@@ -0,0 +1,56 @@
+/*!
+ *  \brief Work-stealing thread pool
+ *  Alternative to the OpenMP dispatcher for irregular kernels, where the cost
+ *  of a range varies (sparse rows, early-exit searches) and a static schedule
+ *  leaves cores idle.
+ *  Each worker owns a Chase-Lev deque of index ranges. Each deque starts with
+ *  an even share of [0, n), pushed before the workers are woken so the share
+ *  of a late worker can be stolen. A worker splits its range in halves at
+ *  SIMD/cache-line grain boundaries pushing the upper half to the bottom of
+ *  its deque, and runs leaves of the range. Idle workers steal the oldest
+ *  (largest) range from the top of a random victim's deque.
+ *  Pool threads are created on first use and persist, the calling thread acts
+ *  as worker 0. Threads pinned by set_affinity() keep their placement.
+ *  \note Nested calls from inside a kernel run serially on the calling worker
+ */
+#ifndef _WORKPOOL_H
+#define _WORKPOOL_H
+
+
+#include <stdint.h>
+#include <stddef.h>   // size_t
+
+
+namespace gvl {
+
+
+//! Backends of parallel_for()
+enum dispatch_backend {
+    DISPATCH_OPENMP,   //!< OpenMP static schedule over aligned chunks (default)
+    DISPATCH_STEALING  //!< Work-stealing pool, for kernels with irregular cost
+};
+
+//! Select backend used by parallel_for()
+void set_dispatch_backend(const dispatch_backend backend);
+
+//! Backend used by parallel_for()
+dispatch_backend get_dispatch_backend();
+
+//! Range function invoked on elements [lo, hi) with the kernel in \c ctx
+typedef void (*steal_fn)(const void *ctx, const size_t lo, const size_t hi);
+
+/*!
+ *  Run \c fn over [0, n) on \c nthreads workers with work stealing.
+ *  Ranges split at multiples of \c grain elements and ranges of at most
+ *  \c leaf elements are not split further (\c leaf is a multiple of \c grain).
+ */
+void steal_run(const size_t n, const size_t grain, const size_t leaf, steal_fn fn, const void *ctx, const int32_t nthreads);
+
+//! Number of pool threads created, excluding calling threads
+int32_t get_pool_threads();
+
+
+}  // namespace gvl
+
+
+#endif  // _WORKPOOL_H
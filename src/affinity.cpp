@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include <stdlib.h>      // setenv
+#include <algorithm>     // sort
+#include <vector>
+#include <string>
+#include <sstream>
+#include "affinity.h"
+#include "cpuid.h"       // get_topology
+
+#if defined(__linux__)
+#   include <pthread.h>  // pthread_setaffinity_np
+#   include <sched.h>    // sched_getaffinity, sched_getcpu, CPU_SET
+#endif
+
+#if defined(_OPENMP)
+#   include <omp.h>
+#endif
+
+
+namespace gvl {
+
+
+// Logical CPU and its location in the topology
+struct cpu_place {
+    int32_t cpu;
+    int32_t package;
+    int32_t core;
+    int32_t smt;      // rank among SMT siblings of the same core
+};
+
+// Placement of last set_affinity(), thread i runs on affinity_map[i]
+static int32_t affinity_map[AFFINITY_MAX_THREADS];
+static int32_t affinity_nthreads = 0;
+
+
+#if defined(__linux__)
+// Integer from a sysfs file, -1 if not available
+static int32_t read_sysfs_int(const int32_t cpu, const char * const name)
+{
+    char path[128];
+    sprintf(path, "/sys/devices/system/cpu/cpu%d/topology/%s", (int)cpu, name);
+    FILE *fd = fopen(path, "r");
+    if (!fd)
+        return -1;
+    int val = -1;
+    if (fscanf(fd, "%d", &val) != 1)
+        val = -1;
+    fclose(fd);
+    return (int32_t)val;
+}
+
+static bool place_less_compact(const cpu_place &a, const cpu_place &b)
+{
+    if (a.package != b.package) return a.package < b.package;
+    if (a.core != b.core) return a.core < b.core;
+    return a.smt < b.smt;
+}
+
+static bool place_less_scatter(const cpu_place &a, const cpu_place &b)
+{
+    if (a.smt != b.smt) return a.smt < b.smt;
+    if (a.core != b.core) return a.core < b.core;
+    return a.package < b.package;
+}
+
+/*
+ *  CPUs in the process affinity mask with their package/core.
+ *  Without sysfs, siblings are assumed to be enumerated as Linux does on x86,
+ *  i.e., CPU c and c + ncores share a core, with the SMT width from CPUID.
+ */
+static std::vector<cpu_place> get_cpu_places()
+{
+    std::vector<cpu_place> places;
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask))
+        return places;
+
+    const int32_t nallowed = CPU_COUNT(&mask);
+    const int32_t smt = (int32_t)get_topology().smt_per_core;
+    const int32_t ncores = (smt > 1 && nallowed >= smt) ? (nallowed / smt) : (nallowed);
+
+    for (int32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &mask))
+            continue;
+        cpu_place p;
+        p.cpu = cpu;
+        p.package = read_sysfs_int(cpu, "physical_package_id");
+        p.core = read_sysfs_int(cpu, "core_id");
+        if (p.package < 0)
+            p.package = 0;
+        if (p.core < 0)
+            p.core = cpu % ncores;
+        p.smt = 0;
+        places.push_back(p);
+    }
+
+    // Rank SMT siblings by CPU number, places are in CPU order
+    for (size_t i = 0; i < places.size(); ++i)
+        for (size_t j = 0; j < i; ++j)
+            if (places[j].package == places[i].package && places[j].core == places[i].core)
+                ++places[i].smt;
+
+    return places;
+}
+
+// Place of \c cpu, package and core are -1 if not in the affinity mask
+static cpu_place find_cpu_place(const std::vector<cpu_place> &places, const int32_t cpu)
+{
+    for (size_t i = 0; i < places.size(); ++i)
+        if (places[i].cpu == cpu)
+            return places[i];
+    cpu_place p = { cpu, -1, -1, -1 };
+    return p;
+}
+#endif
+
+
+int32_t pin_thread(const int32_t cpu)
+{
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return -1;
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    return (pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0) ? (0) : (-1);
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+
+int32_t set_affinity(const affinity_policy policy, const int32_t nthreads, const int32_t * const cpus, const int32_t ncpus)
+{
+#if defined(__linux__)
+    std::vector<cpu_place> places = get_cpu_places();
+    std::vector<int32_t> order;
+
+    switch (policy) {
+        case AFFINITY_COMPACT:
+            std::sort(places.begin(), places.end(), place_less_compact);
+            for (size_t i = 0; i < places.size(); ++i)
+                order.push_back(places[i].cpu);
+            break;
+        case AFFINITY_SCATTER:
+            std::sort(places.begin(), places.end(), place_less_scatter);
+            for (size_t i = 0; i < places.size(); ++i)
+                order.push_back(places[i].cpu);
+            break;
+        case AFFINITY_CORES:
+            std::sort(places.begin(), places.end(), place_less_compact);
+            for (size_t i = 0; i < places.size(); ++i)
+                if (places[i].smt == 0)
+                    order.push_back(places[i].cpu);
+            break;
+        case AFFINITY_LIST:
+            // Keep only CPUs in the process affinity mask
+            for (int32_t i = 0; cpus && i < ncpus; ++i)
+                if (find_cpu_place(places, cpus[i]).package >= 0)
+                    order.push_back(cpus[i]);
+            break;
+    }
+
+    if (order.empty())
+        return 0;
+
+    int32_t nt = (nthreads > 0) ? (nthreads) : ((int32_t)order.size());
+    if (nt > AFFINITY_MAX_THREADS)
+        nt = AFFINITY_MAX_THREADS;
+    for (int32_t t = 0; t < nt; ++t)
+        affinity_map[t] = order[t % order.size()];
+    affinity_nthreads = nt;
+
+    // Same placement for child processes and runtimes not yet initialized
+    std::ostringstream omp_places;
+    for (int32_t t = 0; t < nt; ++t)
+        omp_places << ((t) ? (",{") : ("{")) << affinity_map[t] << "}";
+    setenv("OMP_PLACES", omp_places.str().c_str(), 1);
+    setenv("OMP_PROC_BIND", "true", 1);
+
+#if defined(_OPENMP)
+    omp_set_num_threads(nt);
+    int32_t npinned = 0;
+    #pragma omp parallel num_threads(nt) reduction(+:npinned)
+    {
+        const int32_t tid = omp_get_thread_num();
+        npinned += (pin_thread(affinity_map[tid]) == 0) ? (1) : (0);
+    }
+    return npinned;
+#else
+    return (pin_thread(affinity_map[0]) == 0) ? (1) : (0);
+#endif
+
+#else
+    (void)policy;
+    (void)nthreads;
+    (void)cpus;
+    (void)ncpus;
+    return 0;
+#endif
+}
+
+
+int32_t get_affinity_cpu(const int32_t tid)
+{ return (tid >= 0 && tid < affinity_nthreads) ? (affinity_map[tid]) : (-1); }
+
+
+int32_t get_affinity_threads()
+{ return affinity_nthreads; }
+
+
+void print_affinity()
+{
+#if defined(__linux__)
+    const std::vector<cpu_place> places = get_cpu_places();
+    int32_t current[AFFINITY_MAX_THREADS];
+    int32_t nt = 1;
+
+#if defined(_OPENMP)
+    nt = (affinity_nthreads > 0) ? (affinity_nthreads) : (omp_get_max_threads());
+    if (nt > AFFINITY_MAX_THREADS)
+        nt = AFFINITY_MAX_THREADS;
+    #pragma omp parallel num_threads(nt)
+    current[omp_get_thread_num()] = sched_getcpu();
+#else
+    current[0] = sched_getcpu();
+#endif
+
+    printf("Thread affinity (%d threads)\n", (int)nt);
+    for (int32_t t = 0; t < nt; ++t) {
+        const cpu_place p = find_cpu_place(places, current[t]);
+        printf("  thread %d: assigned CPU %d, running on CPU %d (package %d, core %d, SMT %d)\n",
+               (int)t, (int)get_affinity_cpu(t), (int)current[t], (int)p.package, (int)p.core, (int)p.smt);
+    }
+#else
+    printf("Thread affinity is not supported\n");
+#endif
+}
+
+
+}  // namespace gvl
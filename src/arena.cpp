@@ -0,0 +1,239 @@
+#include <stdlib.h>      // posix_memalign, free
+#include <string.h>      // memset
+#include <new>           // nothrow
+#include <pthread.h>
+#include "arena.h"
+
+
+namespace gvl {
+
+
+/*
+ *  Pool buffers are powers of two, blocks add a header of POOL_ALIGN bytes
+ *  (size class and free list link) in front of the buffer returned
+ */
+const int32_t POOL_MIN_SHIFT = 8;    // 256 B buffers
+const int32_t POOL_CLASSES = 48;
+const uint32_t POOL_MAX_CACHED = 16;                      // blocks per class
+const size_t POOL_MAX_CACHED_BYTES = (size_t)256 << 20;  // bytes per thread
+
+struct pool_header {
+    int32_t cls;
+    void *next;
+};
+
+// Free lists and arena of a thread
+struct thread_heap {
+    void *lists[POOL_CLASSES];
+    uint32_t counts[POOL_CLASSES];
+    size_t cached_bytes;
+    arena *scratch;
+};
+
+static __thread thread_heap *tl_heap = NULL;
+static pthread_key_t heap_key;
+static pthread_once_t heap_once = PTHREAD_ONCE_INIT;
+
+// Arena of threads whose heap could not be created, allocations fail
+static arena no_arena(0);
+
+
+static void trim_heap(thread_heap * const heap)
+{
+    for (int32_t c = 0; c < POOL_CLASSES; ++c) {
+        void *block = heap->lists[c];
+        while (block) {
+            void *next = ((pool_header *)block)->next;
+            free(block);
+            block = next;
+        }
+        heap->lists[c] = NULL;
+        heap->counts[c] = 0;
+    }
+    heap->cached_bytes = 0;
+}
+
+// Thread exit, main thread memory is released by the system
+static void destroy_heap(void *p)
+{
+    thread_heap * const heap = (thread_heap *)p;
+    trim_heap(heap);
+    delete heap->scratch;
+    delete heap;
+    tl_heap = NULL;
+}
+
+static void create_heap_key()
+{ pthread_key_create(&heap_key, destroy_heap); }
+
+static thread_heap *get_heap()
+{
+    if (!tl_heap) {
+        pthread_once(&heap_once, create_heap_key);
+        thread_heap * const heap = new (std::nothrow) thread_heap;
+        if (!heap)
+            return NULL;
+        memset(heap, 0, sizeof(thread_heap));
+        pthread_setspecific(heap_key, heap);
+        tl_heap = heap;
+    }
+    return tl_heap;
+}
+
+
+/**********
+ *  Pool  *
+ **********/
+void *pool_malloc(const size_t bytes)
+{
+    int32_t cls = POOL_MIN_SHIFT;
+    while (cls < POOL_MIN_SHIFT + POOL_CLASSES && ((size_t)1 << cls) < bytes)
+        ++cls;
+    if (cls == POOL_MIN_SHIFT + POOL_CLASSES)
+        return NULL;
+    const int32_t c = cls - POOL_MIN_SHIFT;
+
+    thread_heap * const heap = get_heap();
+    void *block = (heap) ? (heap->lists[c]) : (NULL);
+    if (block) {
+        heap->lists[c] = ((pool_header *)block)->next;
+        --heap->counts[c];
+        heap->cached_bytes -= (size_t)1 << cls;
+    } else if (posix_memalign(&block, POOL_ALIGN, POOL_ALIGN + ((size_t)1 << cls))) {
+        return NULL;
+    }
+
+    ((pool_header *)block)->cls = c;
+    return (char *)block + POOL_ALIGN;
+}
+
+
+void pool_free(void * const sa)
+{
+    if (!sa)
+        return;
+
+    void * const block = (char *)sa - POOL_ALIGN;
+    const int32_t c = ((pool_header *)block)->cls;
+    const size_t block_bytes = (size_t)1 << (c + POOL_MIN_SHIFT);
+
+    thread_heap * const heap = get_heap();
+    if (heap && heap->counts[c] < POOL_MAX_CACHED && heap->cached_bytes + block_bytes <= POOL_MAX_CACHED_BYTES) {
+        ((pool_header *)block)->next = heap->lists[c];
+        heap->lists[c] = block;
+        ++heap->counts[c];
+        heap->cached_bytes += block_bytes;
+    } else {
+        free(block);
+    }
+}
+
+
+void pool_trim()
+{
+    if (tl_heap)
+        trim_heap(tl_heap);
+}
+
+
+/***********
+ *  Arena  *
+ ***********/
+arena::arena(const size_t chunk_sz): head(NULL), current(NULL), used(0), chunk_bytes(chunk_sz)
+{ }
+
+
+arena::~arena()
+{
+    while (head) {
+        chunk_header *next = head->next;
+        free(head);
+        head = next;
+    }
+}
+
+
+void *arena::allocate(const size_t bytes)
+{
+    // Sizes in multiples of alignment keep every allocation aligned
+    const size_t nbytes = ((bytes + POOL_ALIGN - 1) / POOL_ALIGN) * POOL_ALIGN;
+    const size_t b = (nbytes > 0) ? (nbytes) : (POOL_ALIGN);
+
+    if (!current || used + b > current->capacity) {
+        chunk_header *next = (current) ? (current->next) : (head);
+        if (!next || next->capacity < b) {
+            if (chunk_bytes == 0)
+                return NULL;
+
+            // New chunk after current one, later chunks are kept for reuse
+            const size_t capacity = (b > chunk_bytes) ? (b) : (chunk_bytes);
+            chunk_header *chunk = NULL;
+            if (posix_memalign((void **)&chunk, POOL_ALIGN, POOL_ALIGN + capacity))
+                return NULL;
+            chunk->capacity = capacity;
+            chunk->next = next;
+            if (current)
+                current->next = chunk;
+            else
+                head = chunk;
+            next = chunk;
+        }
+        current = next;
+        used = 0;
+    }
+
+    void * const p = (char *)current + POOL_ALIGN + used;
+    used += b;
+    return p;
+}
+
+
+arena::arena_mark arena::mark() const
+{
+    arena_mark m;
+    m.chunk = current;
+    m.used = used;
+    return m;
+}
+
+
+void arena::reset(const arena_mark &m)
+{
+    // Nothing allocated yet, keeps no_arena read-only when shared by threads
+    if (!head)
+        return;
+    current = (chunk_header *)m.chunk;
+    used = m.used;
+}
+
+
+void arena::reset()
+{
+    if (!head)
+        return;
+    current = NULL;
+    used = 0;
+}
+
+
+size_t arena::capacity() const
+{
+    size_t total = 0;
+    for (const chunk_header *chunk = head; chunk; chunk = chunk->next)
+        total += chunk->capacity;
+    return total;
+}
+
+
+arena & thread_arena()
+{
+    thread_heap * const heap = get_heap();
+    if (!heap)
+        return no_arena;
+    if (!heap->scratch)
+        heap->scratch = new (std::nothrow) arena();
+    return (heap->scratch) ? (*heap->scratch) : (no_arena);
+}
+
+
+}  // namespace gvl
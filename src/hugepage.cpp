@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>      // posix_memalign, free
+#include <string.h>      // strstr
+#include <map>
+#include <pthread.h>
+#include "hugepage.h"
+
+#if defined(__linux__)
+#   include <sys/mman.h>  // mmap, madvise
+#endif
+
+
+namespace gvl {
+
+
+/*
+ *  Huge page buffers by address, with their mode and length, so that
+ *  normal page buffers are plain posix_memalign() ones (no header, can be
+ *  released with free())
+ */
+struct hugepage_entry {
+    size_t bytes;        // Length of mapping, for munmap()
+    hugepage_mode mode;  // Mode obtained
+};
+
+static std::map<const void *, hugepage_entry> hugepage_buffers;
+static pthread_mutex_t hugepage_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void add_buffer(void * const sa, const size_t bytes, const hugepage_mode mode)
+{
+    const hugepage_entry entry = {bytes, mode};
+    pthread_mutex_lock(&hugepage_mutex);
+    hugepage_buffers[sa] = entry;
+    pthread_mutex_unlock(&hugepage_mutex);
+}
+
+// Entry of buffer \c sa, mode HUGEPAGE_NONE if not a huge page buffer
+static hugepage_entry find_buffer(const void * const sa, const bool remove)
+{
+    hugepage_entry entry = {0, HUGEPAGE_NONE};
+    pthread_mutex_lock(&hugepage_mutex);
+    std::map<const void *, hugepage_entry>::iterator it = hugepage_buffers.find(sa);
+    if (it != hugepage_buffers.end()) {
+        entry = it->second;
+        if (remove)
+            hugepage_buffers.erase(it);
+    }
+    pthread_mutex_unlock(&hugepage_mutex);
+    return entry;
+}
+
+
+#if defined(__linux__)
+// THP is usable with madvise unless disabled ("[never]")
+static bool thp_enabled()
+{
+    FILE *fd = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+    if (!fd)
+        return false;
+    char line[128] = "";
+    const bool enabled = fgets(line, sizeof(line), fd) && !strstr(line, "[never]");
+    fclose(fd);
+    return enabled;
+}
+#endif
+
+
+size_t get_hugepage_sz()
+{
+    static size_t hugepage_sz = 0;
+    if (hugepage_sz == 0) {
+        size_t sz = 2 * 1024 * 1024;
+#if defined(__linux__)
+        FILE *fd = fopen("/proc/meminfo", "r");
+        if (fd) {
+            char line[128];
+            unsigned long kb = 0;
+            while (fgets(line, sizeof(line), fd))
+                if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1 && kb > 0) {
+                    sz = (size_t)kb * 1024;
+                    break;
+                }
+            fclose(fd);
+        }
+#endif
+        hugepage_sz = sz;
+    }
+    return hugepage_sz;
+}
+
+
+int hugepage_malloc(void ** const sa, const size_t align, const size_t bytes, const hugepage_mode mode)
+{
+    *sa = NULL;
+    const size_t alignment = (align > sizeof(void *)) ? (align) : (sizeof(void *));
+
+    // Sizes are rounded up to whole huge pages only when huge pages are used,
+    // buffers then start on a huge page
+    const size_t hpage = get_hugepage_sz();
+    const size_t len = (bytes + hpage - 1) / hpage * hpage;
+
+#if defined(__linux__) && defined(MAP_HUGETLB)
+    if (mode == HUGEPAGE_HUGETLB && alignment <= hpage) {
+        void * const base = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) {
+            add_buffer(base, len, HUGEPAGE_HUGETLB);
+            *sa = base;
+            return 0;
+        }
+    }
+#endif
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // Transparent huge pages, released with free() as normal page buffers
+    if (mode != HUGEPAGE_NONE && thp_enabled()) {
+        int ierr = posix_memalign(sa, (alignment > hpage) ? (alignment) : (hpage), len);
+        if (ierr)
+            return ierr;
+        if (madvise(*sa, len, MADV_HUGEPAGE) == 0)
+            add_buffer(*sa, len, HUGEPAGE_THP);
+        return 0;
+    }
+#endif
+
+    // Normal pages
+    return posix_memalign(sa, alignment, bytes);
+}
+
+
+void hugepage_free(void * const sa)
+{
+    if (!sa)
+        return;
+    const hugepage_entry entry = find_buffer(sa, true);
+#if defined(__linux__)
+    if (entry.mode == HUGEPAGE_HUGETLB) {
+        munmap(sa, entry.bytes);
+        return;
+    }
+#endif
+    free(sa);
+}
+
+
+hugepage_mode get_hugepage_mode(const void * const sa)
+{ return (sa) ? (find_buffer(sa, false).mode) : (HUGEPAGE_NONE); }
+
+
+size_t get_hugepage_bytes(const void * const sa, const size_t bytes)
+{
+    size_t total = 0;
+#if defined(__linux__)
+    FILE *fd = fopen("/proc/self/smaps", "r");
+    if (!fd)
+        return 0;
+
+    const unsigned long lo = (unsigned long)sa;
+    const unsigned long hi = lo + bytes;
+    bool overlap = false;
+    char line[512];
+    while (fgets(line, sizeof(line), fd)) {
+        unsigned long start, end, kb;
+        // Mapping header "start-end perms ...", then "Field: value kB" lines
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2)
+            overlap = (start < hi && end > lo);
+        else if (overlap && (sscanf(line, "AnonHugePages: %lu kB", &kb) == 1 || sscanf(line, "Private_Hugetlb: %lu kB", &kb) == 1))
+            total += (size_t)kb * 1024;
+    }
+    fclose(fd);
+#else
+    (void)sa;
+    (void)bytes;
+#endif
+    return total;
+}
+
+
+}  // namespace gvl
@@ -0,0 +1,225 @@
+#include <stdio.h>
+#include <string.h>      // memset
+#include "numa.h"
+#include "sysconf.h"
+#include "dispatch.h"    // dispatch_chunk, get_dispatch_backend
+#include "affinity.h"    // get_affinity_cpu
+
+#if defined(__linux__)
+#   include <unistd.h>       // syscall, sysconf
+#   include <sched.h>        // sched_getcpu
+#   include <dirent.h>       // opendir
+#   include <sys/syscall.h>  // SYS_mbind, SYS_set_mempolicy
+#endif
+
+
+namespace gvl {
+
+
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_set_mempolicy)
+#   define NUMA_SYSCALLS 1
+
+// Memory policy modes and flags from linux/mempolicy.h
+const int MPOL_DEFAULT_ = 0;
+const int MPOL_PREFERRED_ = 1;
+const int MPOL_INTERLEAVE_ = 3;
+const unsigned int MPOL_MF_MOVE_ = 1 << 1;
+
+// Node mask of system calls
+const int32_t NUMA_MAX_NODES = 1024;
+const int32_t NUMA_MASK_LONGS = NUMA_MAX_NODES / (8 * sizeof(unsigned long));
+
+struct numa_mask {
+    unsigned long bits[NUMA_MASK_LONGS];
+};
+
+static void mask_set(numa_mask &mask, const int32_t node)
+{ mask.bits[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long))); }
+
+/*
+ *  Parse list of online nodes, e.g., "0-1,3"
+ *  \return Highest node + 1, 0 if not available
+ */
+static int32_t read_online_nodes(numa_mask &mask)
+{
+    memset(&mask, 0, sizeof(mask));
+    FILE *fd = fopen("/sys/devices/system/node/online", "r");
+    if (!fd)
+        return 0;
+
+    int32_t nnodes = 0;
+    int lo, hi;
+    char sep;
+    while (fscanf(fd, "%d", &lo) == 1) {
+        hi = lo;
+        sep = (char)fgetc(fd);
+        if (sep == '-') {
+            if (fscanf(fd, "%d", &hi) != 1)
+                break;
+            sep = (char)fgetc(fd);
+        }
+        for (int node = lo; node <= hi && node < NUMA_MAX_NODES; ++node) {
+            mask_set(mask, node);
+            nnodes = node + 1;
+        }
+        if (sep != ',')
+            break;
+    }
+    fclose(fd);
+    return nnodes;
+}
+
+// Preferred node for pages of [addr, addr + bytes), addr is page-aligned
+static int32_t bind_node(void * const addr, const size_t bytes, const int32_t node)
+{
+    numa_mask mask;
+    memset(&mask, 0, sizeof(mask));
+    mask_set(mask, node);
+    return (syscall(SYS_mbind, addr, bytes, MPOL_PREFERRED_, mask.bits, NUMA_MAX_NODES + 1, MPOL_MF_MOVE_) == 0) ? (0) : (-1);
+}
+#endif
+
+
+int32_t numa_num_nodes()
+{
+#if defined(NUMA_SYSCALLS)
+    numa_mask mask;
+    const int32_t nnodes = read_online_nodes(mask);
+    return (nnodes > 0) ? (nnodes) : (1);
+#else
+    return 1;
+#endif
+}
+
+
+int32_t numa_cpu_node(const int32_t cpu)
+{
+#if defined(NUMA_SYSCALLS)
+    char path[64];
+    sprintf(path, "/sys/devices/system/cpu/cpu%d", (int)cpu);
+    DIR *dir = opendir(path);
+    if (!dir)
+        return 0;
+
+    int node = 0;
+    const struct dirent *entry;
+    while ((entry = readdir(dir)))
+        if (sscanf(entry->d_name, "node%d", &node) == 1)
+            break;
+    closedir(dir);
+    return (int32_t)node;
+#else
+    (void)cpu;
+    return 0;
+#endif
+}
+
+
+int32_t numa_place(void * const sa, const size_t nelems, const size_t elem_bytes, const numa_policy policy, const int32_t nthreads)
+{
+#if defined(NUMA_SYSCALLS)
+    const size_t bytes = nelems * elem_bytes;
+    if (!sa || bytes == 0)
+        return -1;
+
+    const size_t page = SYSCONF::get_page_sz();
+    char * const base = (char *)((size_t)sa & ~(page - 1));
+    const size_t len = (((char *)sa + bytes) - base + page - 1) & ~(page - 1);
+
+    switch (policy) {
+        case NUMA_DEFAULT:
+            return (syscall(SYS_mbind, base, len, MPOL_DEFAULT_, NULL, 0, 0) == 0) ? (0) : (-1);
+
+        case NUMA_LOCAL:
+            return bind_node(base, len, numa_cpu_node(sched_getcpu()));
+
+        case NUMA_INTERLEAVE:
+        {
+            numa_mask mask;
+            const int32_t nnodes = read_online_nodes(mask);
+            if (nnodes == 0)
+                return -1;
+            return (syscall(SYS_mbind, base, len, MPOL_INTERLEAVE_, mask.bits, NUMA_MAX_NODES + 1, MPOL_MF_MOVE_) == 0) ? (0) : (-1);
+        }
+
+        case NUMA_PARTITION:
+        {
+            // Stolen ranges have no owner thread known in advance
+            if (get_dispatch_backend() == DISPATCH_STEALING)
+                return -1;
+
+            // Chunks of parallel_for(), OpenMP static schedule gives each
+            // thread a contiguous block, the first (nchunks % nt) get one more
+            const int32_t nt = (nthreads > 0) ? (nthreads) : (get_dispatch_threads());
+            const size_t chunk = dispatch_chunk(nelems, elem_bytes, nt);
+            const size_t nchunks = (nelems + chunk - 1) / chunk;
+            int32_t ierr = 0;
+
+            for (int32_t t = 0; t < nt; ++t) {
+                size_t q = nchunks / nt;
+                size_t r = nchunks % nt;
+                if ((size_t)t < r) {
+                    ++q;
+                    r = 0;
+                }
+                const size_t first = q * t + r;
+                const size_t lo = first * chunk;
+                const size_t hi = ((first + q) * chunk < nelems) ? ((first + q) * chunk) : (nelems);
+                if (lo >= hi)
+                    continue;
+
+                // Both ends round down, pages shared by two threads go to the higher one
+                char * const plo = (t == 0) ? (base) : ((char *)((size_t)((char *)sa + lo * elem_bytes) & ~(page - 1)));
+                char * const phi = (hi == nelems) ? (base + len) : ((char *)((size_t)((char *)sa + hi * elem_bytes) & ~(page - 1)));
+                if (plo >= phi)
+                    continue;
+
+                const int32_t cpu = get_affinity_cpu(t);
+                if (cpu < 0 || bind_node(plo, phi - plo, numa_cpu_node(cpu)))
+                    ierr = -1;
+            }
+            return ierr;
+        }
+    }
+    return -1;
+#else
+    (void)sa;
+    (void)nelems;
+    (void)elem_bytes;
+    (void)policy;
+    (void)nthreads;
+    return -1;
+#endif
+}
+
+
+int32_t numa_thread_policy(const numa_policy policy)
+{
+#if defined(NUMA_SYSCALLS)
+    switch (policy) {
+        case NUMA_DEFAULT:
+            return (syscall(SYS_set_mempolicy, MPOL_DEFAULT_, NULL, 0) == 0) ? (0) : (-1);
+
+        case NUMA_LOCAL:
+            // Preferred with empty node mask allocates on node of faulting CPU
+            return (syscall(SYS_set_mempolicy, MPOL_PREFERRED_, NULL, 0) == 0) ? (0) : (-1);
+
+        case NUMA_INTERLEAVE:
+        {
+            numa_mask mask;
+            if (read_online_nodes(mask) == 0)
+                return -1;
+            return (syscall(SYS_set_mempolicy, MPOL_INTERLEAVE_, mask.bits, NUMA_MAX_NODES + 1) == 0) ? (0) : (-1);
+        }
+
+        default:
+            return -1;
+    }
+#else
+    (void)policy;
+    return -1;
+#endif
+}
+
+
+}  // namespace gvl
@@ -0,0 +1,31 @@
+#include "sysconf.h"
+
+
+namespace gvl {
+
+
+/*
+ *  Single definition of system configuration, OpenMP is disabled until
+ *  SYSCONF::set_omp() is invoked
+ */
+bool SYSCONF::initialized = false;
+bool SYSCONF::omp_enabled = false;
+int32_t SYSCONF::omp_threads = 1;
+int32_t SYSCONF::ncores;
+size_t SYSCONF::L1l_sz;
+size_t SYSCONF::L1c_sz;
+size_t SYSCONF::L2l_sz;
+size_t SYSCONF::L2c_sz;
+size_t SYSCONF::L3c_sz;
+size_t SYSCONF::L1l_elems_i32;
+size_t SYSCONF::L1c_elems_i32;
+size_t SYSCONF::L2l_elems_i32;
+size_t SYSCONF::L2c_elems_i32;
+size_t SYSCONF::page_sz;
+
+
+// Read system values once at startup
+static const int32_t sysconf_init = SYSCONF::initSysconf();
+
+
+}  // namespace gvl
@@ -0,0 +1,282 @@
+#include <pthread.h>
+#include <sched.h>       // sched_yield
+#include "workpool.h"
+#include "affinity.h"    // get_affinity_cpu, pin_thread
+#include "compiler_attributes.h"
+
+
+namespace gvl {
+
+
+//! Maximum number of workers, including the calling thread
+const int32_t POOL_MAX_WORKERS = 256;
+
+/*
+ *  Deque capacity, power of 2. Ranges are split in halves so a worker holds
+ *  at most log2(n / grain) ranges, if full the range is run without splitting.
+ */
+const int64_t DEQUE_SIZE = 128;
+
+struct steal_range {
+    size_t lo;
+    size_t hi;
+};
+
+/*
+ *  Chase-Lev deque with fixed capacity, owner pushes/takes at bottom and
+ *  thieves steal at top (Le et al., "Correct and efficient work-stealing for
+ *  weak memory models", 2013). Top and bottom are in separate cache lines.
+ */
+struct steal_deque {
+    int64_t top SIMD_ALIGNED(64);
+    int64_t bottom SIMD_ALIGNED(64);
+    size_t lo[DEQUE_SIZE] SIMD_ALIGNED(64);
+    size_t hi[DEQUE_SIZE];
+};
+
+// Job shared by workers, written under wake_mutex before waking them
+struct steal_job {
+    size_t n;
+    size_t grain;
+    size_t leaf;
+    steal_fn fn;
+    const void *ctx;
+    int32_t nworkers;
+    size_t pending SIMD_ALIGNED(64);  // elements not yet processed
+};
+
+
+static steal_deque deques[POOL_MAX_WORKERS];
+static steal_job job;
+static uint64_t job_generation = 0;  // incremented for each job
+static int32_t job_active = 0;       // pool threads not done with current job
+static uint64_t start_generation[POOL_MAX_WORKERS];
+static int32_t pool_nthreads = 0;
+static dispatch_backend backend = DISPATCH_OPENMP;
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;  // one job at a time, pool growth
+static pthread_mutex_t wake_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake_cond = PTHREAD_COND_INITIALIZER;
+
+// Worker index of current thread during a job, -1 otherwise
+static __thread int32_t worker_id = -1;
+
+
+/***********
+ *  Deque  *
+ ***********/
+static bool deque_push(steal_deque &dq, const size_t lo, const size_t hi)
+{
+    const int64_t b = __atomic_load_n(&dq.bottom, __ATOMIC_RELAXED);
+    const int64_t t = __atomic_load_n(&dq.top, __ATOMIC_ACQUIRE);
+    if (b - t >= DEQUE_SIZE)
+        return false;
+    __atomic_store_n(&dq.lo[b & (DEQUE_SIZE - 1)], lo, __ATOMIC_RELAXED);
+    __atomic_store_n(&dq.hi[b & (DEQUE_SIZE - 1)], hi, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&dq.bottom, b + 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+static bool deque_take(steal_deque &dq, steal_range &r)
+{
+    const int64_t b = __atomic_load_n(&dq.bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&dq.bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t t = __atomic_load_n(&dq.top, __ATOMIC_RELAXED);
+
+    if (t > b) {
+        __atomic_store_n(&dq.bottom, b + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    r.lo = __atomic_load_n(&dq.lo[b & (DEQUE_SIZE - 1)], __ATOMIC_RELAXED);
+    r.hi = __atomic_load_n(&dq.hi[b & (DEQUE_SIZE - 1)], __ATOMIC_RELAXED);
+    if (t == b) {
+        // Last range, race against thieves
+        const bool won = __atomic_compare_exchange_n(&dq.top, &t, t + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+        __atomic_store_n(&dq.bottom, b + 1, __ATOMIC_RELAXED);
+        return won;
+    }
+    return true;
+}
+
+static bool deque_steal(steal_deque &dq, steal_range &r)
+{
+    int64_t t = __atomic_load_n(&dq.top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    const int64_t b = __atomic_load_n(&dq.bottom, __ATOMIC_ACQUIRE);
+    if (t >= b)
+        return false;
+
+    r.lo = __atomic_load_n(&dq.lo[t & (DEQUE_SIZE - 1)], __ATOMIC_RELAXED);
+    r.hi = __atomic_load_n(&dq.hi[t & (DEQUE_SIZE - 1)], __ATOMIC_RELAXED);
+    return __atomic_compare_exchange_n(&dq.top, &t, t + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+
+/************
+ *  Worker  *
+ ************/
+// Run a range splitting it in halves for thieves, then drain own deque
+static void run_range(steal_deque &dq, steal_range r)
+{
+    do {
+        while (r.hi - r.lo > job.leaf) {
+            const size_t mid = r.lo + ((r.hi - r.lo) / (2 * job.grain)) * job.grain;
+            if (mid == r.lo || !deque_push(dq, mid, r.hi))
+                break;
+            r.hi = mid;
+        }
+        if (r.lo < r.hi) {
+            job.fn(job.ctx, r.lo, r.hi);
+            __atomic_sub_fetch(&job.pending, r.hi - r.lo, __ATOMIC_ACQ_REL);
+        }
+    } while (deque_take(dq, r));
+}
+
+/*
+ *  Push the share of each worker on its deque before workers are woken, so
+ *  shares of workers that have not started yet can be stolen
+ */
+static void push_shares()
+{
+    const size_t nw = (size_t)job.nworkers;
+    const size_t share = ((job.n + nw - 1) / nw + job.grain - 1) / job.grain * job.grain;
+    for (size_t id = 0; id < nw; ++id) {
+        const size_t lo = (id * share < job.n) ? (id * share) : (job.n);
+        const size_t hi = (lo + share < job.n) ? (lo + share) : (job.n);
+        if (lo < hi)
+            deque_push(deques[id], lo, hi);
+    }
+}
+
+// Run own share of the job if not stolen, then steal from random victims until all elements are processed
+static void steal_work(const int32_t id)
+{
+    steal_range r;
+    if (deque_take(deques[id], r))
+        run_range(deques[id], r);
+
+    uint32_t seed = (uint32_t)id * 2654435761u + 1u;
+    while (__atomic_load_n(&job.pending, __ATOMIC_ACQUIRE) > 0) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        int32_t victim = (int32_t)(seed % (uint32_t)(job.nworkers - 1));
+        if (victim >= id)
+            ++victim;
+        if (deque_steal(deques[victim], r))
+            run_range(deques[id], r);
+        else
+            sched_yield();
+    }
+}
+
+static void *pool_worker(void *arg)
+{
+    const int32_t id = (int32_t)(intptr_t)arg;
+    uint64_t seen = start_generation[id];
+    int32_t pinned_cpu = -1;
+
+    for (;;) {
+        pthread_mutex_lock(&wake_mutex);
+        while (job_generation == seen)
+            pthread_cond_wait(&wake_cond, &wake_mutex);
+        seen = job_generation;
+        const bool join = (id < job.nworkers);
+        pthread_mutex_unlock(&wake_mutex);
+
+        if (join) {
+            // Follow placement of set_affinity(), worker i runs as thread i
+            const int32_t cpu = get_affinity_cpu(id);
+            if (cpu >= 0 && cpu != pinned_cpu && pin_thread(cpu) == 0)
+                pinned_cpu = cpu;
+
+            worker_id = id;
+            steal_work(id);
+            worker_id = -1;
+            __atomic_sub_fetch(&job_active, 1, __ATOMIC_RELEASE);
+        }
+    }
+    return NULL;
+}
+
+// Create pool threads up to \c nthreads, invoked with pool_mutex held
+static void pool_grow(const int32_t nthreads)
+{
+    while (pool_nthreads < nthreads) {
+        const int32_t id = pool_nthreads + 1;
+        start_generation[id] = job_generation;
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, pool_worker, (void *)(intptr_t)id))
+            break;
+        pthread_detach(thread);
+        __atomic_store_n(&pool_nthreads, id, __ATOMIC_RELEASE);
+    }
+}
+
+
+/*********
+ *  API  *
+ *********/
+void steal_run(const size_t n, const size_t grain, const size_t leaf, steal_fn fn, const void *ctx, const int32_t nthreads)
+{
+    if (n == 0)
+        return;
+
+    int32_t nt = (nthreads < POOL_MAX_WORKERS) ? (nthreads) : (POOL_MAX_WORKERS);
+    if (nt <= 1 || worker_id >= 0) {
+        fn(ctx, 0, n);
+        return;
+    }
+
+    pthread_mutex_lock(&pool_mutex);
+    pool_grow(nt - 1);
+    if (nt > pool_nthreads + 1)
+        nt = pool_nthreads + 1;
+    if (nt <= 1) {
+        pthread_mutex_unlock(&pool_mutex);
+        fn(ctx, 0, n);
+        return;
+    }
+
+    pthread_mutex_lock(&wake_mutex);
+    job.n = n;
+    job.grain = (grain > 0) ? (grain) : (1);
+    job.leaf = (leaf > job.grain) ? (leaf) : (job.grain);
+    job.fn = fn;
+    job.ctx = ctx;
+    job.nworkers = nt;
+    job.pending = n;
+    push_shares();
+    job_active = nt - 1;
+    ++job_generation;
+    pthread_cond_broadcast(&wake_cond);
+    pthread_mutex_unlock(&wake_mutex);
+
+    worker_id = 0;
+    steal_work(0);
+    worker_id = -1;
+
+    // Workers may still be leaving the job, deques and job are reused by next call
+    while (__atomic_load_n(&job_active, __ATOMIC_ACQUIRE) > 0)
+        sched_yield();
+
+    pthread_mutex_unlock(&pool_mutex);
+}
+
+
+int32_t get_pool_threads()
+{ return __atomic_load_n(&pool_nthreads, __ATOMIC_ACQUIRE); }
+
+
+void set_dispatch_backend(const dispatch_backend b)
+{ backend = b; }
+
+
+dispatch_backend get_dispatch_backend()
+{ return backend; }
+
+
+}  // namespace gvl
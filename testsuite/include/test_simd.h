@@ -67,6 +67,120 @@
  *  Shuffle 16/32/64-bit integers and single/double-precision floating-point numbers
  *  \return Test result, 0 = PASSED and # = FAILED
  *
+ *
+ *  \fn int test_simd_cmp()
+ *  \brief Compare test cases
+ *  Compare and blend 32-bit integers and single/double-precision floating-point numbers
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_expr()
+ *  \brief Array expression test cases
+ *  Fused array expressions of 32-bit integers and single/double-precision floating-point numbers
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_kernels()
+ *  \brief Array kernel test cases
+ *  Add/sub/mul/fma/scale/axpy arrays of 8/16/32/64-bit integers and single/double-precision floating-point numbers
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_dispatch()
+ *  \brief Multi-core dispatcher test cases
+ *  Partition ranges in SIMD/cache-line aligned chunks among threads
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_affinity()
+ *  \brief Thread placement test cases
+ *  Pin threads with compact/scatter/one-per-core policies and explicit CPU lists
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_workpool()
+ *  \brief Work-stealing pool test cases
+ *  Split ranges of irregular cost among threads with work stealing
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_numa()
+ *  \brief NUMA placement test cases
+ *  Local/interleave/partition page placement and parallel first touch
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_hugepage()
+ *  \brief Huge page test cases
+ *  Allocate buffers with transparent/reserved huge pages and fallbacks
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_arena()
+ *  \brief Arena and pool allocator test cases
+ *  Scratch buffers from thread arenas and size-class pools for arrays and kernels
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_aligned_vector()
+ *  \brief Aligned vector test cases
+ *  Aligned vectors with zeroed SIMD padding and aligned allocator for standard containers
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_soa()
+ *  \brief Structure-of-arrays test cases
+ *  SoA and AoSoA records with field vectors, dense push/erase and zeroed padding
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_interleave()
+ *  \brief Interleave test cases
+ *  Deinterleave/interleave records of 2/3/4 32/64-bit floating-point, 32-bit and 8-bit integer components
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_transpose()
+ *  \brief Transpose test cases
+ *  Register tile transposes and cache-blocked transpose of 32/64-bit floating-point matrices
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_batched()
+ *  \brief Batched small matrices test cases
+ *  Compact layout pack/unpack and batched matrix-vector products of 32/64-bit floating-point matrices
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_gemm()
+ *  \brief Matrix multiply test cases
+ *  Packed and register-blocked matrix-matrix products of 32/64-bit floating-point matrices
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_mat()
+ *  \brief Fixed-size matrix test cases
+ *  Products, transpose, inverse and determinant of 2x2 to 8x8 32/64-bit floating-point matrices
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_spmv()
+ *  \brief Sparse matrix-vector multiply test cases
+ *  CSR and SELL-C-sigma conversion and products of 32/64-bit floating-point sparse matrices
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_stencil()
+ *  \brief Stencil test cases
+ *  Star stencils with coefficients and functors on 1D/2D/3D grids of 32/64-bit floating-point values, with and without temporal blocking
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
+ *
+ *  \fn int test_simd_scan()
+ *  \brief Prefix sum test cases
+ *  Inclusive and exclusive scans of 32/64-bit integer and floating-point arrays, serial and two-pass multithreaded
+ *  \return Test result, 0 = PASSED and # = FAILED
+ *
  *    \}
  *
  *  \}
@@ -82,6 +196,25 @@ int test_simd_shift();
 int test_simd_merge();
 int test_simd_pack();
 int test_simd_shuffle();
+int test_simd_cmp();
+int test_simd_expr();
+int test_simd_kernels();
+int test_simd_dispatch();
+int test_simd_affinity();
+int test_simd_workpool();
+int test_simd_numa();
+int test_simd_hugepage();
+int test_simd_arena();
+int test_simd_aligned_vector();
+int test_simd_soa();
+int test_simd_interleave();
+int test_simd_transpose();
+int test_simd_batched();
+int test_simd_gemm();
+int test_simd_mat();
+int test_simd_spmv();
+int test_simd_stencil();
+int test_simd_scan();
 //int test_simd_cvt_i32_fp();
 //int test_simd_cvt_u64_fp();
 //int test_simd_set_32();
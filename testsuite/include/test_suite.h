@@ -36,6 +36,25 @@ struct TEST_T TESTS[] =
     { test_simd_merge, "Merge low/high parts from pair of integers/floating-point numbers" },
     { test_simd_pack, "Pack 8/16/32-bit integers and single-precision floating-point numbers" },
     { test_simd_shuffle, "Shuffle 16/32/64-bit integers and single/double-precision floating-point numbers" },
+    { test_simd_cmp, "Compare and blend 32-bit integers and single/double-precision floating-point numbers" },
+    { test_simd_expr, "Fused array expressions of 32-bit integers and single/double-precision floating-point numbers" },
+    { test_simd_kernels, "Add/sub/mul/fma/scale/axpy arrays of 8/16/32/64-bit integers and single/double-precision floating-point numbers" },
+    { test_simd_dispatch, "Partition ranges in SIMD/cache-line aligned chunks among threads" },
+    { test_simd_affinity, "Pin threads with compact/scatter/one-per-core policies and explicit CPU lists" },
+    { test_simd_workpool, "Split ranges of irregular cost among threads with work stealing" },
+    { test_simd_numa, "Local/interleave/partition page placement and parallel first touch" },
+    { test_simd_hugepage, "Allocate buffers with transparent/reserved huge pages and fallbacks" },
+    { test_simd_arena, "Scratch buffers from thread arenas and size-class pools for arrays and kernels" },
+    { test_simd_aligned_vector, "Aligned vectors with zeroed SIMD padding and aligned allocator for standard containers" },
+    { test_simd_soa, "SoA and AoSoA records with field vectors, dense push/erase and zeroed padding" },
+    { test_simd_interleave, "Deinterleave/interleave records of 2/3/4 32/64-bit floating-point, 32-bit and 8-bit integer components" },
+    { test_simd_transpose, "Register tile and cache-blocked transpose of 32/64-bit floating-point matrices" },
+    { test_simd_batched, "Compact layout pack/unpack and batched matrix-vector products of 32/64-bit floating-point matrices" },
+    { test_simd_gemm, "Packed and register-blocked matrix-matrix products of 32/64-bit floating-point matrices" },
+    { test_simd_mat, "Products, transpose, inverse and determinant of 2x2 to 8x8 32/64-bit floating-point matrices" },
+    { test_simd_spmv, "CSR and SELL-C-sigma conversion and products of 32/64-bit floating-point sparse matrices" },
+    { test_simd_stencil, "Star stencils with coefficients and functors on 1D/2D/3D grids of 32/64-bit floating-point values, with and without temporal blocking" },
+    { test_simd_scan, "Inclusive and exclusive scans of 32/64-bit integer and floating-point arrays, serial and two-pass multithreaded" },
     //{ test_simd_cvt_i32_fp, "Convert 32-bit integers to 32/64-bit floating-point" },
     //{ test_simd_cvt_u64_fp, "Convert unsigned 64-bit integers to 32/64-bit floating-point" },
     //{ test_simd_set_32, "Broadcast 32-bit integers to all elements" },
@@ -4,11 +4,38 @@
 
 #include <stdio.h>
 #include <stdlib.h>      // free, NULL
+#include <string.h>      // memcpy
 #include <stdint.h>
 #include <math.h>        // sqrt, abs, floor, ceil
 #include <limits.h>      // limits of fundamental integral types
+#if defined(__linux__)
+#include <sched.h>       // sched_getcpu
+#endif
 #include "test_utils.h"
 #include "test_simd.h"
+#include "vutils.h"       // scalar_malloc
+#include "aligned_vector.h"
+#include "sysconf.h"
+#include "dispatch.h"
+#include "affinity.h"
+#include "workpool.h"
+#include "numa.h"
+#include "hugepage.h"
+#include "arena.h"
+#include "vec.h"
+#include "expr.h"
+#include "kernels.h"
+#include "soa.h"
+#include "transpose.h"
+#include "batched.h"
+#include "gemm.h"
+#include "mat.h"
+#include "spmv.h"
+#include "stencil.h"
+#include "scan.h"
+#include <vector>
+#include <limits>      // numeric_limits
+#include <algorithm>   // fill
 
 
 // Deallocate dynamic memory and nullify pointer
@@ -1256,14 +1283,14 @@ int test_simd_shift()
 
         SIMD_INT va = simd_load(A);
 
-        for (int32_t shft = 0; shft <= num_elems; ++shft) {
+        // Each 128-bit lane of wider registers is shifted independently
+        const int lane_elems = (num_elems < 16) ? (num_elems) : (16);
+        for (int32_t shft = 0; shft <= lane_elems; ++shft) {
             SIMD_INT vc = simd_sll_128(va, shft);
             simd_store(C1, vc);
 
-            for (int i = shft; i < num_elems; ++i)
-                C2[i] = A[i - shft];
-            for (int i = 0; i < shft; ++i)
-                C2[i] = 0;
+            for (int i = 0; i < num_elems; ++i)
+                C2[i] = ((i % lane_elems) >= shft) ? (A[i - shft]) : (0);
 
             test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
         }
@@ -1365,14 +1392,14 @@ int test_simd_shift()
 
         SIMD_INT va = simd_load(A);
 
-        for (int32_t shft = 0; shft <= num_elems; ++shft) {
+        // Each 128-bit lane of wider registers is shifted independently
+        const int lane_elems = (num_elems < 16) ? (num_elems) : (16);
+        for (int32_t shft = 0; shft <= lane_elems; ++shft) {
             SIMD_INT vc = simd_srl_128(va, shft);
             simd_store(C1, vc);
 
-            for (int i = 0; i < (num_elems - shft); ++i)
-                C2[i] = A[i + shft];
-            for (int i = num_elems - shft; i < num_elems; ++i)
-                C2[i] = 0;
+            for (int i = 0; i < num_elems; ++i)
+                C2[i] = ((i % lane_elems) + shft < lane_elems) ? (A[i + shft]) : (0);
 
             test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
         }
@@ -2033,7 +2060,7 @@ int test_simd_shuffle()
         SIMD_DBL vc = simd_shuffle(va, XCHG64);
         simd_store(C1, vc);
 
-        for (int i = 0; i < num_elems; i+=4) {
+        for (int i = 0; i < num_elems; i+=2) {
             C2[i] = A[i + 1];
             C2[i + 1] = A[i];
         }
@@ -2101,6 +2128,1691 @@ int test_simd_shuffle()
 }
 
 
+int test_simd_cmp()
+{
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+
+    {
+        const int num_elems = SIMD_STREAMS_32;
+        const TEST_TYPES test_type = TEST_I32;
+        int32_t *A = NULL, *B = NULL, *C1 = NULL, *C2 = NULL;
+
+        create_test_array(test_type, (void **)&A, num_elems, alignment);
+        create_test_array(test_type, (void **)&B, num_elems, alignment);
+        create_test_array(test_type, (void **)&C1, num_elems, alignment);
+        create_test_array(test_type, (void **)&C2, num_elems, alignment);
+
+        // Force some equal elements
+        for (int i = 0; i < num_elems; i+=2)
+            B[i] = A[i];
+
+        SIMD_INT va = simd_load(A);
+        SIMD_INT vb = simd_load(B);
+        SIMD_INT vc = simd_cmpeq_32(va, vb);
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] == B[i]) ? -1 : 0;
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        vc = simd_cmpgt_i32(va, vb);
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] > B[i]) ? -1 : 0;
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        vc = simd_blend(va, vb, simd_cmplt_i32(va, vb));
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] < B[i]) ? B[i] : A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        FREE(A);
+        FREE(B);
+        FREE(C1);
+        FREE(C2);
+    }
+
+    {
+        const int num_elems = SIMD_STREAMS_32;
+        const TEST_TYPES test_type = TEST_FLT;
+        float *A = NULL, *B = NULL, *C1 = NULL, *C2 = NULL;
+
+        create_test_array(test_type, (void **)&A, num_elems, alignment);
+        create_test_array(test_type, (void **)&B, num_elems, alignment);
+        create_test_array(test_type, (void **)&C1, num_elems, alignment);
+        create_test_array(test_type, (void **)&C2, num_elems, alignment);
+
+        // Force some equal elements
+        for (int i = 0; i < num_elems; i+=2)
+            B[i] = A[i];
+
+        SIMD_FLT va = simd_load(A);
+        SIMD_FLT vb = simd_load(B);
+        SIMD_FLT vc = simd_blend(va, vb, simd_cmpeq(va, vb));
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] == B[i]) ? B[i] : A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        vc = simd_blend(va, vb, simd_cmpneq(va, vb));
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] != B[i]) ? B[i] : A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        vc = simd_blend(va, vb, simd_cmplt(va, vb));
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] < B[i]) ? B[i] : A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        vc = simd_blend(va, vb, simd_cmple(va, vb));
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] <= B[i]) ? B[i] : A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        vc = simd_blend(va, vb, simd_cmpgt(va, vb));
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] > B[i]) ? B[i] : A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        vc = simd_blend(va, vb, simd_cmpge(va, vb));
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] >= B[i]) ? B[i] : A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        FREE(A);
+        FREE(B);
+        FREE(C1);
+        FREE(C2);
+    }
+
+    {
+        const int num_elems = SIMD_STREAMS_64;
+        const TEST_TYPES test_type = TEST_DBL;
+        double *A = NULL, *B = NULL, *C1 = NULL, *C2 = NULL;
+
+        create_test_array(test_type, (void **)&A, num_elems, alignment);
+        create_test_array(test_type, (void **)&B, num_elems, alignment);
+        create_test_array(test_type, (void **)&C1, num_elems, alignment);
+        create_test_array(test_type, (void **)&C2, num_elems, alignment);
+
+        // Force some equal elements
+        for (int i = 0; i < num_elems; i+=2)
+            B[i] = A[i];
+
+        SIMD_DBL va = simd_load(A);
+        SIMD_DBL vb = simd_load(B);
+        SIMD_DBL vc = simd_blend(va, vb, simd_cmpeq(va, vb));
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] == B[i]) ? B[i] : A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        vc = simd_blend(va, vb, simd_cmpneq(va, vb));
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] != B[i]) ? B[i] : A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        vc = simd_blend(va, vb, simd_cmplt(va, vb));
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] < B[i]) ? B[i] : A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        vc = simd_blend(va, vb, simd_cmple(va, vb));
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] <= B[i]) ? B[i] : A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        vc = simd_blend(va, vb, simd_cmpgt(va, vb));
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] > B[i]) ? B[i] : A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        vc = simd_blend(va, vb, simd_cmpge(va, vb));
+        simd_store(C1, vc);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = (A[i] >= B[i]) ? B[i] : A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        FREE(A);
+        FREE(B);
+        FREE(C1);
+        FREE(C2);
+    }
+
+    return test_result;
+}
+
+
+int test_simd_expr()
+{
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+
+    {
+        // Views offset by one element exercise peeling and remainder
+        const int num_elems = 3 * SIMD_STREAMS_32 + 1;
+        const TEST_TYPES test_type = TEST_I32;
+        int32_t *A = NULL, *B = NULL, *C = NULL, *E = NULL, *D1 = NULL, *D2 = NULL;
+
+        create_test_array(test_type, (void **)&A, num_elems, alignment);
+        create_test_array(test_type, (void **)&B, num_elems, alignment);
+        create_test_array(test_type, (void **)&C, num_elems, alignment);
+        create_test_array(test_type, (void **)&E, num_elems, alignment);
+        create_test_array(test_type, (void **)&D1, num_elems + 1, alignment);
+        create_test_array(test_type, (void **)&D2, num_elems, alignment);
+
+        // Small integer values keep results exact with or without FMA
+        for (int i = 0; i < num_elems; ++i) {
+            A[i] = (int32_t)(i % 5);
+            B[i] = (int32_t)(i % 3);
+            C[i] = (int32_t)(i % 11);
+            E[i] = (int32_t)(i % 4);
+        }
+
+        gvl::varray<int32_t> a(A, num_elems), b(B, num_elems), c(C, num_elems), e(E, num_elems);
+        gvl::varray<int32_t> d(D1 + 1, num_elems);
+        d = a + b * c - e;
+        d += 2 * a;
+
+        for (int i = 0; i < num_elems; ++i)
+            D2[i] = A[i] + B[i] * C[i] - E[i] + 2 * A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)(D1 + 1), (void *)D2, num_elems);
+
+        FREE(A);
+        FREE(B);
+        FREE(C);
+        FREE(E);
+        FREE(D1);
+        FREE(D2);
+    }
+
+    {
+        // Views offset by one element exercise peeling and remainder
+        const int num_elems = 3 * SIMD_STREAMS_32 + 1;
+        const TEST_TYPES test_type = TEST_FLT;
+        float *A = NULL, *B = NULL, *C = NULL, *E = NULL, *D1 = NULL, *D2 = NULL;
+
+        create_test_array(test_type, (void **)&A, num_elems, alignment);
+        create_test_array(test_type, (void **)&B, num_elems, alignment);
+        create_test_array(test_type, (void **)&C, num_elems, alignment);
+        create_test_array(test_type, (void **)&E, num_elems, alignment);
+        create_test_array(test_type, (void **)&D1, num_elems + 1, alignment);
+        create_test_array(test_type, (void **)&D2, num_elems, alignment);
+
+        // Small integer values keep results exact with or without FMA
+        for (int i = 0; i < num_elems; ++i) {
+            A[i] = (float)(i % 5);
+            B[i] = (float)(i % 3);
+            C[i] = (float)(i % 11);
+            E[i] = (float)(i % 4);
+        }
+
+        gvl::varray<float> a(A, num_elems), b(B, num_elems), c(C, num_elems), e(E, num_elems);
+        gvl::varray<float> d(D1 + 1, num_elems);
+        d = a + b * c - e;
+        d += 2 * a;
+
+        for (int i = 0; i < num_elems; ++i)
+            D2[i] = A[i] + B[i] * C[i] - E[i] + 2 * A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)(D1 + 1), (void *)D2, num_elems);
+
+        FREE(A);
+        FREE(B);
+        FREE(C);
+        FREE(E);
+        FREE(D1);
+        FREE(D2);
+    }
+
+    {
+        // Views offset by one element exercise peeling and remainder
+        const int num_elems = 3 * SIMD_STREAMS_64 + 1;
+        const TEST_TYPES test_type = TEST_DBL;
+        double *A = NULL, *B = NULL, *C = NULL, *E = NULL, *D1 = NULL, *D2 = NULL;
+
+        create_test_array(test_type, (void **)&A, num_elems, alignment);
+        create_test_array(test_type, (void **)&B, num_elems, alignment);
+        create_test_array(test_type, (void **)&C, num_elems, alignment);
+        create_test_array(test_type, (void **)&E, num_elems, alignment);
+        create_test_array(test_type, (void **)&D1, num_elems + 1, alignment);
+        create_test_array(test_type, (void **)&D2, num_elems, alignment);
+
+        // Small integer values keep results exact with or without FMA
+        for (int i = 0; i < num_elems; ++i) {
+            A[i] = (double)(i % 5);
+            B[i] = (double)(i % 3);
+            C[i] = (double)(i % 11);
+            E[i] = (double)(i % 4);
+        }
+
+        gvl::varray<double> a(A, num_elems), b(B, num_elems), c(C, num_elems), e(E, num_elems);
+        gvl::varray<double> d(D1 + 1, num_elems);
+        d = a + b * c - e;
+        d += 2 * a;
+
+        for (int i = 0; i < num_elems; ++i)
+            D2[i] = A[i] + B[i] * C[i] - E[i] + 2 * A[i];
+
+        test_result += validate_test_arrays(test_type, (void *)(D1 + 1), (void *)D2, num_elems);
+
+        FREE(A);
+        FREE(B);
+        FREE(C);
+        FREE(E);
+        FREE(D1);
+        FREE(D2);
+    }
+
+    return test_result;
+}
+
+
+// Reference a * b + c, integers wrap around like SIMD lanes (no signed overflow)
+template <typename T>
+static T test_kernel_madd(const T a, const T b, const T c)
+{
+    if (std::numeric_limits<T>::is_integer)
+        return (T)((uint64_t)a * (uint64_t)b + (uint64_t)c);
+    return (T)(a * b + c);
+}
+
+// Kernels of type T against scalar loops, outputs and inputs at different offsets
+// exercise every peel/loop/tail version
+template <typename T>
+static int test_kernels(const TEST_TYPES test_type)
+{
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+    const int num_elems = 4 * (int)(SIMD_WIDTH_BYTES / sizeof(T)) + 3;
+    T *A = NULL, *B = NULL, *D = NULL, *C1 = NULL, *C2 = NULL;
+
+    create_test_array(test_type, (void **)&A, num_elems + 2, alignment);
+    create_test_array(test_type, (void **)&B, num_elems + 2, alignment);
+    create_test_array(test_type, (void **)&D, num_elems + 2, alignment);
+    create_test_array(test_type, (void **)&C1, num_elems + 2, alignment);
+    create_test_array(test_type, (void **)&C2, num_elems, alignment);
+
+    // Small integer values keep results exact with or without FMA
+    for (int i = 0; i < num_elems + 2; ++i) {
+        A[i] = (T)(i % 5);
+        B[i] = (T)(i % 3);
+        D[i] = (T)(i % 7);
+    }
+
+    // Integers span every byte, so products carry across bytes of each lane
+    if (std::numeric_limits<T>::is_integer) {
+        const uint64_t m = (uint64_t)0x01030507 * (uint64_t)0x0B0D1113;
+        for (int i = 0; i < num_elems + 2; ++i) {
+            A[i] = (T)(m * (uint64_t)(i + 1));
+            B[i] = (T)((m * (uint64_t)(i + 3)) >> 3);
+            D[i] = (T)((m * (uint64_t)(i + 7)) >> 5);
+        }
+    }
+
+    for (int offs = 0; offs < 3; ++offs) {
+        const T *pA = A + offs, *pB = B + (offs & 1), *pD = D + offs;
+        T *pC1 = C1 + (2 - offs);
+
+        gvl::add(pC1, pA, pB, num_elems);
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = test_kernel_madd(pA[i], (T)1, pB[i]);
+        test_result += validate_test_arrays(test_type, (void *)pC1, (void *)C2, num_elems);
+
+        gvl::sub(pC1, pA, pB, num_elems);
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = test_kernel_madd(pB[i], (T)-1, pA[i]);
+        test_result += validate_test_arrays(test_type, (void *)pC1, (void *)C2, num_elems);
+
+        gvl::mul(pC1, pA, pB, num_elems);
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = test_kernel_madd(pA[i], pB[i], (T)0);
+        test_result += validate_test_arrays(test_type, (void *)pC1, (void *)C2, num_elems);
+
+        gvl::fma(pC1, pA, pB, pD, num_elems);
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = test_kernel_madd(pA[i], pB[i], pD[i]);
+        test_result += validate_test_arrays(test_type, (void *)pC1, (void *)C2, num_elems);
+
+        gvl::scale(pC1, (T)3, pA, num_elems);
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = test_kernel_madd((T)3, pA[i], (T)0);
+        test_result += validate_test_arrays(test_type, (void *)pC1, (void *)C2, num_elems);
+
+        gvl::axpy(pC1, (T)3, pA, pD, num_elems);
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = test_kernel_madd((T)3, pA[i], pD[i]);
+        test_result += validate_test_arrays(test_type, (void *)pC1, (void *)C2, num_elems);
+    }
+
+    FREE(A);
+    FREE(B);
+    FREE(D);
+    FREE(C1);
+    FREE(C2);
+
+    return test_result;
+}
+
+int test_simd_kernels()
+{
+    int test_result = 0;
+
+    test_result += test_kernels<uint8_t>(TEST_U8);
+    test_result += test_kernels<uint16_t>(TEST_U16);
+    test_result += test_kernels<uint32_t>(TEST_U32);
+    test_result += test_kernels<uint64_t>(TEST_U64);
+    test_result += test_kernels<int8_t>(TEST_I8);
+    test_result += test_kernels<int16_t>(TEST_I16);
+    test_result += test_kernels<int32_t>(TEST_I32);
+    test_result += test_kernels<int64_t>(TEST_I64);
+    test_result += test_kernels<float>(TEST_FLT);
+    test_result += test_kernels<double>(TEST_DBL);
+
+    return test_result;
+}
+
+
+// Marks elements of a range, checks that ranges start at a SIMD/cache-line multiple
+struct test_dispatch_kernel
+{
+    typedef float stype;
+    int32_t *marks;
+    int32_t *misaligned;
+    size_t grain;
+
+    void operator()(const size_t lo, const size_t hi) const
+    {
+        if (lo % grain)
+            misaligned[lo / grain] = 1;
+        for (size_t i = lo; i < hi; ++i)
+            marks[i] += 1;
+    }
+};
+
+int test_simd_dispatch()
+{
+
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+
+    {
+        // Several chunks per thread and a partial last chunk
+        const size_t grain = gvl::dispatch_grain(sizeof(float));
+        const int num_elems = (int)(gvl::dispatch_chunk(0, sizeof(float), 1) * 3 + grain / 2 + 1);
+        const int num_chunks = num_elems / (int)grain + 1;
+        const TEST_TYPES test_type = TEST_I32;
+        int32_t *C1 = NULL, *C2 = NULL, *M = NULL;
+
+        create_test_array(test_type, (void **)&C1, num_elems, alignment);
+        create_test_array(test_type, (void **)&C2, num_elems, alignment);
+        create_test_array(test_type, (void **)&M, num_chunks, alignment);
+
+        for (int i = 0; i < num_elems; ++i) {
+            C1[i] = 0;
+            C2[i] = 1;
+        }
+        for (int i = 0; i < num_chunks; ++i)
+            M[i] = 0;
+
+        test_dispatch_kernel k;
+        k.marks = C1;
+        k.misaligned = M;
+        k.grain = grain;
+        gvl::parallel_for(num_elems, k, 4);
+
+        // Every element is processed exactly once
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        for (int i = 0; i < num_chunks; ++i)
+            test_result += M[i];
+
+        FREE(C1);
+        FREE(C2);
+        FREE(M);
+    }
+
+    return test_result;
+}
+
+
+int test_simd_affinity()
+{
+    int test_result = 0;
+
+#if defined(__linux__)
+    // Every policy pins all requested threads to CPUs of the process mask
+    {
+        const gvl::affinity_policy policies[] = { gvl::AFFINITY_COMPACT, gvl::AFFINITY_SCATTER, gvl::AFFINITY_CORES };
+        for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]); ++p) {
+            const int32_t nthreads = 2;
+            test_result += (gvl::set_affinity(policies[p], nthreads) != nthreads);
+            test_result += (gvl::get_affinity_threads() != nthreads);
+            for (int32_t t = 0; t < nthreads; ++t)
+                test_result += (gvl::get_affinity_cpu(t) < 0);
+        }
+    }
+
+    // Explicit list keeps allowed CPUs only, calling thread runs on its CPU
+    {
+        const int32_t cpu = sched_getcpu();
+        const int32_t cpus[] = { -1, cpu };
+        test_result += (gvl::set_affinity(gvl::AFFINITY_LIST, 1, cpus, 2) != 1);
+        test_result += (gvl::get_affinity_cpu(0) != cpu);
+        test_result += (gvl::get_affinity_cpu(1) != -1);
+        test_result += (sched_getcpu() != cpu);
+        test_result += (gvl::set_affinity(gvl::AFFINITY_LIST, 1, cpus, 1) != 0);
+    }
+#endif
+
+    return test_result;
+}
+
+// Irregular kernel, cost grows with index, nested calls run serially on the worker
+struct test_steal_kernel
+{
+    typedef float stype;
+    int32_t *marks;
+    int32_t *misaligned;
+    size_t grain;
+    bool nested;
+
+    void operator()(const size_t lo, const size_t hi) const
+    {
+        if (lo % grain)
+            misaligned[lo / grain] = 1;
+        if (nested) {
+            test_steal_kernel k = *this;
+            k.marks = marks + lo;
+            k.misaligned = misaligned + lo / grain;
+            k.nested = false;
+            gvl::steal_for(hi - lo, k, 2);
+            return;
+        }
+        for (size_t i = lo; i < hi; ++i) {
+            volatile size_t spin = 0;
+            for (size_t j = 0; j < (i & 255); ++j)
+                spin += j;
+            marks[i] += 1;
+        }
+    }
+};
+
+int test_simd_workpool()
+{
+    int test_result = 0;
+    const int alignment = SIMD_WIDTH_BYTES;
+
+    {
+        const size_t grain = gvl::dispatch_grain(sizeof(float));
+        const int num_elems = (int)(grain * 257 + 3);
+        const int num_chunks = num_elems / (int)grain + 1;
+        const TEST_TYPES test_type = TEST_I32;
+        int32_t *C1 = NULL, *C2 = NULL, *M = NULL;
+
+        create_test_array(test_type, (void **)&C1, num_elems, alignment);
+        create_test_array(test_type, (void **)&C2, num_elems, alignment);
+        create_test_array(test_type, (void **)&M, num_chunks, alignment);
+
+        test_steal_kernel k;
+        k.marks = C1;
+        k.misaligned = M;
+        k.grain = grain;
+
+        // Default leaves, single-grain leaves, parallel_for() backend, nested calls
+        for (int v = 0; v < 4; ++v) {
+            for (int i = 0; i < num_elems; ++i) {
+                C1[i] = 0;
+                C2[i] = 1;
+            }
+            for (int i = 0; i < num_chunks; ++i)
+                M[i] = 0;
+
+            k.nested = (v == 3);
+            if (v == 0) {
+                gvl::steal_for(num_elems, k, 4);
+            } else if (v == 1) {
+                gvl::steal_for(num_elems, k, 3, grain);
+            } else {
+                gvl::set_dispatch_backend(gvl::DISPATCH_STEALING);
+                gvl::parallel_for(num_elems, k, 4);
+                gvl::set_dispatch_backend(gvl::DISPATCH_OPENMP);
+            }
+
+            // Every element is processed exactly once
+            test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+            for (int i = 0; i < num_chunks; ++i)
+                test_result += M[i];
+        }
+
+        test_result += (gvl::get_pool_threads() != 3);
+
+        FREE(C1);
+        FREE(C2);
+        FREE(M);
+    }
+
+    return test_result;
+}
+
+int test_simd_numa()
+{
+    int test_result = 0;
+    const size_t page = gvl::SYSCONF::get_page_sz();
+
+    {
+        const int num_elems = (int)(4 * page / sizeof(float) + 5);
+        const TEST_TYPES test_type = TEST_FLT;
+        float *C1 = NULL, *C2 = NULL;
+
+        // Policies are hints, only checked if the system accepts memory policies
+        const gvl::numa_policy policies[] = { gvl::NUMA_DEFAULT, gvl::NUMA_LOCAL, gvl::NUMA_INTERLEAVE, gvl::NUMA_PARTITION };
+        test_result += (gvl::numa_num_nodes() < 1);
+        test_result += (gvl::numa_cpu_node(0) < 0);
+        gvl::set_affinity(gvl::AFFINITY_COMPACT, 2);
+        for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]); ++p) {
+            // Allocation is page-aligned and succeeds regardless of placement
+            test_result += (scalar_malloc(&C1, SIMD_WIDTH_BYTES, num_elems, policies[p]) != 0);
+            if (policies[p] != gvl::NUMA_DEFAULT)
+                test_result += (((size_t)C1 & (page - 1)) != 0);
+            if (gvl::numa_place(C1, num_elems, sizeof(float), gvl::NUMA_DEFAULT) == 0)
+                test_result += (gvl::numa_place(C1, num_elems, sizeof(float), policies[p], 2) != 0);
+            scalar_free(&C1);
+        }
+
+        // Partitions are refused when chunks are stolen
+        test_result += (scalar_malloc(&C1, SIMD_WIDTH_BYTES, num_elems) != 0);
+        gvl::set_dispatch_backend(gvl::DISPATCH_STEALING);
+        test_result += (gvl::numa_place(C1, num_elems, sizeof(float), gvl::NUMA_PARTITION, 2) != -1);
+        gvl::set_dispatch_backend(gvl::DISPATCH_OPENMP);
+        scalar_free(&C1);
+
+        // Parallel first touch initializes all elements
+        create_test_array(test_type, (void **)&C1, num_elems, page);
+        create_test_array(test_type, (void **)&C2, num_elems, page);
+        gvl::first_touch(C1, num_elems, 3.0f, 2);
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = 3.0f;
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+        FREE(C1);
+        FREE(C2);
+    }
+
+    return test_result;
+}
+
+int test_simd_hugepage()
+{
+    int test_result = 0;
+    const size_t hpage = gvl::get_hugepage_sz();
+
+    {
+        const int num_elems = (int)(hpage / sizeof(float) + 7);
+        const TEST_TYPES test_type = TEST_FLT;
+        float *C1 = NULL, *C2 = NULL;
+
+        create_test_array(test_type, (void **)&C2, num_elems, SIMD_WIDTH_BYTES);
+
+        // Huge page modes fall back to what the system provides
+        const gvl::hugepage_mode modes[] = { gvl::HUGEPAGE_NONE, gvl::HUGEPAGE_THP, gvl::HUGEPAGE_HUGETLB };
+        for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m) {
+            test_result += (scalar_malloc(&C1, SIMD_WIDTH_BYTES, num_elems, gvl::NUMA_DEFAULT, modes[m]) != 0);
+            const gvl::hugepage_mode obtained = gvl::get_hugepage_mode(C1);
+            test_result += (obtained > modes[m]);
+            // Huge page buffers start on a huge page
+            test_result += (((size_t)C1 & (SIMD_WIDTH_BYTES - 1)) != 0);
+            if (obtained != gvl::HUGEPAGE_NONE)
+                test_result += (((size_t)C1 & (hpage - 1)) != 0);
+
+            for (int i = 0; i < num_elems; ++i)
+                C1[i] = C2[i];
+            test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+
+            // Reserved huge pages are always resident once touched
+            if (obtained == gvl::HUGEPAGE_HUGETLB)
+                test_result += (gvl::get_hugepage_bytes(C1, num_elems * sizeof(float)) == 0);
+            scalar_free(&C1);
+            test_result += (C1 != NULL);
+        }
+
+        // Normal page buffers are plain posix_memalign() ones
+        test_result += (scalar_malloc(&C1, SIMD_WIDTH_BYTES, num_elems, gvl::NUMA_DEFAULT, gvl::HUGEPAGE_NONE) != 0);
+        test_result += (gvl::get_hugepage_mode(C1) != gvl::HUGEPAGE_NONE);
+        FREE(C1);
+
+        FREE(C2);
+    }
+
+    return test_result;
+}
+
+
+int test_simd_arena()
+{
+    int test_result = 0;
+
+    // Arena, aligned bump allocation and reset to marks
+    {
+        gvl::arena a(4096);
+        char *p1 = a.allocate<char>(3);
+        float *p2 = a.allocate<float>(100);
+        test_result += (p1 == NULL || p2 == NULL);
+        test_result += (((size_t)p1 & (gvl::POOL_ALIGN - 1)) != 0);
+        test_result += (((size_t)p2 & (gvl::POOL_ALIGN - 1)) != 0);
+        test_result += ((char *)p2 < p1 + 3);
+
+        const gvl::arena::arena_mark m = a.mark();
+        double *p3 = a.allocate<double>(10);
+        a.reset(m);
+        test_result += (a.allocate<double>(10) != p3);
+
+        // Larger than chunk size, chunk of its own kept on reset
+        float *p4 = a.allocate<float>(10000);
+        test_result += (p4 == NULL);
+        const size_t cap = a.capacity();
+        a.reset();
+        test_result += (a.allocate<char>(3) != p1);
+        a.allocate<float>(100);
+        a.allocate<double>(10);
+        test_result += (a.allocate<float>(10000) != p4);
+        test_result += (a.capacity() != cap);
+    }
+
+    // Thread arena, scope releases allocations
+    {
+        void *p1 = NULL, *p2 = NULL;
+        {
+            gvl::arena_scope scope;
+            p1 = gvl::arena_allocator::allocate(1000);
+        }
+        {
+            gvl::arena_scope scope;
+            p2 = gvl::arena_allocator::allocate(1000);
+        }
+        test_result += (p1 == NULL || p1 != p2);
+    }
+
+    // Pool, freed buffers are recycled within their size class
+    {
+        void *p1 = gvl::pool_malloc(1000);
+        test_result += (p1 == NULL);
+        test_result += (((size_t)p1 & (gvl::POOL_ALIGN - 1)) != 0);
+        gvl::pool_free(p1);
+        void *p2 = gvl::pool_malloc(900);
+        test_result += (p2 != p1);
+        void *p3 = gvl::pool_malloc(1000);
+        test_result += (p3 == NULL || p3 == p2);
+        gvl::pool_free(p3);
+        gvl::pool_free(p2);
+        // Power-of-two requests fit their own class
+        void *p4 = gvl::pool_malloc(1024);
+        test_result += (p4 != p2);
+        gvl::pool_free(p4);
+        gvl::pool_trim();
+    }
+
+    // Arrays and kernels on pool/arena memory
+    {
+        const int num_elems = 1000;
+        const TEST_TYPES test_type = TEST_FLT;
+        float *A = NULL, *B = NULL, *C1 = NULL, *C2 = NULL;
+
+        create_test_array(test_type, (void **)&A, num_elems, SIMD_WIDTH_BYTES);
+        create_test_array(test_type, (void **)&B, num_elems, SIMD_WIDTH_BYTES);
+        create_test_array(test_type, (void **)&C2, num_elems, SIMD_WIDTH_BYTES);
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = A[i] + B[i] * A[i];
+
+        gvl::varray<float> a(A, num_elems), b(B, num_elems);
+        {
+            gvl::varray<float, gvl::pool_allocator> c(a + b * a);
+            test_result += ((int)c.size() != num_elems);
+            test_result += validate_test_arrays(test_type, (void *)c.data(), (void *)C2, num_elems);
+        }
+        {
+            gvl::arena_scope scope;
+            gvl::varray<float, gvl::arena_allocator> c(a + b * a);
+            test_result += ((int)c.size() != num_elems);
+            test_result += validate_test_arrays(test_type, (void *)c.data(), (void *)C2, num_elems);
+        }
+
+        for (int i = 0; i < num_elems; ++i)
+            C2[i] = A[i] + B[i];
+        C1 = gvl::add(A, B, num_elems, true, gvl::pool_allocator());
+        test_result += (C1 == NULL);
+        test_result += validate_test_arrays(test_type, (void *)C1, (void *)C2, num_elems);
+        gvl::pool_free(C1);
+
+        // Containers with storage from the pool and the arena
+        {
+            gvl::aligned_vector<float, SIMD_WIDTH_BYTES, gvl::pool_allocator> v(num_elems, 1.0f);
+            for (int i = 0; i < 100; ++i)
+                v.push_back(2.0f);
+            test_result += ((int)v.size() != num_elems + 100 || v[0] != 1.0f || v[num_elems] != 2.0f);
+            test_result += (((size_t)v.data() & (SIMD_WIDTH_BYTES - 1)) != 0);
+            for (size_t i = v.size(); i < v.capacity(); ++i)
+                test_result += (v[i] != 0.0f);
+        }
+        {
+            gvl::arena_scope scope;
+            gvl::aligned_vector<float, SIMD_WIDTH_BYTES, gvl::arena_allocator> v;
+            for (int i = 0; i < num_elems; ++i)
+                v.push_back(A[i]);
+            test_result += validate_test_arrays(test_type, (void *)v.data(), (void *)A, num_elems);
+        }
+
+        FREE(A);
+        FREE(B);
+        FREE(C2);
+    }
+
+    return test_result;
+}
+
+
+int test_simd_aligned_vector()
+{
+    int test_result = 0;
+
+    // Padding to a whole SIMD register is zero, tail needs no remainder loop
+    {
+        const int num_elems = 3 * SIMD_STREAMS_32 + 1;
+        gvl::aligned_vector<float> v(num_elems, 1.0f);
+        test_result += ((int)v.size() != num_elems);
+        test_result += (v.padded_size() % SIMD_STREAMS_32 != 0 || v.padded_size() < v.size());
+        test_result += (v.capacity() < v.padded_size());
+        test_result += (((size_t)v.data() & (SIMD_WIDTH_BYTES - 1)) != 0);
+
+        SIMD_FLT vs = simd_set(0.0f);
+        for (size_t i = 0; i < v.padded_size(); i+=SIMD_STREAMS_32)
+            vs = simd_add(vs, simd_load(v.data() + i));
+        float sums[SIMD_STREAMS_32] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+        simd_store(sums, vs);
+        float sum = 0.0f;
+        for (int i = 0; i < SIMD_STREAMS_32; ++i)
+            sum += sums[i];
+        test_result += (sum != (float)num_elems);
+
+        // Removed and reallocated elements leave zero padding
+        v.resize(2);
+        for (size_t i = v.size(); i < v.capacity(); ++i)
+            test_result += (v[i] != 0.0f);
+        for (int i = 0; i < 100; ++i)
+            v.push_back(2.0f);
+        test_result += (v.size() != 102 || v[1] != 1.0f || v[2] != 2.0f);
+        for (size_t i = v.size(); i < v.capacity(); ++i)
+            test_result += (v[i] != 0.0f);
+        test_result += (((size_t)v.data() & (SIMD_WIDTH_BYTES - 1)) != 0);
+
+        gvl::aligned_vector<float> w(v);
+        test_result += (w.size() != v.size() || w[101] != 2.0f);
+        v.clear();
+        test_result += (!v.empty() || v[0] != 0.0f);
+        w = v;
+        test_result += (!w.empty());
+    }
+
+    // Allocator for standard containers
+    {
+        std::vector<double, gvl::aligned_allocator<double, 64> > v(7, 1.0);
+        test_result += (((size_t)&v[0] & 63) != 0);
+        v.resize(1000, 2.0);
+        test_result += (((size_t)&v[0] & 63) != 0 || v[6] != 1.0 || v[999] != 2.0);
+    }
+
+    return test_result;
+}
+
+
+int test_simd_soa()
+{
+    int test_result = 0;
+    const int num_elems = 5 * SIMD_STREAMS_32 + 3;
+
+    // Structure of arrays, position/velocity/mass/id records
+    {
+        gvl::soa<float, float, double, int32_t> parts;
+        for (int i = 0; i < num_elems; ++i)
+            test_result += !parts.push_back((float)i, 0.5f * i, 2.0 * i, i);
+        test_result += ((int)parts.size() != num_elems);
+        test_result += (parts.capacity() % parts.block != 0);
+        test_result += (((size_t)parts.field<0>() & (SIMD_WIDTH_BYTES - 1)) != 0);
+        test_result += (((size_t)parts.field<2>() & (SIMD_WIDTH_BYTES - 1)) != 0);
+        test_result += (((size_t)parts.field<3>() & (SIMD_WIDTH_BYTES - 1)) != 0);
+
+        // Unit-stride vectors over padded records, x += v, m *= 2
+        for (size_t i = 0; i < parts.padded_size(); i+=SIMD_STREAMS_32)
+            parts.store<0>(i, parts.load<0>(i) + parts.load<1>(i));
+        for (size_t i = 0; i < parts.padded_size(); i+=SIMD_STREAMS_64)
+            parts.store<2>(i, parts.load<2>(i) * gvl::vec<double>(2.0));
+        for (int i = 0; i < num_elems; ++i)
+            test_result += (parts.get<0>(i) != 1.5f * i || parts.get<2>(i) != 4.0 * i || parts.get<3>(i) != i);
+        for (size_t i = parts.size(); i < parts.capacity(); ++i)
+            test_result += (parts.get<0>(i) != 0.0f || parts.get<2>(i) != 0.0);
+
+        // Erase keeps records dense, last record fills the slot
+        parts.erase(3);
+        parts.erase(parts.size() - 1);
+        test_result += ((int)parts.size() != num_elems - 2);
+        test_result += (parts.get<3>(3) != num_elems - 1);
+        for (size_t i = parts.size(); i < parts.capacity(); ++i)
+            test_result += (parts.get<3>(i) != 0);
+        parts.clear();
+        test_result += (!parts.empty() || parts.get<1>(0) != 0.0f);
+    }
+
+    // Blocked array of structures of arrays
+    {
+        gvl::aosoa<float, double, int32_t> parts;
+        test_result += (parts.block != (size_t)SIMD_STREAMS_32);
+        for (int i = 0; i < num_elems; ++i)
+            test_result += !parts.push_back((float)i, 2.0 * i, i);
+        test_result += (parts.nblocks() != (size_t)(num_elems + SIMD_STREAMS_32 - 1) / SIMD_STREAMS_32);
+        for (int i = 0; i < num_elems; ++i)
+            test_result += (parts.get<0>(i) != (float)i || parts.get<1>(i) != 2.0 * i || parts.get<2>(i) != i);
+
+        // Double field spans two vectors per block
+        test_result += (parts.block_vectors<0>() != 1 || parts.block_vectors<1>() != 2);
+        for (size_t b = 0; b < parts.nblocks(); ++b) {
+            test_result += (((size_t)parts.field<1>(b) & (SIMD_WIDTH_BYTES - 1)) != 0);
+            parts.store<0>(b, parts.load<0>(b) + gvl::vec<float>(1.0f));
+            for (size_t k = 0; k < parts.block_vectors<1>(); ++k)
+                parts.store<1>(b, parts.load<1>(b, k) + parts.load<1>(b, k), k);
+        }
+        for (int i = 0; i < num_elems; ++i)
+            test_result += (parts.get<0>(i) != (float)i + 1.0f || parts.get<1>(i) != 4.0 * i);
+
+        parts.erase(0);
+        test_result += ((int)parts.size() != num_elems - 1 || parts.get<2>(0) != num_elems - 1);
+        test_result += (parts.get<2>(parts.size()) != 0 || parts.get<1>(parts.size()) != 0.0);
+        parts.resize(1);
+        test_result += (parts.size() != 1 || parts.get<0>(1) != 0.0f);
+    }
+
+    // Storage from the pool, growth moves records between pool buffers
+    {
+        typedef gvl::soa_none none;
+        gvl::soa<float, int32_t, none, none, none, none, none, none, gvl::pool_allocator> parts;
+        gvl::aosoa<float, int32_t, none, none, none, none, none, none, gvl::pool_allocator> blocks;
+        for (int i = 0; i < num_elems; ++i) {
+            test_result += !parts.push_back((float)i, i);
+            test_result += !blocks.push_back((float)i, i);
+        }
+        test_result += (((size_t)parts.field<1>() & (SIMD_WIDTH_BYTES - 1)) != 0);
+        for (int i = 0; i < num_elems; ++i)
+            test_result += (parts.get<0>(i) != (float)i || parts.get<1>(i) != i || blocks.get<0>(i) != (float)i || blocks.get<1>(i) != i);
+    }
+
+    return test_result;
+}
+
+
+// Split records of 2/3/4 components into vectors and interleave them back
+int test_simd_interleave()
+{
+    int test_result = 0;
+
+    // Single-precision xy/xyz/xyzw points
+    {
+        // Floating-point vectors are scalar on some backends (MMX)
+        const int nf = (int)(sizeof(SIMD_FLT) / sizeof(float));
+        float sa[4 * nf], sb[4 * nf + 1];
+        float vals[4][nf] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+        for (int i = 0; i < 4 * nf; ++i)
+            sa[i] = (float)(i % 97) - 0.5f;
+
+        for (int k = 2; k <= 4; ++k) {
+            SIMD_FLT v[4];
+            switch (k) {
+                case 2: simd_load_deinterleave2(sa, &v[0], &v[1]); break;
+                case 3: simd_load_deinterleave3(sa, &v[0], &v[1], &v[2]); break;
+                default: simd_load_deinterleave4(sa, &v[0], &v[1], &v[2], &v[3]); break;
+            }
+            for (int c = 0; c < k; ++c) {
+                simd_store(vals[c], v[c]);
+                for (int i = 0; i < nf; ++i)
+                    test_result += (vals[c][i] != sa[i * k + c]);
+            }
+
+            // Unaligned destination, element past the records is untouched
+            for (int i = 0; i < 4 * nf + 1; ++i)
+                sb[i] = 0;
+            switch (k) {
+                case 2: simd_store_interleave2(sb + 1, v[0], v[1]); break;
+                case 3: simd_store_interleave3(sb + 1, v[0], v[1], v[2]); break;
+                default: simd_store_interleave4(sb + 1, v[0], v[1], v[2], v[3]); break;
+            }
+            for (int i = 0; i < k * nf; ++i)
+                test_result += (sb[i + 1] != sa[i]);
+            test_result += (sb[0] != 0);
+            if (k < 4)
+                test_result += (sb[k * nf + 1] != 0);
+        }
+    }
+
+    // Double-precision
+    {
+        double sa[4 * SIMD_STREAMS_64], sb[4 * SIMD_STREAMS_64 + 1];
+        double vals[4][SIMD_STREAMS_64] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+        for (int i = 0; i < 4 * SIMD_STREAMS_64; ++i)
+            sa[i] = 0.25 * (i % 89);
+
+        for (int k = 2; k <= 4; ++k) {
+            SIMD_DBL v[4];
+            switch (k) {
+                case 2: simd_load_deinterleave2(sa, &v[0], &v[1]); break;
+                case 3: simd_load_deinterleave3(sa, &v[0], &v[1], &v[2]); break;
+                default: simd_load_deinterleave4(sa, &v[0], &v[1], &v[2], &v[3]); break;
+            }
+            for (int c = 0; c < k; ++c) {
+                simd_store(vals[c], v[c]);
+                for (int i = 0; i < SIMD_STREAMS_64; ++i)
+                    test_result += (vals[c][i] != sa[i * k + c]);
+            }
+
+            // Unaligned destination, element past the records is untouched
+            for (int i = 0; i < 4 * SIMD_STREAMS_64 + 1; ++i)
+                sb[i] = 0;
+            switch (k) {
+                case 2: simd_store_interleave2(sb + 1, v[0], v[1]); break;
+                case 3: simd_store_interleave3(sb + 1, v[0], v[1], v[2]); break;
+                default: simd_store_interleave4(sb + 1, v[0], v[1], v[2], v[3]); break;
+            }
+            for (int i = 0; i < k * SIMD_STREAMS_64; ++i)
+                test_result += (sb[i + 1] != sa[i]);
+            test_result += (sb[0] != 0);
+            if (k < 4)
+                test_result += (sb[k * SIMD_STREAMS_64 + 1] != 0);
+        }
+    }
+
+    // 32-bit integers
+    {
+        int32_t sa[4 * SIMD_STREAMS_32], sb[4 * SIMD_STREAMS_32 + 1];
+        int32_t vals[4][SIMD_STREAMS_32] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+        for (int i = 0; i < 4 * SIMD_STREAMS_32; ++i)
+            sa[i] = (int32_t)(i * 7) - 100;
+
+        for (int k = 2; k <= 4; ++k) {
+            SIMD_INT v[4];
+            switch (k) {
+                case 2: simd_load_deinterleave2(sa, &v[0], &v[1]); break;
+                case 3: simd_load_deinterleave3(sa, &v[0], &v[1], &v[2]); break;
+                default: simd_load_deinterleave4(sa, &v[0], &v[1], &v[2], &v[3]); break;
+            }
+            for (int c = 0; c < k; ++c) {
+                simd_store(vals[c], v[c]);
+                for (int i = 0; i < SIMD_STREAMS_32; ++i)
+                    test_result += (vals[c][i] != sa[i * k + c]);
+            }
+
+            // Unaligned destination, element past the records is untouched
+            for (int i = 0; i < 4 * SIMD_STREAMS_32 + 1; ++i)
+                sb[i] = 0;
+            switch (k) {
+                case 2: simd_store_interleave2(sb + 1, v[0], v[1]); break;
+                case 3: simd_store_interleave3(sb + 1, v[0], v[1], v[2]); break;
+                default: simd_store_interleave4(sb + 1, v[0], v[1], v[2], v[3]); break;
+            }
+            for (int i = 0; i < k * SIMD_STREAMS_32; ++i)
+                test_result += (sb[i + 1] != sa[i]);
+            test_result += (sb[0] != 0);
+            if (k < 4)
+                test_result += (sb[k * SIMD_STREAMS_32 + 1] != 0);
+        }
+    }
+
+    // 8-bit gray-alpha/RGB/RGBA pixels, SIMD_WIDTH_BYTES pixels per vector
+    {
+        uint8_t sa[4 * SIMD_WIDTH_BYTES], sb[4 * SIMD_WIDTH_BYTES + 1];
+        uint8_t vals[4][SIMD_WIDTH_BYTES] SIMD_ALIGNED(SIMD_WIDTH_BYTES);
+        for (int i = 0; i < 4 * SIMD_WIDTH_BYTES; ++i)
+            sa[i] = (uint8_t)(i * 7 + 3);
+
+        for (int k = 2; k <= 4; ++k) {
+            SIMD_INT v[4];
+            switch (k) {
+                case 2: simd_load_deinterleave2(sa, &v[0], &v[1]); break;
+                case 3: simd_load_deinterleave3(sa, &v[0], &v[1], &v[2]); break;
+                default: simd_load_deinterleave4(sa, &v[0], &v[1], &v[2], &v[3]); break;
+            }
+            for (int c = 0; c < k; ++c) {
+                memcpy(vals[c], &v[c], sizeof(SIMD_INT));
+                for (int i = 0; i < SIMD_WIDTH_BYTES; ++i)
+                    test_result += (vals[c][i] != sa[i * k + c]);
+            }
+
+            // Unaligned destination, element past the records is untouched
+            for (int i = 0; i < 4 * SIMD_WIDTH_BYTES + 1; ++i)
+                sb[i] = 0;
+            switch (k) {
+                case 2: simd_store_interleave2(sb + 1, v[0], v[1]); break;
+                case 3: simd_store_interleave3(sb + 1, v[0], v[1], v[2]); break;
+                default: simd_store_interleave4(sb + 1, v[0], v[1], v[2], v[3]); break;
+            }
+            for (int i = 0; i < k * SIMD_WIDTH_BYTES; ++i)
+                test_result += (sb[i + 1] != sa[i]);
+            test_result += (sb[0] != 0);
+            if (k < 4)
+                test_result += (sb[k * SIMD_WIDTH_BYTES + 1] != 0);
+        }
+    }
+
+    return test_result;
+}
+
+
+// Enable OpenMP in SYSCONF with nthreads, returns the previous count for set_omp() to restore
+static int32_t test_omp_set(const int32_t nthreads)
+{
+    const int32_t prev = (gvl::SYSCONF::get_omp()) ? (gvl::SYSCONF::get_threads()) : (1);
+    gvl::SYSCONF::set_omp(nthreads);
+    return prev;
+}
+
+
+// Transpose tile of n x n elements with leading dimensions, check and reset destination
+#define TEST_TRANSPOSE_TILE(fn, n, T) \
+    do { \
+        T sa[n * (n + 3)], sb[n * (n + 1)]; \
+        for (int i = 0; i < n * (n + 3); ++i) \
+            sa[i] = (T)i; \
+        for (int i = 0; i < n * (n + 1); ++i) \
+            sb[i] = (T)-1; \
+        fn(sb + 1, n + 1, sa + 2, n + 3); \
+        for (int i = 0; i < n; ++i) \
+            for (int j = 0; j < n; ++j) \
+                test_result += (sb[1 + j * (n + 1) + i] != sa[2 + i * (n + 3) + j]); \
+        test_result += (sb[0] != (T)-1); \
+    } while (0)
+
+int test_simd_transpose()
+{
+    int test_result = 0;
+
+    // Register tiles, unaligned rows
+    TEST_TRANSPOSE_TILE(simd_transpose4x4_f32, 4, float);
+    TEST_TRANSPOSE_TILE(simd_transpose8x8_f32, 8, float);
+    TEST_TRANSPOSE_TILE(simd_transpose4x4_f64, 4, double);
+    TEST_TRANSPOSE_TILE(simd_transpose8x8_f64, 8, double);
+#if defined(SIMD_AVX512)
+    TEST_TRANSPOSE_TILE(simd_transpose16x16_f32, 16, float);
+#endif
+
+    // Blocked transpose, sizes not multiple of tiles or blocks and larger than L2, serial and parallel
+    const int32_t omp_prev = test_omp_set(4);
+    {
+        const size_t rows = 301, cols = 2 * gvl::SYSCONF::get_L2_sz() / (rows * sizeof(float)) + 517, lda = cols + 3, ldb = rows + 5;
+        std::vector<float> sa(rows * lda), sb(cols * ldb);
+        std::vector<double> da(rows * lda), db(cols * ldb);
+        for (size_t i = 0; i < rows * lda; ++i) {
+            sa[i] = (float)i;
+            da[i] = (double)i + 0.5;
+        }
+
+        for (int par = 0; par <= 1; ++par) {
+            for (size_t i = 0; i < cols * ldb; ++i) {
+                sb[i] = -1.0f;
+                db[i] = -1.0;
+            }
+            gvl::transpose(&sb[0], ldb, &sa[0], lda, rows, cols, par == 1);
+            gvl::transpose(&db[0], ldb, &da[0], lda, rows, cols, par == 1);
+            for (size_t j = 0; j < cols; ++j) {
+                for (size_t i = 0; i < rows; ++i) {
+                    test_result += (sb[j * ldb + i] != sa[i * lda + j]);
+                    test_result += (db[j * ldb + i] != da[i * lda + j]);
+                }
+                // Padding past rows is untouched
+                for (size_t i = rows; i < ldb; ++i) {
+                    test_result += (sb[j * ldb + i] != -1.0f);
+                    test_result += (db[j * ldb + i] != -1.0);
+                }
+            }
+        }
+
+        // Transpose back
+        std::vector<float> sc(rows * lda, 0.0f);
+        gvl::transpose(&sc[0], lda, &sb[0], ldb, cols, rows, true);
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t j = 0; j < cols; ++j)
+                test_result += (sc[i * lda + j] != sa[i * lda + j]);
+    }
+    gvl::SYSCONF::set_omp(omp_prev);
+
+    return test_result;
+}
+
+
+int test_simd_batched()
+{
+    int test_result = 0;
+
+    // Sizes and counts leave partial batches and rows not multiple of 4, last
+    // matrices are larger than L2 and split among threads
+    const int32_t omp_prev = test_omp_set(4);
+    const size_t nbig = gvl::SYSCONF::get_L2_sz() / (16 * 16 * sizeof(float)) + 37;
+    const size_t sizes[][3] = { { 6, 6, 37 }, { 3, 5, 9 }, { 16, 16, 101 }, { 1, 1, 1 }, { 16, 16, nbig } };
+    for (size_t t = 0; t < sizeof(sizes) / sizeof(sizes[0]); ++t) {
+        const size_t rows = sizes[t][0], cols = sizes[t][1], n = sizes[t][2];
+
+        // Single-precision, padded leading dimension
+        {
+            const size_t lda = cols + 1;
+            std::vector<float> sa(n * rows * lda), sx(n * cols), sy(n * rows, -1.0f);
+            gvl::aligned_vector<float> ac(gvl::batch_elems<float>(n, rows, cols)), xc(gvl::batch_elems<float>(n, cols, 1)), yc(gvl::batch_elems<float>(n, rows, 1));
+            for (size_t i = 0; i < sa.size(); ++i)
+                sa[i] = (float)(i % 13) - 6.0f;
+            for (size_t i = 0; i < sx.size(); ++i)
+                sx[i] = (float)(i % 7) - 3.0f;
+
+            gvl::batch_pack(ac.data(), &sa[0], n, rows, cols, lda);
+            gvl::batch_pack(xc.data(), &sx[0], n, cols, 1, 1);
+            for (int par = 0; par <= 1; ++par) {
+                gvl::batch_gemv(yc.data(), ac.data(), xc.data(), n, rows, cols, par == 1);
+                gvl::batch_unpack(&sy[0], 1, yc.data(), n, rows, 1);
+                for (size_t k = 0; k < n; ++k)
+                    for (size_t i = 0; i < rows; ++i) {
+                        float dp = 0.0f;
+                        for (size_t j = 0; j < cols; ++j)
+                            dp += sa[(k * rows + i) * lda + j] * sx[k * cols + j];
+                        test_result += (sy[k * rows + i] != dp);
+                    }
+            }
+
+            // Lanes past n in the last batch are zeroed
+            const size_t nlanes = gvl::batch_traits<float>::nlanes;
+            const size_t nlast = n - (gvl::batch_count<float>(n) - 1) * nlanes;
+            const float * const plast = xc.data() + (gvl::batch_count<float>(n) - 1) * cols * nlanes;
+            for (size_t j = 0; j < cols; ++j)
+                for (size_t k = nlast; k < nlanes; ++k)
+                    test_result += (plast[j * nlanes + k] != 0.0f);
+        }
+
+        // Double-precision, contiguous matrices, unpack round trip
+        {
+            std::vector<double> sa(n * rows * cols), sb(n * rows * cols), sx(n * cols), sy(n * rows);
+            gvl::aligned_vector<double> ac(gvl::batch_elems<double>(n, rows, cols)), xc(gvl::batch_elems<double>(n, cols, 1)), yc(gvl::batch_elems<double>(n, rows, 1));
+            for (size_t i = 0; i < sa.size(); ++i)
+                sa[i] = (double)(i % 11) - 5.0;
+            for (size_t i = 0; i < sx.size(); ++i)
+                sx[i] = (double)(i % 5) + 0.5;
+
+            gvl::batch_pack(ac.data(), &sa[0], n, rows, cols, cols);
+            gvl::batch_unpack(&sb[0], cols, ac.data(), n, rows, cols);
+            for (size_t i = 0; i < sa.size(); ++i)
+                test_result += (sb[i] != sa[i]);
+
+            gvl::batch_pack(xc.data(), &sx[0], n, cols, 1, 1);
+            gvl::batch_gemv(yc.data(), ac.data(), xc.data(), n, rows, cols, true);
+            gvl::batch_unpack(&sy[0], 1, yc.data(), n, rows, 1);
+            for (size_t k = 0; k < n; ++k)
+                for (size_t i = 0; i < rows; ++i) {
+                    double dp = 0.0;
+                    for (size_t j = 0; j < cols; ++j)
+                        dp += sa[(k * rows + i) * cols + j] * sx[k * cols + j];
+                    test_result += (sy[k * rows + i] != dp);
+                }
+        }
+    }
+    gvl::SYSCONF::set_omp(omp_prev);
+
+    return test_result;
+}
+
+
+// Reference C = alpha * A * B + beta * C, checks gemm() on copies of C
+#define TEST_GEMM(T, m, n, k, alpha, beta, run_par) \
+    do { \
+        const size_t lda = (k) + 3, ldb = (n) + 1, ldc = (n) + 2; \
+        std::vector<T> sa((m) * lda + 1), sb((k) * ldb + 1), sc((m) * ldc + 1), sr((m) * ldc + 1); \
+        for (size_t i = 0; i < sa.size(); ++i) \
+            sa[i] = (T)((int)(i % 7) - 3); \
+        for (size_t i = 0; i < sb.size(); ++i) \
+            sb[i] = (T)((int)(i % 5) - 2); \
+        for (size_t i = 0; i < sc.size(); ++i) \
+            sc[i] = sr[i] = (T)((int)(i % 9) - 4); \
+        for (size_t i = 0; i < (m); ++i) \
+            for (size_t j = 0; j < (n); ++j) { \
+                T dp = 0; \
+                for (size_t p = 0; p < (k); ++p) \
+                    dp += sa[i * lda + p] * sb[p * ldb + j]; \
+                sr[i * ldc + j] = (alpha) * dp + (((beta) != 0) ? ((beta) * sr[i * ldc + j]) : (0)); \
+            } \
+        test_result += gvl::gemm(&sc[0], ldc, &sa[0], lda, &sb[0], ldb, m, n, k, (T)(alpha), (T)(beta), run_par); \
+        for (size_t i = 0; i < sc.size(); ++i) \
+            test_result += (sc[i] != sr[i]); \
+    } while (0)
+
+int test_simd_gemm()
+{
+    int test_result = 0;
+
+    // Sizes not multiple of register tiles nor cache blocks, integer values keep sums exact,
+    // A of the last one is larger than L2 and split in several MC blocks among threads
+    const int32_t omp_prev = test_omp_set(4);
+    const size_t mbig = 2 * gvl::SYSCONF::get_L2_sz() / (130 * sizeof(float)) + 7;
+    const size_t sizes[][3] = { { 1, 1, 1 }, { 7, 5, 3 }, { 50, 70, 90 }, { 301, 517, 300 }, { 130, 33, 1000 }, { 16, 16, 0 }, { mbig, 65, 130 } };
+    for (size_t t = 0; t < sizeof(sizes) / sizeof(sizes[0]); ++t) {
+        const size_t m = sizes[t][0], n = sizes[t][1], k = sizes[t][2];
+        for (int par = 0; par <= 1; ++par) {
+            TEST_GEMM(float, m, n, k, 1, 0, par == 1);
+            TEST_GEMM(float, m, n, k, 2, -1, par == 1);
+            TEST_GEMM(double, m, n, k, 1, 0, par == 1);
+            TEST_GEMM(double, m, n, k, -0.5, 3, par == 1);
+        }
+    }
+    gvl::SYSCONF::set_omp(omp_prev);
+
+    return test_result;
+}
+
+
+// Products, transpose, inverse and determinant of N x N matrices against scalar loops
+template <typename T, size_t N>
+static int test_mat_square(const T tol)
+{
+    int test_result = 0;
+    T sa[N * N], sb[N * N], sc[N * N];
+    for (size_t i = 0; i < N * N; ++i) {
+        sa[i] = (T)((int)((i * 7) % 9) - 4);
+        sb[i] = (T)((int)((i * 5) % 7) - 3);
+    }
+    // Diagonally dominant, invertible
+    for (size_t i = 0; i < N; ++i)
+        sa[i * N + i] += (T)20;
+
+    const gvl::mat<T, N, N> ma(sa), mb(sb);
+    (ma * mb).store(sc);
+    for (size_t i = 0; i < N; ++i)
+        for (size_t j = 0; j < N; ++j) {
+            T dp = 0;
+            for (size_t k = 0; k < N; ++k)
+                dp += sa[i * N + k] * sb[k * N + j];
+            test_result += (sc[i * N + j] != dp);
+        }
+
+    const gvl::mat<T, N, N> mt = gvl::transpose(ma);
+    for (size_t i = 0; i < N; ++i)
+        for (size_t j = 0; j < N; ++j)
+            test_result += (mt(i, j) != sa[j * N + i]);
+
+    // Matrix-vector product
+    gvl::mat<T, N, 1> vx;
+    for (size_t i = 0; i < N; ++i)
+        vx(i, 0) = (T)i;
+    const gvl::mat<T, N, 1> vy = ma * vx;
+    for (size_t i = 0; i < N; ++i) {
+        T dp = 0;
+        for (size_t k = 0; k < N; ++k)
+            dp += sa[i * N + k] * (T)k;
+        test_result += (vy(i, 0) != dp);
+    }
+
+    // A * A^-1 = I and det(A) * det(A^-1) = 1
+    gvl::mat<T, N, N> mi;
+    test_result += (gvl::inverse(mi, ma) != 0);
+    const gvl::mat<T, N, N> mid = ma * mi;
+    for (size_t i = 0; i < N; ++i)
+        for (size_t j = 0; j < N; ++j)
+            test_result += (fabs(mid(i, j) - ((i == j) ? (T)1 : (T)0)) > tol);
+    test_result += (fabs(gvl::determinant(ma) * gvl::determinant(mi) - (T)1) > N * tol);
+
+    // Singular
+    const gvl::mat<T, N, N> mz;
+    test_result += (gvl::inverse(mi, mz) != -1);
+    test_result += (gvl::determinant(mz) != (T)0);
+
+    // Element-wise operations
+    const gvl::mat<T, N, N> ms = ma + mb - mb * (T)2 + (T)1 * mb;
+    for (size_t i = 0; i < N; ++i)
+        for (size_t j = 0; j < N; ++j)
+            test_result += (ms(i, j) != ma(i, j));
+
+    return test_result;
+}
+
+int test_simd_mat()
+{
+    int test_result = 0;
+
+    test_result += test_mat_square<float, 2>(1e-5f);
+    test_result += test_mat_square<float, 3>(1e-5f);
+    test_result += test_mat_square<float, 4>(1e-5f);
+    test_result += test_mat_square<float, 6>(1e-5f);
+    test_result += test_mat_square<float, 8>(1e-5f);
+    test_result += test_mat_square<double, 2>(1e-12);
+    test_result += test_mat_square<double, 4>(1e-12);
+    test_result += test_mat_square<double, 5>(1e-12);
+    test_result += test_mat_square<double, 8>(1e-12);
+
+    // Closed-form determinant and rectangular products
+    {
+        const float sa[9] = { 2, 0, 0, 0, 3, 0, 0, 0, 4 };
+        test_result += (gvl::determinant(gvl::mat<float, 3, 3>(sa)) != 24.0f);
+    }
+    {
+        const double sa[6] = { 1, 2, 3, 4, 5, 6 };
+        const gvl::mat<double, 2, 3> ma(sa);
+        const gvl::mat<double, 3, 2> mt = gvl::transpose(ma);
+        test_result += (mt(2, 1) != 6.0 || mt(0, 1) != 4.0);
+        const gvl::mat<double, 2, 2> mp = ma * mt;
+        test_result += (mp(0, 0) != 14.0 || mp(0, 1) != 32.0 || mp(1, 0) != 32.0 || mp(1, 1) != 77.0);
+    }
+
+    return test_result;
+}
+
+
+// CSR matrix with empty, short and long rows, SpMV checked in both formats
+template <typename T>
+static int test_spmv_type(const size_t n)
+{
+    int test_result = 0;
+
+    std::vector<size_t> row_ptr(n + 1, 0);
+    std::vector<int32_t> col_idx;
+    std::vector<T> val;
+    for (size_t i = 0; i < n; ++i) {
+        const size_t len = (i % 11 == 0) ? (0) : ((i % 50 == 1) ? (200) : ((i * 7) % 23));
+        for (size_t k = 0; k < len; ++k) {
+            col_idx.push_back((int32_t)((i * 31 + k * 17) % n));
+            val.push_back((T)((int32_t)(k % 9) - 4));
+        }
+        row_ptr[i + 1] = col_idx.size();
+    }
+
+    // Small integers, sums are exact in any order
+    std::vector<T> x(n), y(n), yref(n);
+    for (size_t j = 0; j < n; ++j)
+        x[j] = (T)((int32_t)(j % 5) - 2);
+    for (size_t i = 0; i < n; ++i) {
+        T dp = (T)0;
+        for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+            dp += val[k] * x[col_idx[k]];
+        yref[i] = dp;
+    }
+
+    const gvl::csr_matrix<T> a(n, n, &row_ptr[0], &col_idx[0], &val[0]);
+    for (int par = 0; par <= 1; ++par) {
+        std::fill(y.begin(), y.end(), (T)-1);
+        gvl::spmv(&y[0], a, &x[0], par == 1);
+        for (size_t i = 0; i < n; ++i)
+            test_result += (y[i] != yref[i]);
+    }
+
+    // Arrays from the pool
+    {
+        gvl::sell_matrix<T, gvl::pool_allocator> b(a, 64);
+        std::fill(y.begin(), y.end(), (T)-1);
+        gvl::spmv(&y[0], b, &x[0]);
+        for (size_t i = 0; i < n; ++i)
+            test_result += (y[i] != yref[i]);
+    }
+
+    const size_t C = gvl::sell_matrix<T>::C;
+    const size_t sigmas[] = { 1, C, 64, n };
+    size_t elems_unsorted = 0;
+    for (size_t t = 0; t < sizeof(sigmas) / sizeof(sigmas[0]); ++t) {
+        gvl::sell_matrix<T> b;
+        test_result += (b.assign(a, sigmas[t]) != true);
+        test_result += (b.rows() != n || b.slices() != (n + C - 1) / C);
+
+        // Every row appears once, lengths decrease within sigma windows
+        std::vector<int32_t> seen(n, 0);
+        for (size_t l = 0; l < b.slices() * C; ++l) {
+            const int32_t r = b.row_perm()[l];
+            test_result += (l < n) ? (r < 0 || r >= (int32_t)n) : (r != -1);
+            if (r >= 0 && r < (int32_t)n)
+                ++seen[r];
+            if (b.sigma() > C && l < n && l % b.sigma() != 0 && r >= 0 && r < (int32_t)n) {
+                const int32_t q = b.row_perm()[l - 1];
+                test_result += (row_ptr[r + 1] - row_ptr[r] > row_ptr[q + 1] - row_ptr[q]);
+            }
+        }
+        for (size_t i = 0; i < n; ++i)
+            test_result += (seen[i] != 1);
+
+        // Sorting does not add padding
+        if (t == 0)
+            elems_unsorted = b.elems();
+        test_result += (b.elems() > elems_unsorted || b.elems() < a.nnz());
+
+        for (int par = 0; par <= 1; ++par) {
+            std::fill(y.begin(), y.end(), (T)-1);
+            gvl::spmv(&y[0], b, &x[0], par == 1);
+            for (size_t i = 0; i < n; ++i)
+                test_result += (y[i] != yref[i]);
+        }
+    }
+
+    return test_result;
+}
+
+int test_simd_spmv()
+{
+    int test_result = 0;
+
+    // Last matrices are larger than L2, rows are split among threads
+    const int32_t omp_prev = test_omp_set(4);
+    const size_t nbig = gvl::SYSCONF::get_L2_sz() / 32 + 3;
+    test_result += test_spmv_type<float>(1);
+    test_result += test_spmv_type<float>(37);
+    test_result += test_spmv_type<float>(2003);
+    test_result += test_spmv_type<float>(nbig);
+    test_result += test_spmv_type<double>(1);
+    test_result += test_spmv_type<double>(37);
+    test_result += test_spmv_type<double>(2003);
+    test_result += test_spmv_type<double>(nbig);
+    gvl::SYSCONF::set_omp(omp_prev);
+
+    return test_result;
+}
+
+
+// Central differences along x times along y, a stencil given as a functor
+template <typename T>
+struct test_stencil_cross: public gvl::stencil_op<T, 2, 1>
+{
+    typedef typename gvl::stencil_op<T, 2, 1>::star star;
+    typedef typename gvl::stencil_op<T, 2, 1>::vtype vtype;
+
+    vtype operator()(const star &s) const
+    { return simd_mul(simd_sub(s.x[2], s.x[0]), simd_sub(s.y[2], s.y[0])); }
+};
+
+// Time steps of a weighted star stencil against scalar loops over the interior
+template <typename T, size_t D, size_t R>
+static int test_stencil_coeffs(const size_t nx, const size_t ny, const size_t nz, const size_t steps, const size_t tblock, const bool run_par)
+{
+    int test_result = 0;
+
+    const gvl::stencil_grid<T> g(nx, ny, nz);
+    T wx[2 * R + 1], wy[2 * R + 1], wz[2 * R + 1];
+    for (size_t k = 0; k < 2 * R + 1; ++k) {
+        wx[k] = (T)0.125 * (T)(k + 1);
+        wy[k] = (T)0.0625 * (T)(k + 2);
+        wz[k] = (T)0.03125 * (T)(k + 1);
+    }
+    const gvl::stencil_coeffs<T, D, R> f((T)0.25, wx, wy, wz);
+
+    gvl::aligned_vector<T> a(g.elems()), b(g.elems());
+    std::vector<T> ra(g.elems()), rb(g.elems());
+    for (size_t i = 0; i < g.elems(); ++i)
+        a[i] = b[i] = ra[i] = rb[i] = (T)((i * 37) % 11) / (T)8;
+
+    const long ld[3] = { 1, (long)g.ldx, (long)g.ldy };
+    for (size_t s = 0; s < steps; ++s) {
+        for (size_t z = (D > 2) ? (R) : (0); z < ((D > 2) ? (nz - R) : (1)); ++z)
+            for (size_t y = (D > 1) ? (R) : (0); y < ((D > 1) ? (ny - R) : (1)); ++y)
+                for (size_t x = R; x < nx - R; ++x) {
+                    const size_t i = g.index(x, y, z);
+                    T v = (T)0.25 * ra[i];
+                    for (long d = -(long)R; d <= (long)R; ++d) {
+                        if (d == 0)
+                            continue;
+                        v += wx[R + d] * ra[i + d * ld[0]];
+                        if (D > 1)
+                            v += wy[R + d] * ra[i + d * ld[1]];
+                        if (D > 2)
+                            v += wz[R + d] * ra[i + d * ld[2]];
+                    }
+                    rb[i] = v;
+                }
+        ra.swap(rb);
+    }
+
+    const T * const pc = gvl::stencil_run(a.data(), b.data(), g, f, steps, tblock, run_par);
+    test_result += (pc != ((steps % 2 == 0) ? (a.data()) : (b.data())));
+    for (size_t i = 0; i < g.elems(); ++i)
+        test_result += (fabs(pc[i] - ra[i]) > (T)1e-4 * (1 + fabs(ra[i])));
+
+    return test_result;
+}
+
+int test_simd_stencil()
+{
+    int test_result = 0;
+
+    // Temporal blocking changes the order of updates, not the results, grids
+    // larger than L2 are cut in several slabs and tiles among threads
+    const int32_t omp_prev = test_omp_set(4);
+    const size_t l2_elems = gvl::SYSCONF::get_L2_sz() / sizeof(float);
+    for (size_t tblock = 1; tblock <= 4; tblock += 3)
+        for (int par = 0; par <= 1; ++par) {
+            test_result += test_stencil_coeffs<float, 1, 1>(1000, 1, 1, 5, tblock, par == 1);
+            test_result += test_stencil_coeffs<float, 1, 3>(200003, 1, 1, 7, tblock, par == 1);
+            test_result += test_stencil_coeffs<float, 1, 2>(2 * l2_elems + 3, 1, 1, 5, tblock, par == 1);
+            test_result += test_stencil_coeffs<float, 2, 2>(300, 700, 1, 6, tblock, par == 1);
+            test_result += test_stencil_coeffs<float, 2, 1>(300, 2 * l2_elems / 300 + 7, 1, 6, tblock, par == 1);
+            test_result += test_stencil_coeffs<float, 3, 1>(300, 200, 20, 3, tblock, par == 1);
+            test_result += test_stencil_coeffs<double, 1, 2>(37, 1, 1, 4, tblock, par == 1);
+            test_result += test_stencil_coeffs<double, 2, 3>(19, 23, 1, 3, tblock, par == 1);
+            test_result += test_stencil_coeffs<double, 3, 2>(70, 40, 50, 4, tblock, par == 1);
+        }
+    gvl::SYSCONF::set_omp(omp_prev);
+
+    // Functor, boundary points are not written
+    const gvl::stencil_grid<float> g(45, 33);
+    gvl::aligned_vector<float> a(g.elems()), b(g.elems(), -1.0f);
+    for (size_t y = 0; y < g.ny; ++y)
+        for (size_t x = 0; x < g.ldx; ++x)
+            a[g.index(x, y)] = (float)(x * x) + (float)(3 * y);
+    gvl::stencil_sweep(b.data(), a.data(), g, test_stencil_cross<float>());
+    for (size_t y = 0; y < g.ny; ++y)
+        for (size_t x = 0; x < g.nx; ++x) {
+            const bool inner = (x > 0 && x + 1 < g.nx && y > 0 && y + 1 < g.ny);
+            test_result += (b[g.index(x, y)] != ((inner) ? ((float)(4 * x) * 6.0f) : (-1.0f)));
+        }
+
+    return test_result;
+}
+
+
+// Inclusive and exclusive scans from init against scalar loops, out-of-place and in-place
+template <typename T>
+static int test_scan(const size_t n, const T init, const bool run_par)
+{
+    int test_result = 0;
+    std::vector<T> a(n + 1), b(n + 1), ref(n + 1);
+    for (size_t i = 0; i < n; ++i)
+        a[i] = (T)((int)((i * 5 + n) % 7) - 2);
+
+    for (int excl = 0; excl <= 1; ++excl)
+        for (int inplace = 0; inplace <= 1; ++inplace) {
+            T s = init;
+            for (size_t i = 0; i < n; ++i) {
+                if (excl == 1)
+                    ref[i] = s;
+                s += a[i];
+                if (excl == 0)
+                    ref[i] = s;
+            }
+
+            std::vector<T> x(a);
+            b.assign(n + 1, (T)-1);
+            T * const sb = (inplace == 1) ? (&x[0]) : (&b[0]);
+            const T total = (excl == 1) ? (gvl::exclusive_scan(sb, &x[0], n, init, run_par))
+                                        : (gvl::inclusive_scan(sb, &x[0], n, init, run_par));
+            test_result += (total != s);
+            for (size_t i = 0; i < n; ++i)
+                test_result += (sb[i] != ref[i]);
+            // Element past the end is not written
+            test_result += (sb[n] != ((inplace == 1) ? ((T)0) : ((T)-1)));
+        }
+
+    return test_result;
+}
+
+int test_simd_scan()
+{
+    int test_result = 0;
+
+    // Sizes around multiples of the vector width, and larger than L2 for the two-pass scan
+    // among threads
+    const int32_t omp_prev = test_omp_set(4);
+    const size_t sizes[] = { 0, 1, 3, 8, 17, 64, 1001, 3000001 };
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); ++k)
+        for (int par = 0; par <= 1; ++par) {
+            test_result += test_scan<int32_t>(sizes[k], 5, par == 1);
+            test_result += test_scan<int64_t>(sizes[k], -3, par == 1);
+            test_result += test_scan<float>(sizes[k], 0.5f, par == 1);
+            test_result += test_scan<double>(sizes[k], 0.0, par == 1);
+        }
+    gvl::SYSCONF::set_omp(omp_prev);
+
+    return test_result;
+}
+
+
+
+
+
 
 
 
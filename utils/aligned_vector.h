@@ -0,0 +1,304 @@
+/*!
+ *  \brief Aligned containers without external dependencies
+ *  - aligned_allocator<T, Align>, standard allocator returning memory
+ *    aligned to Align bytes, for std::vector and other containers
+ *  - aligned_vector<T, Align, A>, dynamic array whose capacity is a whole
+ *    number of SIMD registers and whose padding past size() is always
+ *    zero, so kernels can process the tail with full-width vector
+ *    operations and no remainder loop. Storage comes from allocator
+ *    policy A (aligned_heap, or pool_allocator and arena_allocator of
+ *    arena.h).
+ */
+#ifndef _ALIGNED_VECTOR_H
+#define _ALIGNED_VECTOR_H
+
+
+#include <stddef.h>   // size_t, ptrdiff_t
+#include <stdlib.h>   // posix_memalign, free
+#include <string.h>   // memcpy, memset
+#include <new>        // bad_alloc, placement new
+#include "simd.h"     // SIMD_WIDTH_BYTES
+#include "arena.h"    // allocator policies
+
+
+namespace gvl {
+
+
+/*!
+ *  \class aligned_allocator
+ *  \brief Allocator of memory aligned to Align bytes (power of two)
+ *  Allocations are rounded up to a multiple of Align bytes, bytes past the
+ *  requested elements are zeroed.
+ */
+template <typename T, size_t Align = SIMD_WIDTH_BYTES>
+class aligned_allocator
+{
+    public:
+        typedef T value_type;
+        typedef T * pointer;
+        typedef const T * const_pointer;
+        typedef T & reference;
+        typedef const T & const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template <typename U>
+        struct rebind
+        { typedef aligned_allocator<U, Align> other; };
+
+        //! Alignment in bytes, posix_memalign() needs a multiple of sizeof(void *)
+        static const size_t alignment = (Align > sizeof(void *)) ? (Align) : (sizeof(void *));
+
+        aligned_allocator()
+        { }
+
+        template <typename U>
+        aligned_allocator(const aligned_allocator<U, Align> &)
+        { }
+
+        pointer address(reference x) const
+        { return &x; }
+
+        const_pointer address(const_reference x) const
+        { return &x; }
+
+        //! Bytes reserved for \c n elements, a multiple of alignment
+        static size_type padded_bytes(const size_type n)
+        { return (n * sizeof(T) + alignment - 1) & ~(alignment - 1); }
+
+        pointer allocate(const size_type n, const void * = 0)
+        {
+            if (n == 0)
+                return NULL;
+            if (n > max_size())
+                throw std::bad_alloc();
+
+            void *p = NULL;
+            const size_type bytes = padded_bytes(n);
+            if (posix_memalign(&p, alignment, bytes))
+                throw std::bad_alloc();
+            memset((char *)p + n * sizeof(T), 0, bytes - n * sizeof(T));
+            return (pointer)p;
+        }
+
+        void deallocate(const pointer p, const size_type)
+        { free(p); }
+
+        size_type max_size() const
+        { return ((size_type)-1 - alignment) / sizeof(T); }
+
+        void construct(const pointer p, const T &x)
+        { new ((void *)p) T(x); }
+
+        void destroy(const pointer p)
+        { p->~T(); }
+};
+
+template <typename T, typename U, size_t Align>
+inline bool operator==(const aligned_allocator<T, Align> &, const aligned_allocator<U, Align> &)
+{ return true; }
+
+template <typename T, typename U, size_t Align>
+inline bool operator!=(const aligned_allocator<T, Align> &, const aligned_allocator<U, Align> &)
+{ return false; }
+
+
+/*!
+ *  \class aligned_heap
+ *  \brief Allocator policy (see arena.h) of system memory aligned to Align bytes
+ */
+template <size_t Align>
+struct aligned_heap
+{
+    static void *allocate(const size_t bytes)
+    {
+        void *p = NULL;
+        const size_t alignment = (Align > sizeof(void *)) ? (Align) : (sizeof(void *));
+        return (posix_memalign(&p, alignment, bytes)) ? (NULL) : (p);
+    }
+
+    static void deallocate(void * const p)
+    { free(p); }
+};
+
+
+/*!
+ *  \class aligned_vector
+ *  \brief Dynamic array with aligned storage and zeroed SIMD padding
+ *  Capacity is rounded up to a multiple of Align bytes and elements in
+ *  [size(), padded_size()) are always zero.
+ *  Storage comes from allocator policy A, pool_allocator and
+ *  arena_allocator align to POOL_ALIGN bytes and need Align <= POOL_ALIGN.
+ *  \note Allocation failures throw std::bad_alloc
+ *  \note Elements are copied with memcpy() and cleared with memset(), T must
+ *        be a plain data type (integers, floating-point numbers)
+ */
+template <typename T, size_t Align = SIMD_WIDTH_BYTES, typename A = aligned_heap<Align> >
+class aligned_vector
+{
+    public:
+        typedef T value_type;
+        typedef T * iterator;
+        typedef const T * const_iterator;
+
+    private:
+        T *p;
+        size_t n;
+        size_t cap;
+
+        // Move to storage for \c nc elements, padding past n is zeroed
+        void reallocate(const size_t nc)
+        {
+            const size_t ncap = padded(nc);
+            if (ncap > aligned_allocator<T, Align>().max_size())
+                throw std::bad_alloc();
+            T * const np = (T *)A::allocate(ncap * sizeof(T));
+            if (!np)
+                throw std::bad_alloc();
+            if (n > 0)
+                memcpy(np, p, n * sizeof(T));
+            if (ncap > n)
+                memset(np + n, 0, (ncap - n) * sizeof(T));
+            A::deallocate(p);
+            p = np;
+            cap = ncap;
+        }
+
+    public:
+        //! Elements reserved for \c na elements, a whole number of SIMD registers
+        static size_t padded(const size_t na)
+        { return aligned_allocator<T, Align>::padded_bytes(na) / sizeof(T); }
+
+        /******************
+         *  Constructors  *
+         ******************/
+        aligned_vector(): p(NULL), n(0), cap(0)
+        { }
+
+        //! \c na elements set to \c x
+        explicit aligned_vector(const size_t na, const T &x = T()): p(NULL), n(0), cap(0)
+        { resize(na, x); }
+
+        aligned_vector(const aligned_vector &va): p(NULL), n(0), cap(0)
+        {
+            reserve(va.n);
+            if (va.n > 0)
+                memcpy(p, va.p, va.n * sizeof(T));
+            n = va.n;
+        }
+
+        ~aligned_vector()
+        { A::deallocate(p); }
+
+        aligned_vector & operator=(const aligned_vector &va)
+        {
+            if (this != &va) {
+                aligned_vector tmp(va);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        void swap(aligned_vector &va)
+        {
+            T * const tp = p; p = va.p; va.p = tp;
+            const size_t tn = n; n = va.n; va.n = tn;
+            const size_t tc = cap; cap = va.cap; va.cap = tc;
+        }
+
+        /*************
+         *  Get/set  *
+         *************/
+        size_t size() const
+        { return n; }
+
+        //! Elements up to the end of the last SIMD register in use
+        size_t padded_size() const
+        { return padded(n); }
+
+        size_t capacity() const
+        { return cap; }
+
+        bool empty() const
+        { return n == 0; }
+
+        T * data()
+        { return p; }
+
+        const T * data() const
+        { return p; }
+
+        T & operator[](const size_t i)
+        { return p[i]; }
+
+        const T & operator[](const size_t i) const
+        { return p[i]; }
+
+        T & front()
+        { return p[0]; }
+
+        const T & front() const
+        { return p[0]; }
+
+        T & back()
+        { return p[n - 1]; }
+
+        const T & back() const
+        { return p[n - 1]; }
+
+        iterator begin()
+        { return p; }
+
+        const_iterator begin() const
+        { return p; }
+
+        iterator end()
+        { return p + n; }
+
+        const_iterator end() const
+        { return p + n; }
+
+        /***************
+         *  Modifiers  *
+         ***************/
+        //! Capacity for at least \c nc elements
+        void reserve(const size_t nc)
+        {
+            if (nc > cap)
+                reallocate(nc);
+        }
+
+        //! New elements are set to \c x, removed ones are zeroed
+        void resize(const size_t na, const T &x = T())
+        {
+            if (na > n) {
+                reserve(na);
+                for (size_t i = n; i < na; ++i)
+                    p[i] = x;
+            } else if (na < n) {
+                memset(p + na, 0, (n - na) * sizeof(T));
+            }
+            n = na;
+        }
+
+        //! Capacity grows geometrically
+        void push_back(const T &x)
+        {
+            if (n == cap)
+                reallocate((cap > 0) ? (2 * cap) : (1));
+            p[n++] = x;
+        }
+
+        void pop_back()
+        { memset(p + --n, 0, sizeof(T)); }
+
+        //! Zero all elements, capacity is kept
+        void clear()
+        { resize(0); }
+};
+
+
+}  // namespace gvl
+
+
+#endif  // _ALIGNED_VECTOR_H
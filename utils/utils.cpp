@@ -2,6 +2,7 @@
 #include <stdlib.h> // getenv
 #include <unistd.h> // sysconf
 #include "utils.h"
+#include "cpuid.h"  // get_cache
 #include "compiler_versions.h"
 
 
@@ -164,29 +165,61 @@ long int getPageSz()
 { return sysconf(_SC_PAGESIZE); }
 //{ return sysconf(_SC_PAGE_SIZE); }
 
+/*
+ *  Cache parameters are taken from CPUID (detected once, see cpuid.h) because
+ *  sysconf() reports 0 or -1 for them in some containers and C libraries.
+ *  sysconf() is used when CPUID does not describe the cache level.
+ */
 long int getL1Sz()
-{ return sysconf(_SC_LEVEL1_DCACHE_SIZE); }
+{
+    const struct cache_info *ci = get_cache(1);
+    return (ci && ci->size) ? ((long int)ci->size) : (sysconf(_SC_LEVEL1_DCACHE_SIZE));
+}
 
 long int getL1LineSz()
-{ return sysconf(_SC_LEVEL1_DCACHE_LINESIZE); }
+{
+    const struct cache_info *ci = get_cache(1);
+    return (ci && ci->line_size) ? ((long int)ci->line_size) : (sysconf(_SC_LEVEL1_DCACHE_LINESIZE));
+}
 
 long int getL1Assoc()
-{ return sysconf(_SC_LEVEL1_DCACHE_ASSOC); }
+{
+    const struct cache_info *ci = get_cache(1);
+    return (ci && ci->ways) ? ((long int)ci->ways) : (sysconf(_SC_LEVEL1_DCACHE_ASSOC));
+}
 
 long int getL2Sz()
-{ return sysconf(_SC_LEVEL2_CACHE_SIZE); }
+{
+    const struct cache_info *ci = get_cache(2);
+    return (ci && ci->size) ? ((long int)ci->size) : (sysconf(_SC_LEVEL2_CACHE_SIZE));
+}
 
 long int getL2LineSz()
-{ return sysconf(_SC_LEVEL2_CACHE_LINESIZE); }
+{
+    const struct cache_info *ci = get_cache(2);
+    return (ci && ci->line_size) ? ((long int)ci->line_size) : (sysconf(_SC_LEVEL2_CACHE_LINESIZE));
+}
 
 long int getL2Assoc()
-{ return sysconf(_SC_LEVEL2_CACHE_ASSOC); }
+{
+    const struct cache_info *ci = get_cache(2);
+    return (ci && ci->ways) ? ((long int)ci->ways) : (sysconf(_SC_LEVEL2_CACHE_ASSOC));
+}
 
 long int getL3Sz()
-{ return sysconf(_SC_LEVEL3_CACHE_SIZE); }
+{
+    const struct cache_info *ci = get_cache(3);
+    return (ci && ci->size) ? ((long int)ci->size) : (sysconf(_SC_LEVEL3_CACHE_SIZE));
+}
 
 long int getL3LineSz()
-{ return sysconf(_SC_LEVEL3_CACHE_LINESIZE); }
+{
+    const struct cache_info *ci = get_cache(3);
+    return (ci && ci->line_size) ? ((long int)ci->line_size) : (sysconf(_SC_LEVEL3_CACHE_LINESIZE));
+}
 
 long int getL3Assoc()
-{ return sysconf(_SC_LEVEL3_CACHE_ASSOC); }
+{
+    const struct cache_info *ci = get_cache(3);
+    return (ci && ci->ways) ? ((long int)ci->ways) : (sysconf(_SC_LEVEL3_CACHE_ASSOC));
+}
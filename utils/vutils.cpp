@@ -5,149 +5,125 @@
 #include <stdio.h>
 #include <stdlib.h> // posix_memalign
 #include <errno.h> // errno
+#include "sysconf.h"
 #include "vutils.h"
 
 
-int scalar_malloc(int ** const sa, const size_t align, const size_t nelems)
+/*
+ *  Aligned allocation with pages placed following NUMA policy, backed by
+ *  huge pages if requested (see hugepage.h, get_hugepage_mode() reports the
+ *  mode obtained). Placement is a hint, allocation succeeds even if the
+ *  policy is not applied. Policies other than NUMA_DEFAULT use at least
+ *  page alignment.
+ */
+static int aligned_malloc(void ** const sa, const size_t align, const size_t nelems, const size_t elem_bytes, const gvl::numa_policy policy, const gvl::hugepage_mode huge)
 {
-    int ierr = posix_memalign((void **)sa, align, nelems * sizeof(int));
+    const size_t page = gvl::SYSCONF::get_page_sz();
+    const size_t alignment = (policy != gvl::NUMA_DEFAULT && align < page) ? (page) : (align);
+    int ierr = gvl::hugepage_malloc(sa, alignment, nelems * elem_bytes, huge);
     if (ierr)
         printf("ERROR: failed to allocate aligned memory, %d\n", errno);
+    else if (policy != gvl::NUMA_DEFAULT)
+        gvl::numa_place(*sa, nelems, elem_bytes, policy);
     return ierr;
 }
 
 
-int scalar_malloc(unsigned int ** const sa, const size_t align, const size_t nelems)
-{
-    int ierr = posix_memalign((void **)sa, align, nelems * sizeof(unsigned int));
-    if (ierr)
-        printf("ERROR: failed to allocate aligned memory, %d\n", errno);
-    return ierr;
-}
+int scalar_malloc(int ** const sa, const size_t align, const size_t nelems, const gvl::numa_policy policy, const gvl::hugepage_mode huge)
+{ return aligned_malloc((void **)sa, align, nelems, sizeof(int), policy, huge); }
 
 
-int scalar_malloc(long int ** const sa, const size_t align, const size_t nelems)
-{
-    int ierr = posix_memalign((void **)sa, align, nelems * sizeof(long int));
-    if (ierr)
-        printf("ERROR: failed to allocate aligned memory, %d\n", errno);
-    return ierr;
-}
+int scalar_malloc(unsigned int ** const sa, const size_t align, const size_t nelems, const gvl::numa_policy policy, const gvl::hugepage_mode huge)
+{ return aligned_malloc((void **)sa, align, nelems, sizeof(unsigned int), policy, huge); }
 
 
-int scalar_malloc(unsigned long int ** const sa, const size_t align, const size_t nelems)
-{
-    int ierr = posix_memalign((void **)sa, align, nelems * sizeof(unsigned long int));
-    if (ierr)
-        printf("ERROR: failed to allocate aligned memory, %d\n", errno);
-    return ierr;
-}
+int scalar_malloc(long int ** const sa, const size_t align, const size_t nelems, const gvl::numa_policy policy, const gvl::hugepage_mode huge)
+{ return aligned_malloc((void **)sa, align, nelems, sizeof(long int), policy, huge); }
 
 
-int scalar_malloc(float ** const sa, const size_t align, const size_t nelems)
-{
-    int ierr = posix_memalign((void **)sa, align, nelems * sizeof(float));
-    if (ierr)
-        printf("ERROR: failed to allocate aligned memory, %d\n", errno);
-    return ierr;
-}
+int scalar_malloc(unsigned long int ** const sa, const size_t align, const size_t nelems, const gvl::numa_policy policy, const gvl::hugepage_mode huge)
+{ return aligned_malloc((void **)sa, align, nelems, sizeof(unsigned long int), policy, huge); }
 
 
-int scalar_malloc(double ** const sa, const size_t align, const size_t nelems)
-{
-    int ierr = posix_memalign((void **)sa, align, nelems * sizeof(double));
-    if (ierr)
-        printf("ERROR: failed to allocate aligned memory, %d\n", errno);
-    return ierr;
-}
+int scalar_malloc(float ** const sa, const size_t align, const size_t nelems, const gvl::numa_policy policy, const gvl::hugepage_mode huge)
+{ return aligned_malloc((void **)sa, align, nelems, sizeof(float), policy, huge); }
 
 
-int simd_malloc(SIMD_INT ** const va, const size_t align, const size_t nelems)
-{
-    int ierr = posix_memalign((void **)va, align, nelems * sizeof(SIMD_INT));
-    if (ierr)
-        printf("ERROR: failed to allocate aligned memory, %d\n", errno);
-    return ierr;
-}
+int scalar_malloc(double ** const sa, const size_t align, const size_t nelems, const gvl::numa_policy policy, const gvl::hugepage_mode huge)
+{ return aligned_malloc((void **)sa, align, nelems, sizeof(double), policy, huge); }
 
 
-int simd_malloc(SIMD_FLT ** const va, const size_t align, const size_t nelems)
-{
-    int ierr = posix_memalign((void **)va, align, nelems * sizeof(SIMD_FLT));
-    if (ierr)
-        printf("ERROR: failed to allocate aligned memory, %d\n", errno);
-    return ierr;
-}
+int simd_malloc(SIMD_INT ** const va, const size_t align, const size_t nelems, const gvl::numa_policy policy, const gvl::hugepage_mode huge)
+{ return aligned_malloc((void **)va, align, nelems, sizeof(SIMD_INT), policy, huge); }
 
 
-int simd_malloc(SIMD_DBL ** const va, const size_t align, const size_t nelems)
-{
-    int ierr = posix_memalign((void **)va, align, nelems * sizeof(SIMD_DBL));
-    if (ierr)
-        printf("ERROR: failed to allocate aligned memory, %d\n", errno);
-    return ierr;
-}
+int simd_malloc(SIMD_FLT ** const va, const size_t align, const size_t nelems, const gvl::numa_policy policy, const gvl::hugepage_mode huge)
+{ return aligned_malloc((void **)va, align, nelems, sizeof(SIMD_FLT), policy, huge); }
+
+
+int simd_malloc(SIMD_DBL ** const va, const size_t align, const size_t nelems, const gvl::numa_policy policy, const gvl::hugepage_mode huge)
+{ return aligned_malloc((void **)va, align, nelems, sizeof(SIMD_DBL), policy, huge); }
 
 
 void scalar_free(int ** const va)
 {
-    if (va) free(*va);
+    if (va) gvl::hugepage_free(*va);
     *va = NULL;
 }
 
 
 void scalar_free(unsigned int ** const va)
 {
-    if (va) free(*va);
+    if (va) gvl::hugepage_free(*va);
     *va = NULL;
 }
 
 
 void scalar_free(long int ** const va)
 {
-    if (va) free(*va);
+    if (va) gvl::hugepage_free(*va);
     *va = NULL;
 }
 
 
 void scalar_free(unsigned long int ** const va)
 {
-    if (va) free(*va);
+    if (va) gvl::hugepage_free(*va);
     *va = NULL;
 }
 
 
 void scalar_free(float ** const va)
 {
-    if (va) free(*va);
+    if (va) gvl::hugepage_free(*va);
     *va = NULL;
 }
 
 
 void scalar_free(double ** const va)
 {
-    if (va) free(*va);
+    if (va) gvl::hugepage_free(*va);
     *va = NULL;
 }
 
 
 void simd_free(SIMD_INT ** const va)
 {
-    if (va) free(*va);
+    if (va) gvl::hugepage_free(*va);
     *va = NULL;
 }
 
 
 void simd_free(SIMD_FLT ** const va)
 {
-    if (va) free(*va);
+    if (va) gvl::hugepage_free(*va);
     *va = NULL;
 }
 
 
 void simd_free(SIMD_DBL ** const va)
 {
-    if (va) free(*va);
+    if (va) gvl::hugepage_free(*va);
     *va = NULL;
 }
 
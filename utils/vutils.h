@@ -6,21 +6,25 @@
 #if defined(SIMD_MODE)
 
 
-int scalar_malloc(int ** const, const size_t, const size_t);
-int scalar_malloc(unsigned int ** const, const size_t, const size_t);
-int scalar_malloc(long int ** const, const size_t, const size_t);
-int scalar_malloc(unsigned long int ** const, const size_t, const size_t);
-int scalar_malloc(float ** const, const size_t, const size_t);
-int scalar_malloc(double ** const, const size_t, const size_t);
+#include "numa.h"      // numa_policy
+#include "hugepage.h"  // hugepage_mode
+
+
+int scalar_malloc(int ** const, const size_t, const size_t, const gvl::numa_policy = gvl::NUMA_DEFAULT, const gvl::hugepage_mode = gvl::HUGEPAGE_NONE);
+int scalar_malloc(unsigned int ** const, const size_t, const size_t, const gvl::numa_policy = gvl::NUMA_DEFAULT, const gvl::hugepage_mode = gvl::HUGEPAGE_NONE);
+int scalar_malloc(long int ** const, const size_t, const size_t, const gvl::numa_policy = gvl::NUMA_DEFAULT, const gvl::hugepage_mode = gvl::HUGEPAGE_NONE);
+int scalar_malloc(unsigned long int ** const, const size_t, const size_t, const gvl::numa_policy = gvl::NUMA_DEFAULT, const gvl::hugepage_mode = gvl::HUGEPAGE_NONE);
+int scalar_malloc(float ** const, const size_t, const size_t, const gvl::numa_policy = gvl::NUMA_DEFAULT, const gvl::hugepage_mode = gvl::HUGEPAGE_NONE);
+int scalar_malloc(double ** const, const size_t, const size_t, const gvl::numa_policy = gvl::NUMA_DEFAULT, const gvl::hugepage_mode = gvl::HUGEPAGE_NONE);
 void scalar_free(int ** const);
 void scalar_free(unsigned int ** const);
 void scalar_free(long int ** const);
 void scalar_free(unsigned long int ** const);
 void scalar_free(float ** const);
 void scalar_free(double ** const);
-int simd_malloc(SIMD_INT ** const, const size_t, const size_t);
-int simd_malloc(SIMD_FLT ** const, const size_t, const size_t);
-int simd_malloc(SIMD_DBL ** const, const size_t, const size_t);
+int simd_malloc(SIMD_INT ** const, const size_t, const size_t, const gvl::numa_policy = gvl::NUMA_DEFAULT, const gvl::hugepage_mode = gvl::HUGEPAGE_NONE);
+int simd_malloc(SIMD_FLT ** const, const size_t, const size_t, const gvl::numa_policy = gvl::NUMA_DEFAULT, const gvl::hugepage_mode = gvl::HUGEPAGE_NONE);
+int simd_malloc(SIMD_DBL ** const, const size_t, const size_t, const gvl::numa_policy = gvl::NUMA_DEFAULT, const gvl::hugepage_mode = gvl::HUGEPAGE_NONE);
 void simd_free(SIMD_INT ** const);
 void simd_free(SIMD_FLT ** const);
 void simd_free(SIMD_DBL ** const);